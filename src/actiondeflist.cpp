@@ -4,12 +4,14 @@
 
 #include "lara.h"
 #include "actiondeflist.h"
+#include "timestampparser.h"
 
 cActionDefList::cActionDefList( const QString &p_qsActionDefFile, const QString &p_qsSchemaFile ) throw()
 {
     cTracer  obTracer( &g_obLogger, "cActionDefList::cActionDefList", p_qsActionDefFile.toStdString() );
 
     m_poActionsDoc = new QDomDocument( "actions" );
+    for( int i = 0; i < cTimeStampPart::MAX - 1; i++ ) m_poTimeStampParts[i] = cTimeStampPart::MIN;
 
     try
     {
@@ -20,6 +22,12 @@ cActionDefList::cActionDefList( const QString &p_qsActionDefFile, const QString
     {
         g_obLogger << e;
     }
+
+    // The matchers are built even if parsing stopped half way, so they always cover exactly
+    // the Patterns in m_vePatternList
+    buildMatchers();
+
+    m_poTimeStampParser = new cTimeStampParser( this );
 }
 
 cActionDefList::~cActionDefList()
@@ -27,6 +35,7 @@ cActionDefList::~cActionDefList()
 {
     cTracer  obTracer( &g_obLogger, "cActionDefList::~cActionDefList" );
 
+    delete m_poTimeStampParser;
     delete m_poActionsDoc;
 }
 
@@ -83,6 +92,21 @@ cTimeStampPart::teTimeStampPart cActionDefList::timeStampPart( const unsigned in
         return m_poTimeStampParts[p_uiIndex];
 }
 
+const cLiteralFilter &cActionDefList::literalFilter() const throw()
+{
+    return m_obLiteralFilter;
+}
+
+const cRegExpSet &cActionDefList::regExpSet() const throw()
+{
+    return m_obRegExpSet;
+}
+
+const cTimeStampParser &cActionDefList::timeStampParser() const throw()
+{
+    return *m_poTimeStampParser;
+}
+
 void cActionDefList::validateActionDef( const QString &p_qsActionDefFile, const QString &p_qsSchemaFile ) throw( cSevException )
 {
     cTracer  obTracer( &g_obLogger, "cActionList::validateActionDef", p_qsActionDefFile.toStdString() );
@@ -148,7 +172,16 @@ void cActionDefList::parseActionDef() throw( cSevException )
     {
         if( obElem.tagName() == "pattern" )
         {
-            m_vePatternList.push_back( cPattern( &obElem ) );
+            // A Pattern with an invalid regular expression is left out, the rest of the
+            // Patterns are still used
+            try
+            {
+                m_vePatternList.push_back( cPattern( &obElem ) );
+            }
+            catch( cSevException &e )
+            {
+                g_obLogger << e;
+            }
             continue;
         }
 
@@ -171,3 +204,37 @@ void cActionDefList::parseActionDef() throw( cSevException )
         }
     }
 }
+
+void cActionDefList::buildMatchers() throw()
+{
+    cTracer  obTracer( &g_obLogger, "cActionDefList::buildMatchers" );
+
+    QStringList  slLiterals;
+    QStringList  slRegExps;
+    unsigned int uiLiteralCount = 0;
+    unsigned int uiFusedCount   = 0;
+    for( tvPatternList::iterator itPattern = m_vePatternList.begin(); itPattern != m_vePatternList.end(); itPattern++ )
+    {
+        slLiterals.push_back( itPattern->literal() );
+        slRegExps.push_back( itPattern->pattern() );
+        if( !itPattern->literal().isEmpty() ) uiLiteralCount++;
+
+        itPattern->fuse( m_obTimeStampRegExp.pattern() );
+        if( itPattern->fused() ) uiFusedCount++;
+
+        obTracer << QString( "Pattern %1 uses the %2 engine" ).arg( itPattern->name() ).arg( cPattern::engineName( itPattern->engine() ) ).toStdString();
+
+        if( itPattern->backtrackingProne() )
+        {
+            g_obLogger << cSeverity::WARNING
+                       << QString( "Pattern %1 is prone to backtracking, it may run out of the match budget on long Log Lines: %2" ).arg( itPattern->name() ).arg( itPattern->pattern() ).toStdString()
+                       << cLogMessage::EOM;
+        }
+    }
+    m_obLiteralFilter.build( slLiterals );
+    m_obRegExpSet.build( slRegExps );
+
+    obTracer << QString( "Prefilter literals found for %1 of %2 patterns" ).arg( uiLiteralCount ).arg( m_vePatternList.size() ).toStdString();
+    obTracer << QString( "Regexp set covers %1 of %2 patterns" ).arg( m_obRegExpSet.coveredCount() ).arg( m_vePatternList.size() ).toStdString();
+    obTracer << QString( "Time-stamp fused into %1 of %2 patterns" ).arg( uiFusedCount ).arg( m_vePatternList.size() ).toStdString();
+}
@@ -10,9 +10,13 @@
 #include <sevexception.h>
 
 #include "pattern.h"
+#include "literalfilter.h"
+#include "regexpset.h"
 #include "actiondefsingleliner.h"
 #include "countaction.h"
 
+class cTimeStampParser;
+
 //! Convenience class to provide conversion functions for the TimeStampPart enum values
 /*! TimeStampPart is used to identify the different numerical values (for example year,
  *  month, etc) within a timestamp string. The possible enum values are:
@@ -84,6 +88,12 @@ public:
  *  In addition to the Pattern and ActionDef lists, this class also holds the Time Stamp
  *  format used to parse the time stamps from the input log, and the list of Pattern names
  *  that defines the Batch Attributes.
+ *
+ *  Once the XML file is read, the list does not change anymore: every object it returns
+ *  (Patterns, the prefilter, the regular expression set and the time-stamp parser) is
+ *  used through <tt>const</tt> functions that keep their mutable state in scratch objects
+ *  owned by the caller. One cActionDefList can therefore be shared by several scanner
+ *  threads without locks and without copying.
  */
 class cActionDefList
 {
@@ -185,6 +195,9 @@ public:
      *  and the given log line is skipped if it doesn't match) otherwise the time-stamp of
      *  the Action couldn't be determined. Each part of the time stamp (Year, Month, Day,
      *  etc) is captured using the "capture" feature of regular expressions.
+     *
+     *  The returned QRegExp is a copy, matching with it does not affect the Action
+     *  Definitions. Log Analysis uses timeStampParser() instead.
      */
     QRegExp                          timeStampRegExp() const throw();
 
@@ -203,6 +216,32 @@ public:
      */
     cTimeStampPart::teTimeStampPart  timeStampPart( const unsigned int p_uiIndex ) const throw();
 
+    //! \brief Returns the literal prefilter built from the defined Patterns
+    /*! The prefilter is built when the XML file is parsed, from the required literals of
+     *  all the Patterns (see cPattern::literal()). The Patterns are indexed in the filter
+     *  in the same order as they can be iterated with patternBegin() and patternEnd().
+     *  \sa cLiteralFilter
+     *  \return Reference to the prefilter of the Pattern list
+     */
+    const cLiteralFilter            &literalFilter() const throw();
+
+    //! \brief Returns the combined automaton of the defined Patterns
+    /*! The automaton is built when the XML file is parsed, from the regular expressions of
+     *  all the Patterns. The Patterns are indexed in the set in the same order as they can
+     *  be iterated with patternBegin() and patternEnd().
+     *  \sa cRegExpSet
+     *  \return Reference to the regular expression set of the Pattern list
+     */
+    const cRegExpSet                &regExpSet() const throw();
+
+    //! \brief Returns the parser of the time-stamps defined by timeStampRegExp()
+    /*! The parser is built when the XML file is parsed. It is shared by everyone using the
+     *  Action Definitions, the state of parsing is kept in a cTimeStampScratch.
+     *  \sa cTimeStampParser
+     *  \return Reference to the time-stamp parser
+     */
+    const cTimeStampParser          &timeStampParser() const throw();
+
 private:
     //! Holds the contents of the XML configuration file fully parsed
     QDomDocument                    *m_poActionsDoc;
@@ -227,6 +266,21 @@ private:
      */
     tvPatternList                    m_vePatternList;
 
+    //! Holds the literal prefilter of the defined Patterns
+    /*! \sa literalFilter()
+     */
+    cLiteralFilter                   m_obLiteralFilter;
+
+    //! Holds the combined automaton of the defined Patterns
+    /*! \sa regExpSet()
+     */
+    cRegExpSet                       m_obRegExpSet;
+
+    //! Holds the parser of the time-stamps
+    /*! \sa timeStampParser()
+     */
+    cTimeStampParser                *m_poTimeStampParser;
+
     //! Holds the list of the defined SingleLiner Actions
     /*! \sa singleLinerBegin() singleLinerEnd()
      */
@@ -256,6 +310,13 @@ private:
      *  containers.
      */
     void parseActionDef() throw( cSevException );
+
+    //! Builds the literal prefilter and the regular expression set of the Patterns
+    /*! Fuses the time-stamp into the Patterns, and builds m_obLiteralFilter and
+     *  m_obRegExpSet from the Patterns kept in m_vePatternList, so both are indexed the same
+     *  way as the Pattern list.
+     */
+    void buildMatchers() throw();
 };
 
 #endif // ACTIONDEFLIST_H
@@ -6,6 +6,8 @@
 #include "batchanalyser.h"
 #include "loganalyser.h"
 #include "outputcreator.h"
+#include "filediscovery.h"
+#include "timecatalog.h"
 
 using namespace std;
 
@@ -34,15 +36,24 @@ cBatchAnalyser::~cBatchAnalyser()
     delete m_poBatchDoc;
 }
 
-void cBatchAnalyser::analyse() throw()
+void cBatchAnalyser::analyse( const bool p_boFollow, const bool p_boResume ) throw()
 {
+    // The directories listed for an Input Log are not listed again for the next ones
+    cFileDiscovery  obDiscovery( g_poPrefs->discoveryThreads() );
+
     for( unsigned int i = 0; i < m_veAnalyseDefs.size(); i++ )
     {
         tsAnalyseDefinition  suAnalysis = m_veAnalyseDefs.at( i );
         g_obLogger << cSeverity::INFO << "Starting to analyse " << suAnalysis.qsName.toStdString();
 
         QString qsFullDirPrefix = m_qsDirPrefix + "/" + suAnalysis.qsName;
-        cOutputCreator  *poOC = new cOutputCreator( qsFullDirPrefix );
+        cOutputCreator  *poOC = new cOutputCreator( qsFullDirPrefix, p_boFollow, p_boResume );
+        if( poOC->checkpoint() && poOC->checkpoint()->analysisDone() )
+        {
+            g_obLogger << cSeverity::INFO << "Skipping " << suAnalysis.qsName.toStdString() << ", it was finished before the checkpoint" << cLogMessage::EOM;
+            delete poOC;
+            continue;
+        }
 
         for( tiAttributes itAttrib = suAnalysis.maAttributes.begin();
              itAttrib != suAnalysis.maAttributes.end();
@@ -53,7 +64,11 @@ void cBatchAnalyser::analyse() throw()
 
         for( unsigned int l = 0; l < suAnalysis.veInputLogs.size(); l++ )
         {
-            cLogAnalyser  obAnalyser( qsFullDirPrefix, suAnalysis.veInputLogs.at( l ).qsFiles, suAnalysis.veInputLogs.at( l ).qsActionDefFile, poOC );
+            cLogAnalyser  obAnalyser( qsFullDirPrefix, suAnalysis.veInputLogs.at( l ).qsFiles, suAnalysis.veInputLogs.at( l ).qsActionDefFile, poOC, &obDiscovery );
+            if( suAnalysis.veInputLogs.at( l ).boTimeRange )
+            {
+                obAnalyser.setTimeRange( suAnalysis.veInputLogs.at( l ).ullFrom, suAnalysis.veInputLogs.at( l ).ullTo );
+            }
             obAnalyser.analyse();
         }
 
@@ -64,6 +79,17 @@ void cBatchAnalyser::analyse() throw()
             poOC->generateCombilog();
             poOC->uploadActionSummary();
             poOC->uploadActionList();
+            poOC->finishCheckpoint();
+        } catch( cSevException &e )
+        {
+            g_obLogger << e;
+        }
+
+        // The Input Log Files were read even if an output failed, reading them again would
+        // count their Actions twice
+        try
+        {
+            poOC->saveFollowState();
         } catch( cSevException &e )
         {
             g_obLogger << e;
@@ -136,6 +162,8 @@ void cBatchAnalyser::parseBatchDef() throw( cSevException )
     {
         tsAnalyseDefinition  suAnalyseDef;
         suAnalyseDef.qsName = obElem.attribute( "name", "" );
+        QString qsFrom = obElem.attribute( "from", "" );
+        QString qsTo   = obElem.attribute( "to", "" );
         for( QDomElement obLogElem = obElem.firstChildElement( "input_log" );
              !obLogElem.isNull();
              obLogElem = obLogElem.nextSiblingElement( "input_log" ) )
@@ -143,6 +171,22 @@ void cBatchAnalyser::parseBatchDef() throw( cSevException )
             tsInputLogDefinition suInputLog;
             suInputLog.qsFiles = obLogElem.attribute( "files", "" );
             suInputLog.qsActionDefFile = obLogElem.attribute( "action_def" );
+
+            QString qsLogFrom = obLogElem.attribute( "from", qsFrom );
+            QString qsLogTo   = obLogElem.attribute( "to", qsTo );
+            suInputLog.boTimeRange = !qsLogFrom.isEmpty() || !qsLogTo.isEmpty();
+            suInputLog.ullFrom     = 0;
+            suInputLog.ullTo       = ~0ULL;
+            if( !qsLogFrom.isEmpty() && !cTimeCatalog::parseTime( qsLogFrom, &suInputLog.ullFrom ) )
+            {
+                throw cSevException( cSeverity::ERROR,
+                                     QString( "Invalid from time \"%1\" in analysis %2" ).arg( qsLogFrom ).arg( suAnalyseDef.qsName ).toStdString() );
+            }
+            if( !qsLogTo.isEmpty() && !cTimeCatalog::parseTime( qsLogTo, &suInputLog.ullTo ) )
+            {
+                throw cSevException( cSeverity::ERROR,
+                                     QString( "Invalid to time \"%1\" in analysis %2" ).arg( qsLogTo ).arg( suAnalyseDef.qsName ).toStdString() );
+            }
             suAnalyseDef.veInputLogs.push_back( suInputLog );
         }
 
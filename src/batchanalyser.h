@@ -37,8 +37,21 @@ public:
      *  \li If there are Batch Attributes, add them to the cOutputCreator
      *  \li Create a cLogAnalyser and run it
      *  \li Generate outputs using cOutputCreator functions
+     *
+     *  The Input Log Files of all the Log Analysis are found by the same cFileDiscovery, so
+     *  each directory of the Input Directory is only listed once during the Batch Analysis.
+     *
+     *  In follow mode each Log Analysis continues the previous run of the same Batch: only
+     *  the Log Lines appended to the Input Log Files since then are analysed, and the results
+     *  are added to the previous ones (see cFollowState). The state of the Input Log Files is
+     *  saved after the outputs are generated.
+     *
+     *  When resuming, each Log Analysis continues from its last checkpoint (see cCheckpoint),
+     *  and a Log Analysis that generated its outputs before is skipped.
+     *  \param p_boFollow if <tt>true</tt>, the Input Log Files are followed
+     *  \param p_boResume if <tt>true</tt>, the Batch Analysis is resumed from the checkpoints
      */
-    void analyse() throw();
+    void analyse( const bool p_boFollow = false, const bool p_boResume = false ) throw();
 
 private:
     //! \brief Holds Input Log Names and the XML file name used to analyse those logs.
@@ -48,6 +61,12 @@ private:
         QString  qsFiles;
         //! Name of the XML Action Definition file used to analyse the Input Log Files
         QString  qsActionDefFile;
+        //! True if the analysis of the Input Log Files is limited to a time range
+        bool                boTimeRange;
+        //! Start of the time range as a cTimeCatalog::timeKey(), included
+        unsigned long long  ullFrom;
+        //! End of the time range as a cTimeCatalog::timeKey(), not included
+        unsigned long long  ullTo;
     } tsInputLogDefinition;
 
     //! Vector container type to hold Input Log definitions
@@ -95,7 +114,9 @@ private:
     //! \brief Parse and read the contents of the Batch Definition XML file
     /*! Parsing is called after a successful validation (validateBatchDef()) and reads the
      *  contents into memory. Each <tt>analysis</tt> tag is stored in the m_veAnalyseDefs
-     *  vector.
+     *  vector. The <tt>from</tt> and <tt>to</tt> attributes of an <tt>input_log</tt> tag
+     *  limit its analysis to a time range, by default the range of its <tt>analysis</tt>
+     *  tag is used (see cTimeCatalog::parseTime() for the format of the times).
      */
     void parseBatchDef() throw( cSevException );
 };
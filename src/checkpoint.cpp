@@ -0,0 +1,203 @@
+#include "checkpoint.h"
+
+cCheckpoint::cCheckpoint( const QString &p_qsFileName, const unsigned int p_uiInterval ) throw()
+        : m_obFile( p_qsFileName )
+{
+    m_qsFileName      = p_qsFileName;
+    m_uiInterval      = p_uiInterval;
+    m_inCommittedSize = 0;
+    m_uiAnalysersDone = 0;
+    m_uiResumeRecord  = 0;
+    m_boAnalysisDone  = false;
+    m_uiAnalysers     = 0;
+    m_tmLastCommit    = time( NULL );
+
+    m_poPending = new QDataStream( &m_baPending, QIODevice::WriteOnly );
+    m_poPending->setVersion( QDataStream::Qt_4_0 );
+}
+
+cCheckpoint::~cCheckpoint() throw()
+{
+    delete m_poPending;
+    m_obFile.close();
+}
+
+bool cCheckpoint::load() throw()
+{
+    m_veRecords.clear();
+    m_inCommittedSize = 0;
+    m_uiAnalysersDone = 0;
+    m_uiResumeRecord  = 0;
+    m_boAnalysisDone  = false;
+
+    QFile obFile( m_qsFileName );
+    if( !obFile.open( QIODevice::ReadOnly ) ) return false;
+
+    QDataStream obStream( &obFile );
+    obStream.setVersion( QDataStream::Qt_4_0 );
+
+    // The records of a checkpoint are only taken when its COMMIT record is read, the end of a
+    // checkpoint interrupted while it was written is dropped
+    std::vector<tsRecord> veCheckpoint;
+    while( !obStream.atEnd() )
+    {
+        quint8   uiType = 0;
+        tsRecord suRecord;
+        obStream >> uiType >> suRecord.baData;
+        if( obStream.status() != QDataStream::Ok || uiType < FILE_ID || uiType > COMMIT ) break;
+
+        suRecord.enType = (teRecord)uiType;
+        if( suRecord.enType != COMMIT )
+        {
+            veCheckpoint.push_back( suRecord );
+            continue;
+        }
+
+        for( unsigned int i = 0; i < veCheckpoint.size(); i++ )
+        {
+            m_veRecords.push_back( veCheckpoint[i] );
+            if( veCheckpoint[i].enType == ANALYSER_DONE )
+            {
+                m_uiAnalysersDone++;
+                m_uiResumeRecord = m_veRecords.size();
+            }
+            else if( veCheckpoint[i].enType == ANALYSIS_DONE )
+            {
+                m_boAnalysisDone = true;
+            }
+        }
+        veCheckpoint.clear();
+        m_inCommittedSize = obFile.pos();
+    }
+
+    obFile.close();
+
+    return m_inCommittedSize > 0;
+}
+
+const std::vector<cCheckpoint::tsRecord> &cCheckpoint::records() const throw()
+{
+    return m_veRecords;
+}
+
+unsigned int cCheckpoint::analysersDone() const throw()
+{
+    return m_uiAnalysersDone;
+}
+
+unsigned int cCheckpoint::resumeRecord() const throw()
+{
+    return m_uiResumeRecord;
+}
+
+bool cCheckpoint::analysisDone() const throw()
+{
+    return m_boAnalysisDone;
+}
+
+void cCheckpoint::open( const bool p_boResume ) throw( cSevException )
+{
+    if( p_boResume )
+    {
+        if( !m_obFile.open( QIODevice::ReadWrite ) || !m_obFile.resize( m_inCommittedSize ) || !m_obFile.seek( m_inCommittedSize ) )
+        {
+            throw cSevException( cSeverity::ERROR, QString( "Cannot open checkpoint file %1: %2" ).arg( m_qsFileName ).arg( m_obFile.errorString() ).toStdString() );
+        }
+    }
+    else
+    {
+        m_veRecords.clear();
+        m_inCommittedSize = 0;
+        m_uiAnalysersDone = 0;
+        m_uiResumeRecord  = 0;
+        m_boAnalysisDone  = false;
+        if( !m_obFile.open( QIODevice::WriteOnly | QIODevice::Truncate ) )
+        {
+            throw cSevException( cSeverity::ERROR, QString( "Cannot create checkpoint file %1: %2" ).arg( m_qsFileName ).arg( m_obFile.errorString() ).toStdString() );
+        }
+    }
+
+    m_uiAnalysers  = 0;
+    m_tmLastCommit = time( NULL );
+}
+
+unsigned int cCheckpoint::beginAnalyser() throw()
+{
+    return m_uiAnalysers++;
+}
+
+void cCheckpoint::append( const teRecord p_enType, const QByteArray &p_baData ) throw()
+{
+    if( !m_obFile.isOpen() ) return;
+
+    *m_poPending << (quint8)p_enType << p_baData;
+}
+
+bool cCheckpoint::due() const throw()
+{
+    return m_obFile.isOpen() && m_uiInterval && (unsigned int)(time( NULL ) - m_tmLastCommit) >= m_uiInterval;
+}
+
+void cCheckpoint::commit() throw( cSevException )
+{
+    if( !m_obFile.isOpen() ) return;
+
+    append( COMMIT, QByteArray() );
+    m_tmLastCommit = time( NULL );
+
+    qint64 inWritten = m_obFile.write( m_baPending );
+    bool   boFlushed = m_obFile.flush();
+
+    delete m_poPending;
+    m_baPending.clear();
+    m_poPending = new QDataStream( &m_baPending, QIODevice::WriteOnly );
+    m_poPending->setVersion( QDataStream::Qt_4_0 );
+
+    if( inWritten == -1 || !boFlushed )
+    {
+        throw cSevException( cSeverity::ERROR, QString( "Cannot write checkpoint file %1: %2" ).arg( m_qsFileName ).arg( m_obFile.errorString() ).toStdString() );
+    }
+}
+
+void cCheckpoint::writeTimeStamp( QDataStream &p_obStream, const cAction::tsTimeStamp &p_suTimeStamp ) throw()
+{
+    p_obStream << (quint16)p_suTimeStamp.uiYear << (quint8)p_suTimeStamp.uiMonth << (quint8)p_suTimeStamp.uiDay
+               << (quint8)p_suTimeStamp.uiHour << (quint8)p_suTimeStamp.uiMinute << (quint8)p_suTimeStamp.uiSecond
+               << (quint16)p_suTimeStamp.uiMSecond;
+}
+
+void cCheckpoint::readTimeStamp( QDataStream &p_obStream, cAction::tsTimeStamp *p_poTimeStamp ) throw()
+{
+    quint16 uiYear, uiMSecond;
+    quint8  uiMonth, uiDay, uiHour, uiMinute, uiSecond;
+    p_obStream >> uiYear >> uiMonth >> uiDay >> uiHour >> uiMinute >> uiSecond >> uiMSecond;
+
+    p_poTimeStamp->uiYear    = uiYear;
+    p_poTimeStamp->uiMonth   = uiMonth;
+    p_poTimeStamp->uiDay     = uiDay;
+    p_poTimeStamp->uiHour    = uiHour;
+    p_poTimeStamp->uiMinute  = uiMinute;
+    p_poTimeStamp->uiSecond  = uiSecond;
+    p_poTimeStamp->uiMSecond = uiMSecond;
+}
+
+void cCheckpoint::writeAttributes( QDataStream &p_obStream, const tmActionAttribs &p_maAttributes ) throw()
+{
+    p_obStream << (quint32)p_maAttributes.size();
+    for( tiActionAttribs itAttrib = p_maAttributes.begin(); itAttrib != p_maAttributes.end(); itAttrib++ )
+    {
+        p_obStream << itAttrib->first << itAttrib->second;
+    }
+}
+
+void cCheckpoint::readAttributes( QDataStream &p_obStream, tmActionAttribs *p_poAttributes ) throw()
+{
+    quint32 uiCount = 0;
+    p_obStream >> uiCount;
+    for( quint32 i = 0; i < uiCount && p_obStream.status() == QDataStream::Ok; i++ )
+    {
+        QString qsName, qsValue;
+        p_obStream >> qsName >> qsValue;
+        (*p_poAttributes)[qsName] = qsValue;
+    }
+}
@@ -0,0 +1,146 @@
+#ifndef CHECKPOINT_H
+#define CHECKPOINT_H
+
+#include <QString>
+#include <QByteArray>
+#include <QFile>
+#include <QDataStream>
+#include <vector>
+#include <ctime>
+
+#include <sevexception.h>
+
+#include "action.h"
+
+//! \brief Checkpoints of a Log Analysis in progress, so an interrupted analysis can be resumed
+/*! All the results of a Log Analysis are kept in memory until the outputs are generated, so
+ *  a Log Analysis that is killed or crashes loses all its work. To avoid this, the changes
+ *  of the results (the Found Patterns of the cLogAnalyser in progress, and the Input Log
+ *  Files, Actions, Count Action results, Attributes and Combined Log entries stored in the
+ *  cOutputCreator) are collected as records, and written to the checkpoint file every few
+ *  seconds (see cPreferences::checkpointInterval()).
+ *
+ *  The checkpoint file is a journal: each checkpoint only appends the records collected
+ *  since the previous one, followed by a COMMIT record, so writing a checkpoint costs as
+ *  much as the results found in the last few seconds, however long the analysis has been
+ *  running. A checkpoint that was not completely written (because the process was killed
+ *  while writing it) is ignored when the file is loaded.
+ *
+ *  Each record is the type of the record followed by its data, serialized with
+ *  QDataStream. The classes that own the results create and read back the data of their
+ *  records, the checkpoint does not look into it.
+ */
+class cCheckpoint
+{
+public:
+    //! The types of the checkpoint records
+    enum teRecord
+    {
+        FILE_ID = 1,        //!< an Input Log File got a file id (cOutputCreator::fileId())
+        COMBILOG_ENTRY,     //!< a Combined Log entry was added (cOutputCreator::addCombilogEntry())
+        ACTION,             //!< an Action was added (cOutputCreator::addAction())
+        COUNT_ACTION,       //!< a Count Action result was added (cOutputCreator::addCountAction())
+        ATTRIBUTE,          //!< a global Attribute was added (cOutputCreator::addAttribute())
+        FOUND_PATTERN,      //!< a Pattern was found by the Log Analyser in progress
+        FILE_DONE,          //!< the Log Analyser in progress searched an Input Log File completely
+        PROGRESS,           //!< the position in the Input Log File being searched
+        ANALYSER_DONE,      //!< a Log Analyser stored its results in the cOutputCreator
+        ANALYSIS_DONE,      //!< the outputs of the Log Analysis were generated
+        COMMIT,             //!< end of a checkpoint
+        FILE_RESTART        //!< the Input Log File being searched changed, its results so far are dropped
+    };
+
+    //! A record read back from the checkpoint file
+    typedef struct
+    {
+        //! Type of the record
+        teRecord    enType;
+        //! Data of the record
+        QByteArray  baData;
+    } tsRecord;
+
+    //! \brief Constructor
+    /*! \param p_qsFileName name of the checkpoint file
+     *  \param p_uiInterval the number of seconds between two checkpoints, 0 if checkpoints are
+     *         only written when commit() is called
+     */
+    cCheckpoint( const QString &p_qsFileName, const unsigned int p_uiInterval ) throw();
+
+    //! \brief Destructor that closes the checkpoint file, the records not committed are lost
+    ~cCheckpoint() throw();
+
+    //! \brief Loads the records of the checkpoint file up to the last complete checkpoint
+    /*! \return <tt>false</tt> if there is no complete checkpoint in the file
+     */
+    bool                          load() throw();
+
+    //! \brief Returns the records loaded by load()
+    const std::vector<tsRecord>  &records() const throw();
+
+    //! \brief Returns the number of Log Analysers that finished before the loaded checkpoint
+    unsigned int                  analysersDone() const throw();
+
+    //! \brief Returns the index of the first loaded record of the Log Analyser in progress
+    unsigned int                  resumeRecord() const throw();
+
+    //! \brief Returns <tt>true</tt> if the loaded checkpoint is the end of the Log Analysis
+    bool                          analysisDone() const throw();
+
+    //! \brief Opens the checkpoint file for writing
+    /*! \param p_boResume if <tt>true</tt>, the new checkpoints are appended to the ones loaded
+     *         by load(), otherwise the file is started again
+     */
+    void                          open( const bool p_boResume ) throw( cSevException );
+
+    //! \brief Returns the index of the next Log Analyser, they are counted from 0
+    unsigned int                  beginAnalyser() throw();
+
+    //! \brief Adds a record to the next checkpoint
+    void                          append( const teRecord p_enType, const QByteArray &p_baData ) throw();
+
+    //! \brief Returns <tt>true</tt> if the next checkpoint is due
+    bool                          due() const throw();
+
+    //! \brief Writes the records added since the last checkpoint to the checkpoint file
+    void                          commit() throw( cSevException );
+
+    //! \brief Writes a time-stamp into a record
+    static void                   writeTimeStamp( QDataStream &p_obStream, const cAction::tsTimeStamp &p_suTimeStamp ) throw();
+
+    //! \brief Reads a time-stamp from a record
+    static void                   readTimeStamp( QDataStream &p_obStream, cAction::tsTimeStamp *p_poTimeStamp ) throw();
+
+    //! \brief Writes a list of Attributes into a record
+    static void                   writeAttributes( QDataStream &p_obStream, const tmActionAttribs &p_maAttributes ) throw();
+
+    //! \brief Reads a list of Attributes from a record
+    static void                   readAttributes( QDataStream &p_obStream, tmActionAttribs *p_poAttributes ) throw();
+
+private:
+    //! Name of the checkpoint file
+    QString                m_qsFileName;
+    //! The number of seconds between two checkpoints
+    unsigned int           m_uiInterval;
+    //! The checkpoint file, open for appending after open()
+    QFile                  m_obFile;
+    //! Size of the checkpoint file up to the end of the last complete checkpoint
+    qint64                 m_inCommittedSize;
+    //! The records loaded by load()
+    std::vector<tsRecord>  m_veRecords;
+    //! Number of Log Analysers that finished before the loaded checkpoint
+    unsigned int           m_uiAnalysersDone;
+    //! Index of the first loaded record of the Log Analyser in progress
+    unsigned int           m_uiResumeRecord;
+    //! True if the loaded checkpoint is the end of the Log Analysis
+    bool                   m_boAnalysisDone;
+    //! Number of Log Analysers begun since open()
+    unsigned int           m_uiAnalysers;
+    //! The serialized records added since the last checkpoint
+    QByteArray             m_baPending;
+    //! The stream that serializes the records into m_baPending
+    QDataStream           *m_poPending;
+    //! Time of the last checkpoint
+    time_t                 m_tmLastCommit;
+};
+
+#endif // CHECKPOINT_H
@@ -0,0 +1,251 @@
+#include <QDir>
+#include <QFileInfo>
+#include <QDateTime>
+#include <QRegExp>
+#include <algorithm>
+
+#include "filediscovery.h"
+
+// The component of a mask matching any number of directories
+static const char *DISCOVERY_RECURSIVE = "**";
+
+// Extensions of the index files LARA writes, these are never Input Log Files
+static const char *DISCOVERY_SIDECARS[] = { ".tcat", ".gzidx", ".lidx", ".tcat.tmp", ".gzidx.tmp", ".lidx.tmp" };
+
+static bool isSidecar( const QString &p_qsFileName )
+{
+    for( unsigned int i = 0; i < sizeof( DISCOVERY_SIDECARS ) / sizeof( DISCOVERY_SIDECARS[0] ); i++ )
+    {
+        if( p_qsFileName.endsWith( DISCOVERY_SIDECARS[i], Qt::CaseInsensitive ) ) return true;
+    }
+
+    return false;
+}
+
+static bool hasWildCards( const QString &p_qsComponent )
+{
+    return p_qsComponent.contains( '*' ) || p_qsComponent.contains( '?' ) || p_qsComponent.contains( '[' );
+}
+
+static bool fileNameLess( const cFileDiscovery::tsFileEntry &p_suLeft, const cFileDiscovery::tsFileEntry &p_suRight )
+{
+    // Names differing only in case are ordered case-sensitively, so the copies of the same
+    // name are always next to each other for fileNameEqual()
+    int inResult = QString::compare( p_suLeft.qsFileName, p_suRight.qsFileName, Qt::CaseInsensitive );
+    if( inResult == 0 ) inResult = QString::compare( p_suLeft.qsFileName, p_suRight.qsFileName );
+    return inResult < 0;
+}
+
+static bool fileNameEqual( const cFileDiscovery::tsFileEntry &p_suLeft, const cFileDiscovery::tsFileEntry &p_suRight )
+{
+    return p_suLeft.qsFileName == p_suRight.qsFileName;
+}
+
+cFileDiscovery::cFileDiscovery( const unsigned int p_uiThreads ) throw()
+{
+    m_uiThreads = p_uiThreads ? p_uiThreads : 1;
+    m_uiBusy    = 0;
+}
+
+cFileDiscovery::~cFileDiscovery() throw()
+{
+}
+
+cFileDiscovery::tvFileEntries cFileDiscovery::find( const QString &p_qsMask ) throw()
+{
+    // The components without wild-cards at the beginning of the mask are the directory the
+    // search starts from, the last component is always matched against the file names
+    QStringList slComponents = p_qsMask.split( QRegExp( "[/\\\\]" ) );
+    int         inFirst      = 0;
+    while( inFirst < slComponents.size() - 1 && !hasWildCards( slComponents.at( inFirst ) ) ) inFirst++;
+
+    QString qsRoot = QStringList( slComponents.mid( 0, inFirst ) ).join( "/" );
+    if( qsRoot.isEmpty() ) qsRoot = p_qsMask.startsWith( '/' ) ? "/" : ".";
+
+    bool boRecursive = false;
+    m_slComponents.clear();
+    for( int i = inFirst; i < slComponents.size(); i++ )
+    {
+        // Empty components of doubled separators are dropped, except the file name
+        if( slComponents.at( i ).isEmpty() && i < slComponents.size() - 1 ) continue;
+        if( slComponents.at( i ) == DISCOVERY_RECURSIVE ) boRecursive = true;
+        m_slComponents.push_back( slComponents.at( i ) );
+    }
+
+    tsPending suRoot = { qsRoot, 0 };
+    m_vePending.assign( 1, suRoot );
+    m_veFound.clear();
+    m_uiBusy = 0;
+
+    // Masks that are not recursive only list one directory for each wild-card component,
+    // they are not worth starting threads for
+    std::vector<cDiscoveryThread*> veThreads;
+    for( unsigned int i = 1; boRecursive && i < m_uiThreads; i++ )
+    {
+        veThreads.push_back( new cDiscoveryThread( this ) );
+        veThreads.back()->start();
+    }
+
+    walk();
+
+    for( unsigned int i = 0; i < veThreads.size(); i++ )
+    {
+        veThreads[i]->wait();
+        delete veThreads[i];
+    }
+
+    // A file can be found on more than one path if the mask has several recursive components
+    tvFileEntries veFound;
+    veFound.swap( m_veFound );
+    std::sort( veFound.begin(), veFound.end(), fileNameLess );
+    veFound.erase( std::unique( veFound.begin(), veFound.end(), fileNameEqual ), veFound.end() );
+
+    return veFound;
+}
+
+unsigned int cFileDiscovery::listedDirs() const throw()
+{
+    QMutexLocker obLocker( &m_obMutex );
+
+    return m_maDirectories.size();
+}
+
+void cFileDiscovery::walk() throw()
+{
+    m_obMutex.lock();
+    for( ;; )
+    {
+        while( m_vePending.empty() && m_uiBusy ) m_obPending.wait( &m_obMutex );
+        if( m_vePending.empty() ) break;
+
+        tsPending suPending = m_vePending.back();
+        m_vePending.pop_back();
+        m_uiBusy++;
+        m_obMutex.unlock();
+
+        search( suPending );
+
+        m_obMutex.lock();
+        m_uiBusy--;
+        m_obPending.wakeAll();
+    }
+    m_obMutex.unlock();
+}
+
+void cFileDiscovery::search( const tsPending &p_suPending ) throw()
+{
+    QString qsComponent = m_slComponents.at( p_suPending.inComponent );
+    bool    boLast      = p_suPending.inComponent == m_slComponents.size() - 1;
+    QString qsPrefix    = p_suPending.qsDir.endsWith( '/' ) ? p_suPending.qsDir : p_suPending.qsDir + "/";
+
+    std::vector<tsPending> veNext;
+    tvFileEntries          veFound;
+
+    if( !boLast && !hasWildCards( qsComponent ) )
+    {
+        // A plain directory name does not need the directory to be listed
+        tsPending suNext = { qsPrefix + qsComponent, p_suPending.inComponent + 1 };
+        veNext.push_back( suNext );
+    }
+    else
+    {
+        const tsDirectory &suDirectory = directory( p_suPending.qsDir );
+
+        if( qsComponent == DISCOVERY_RECURSIVE )
+        {
+            // The recursive component matches this directory, and all the subdirectories
+            if( boLast )
+            {
+                veFound = suDirectory.veFiles;
+            }
+            else
+            {
+                tsPending suNext = { p_suPending.qsDir, p_suPending.inComponent + 1 };
+                veNext.push_back( suNext );
+            }
+            for( int i = 0; i < suDirectory.slSubDirs.size(); i++ )
+            {
+                tsPending suNext = { qsPrefix + suDirectory.slSubDirs.at( i ), p_suPending.inComponent };
+                veNext.push_back( suNext );
+            }
+        }
+        else
+        {
+            QRegExp obFilter( qsComponent, Qt::CaseInsensitive, QRegExp::Wildcard );
+            if( boLast )
+            {
+                for( unsigned int i = 0; i < suDirectory.veFiles.size(); i++ )
+                {
+                    QString qsName = suDirectory.veFiles[i].qsFileName.section( '/', -1 );
+                    if( obFilter.exactMatch( qsName ) ) veFound.push_back( suDirectory.veFiles[i] );
+                }
+            }
+            else
+            {
+                for( int i = 0; i < suDirectory.slSubDirs.size(); i++ )
+                {
+                    if( !obFilter.exactMatch( suDirectory.slSubDirs.at( i ) ) ) continue;
+
+                    tsPending suNext = { qsPrefix + suDirectory.slSubDirs.at( i ), p_suPending.inComponent + 1 };
+                    veNext.push_back( suNext );
+                }
+            }
+        }
+    }
+
+    m_obMutex.lock();
+    m_veFound.insert( m_veFound.end(), veFound.begin(), veFound.end() );
+    m_vePending.insert( m_vePending.end(), veNext.begin(), veNext.end() );
+    if( !veNext.empty() ) m_obPending.wakeAll();
+    m_obMutex.unlock();
+}
+
+const cFileDiscovery::tsDirectory &cFileDiscovery::directory( const QString &p_qsDir ) throw()
+{
+    m_obMutex.lock();
+    tiDirectories itDirectory = m_maDirectories.find( p_qsDir );
+    bool          boListed    = itDirectory != m_maDirectories.end();
+    m_obMutex.unlock();
+
+    // The nodes of the map are never moved or changed once inserted, so the listing can be
+    // read without holding the mutex
+    if( boListed ) return itDirectory->second;
+
+    // A directory that does not exist has an empty listing
+    QDir          obDir( p_qsDir );
+    QFileInfoList obEntries = obDir.entryInfoList( QDir::Files | QDir::Dirs | QDir::NoSymLinks | QDir::NoDotAndDotDot );
+    tsDirectory   suDirectory;
+    for( int i = 0; i < obEntries.size(); i++ )
+    {
+        const QFileInfo &obEntry = obEntries.at( i );
+        if( obEntry.isDir() )
+        {
+            suDirectory.slSubDirs.push_back( obEntry.fileName() );
+        }
+        else if( !isSidecar( obEntry.fileName() ) )
+        {
+            tsFileEntry suFile;
+            suFile.qsFileName = obDir.absoluteFilePath( obEntry.fileName() );
+            suFile.ullSize    = obEntry.size();
+            suFile.tmModified = obEntry.lastModified().toTime_t();
+            suDirectory.veFiles.push_back( suFile );
+        }
+    }
+
+    // Another thread may have listed the same directory meanwhile, its listing is kept
+    m_obMutex.lock();
+    itDirectory = m_maDirectories.insert( std::make_pair( p_qsDir, suDirectory ) ).first;
+    m_obMutex.unlock();
+
+    return itDirectory->second;
+}
+
+cDiscoveryThread::cDiscoveryThread( cFileDiscovery *p_poDiscovery ) throw()
+{
+    m_poDiscovery = p_poDiscovery;
+}
+
+void cDiscoveryThread::run()
+{
+    m_poDiscovery->walk();
+}
@@ -0,0 +1,144 @@
+#ifndef FILEDISCOVERY_H
+#define FILEDISCOVERY_H
+
+#include <QString>
+#include <QStringList>
+#include <QThread>
+#include <QMutex>
+#include <QWaitCondition>
+#include <vector>
+#include <map>
+#include <ctime>
+
+class cDiscoveryThread;
+
+//! \brief Finds the Input Log Files matching the file name masks of a Batch Analysis
+/*! A file name mask is the path of the Input Log Files, whose components can contain '*'
+ *  and '?' wild-cards (see cLogDataSource). A component that is exactly <tt>**</tt>
+ *  matches any number of directories (including none), so the mask made of the
+ *  components <tt>server</tt>, <tt>**</tt> and <tt>app*.log</tt> finds the matching files
+ *  in the <tt>server</tt> directory and in all its subdirectories. Symbolic links are not followed.
+ *
+ *  The directories are listed by several threads at the same time, each thread taking the
+ *  next directory waiting to be listed, so the subdirectories of a large tree are walked in
+ *  parallel. Each file is returned with its size and modification time, taken from the same
+ *  directory listing. The index files of LARA (see cTimeCatalog, cGzipIndex and cLineIndex)
+ *  are left out of the listings, so a mask never finds them even if they are stored next
+ *  to the Input Log Files.
+ *
+ *  The listings of the directories are kept for the lifetime of the object, so the
+ *  <tt>input_log</tt> elements of a Batch Analysis that look into the same directories
+ *  only list them once (see cBatchAnalyser::analyse()).
+ */
+class cFileDiscovery
+{
+public:
+    //! A file found by find()
+    typedef struct
+    {
+        //! Absolute name of the file
+        QString             qsFileName;
+        //! Size of the file in bytes
+        unsigned long long  ullSize;
+        //! Modification time of the file
+        time_t              tmModified;
+    } tsFileEntry;
+
+    //! Vector container type to hold the files found
+    typedef std::vector<tsFileEntry>  tvFileEntries;
+
+    //! \brief Constructor
+    /*! \param p_uiThreads number of threads listing the directories of recursive masks,
+     *         masks without a <tt>**</tt> component are expanded by the calling thread
+     */
+    cFileDiscovery( const unsigned int p_uiThreads = 4 ) throw();
+
+    //! \brief Destructor
+    ~cFileDiscovery() throw();
+
+    //! \brief Returns the files matching a file name mask
+    /*! \param p_qsMask the file name mask, an absolute path with wild-cards
+     *  \return The matching files, sorted by their names ignoring case
+     */
+    tvFileEntries  find( const QString &p_qsMask ) throw();
+
+    //! \brief Returns the number of directories listed so far
+    unsigned int   listedDirs() const throw();
+
+private:
+    //! The contents of a directory
+    typedef struct
+    {
+        //! The files of the directory
+        tvFileEntries  veFiles;
+        //! The names of the subdirectories
+        QStringList    slSubDirs;
+    } tsDirectory;
+
+    //! Map container type to hold the listed directories, by their names
+    typedef std::map<QString, tsDirectory>  tmDirectories;
+    //! Const iterator type for the map holding the listed directories
+    typedef tmDirectories::const_iterator   tiDirectories;
+
+    //! A directory waiting to be searched
+    typedef struct
+    {
+        //! Name of the directory
+        QString       qsDir;
+        //! Index of the mask component the directory is searched for
+        int           inComponent;
+    } tsPending;
+
+    //! Number of threads listing the directories of recursive masks
+    unsigned int               m_uiThreads;
+    //! The listed directories
+    tmDirectories              m_maDirectories;
+    //! The components of the mask being expanded
+    QStringList                m_slComponents;
+    //! The directories waiting to be searched for the mask being expanded
+    std::vector<tsPending>     m_vePending;
+    //! Number of directories being searched by the threads
+    unsigned int               m_uiBusy;
+    //! The files found for the mask being expanded
+    tvFileEntries              m_veFound;
+    //! Protects all the members while a mask is expanded
+    mutable QMutex             m_obMutex;
+    //! Signalled when a directory is added to m_vePending, or the search is finished
+    QWaitCondition             m_obPending;
+
+    //! \brief Searches the directories of m_vePending until there are none left
+    /*! Run by the calling thread and by the cDiscoveryThread objects at the same time.
+     */
+    void                walk() throw();
+
+    //! \brief Searches a single directory for the given mask component
+    /*! The matching files are added to m_veFound, and the subdirectories to be searched
+     *  for the following components are added to m_vePending.
+     */
+    void                search( const tsPending &p_suPending ) throw();
+
+    //! \brief Returns the contents of a directory, listing it if it was not listed yet
+    const tsDirectory  &directory( const QString &p_qsDir ) throw();
+
+    friend class cDiscoveryThread;
+};
+
+//! \brief Thread of cFileDiscovery listing directories
+class cDiscoveryThread : public QThread
+{
+public:
+    //! \brief Constructor
+    /*! \param p_poDiscovery the file discovery whose directories are listed
+     */
+    cDiscoveryThread( cFileDiscovery *p_poDiscovery ) throw();
+
+protected:
+    //! \brief Runs cFileDiscovery::walk()
+    void run();
+
+private:
+    //! The file discovery whose directories are listed
+    cFileDiscovery  *m_poDiscovery;
+};
+
+#endif // FILEDISCOVERY_H
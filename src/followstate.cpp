@@ -0,0 +1,360 @@
+#include <QtGlobal>
+#include <QFile>
+#include <QFileInfo>
+#include <QSettings>
+#include <vector>
+#ifdef Q_OS_UNIX
+#include <sys/stat.h>
+#endif
+
+#include "followstate.h"
+#include "preparedcache.h"
+#include "streamcodec.h"
+#include "ziparchive.h"
+
+// The number of bytes at the beginning of a file hashed to recognize a reused inode
+static const unsigned long long FOLLOW_HEAD_SIZE = 1024;
+
+cFollowState::cFollowState( const QString &p_qsStateFile ) throw()
+{
+    m_qsStateFile = p_qsStateFile;
+    m_boLoaded    = false;
+    m_ullBatchId  = 0;
+
+    if( !QFile::exists( m_qsStateFile ) ) return;
+
+    QSettings obStateFile( m_qsStateFile, QSettings::IniFormat );
+
+    int inFiles = obStateFile.beginReadArray( QString::fromAscii( "Files" ) );
+    for( int i = 0; i < inFiles; i++ )
+    {
+        obStateFile.setArrayIndex( i );
+
+        tsFilePosition suPosition;
+        suPosition.qsFileName  = obStateFile.value( QString::fromAscii( "Name" ), "" ).toString();
+        suPosition.ullDevice   = obStateFile.value( QString::fromAscii( "Device" ), 0 ).toULongLong();
+        suPosition.ullInode    = obStateFile.value( QString::fromAscii( "Inode" ), 0 ).toULongLong();
+        suPosition.ullOffset   = obStateFile.value( QString::fromAscii( "Offset" ), 0 ).toULongLong();
+        suPosition.ullLines    = obStateFile.value( QString::fromAscii( "Lines" ), 0 ).toULongLong();
+        suPosition.ullHeadSize = obStateFile.value( QString::fromAscii( "HeadSize" ), 0 ).toULongLong();
+        suPosition.ullHeadHash = obStateFile.value( QString::fromAscii( "HeadHash" ), 0 ).toULongLong();
+        suPosition.boSeen      = false;
+        m_vePositions.push_back( suPosition );
+    }
+    obStateFile.endArray();
+
+    int inCounts = obStateFile.beginReadArray( QString::fromAscii( "Counts" ) );
+    for( int i = 0; i < inCounts; i++ )
+    {
+        obStateFile.setArrayIndex( i );
+        m_maCounts[obStateFile.value( QString::fromAscii( "Name" ), "" ).toString()] =
+                std::make_pair( (unsigned long)obStateFile.value( QString::fromAscii( "Ok" ), 0 ).toULongLong(),
+                                (unsigned long)obStateFile.value( QString::fromAscii( "Failed" ), 0 ).toULongLong() );
+    }
+    obStateFile.endArray();
+
+    int inAttributes = obStateFile.beginReadArray( QString::fromAscii( "Attributes" ) );
+    for( int i = 0; i < inAttributes; i++ )
+    {
+        obStateFile.setArrayIndex( i );
+        m_maAttributes[obStateFile.value( QString::fromAscii( "Name" ), "" ).toString()] =
+                obStateFile.value( QString::fromAscii( "Value" ), "" ).toString();
+    }
+    obStateFile.endArray();
+
+    m_slInputFiles = obStateFile.value( QString::fromAscii( "Results/InputFiles" ), QStringList() ).toStringList();
+    m_ullBatchId   = obStateFile.value( QString::fromAscii( "Results/BatchId" ), 0 ).toULongLong();
+
+    m_boLoaded = obStateFile.status() == QSettings::NoError;
+}
+
+cFollowState::~cFollowState() throw()
+{
+}
+
+bool cFollowState::loaded() const throw()
+{
+    return m_boLoaded;
+}
+
+unsigned long long cFollowState::position( const QString &p_qsFileName, unsigned long long *p_poLines ) throw()
+{
+    *p_poLines = 0;
+
+    unsigned long long ullDevice, ullInode, ullSize;
+    if( !identify( p_qsFileName, &ullDevice, &ullInode, &ullSize ) ) return 0;
+
+    tsFilePosition *poPosition = findPosition( p_qsFileName );
+    if( !poPosition->ullOffset )
+    {
+        // A new compressed file starting with the Log Lines of a file already read is that
+        // file compressed by the log rotation, it is taken as read to its end
+        const tsFilePosition *poRotated = rotatedFrom( p_qsFileName, poPosition );
+        if( !poRotated ) return 0;
+
+        unsigned long long ullLines = poRotated->ullLines;
+        setPosition( p_qsFileName, ullSize, ullLines );
+        *p_poLines = ullLines;
+        return ullSize;
+    }
+
+    // A file shorter than the offset was truncated, and a file with different first bytes is
+    // a new file that got the inode of a removed one: both are read from their beginning
+    if( ullSize < poPosition->ullOffset ||
+        headHash( p_qsFileName, poPosition->ullHeadSize ) != poPosition->ullHeadHash )
+    {
+        poPosition->ullOffset = 0;
+        poPosition->ullLines  = 0;
+        return 0;
+    }
+
+    *p_poLines = poPosition->ullLines;
+    return poPosition->ullOffset;
+}
+
+void cFollowState::setPosition( const QString &p_qsFileName, const unsigned long long p_ullOffset,
+                                const unsigned long long p_ullLines ) throw()
+{
+    tsFilePosition *poPosition = findPosition( p_qsFileName );
+
+    poPosition->ullOffset   = p_ullOffset;
+    poPosition->ullLines    = p_ullLines;
+    poPosition->ullHeadSize = qMin( p_ullOffset, FOLLOW_HEAD_SIZE );
+    poPosition->ullHeadHash = headHash( p_qsFileName, poPosition->ullHeadSize );
+}
+
+QStringList cFollowState::inputFiles() const throw()
+{
+    return m_slInputFiles;
+}
+
+void cFollowState::setInputFiles( const QStringList &p_slInputFiles ) throw()
+{
+    m_slInputFiles = p_slInputFiles;
+}
+
+const cFollowState::tmCounts &cFollowState::counts() const throw()
+{
+    return m_maCounts;
+}
+
+void cFollowState::setCounts( const tmCounts &p_maCounts ) throw()
+{
+    m_maCounts = p_maCounts;
+}
+
+const cFollowState::tmAttributes &cFollowState::attributes() const throw()
+{
+    return m_maAttributes;
+}
+
+void cFollowState::setAttributes( const tmAttributes &p_maAttributes ) throw()
+{
+    m_maAttributes = p_maAttributes;
+}
+
+unsigned long long cFollowState::batchId() const throw()
+{
+    return m_ullBatchId;
+}
+
+void cFollowState::setBatchId( const unsigned long long p_ullBatchId ) throw()
+{
+    m_ullBatchId = p_ullBatchId;
+}
+
+void cFollowState::save() const throw( cSevException )
+{
+    // The state is written under a temporary name first, so an interrupted run never leaves
+    // a partly written state behind
+    QString qsTempFile = m_qsStateFile + ".tmp";
+    QFile::remove( qsTempFile );
+
+    {
+        QSettings obStateFile( qsTempFile, QSettings::IniFormat );
+
+        obStateFile.beginWriteArray( QString::fromAscii( "Files" ) );
+        int inFile = 0;
+        for( unsigned int i = 0; i < m_vePositions.size(); i++ )
+        {
+            const tsFilePosition &suPosition = m_vePositions[i];
+            if( !suPosition.boSeen ) continue;
+
+            obStateFile.setArrayIndex( inFile++ );
+            obStateFile.setValue( QString::fromAscii( "Name" ), suPosition.qsFileName );
+            obStateFile.setValue( QString::fromAscii( "Device" ), suPosition.ullDevice );
+            obStateFile.setValue( QString::fromAscii( "Inode" ), suPosition.ullInode );
+            obStateFile.setValue( QString::fromAscii( "Offset" ), suPosition.ullOffset );
+            obStateFile.setValue( QString::fromAscii( "Lines" ), suPosition.ullLines );
+            obStateFile.setValue( QString::fromAscii( "HeadSize" ), suPosition.ullHeadSize );
+            obStateFile.setValue( QString::fromAscii( "HeadHash" ), suPosition.ullHeadHash );
+        }
+        obStateFile.endArray();
+
+        obStateFile.beginWriteArray( QString::fromAscii( "Counts" ) );
+        int inCount = 0;
+        for( tiCounts itCount = m_maCounts.begin(); itCount != m_maCounts.end(); itCount++ )
+        {
+            obStateFile.setArrayIndex( inCount++ );
+            obStateFile.setValue( QString::fromAscii( "Name" ), itCount->first );
+            obStateFile.setValue( QString::fromAscii( "Ok" ), (unsigned long long)itCount->second.first );
+            obStateFile.setValue( QString::fromAscii( "Failed" ), (unsigned long long)itCount->second.second );
+        }
+        obStateFile.endArray();
+
+        obStateFile.beginWriteArray( QString::fromAscii( "Attributes" ) );
+        int inAttribute = 0;
+        for( tiAttributes itAttribute = m_maAttributes.begin(); itAttribute != m_maAttributes.end(); itAttribute++ )
+        {
+            obStateFile.setArrayIndex( inAttribute++ );
+            obStateFile.setValue( QString::fromAscii( "Name" ), itAttribute->first );
+            obStateFile.setValue( QString::fromAscii( "Value" ), itAttribute->second );
+        }
+        obStateFile.endArray();
+
+        obStateFile.setValue( QString::fromAscii( "Results/InputFiles" ), m_slInputFiles );
+        obStateFile.setValue( QString::fromAscii( "Results/BatchId" ), m_ullBatchId );
+
+        obStateFile.sync();
+        if( obStateFile.status() != QSettings::NoError )
+        {
+            QFile::remove( qsTempFile );
+            throw cSevException( cSeverity::ERROR, QString( "Cannot write follow state file %1" ).arg( qsTempFile ).toStdString() );
+        }
+    }
+
+    QFile::remove( m_qsStateFile );
+    if( !QFile::rename( qsTempFile, m_qsStateFile ) )
+    {
+        QFile::remove( qsTempFile );
+        throw cSevException( cSeverity::ERROR, QString( "Cannot create follow state file %1" ).arg( m_qsStateFile ).toStdString() );
+    }
+}
+
+cFollowState::tsFilePosition *cFollowState::findPosition( const QString &p_qsFileName ) throw()
+{
+    unsigned long long ullDevice = 0, ullInode = 0, ullSize = 0;
+    identify( p_qsFileName, &ullDevice, &ullInode, &ullSize );
+
+    // The entries of a ZIP archive share the inode of the archive, they are told apart by
+    // their entry names
+    QString qsArchive, qsEntry;
+    cZipArchive::splitMemberName( p_qsFileName, &qsArchive, &qsEntry );
+
+    for( unsigned int i = 0; i < m_vePositions.size(); i++ )
+    {
+        tsFilePosition *poPosition = &m_vePositions[i];
+
+        bool boSame;
+        if( ullInode && poPosition->ullInode )
+        {
+            QString qsKnownArchive, qsKnownEntry;
+            cZipArchive::splitMemberName( poPosition->qsFileName, &qsKnownArchive, &qsKnownEntry );
+            boSame = poPosition->ullDevice == ullDevice && poPosition->ullInode == ullInode && qsKnownEntry == qsEntry;
+        }
+        else
+        {
+            boSame = poPosition->qsFileName == p_qsFileName;
+        }
+        if( !boSame ) continue;
+
+        poPosition->qsFileName = p_qsFileName;
+        poPosition->boSeen     = true;
+        return poPosition;
+    }
+
+    tsFilePosition suPosition;
+    suPosition.qsFileName  = p_qsFileName;
+    suPosition.ullDevice   = ullDevice;
+    suPosition.ullInode    = ullInode;
+    suPosition.ullOffset   = 0;
+    suPosition.ullLines    = 0;
+    suPosition.ullHeadSize = 0;
+    suPosition.ullHeadHash = 0;
+    suPosition.boSeen      = true;
+    m_vePositions.push_back( suPosition );
+
+    return &m_vePositions.back();
+}
+
+const cFollowState::tsFilePosition *cFollowState::rotatedFrom( const QString &p_qsFileName,
+                                                                const tsFilePosition *p_poPosition ) const throw()
+{
+    QString qsArchive, qsEntry;
+    if( cZipArchive::splitMemberName( p_qsFileName, &qsArchive, &qsEntry ) ) return NULL;
+
+    const cStreamCodec *poCodec = cCodecRegistry::find( p_qsFileName );
+    if( !poCodec ) return NULL;
+
+    QByteArray     baHead( FOLLOW_HEAD_SIZE, 0 );
+    unsigned int   uiRead   = 0;
+    cStreamReader *poReader = NULL;
+    try
+    {
+        poReader = poCodec->open( p_qsFileName );
+        while( uiRead < FOLLOW_HEAD_SIZE )
+        {
+            unsigned int uiBlock = poReader->read( baHead.data() + uiRead, FOLLOW_HEAD_SIZE - uiRead );
+            if( !uiBlock ) break;
+            uiRead += uiBlock;
+        }
+    }
+    catch( cSevException &e )
+    {
+        uiRead = 0;
+    }
+    delete poReader;
+    baHead.resize( uiRead );
+
+    for( unsigned int i = 0; i < m_vePositions.size(); i++ )
+    {
+        const tsFilePosition *poPosition = &m_vePositions[i];
+        if( poPosition == p_poPosition || !poPosition->ullHeadSize ) continue;
+        if( poPosition->ullHeadSize > (unsigned long long)baHead.size() ) continue;
+
+        if( cPreparedCache::hash64( baHead.constData(), poPosition->ullHeadSize ) == poPosition->ullHeadHash ) return poPosition;
+    }
+
+    return NULL;
+}
+
+bool cFollowState::identify( const QString &p_qsFileName, unsigned long long *p_poDevice,
+                             unsigned long long *p_poInode, unsigned long long *p_poSize ) throw()
+{
+    QString qsFileName = p_qsFileName;
+    QString qsArchive, qsEntry;
+    if( cZipArchive::splitMemberName( p_qsFileName, &qsArchive, &qsEntry ) ) qsFileName = qsArchive;
+
+#ifdef Q_OS_UNIX
+    struct stat suStat;
+    if( stat( QFile::encodeName( qsFileName ).constData(), &suStat ) ) return false;
+
+    *p_poDevice = suStat.st_dev;
+    *p_poInode  = suStat.st_ino;
+    *p_poSize   = suStat.st_size;
+#else
+    QFileInfo obFileInfo( qsFileName );
+    if( !obFileInfo.exists() ) return false;
+
+    *p_poDevice = 0;
+    *p_poInode  = 0;
+    *p_poSize   = obFileInfo.size();
+#endif
+
+    return true;
+}
+
+unsigned long long cFollowState::headHash( const QString &p_qsFileName, const unsigned long long p_ullSize ) throw()
+{
+    if( !p_ullSize ) return 0;
+
+    QString qsFileName = p_qsFileName;
+    QString qsArchive, qsEntry;
+    if( cZipArchive::splitMemberName( p_qsFileName, &qsArchive, &qsEntry ) ) qsFileName = qsArchive;
+
+    QFile obFile( qsFileName );
+    if( !obFile.open( QIODevice::ReadOnly ) ) return 0;
+
+    QByteArray baHead = obFile.read( p_ullSize );
+    return cPreparedCache::hash64( baHead.constData(), baHead.size() );
+}
@@ -0,0 +1,172 @@
+#ifndef FOLLOWSTATE_H
+#define FOLLOWSTATE_H
+
+#include <QString>
+#include <QStringList>
+#include <vector>
+#include <map>
+
+#include <sevexception.h>
+
+//! \brief Persistent state of a Log Analysis that follows growing Input Log Files
+/*! In follow mode each run of a Log Analysis only reads the Log Lines appended to the
+ *  Input Log Files since the previous run, and adds its results to the results of the
+ *  previous runs. The state file remembers for each Input Log File how far it was read
+ *  (its byte offset and the number of Log Lines in front of it), together with the
+ *  results of the previous runs (see cOutputCreator).
+ *
+ *  The files are recognized by their device and inode numbers rather than by their names,
+ *  so a log rotated to a new name (for example <tt>server.log</tt> to
+ *  <tt>server.log.1</tt>) is continued where it was left, as long as the rotated name is
+ *  also matched by the Input Log File names, and the new file appearing under the old name
+ *  is read from its beginning. A file that became shorter than the remembered offset
+ *  (truncated in place) or whose first bytes changed (its inode was reused) is also read
+ *  from its beginning. The inode numbers are only available on Unix, elsewhere the files
+ *  are recognized by their names.
+ *
+ *  Compressed files and the entries of ZIP archives cannot be continued in the middle: they
+ *  are skipped while they do not change, and read again as a whole when they do. A log
+ *  rotation that compresses the rotated file (<tt>server.log.1</tt> to
+ *  <tt>server.log.2.gz</tt>) creates a new file with Log Lines already read: a new
+ *  compressed file whose decompressed first bytes are those of a file read before is taken
+ *  as read to its end. Log Lines appended to that file after the previous run and before the
+ *  rotation are lost this way.
+ *
+ *  Only the positions and the results are stored, no open Action: an Action is identified
+ *  from a single Log Line (see cLogAnalyser::identifySingleLinerActions()), and a run only
+ *  reads complete Log Lines, so no Action is split between two runs. An Action made of
+ *  several Log Lines would need its unfinished part stored here, without that its Log Lines
+ *  read by different runs would never be joined, so such Actions are not supported in
+ *  follow mode.
+ */
+class cFollowState
+{
+public:
+    //! Map container type to hold the Count Action results, the number of OK and FAILED Actions
+    typedef std::map<QString, std::pair<unsigned long, unsigned long> > tmCounts;
+    //! Const Iterator type for the map holding the Count Action results
+    typedef tmCounts::const_iterator                                      tiCounts;
+    //! Map container type to hold the global Attributes
+    typedef std::map<QString, QString>                                    tmAttributes;
+    //! Const Iterator type for the map holding the global Attributes
+    typedef tmAttributes::const_iterator                                  tiAttributes;
+
+    //! \brief Constructor that loads the state file if it exists
+    /*! \param p_qsStateFile name of the state file
+     */
+    cFollowState( const QString &p_qsStateFile ) throw();
+
+    //! \brief Destructor
+    ~cFollowState() throw();
+
+    //! \brief Returns <tt>true</tt> if the state of a previous run was loaded
+    bool                loaded() const throw();
+
+    //! \brief Returns the offset the given Input Log File has to be read from
+    /*! \param p_qsFileName name of the Input Log File
+     *  \param p_poLines receives the number of Log Lines in front of the offset
+     *  \return The offset, 0 if the file is new, was truncated or was replaced
+     */
+    unsigned long long  position( const QString &p_qsFileName, unsigned long long *p_poLines ) throw();
+
+    //! \brief Stores how far the given Input Log File was read
+    /*! \param p_qsFileName name of the Input Log File
+     *  \param p_ullOffset offset following the last Log Line read, the size of the file if
+     *         it is compressed
+     *  \param p_ullLines number of Log Lines in front of p_ullOffset
+     */
+    void                setPosition( const QString &p_qsFileName, const unsigned long long p_ullOffset,
+                                     const unsigned long long p_ullLines ) throw();
+
+    //! \brief Returns the Input Log Files of the previous runs
+    QStringList         inputFiles() const throw();
+
+    //! \brief Stores the Input Log Files of all runs
+    void                setInputFiles( const QStringList &p_slInputFiles ) throw();
+
+    //! \brief Returns the Count Action results of the previous runs
+    const tmCounts     &counts() const throw();
+
+    //! \brief Stores the Count Action results of all runs
+    void                setCounts( const tmCounts &p_maCounts ) throw();
+
+    //! \brief Returns the global Attributes of the previous runs
+    const tmAttributes &attributes() const throw();
+
+    //! \brief Stores the global Attributes of all runs
+    void                setAttributes( const tmAttributes &p_maAttributes ) throw();
+
+    //! \brief Returns the id of the Action Summary uploaded to the database, 0 if none
+    unsigned long long  batchId() const throw();
+
+    //! \brief Stores the id of the Action Summary uploaded to the database
+    void                setBatchId( const unsigned long long p_ullBatchId ) throw();
+
+    //! \brief Saves the state file
+    /*! Only the Input Log Files found by this run are saved, so files that were removed
+     *  are forgotten.
+     */
+    void                save() const throw( cSevException );
+
+private:
+    //! The position of an Input Log File
+    typedef struct
+    {
+        //! Name of the file when it was last read
+        QString             qsFileName;
+        //! Device number of the file, 0 if not known
+        unsigned long long  ullDevice;
+        //! Inode number of the file, 0 if not known
+        unsigned long long  ullInode;
+        //! Offset following the last Log Line read
+        unsigned long long  ullOffset;
+        //! Number of Log Lines in front of ullOffset
+        unsigned long long  ullLines;
+        //! Number of bytes at the beginning of the file covered by ullHeadHash
+        unsigned long long  ullHeadSize;
+        //! Hash of the first ullHeadSize bytes of the file
+        unsigned long long  ullHeadHash;
+        //! True if the file was found by this run
+        bool                boSeen;
+    } tsFilePosition;
+
+    //! Name of the state file
+    QString                      m_qsStateFile;
+    //! True if the state of a previous run was loaded
+    bool                         m_boLoaded;
+    //! The positions of the Input Log Files
+    std::vector<tsFilePosition>  m_vePositions;
+    //! The Input Log Files of all runs
+    QStringList                  m_slInputFiles;
+    //! The Count Action results of all runs
+    tmCounts                     m_maCounts;
+    //! The global Attributes of all runs
+    tmAttributes                 m_maAttributes;
+    //! Id of the Action Summary uploaded to the database
+    unsigned long long           m_ullBatchId;
+
+    //! \brief Returns the position of the given file, appending a new one if it is not known yet
+    tsFilePosition     *findPosition( const QString &p_qsFileName ) throw();
+
+    //! \brief Returns the position of the file the given new compressed file was compressed from
+    /*! The decompressed first bytes of the file are compared to the first bytes of the
+     *  other known files.
+     *  \param p_qsFileName name of the new file
+     *  \param p_poPosition the position of the new file, left out of the comparison
+     *  \return The position of the uncompressed file, NULL if the file is not compressed or
+     *          starts like no known file
+     */
+    const tsFilePosition *rotatedFrom( const QString &p_qsFileName, const tsFilePosition *p_poPosition ) const throw();
+
+    //! \brief Determines the device and inode numbers and the size of a file
+    /*! The entries of ZIP archives are identified by the archive.
+     *  \return <tt>false</tt> if the file does not exist
+     */
+    static bool         identify( const QString &p_qsFileName, unsigned long long *p_poDevice,
+                                  unsigned long long *p_poInode, unsigned long long *p_poSize ) throw();
+
+    //! \brief Returns the hash of the first p_ullSize bytes of a file
+    static unsigned long long headHash( const QString &p_qsFileName, const unsigned long long p_ullSize ) throw();
+};
+
+#endif // FOLLOWSTATE_H
@@ -0,0 +1,449 @@
+#include <QDir>
+#include <QFileInfo>
+#include <QDateTime>
+#include <QDataStream>
+#include <QCryptographicHash>
+#include <cstring>
+
+#include "gzipindex.h"
+#include "linesplitter.h"
+
+// Identifies the index files, and the version of their format
+static const quint32      GZIP_INDEX_MAGIC   = 0x4c475a49UL;
+static const quint32      GZIP_INDEX_VERSION = 1;
+
+// Size of the deflate window, the data an access point has to remember
+static const unsigned int GZIP_WINDOW_SIZE   = 32768;
+
+cGzipIndex::cGzipIndex( const QString &p_qsFileName, const unsigned long long p_ullSpan ) throw()
+{
+    m_qsFileName = p_qsFileName;
+    m_ullSpan    = p_ullSpan ? p_ullSpan : 1;
+    m_ullSize    = 0;
+    m_boComplete = false;
+}
+
+cGzipIndex::~cGzipIndex() throw()
+{
+}
+
+QString cGzipIndex::fileName() const throw()
+{
+    return m_qsFileName;
+}
+
+unsigned long long cGzipIndex::span() const throw()
+{
+    return m_ullSpan;
+}
+
+bool cGzipIndex::complete() const throw()
+{
+    return m_boComplete;
+}
+
+unsigned long long cGzipIndex::size() const throw()
+{
+    return m_ullSize;
+}
+
+unsigned int cGzipIndex::pointCount() const throw()
+{
+    return m_vePoints.size();
+}
+
+const cGzipIndex::tsAccessPoint &cGzipIndex::point( const unsigned int p_uiPoint ) const throw()
+{
+    return m_vePoints[p_uiPoint];
+}
+
+unsigned int cGzipIndex::findPoint( const unsigned long long p_ullOffset ) const throw()
+{
+    unsigned int uiLow  = 0;
+    unsigned int uiHigh = m_vePoints.size();
+    while( uiHigh - uiLow > 1 )
+    {
+        unsigned int uiMiddle = (uiLow + uiHigh) / 2;
+        if( m_vePoints[uiMiddle].ullOffset <= p_ullOffset ) uiLow = uiMiddle;
+        else uiHigh = uiMiddle;
+    }
+
+    return uiLow;
+}
+
+void cGzipIndex::build() throw( cSevException )
+{
+    cGzipReader       obReader( m_qsFileName, this );
+    std::vector<char> veBuffer( 1048576 );
+    while( obReader.read( &veBuffer[0], veBuffer.size() ) == veBuffer.size() );
+
+    if( obReader.truncated() )
+    {
+        throw cSevException( cSeverity::ERROR, QString( "Unexpected end of gzip file %1" ).arg( m_qsFileName ).toStdString() );
+    }
+}
+
+bool cGzipIndex::load( const QString &p_qsIndexFile ) throw()
+{
+    m_vePoints.clear();
+    m_boComplete = false;
+
+    unsigned long long ullFileSize = 0;
+    unsigned int       uiFileTime  = 0;
+    if( !fileStamp( &ullFileSize, &uiFileTime ) ) return false;
+
+    QFile obFile( p_qsIndexFile );
+    if( !obFile.open( QIODevice::ReadOnly ) ) return false;
+
+    QDataStream obStream( &obFile );
+    obStream.setVersion( QDataStream::Qt_4_0 );
+
+    quint32 uiMagic = 0, uiVersion = 0, uiTime = 0, uiCount = 0;
+    quint64 ullSize = 0, ullSpan = 0, ullInflatedSize = 0;
+    obStream >> uiMagic >> uiVersion >> ullSize >> uiTime >> ullSpan >> ullInflatedSize >> uiCount;
+    if( obStream.status() != QDataStream::Ok || uiMagic != GZIP_INDEX_MAGIC || uiVersion != GZIP_INDEX_VERSION ||
+        ullSize != ullFileSize || uiTime != uiFileTime || ullSpan != m_ullSpan )
+    {
+        return false;
+    }
+
+    for( quint32 i = 0; i < uiCount && obStream.status() == QDataStream::Ok; i++ )
+    {
+        quint64     ullOffset = 0, ullFileOffset = 0, ullLines = 0;
+        quint8      uiBits = 0, uiFlags = 0;
+        QByteArray  baWindow;
+        obStream >> ullOffset >> ullFileOffset >> uiBits >> ullLines >> uiFlags >> baWindow;
+
+        tsAccessPoint suPoint;
+        suPoint.ullOffset     = ullOffset;
+        suPoint.ullFileOffset = ullFileOffset;
+        suPoint.uiBits        = uiBits;
+        suPoint.ullLines      = ullLines;
+        suPoint.boMemberStart = uiFlags & 1;
+        suPoint.boLineStart   = uiFlags & 2;
+        if( !baWindow.isEmpty() ) suPoint.baWindow = qUncompress( baWindow );
+
+        if( uiBits > 7 || suPoint.baWindow.size() > (int)GZIP_WINDOW_SIZE || ullFileOffset > ullFileSize ||
+            (!m_vePoints.empty() && ullOffset < m_vePoints.back().ullOffset) )
+        {
+            m_vePoints.clear();
+            return false;
+        }
+        m_vePoints.push_back( suPoint );
+    }
+
+    if( obStream.status() != QDataStream::Ok )
+    {
+        m_vePoints.clear();
+        return false;
+    }
+
+    m_ullSize    = ullInflatedSize;
+    m_boComplete = true;
+
+    return true;
+}
+
+void cGzipIndex::save( const QString &p_qsIndexFile ) const throw( cSevException )
+{
+    if( !m_boComplete )
+    {
+        throw cSevException( cSeverity::WARNING, QString( "Index of %1 is not complete" ).arg( m_qsFileName ).toStdString() );
+    }
+
+    unsigned long long ullFileSize = 0;
+    unsigned int       uiFileTime  = 0;
+    if( !fileStamp( &ullFileSize, &uiFileTime ) )
+    {
+        throw cSevException( cSeverity::WARNING, QString( "Cannot find gzip file %1" ).arg( m_qsFileName ).toStdString() );
+    }
+
+    // The index is written under a temporary name first, so a partly written index is
+    // never loaded
+    QDir().mkpath( QFileInfo( p_qsIndexFile ).absolutePath() );
+    QString qsTempFile = p_qsIndexFile + ".tmp";
+    QFile   obFile( qsTempFile );
+    if( !obFile.open( QIODevice::WriteOnly | QIODevice::Truncate ) )
+    {
+        throw cSevException( cSeverity::WARNING, QString( "Cannot create index file %1: %2" ).arg( qsTempFile ).arg( obFile.errorString() ).toStdString() );
+    }
+
+    QDataStream obStream( &obFile );
+    obStream.setVersion( QDataStream::Qt_4_0 );
+    obStream << GZIP_INDEX_MAGIC << GZIP_INDEX_VERSION << (quint64)ullFileSize << (quint32)uiFileTime
+             << (quint64)m_ullSpan << (quint64)m_ullSize << (quint32)m_vePoints.size();
+
+    for( unsigned int i = 0; i < m_vePoints.size(); i++ )
+    {
+        const tsAccessPoint &suPoint = m_vePoints[i];
+        quint8 uiFlags = (suPoint.boMemberStart ? 1 : 0) | (suPoint.boLineStart ? 2 : 0);
+        obStream << (quint64)suPoint.ullOffset << (quint64)suPoint.ullFileOffset << (quint8)suPoint.uiBits
+                 << (quint64)suPoint.ullLines << uiFlags
+                 << (suPoint.baWindow.isEmpty() ? QByteArray() : qCompress( suPoint.baWindow ));
+    }
+
+    obFile.close();
+    if( obStream.status() != QDataStream::Ok || obFile.error() != QFile::NoError )
+    {
+        QFile::remove( qsTempFile );
+        throw cSevException( cSeverity::WARNING, QString( "Cannot write index file %1" ).arg( qsTempFile ).toStdString() );
+    }
+
+    QFile::remove( p_qsIndexFile );
+    if( !QFile::rename( qsTempFile, p_qsIndexFile ) )
+    {
+        QFile::remove( qsTempFile );
+        throw cSevException( cSeverity::WARNING, QString( "Cannot create index file %1" ).arg( p_qsIndexFile ).toStdString() );
+    }
+}
+
+QString cGzipIndex::indexFileName( const QString &p_qsFileName, const QString &p_qsIndexDir ) throw()
+{
+    // Files with the same name in different directories share the index directory, so the
+    // name of the index file also has a hash of the full path of the file
+    QFileInfo  obFileInfo( p_qsFileName );
+    QByteArray baHash = QCryptographicHash::hash( obFileInfo.absoluteFilePath().toUtf8(), QCryptographicHash::Md5 ).toHex();
+
+    return QDir( p_qsIndexDir ).filePath( QString( "%1.%2.gzidx" ).arg( obFileInfo.fileName() ).arg( QString( baHash.left( 16 ) ) ) );
+}
+
+bool cGzipIndex::fileStamp( unsigned long long *p_poSize, unsigned int *p_poTime ) const throw()
+{
+    QFileInfo obFileInfo( m_qsFileName );
+    if( !obFileInfo.exists() ) return false;
+
+    *p_poSize = obFileInfo.size();
+    *p_poTime = obFileInfo.lastModified().toTime_t();
+
+    return true;
+}
+
+cGzipReader::cGzipReader( const QString &p_qsFileName, cGzipIndex *p_poIndex ) throw( cSevException )
+{
+    m_qsFileName    = p_qsFileName;
+    m_boInflating   = false;
+    m_ullFileOffset = 0;
+    m_ullOffset     = 0;
+    m_boInMember    = false;
+    m_boRaw         = false;
+    m_uiTrailer     = 0;
+    m_boEnd         = false;
+    m_boTruncated   = false;
+    m_poIndex       = p_poIndex;
+    m_ullLines      = 0;
+    m_chLast        = '\n';
+
+    open();
+
+    if( m_poIndex )
+    {
+        m_veHistory.resize( GZIP_WINDOW_SIZE );
+        m_poIndex->m_vePoints.clear();
+        m_poIndex->m_ullSize    = 0;
+        m_poIndex->m_boComplete = false;
+    }
+}
+
+cGzipReader::cGzipReader( const cGzipIndex *p_poIndex, const unsigned int p_uiPoint ) throw( cSevException )
+{
+    const cGzipIndex::tsAccessPoint &suPoint = p_poIndex->point( p_uiPoint );
+
+    m_qsFileName    = p_poIndex->fileName();
+    m_boInflating   = false;
+    m_ullFileOffset = suPoint.ullFileOffset;
+    m_ullOffset     = suPoint.ullOffset;
+    m_boInMember    = false;
+    m_boRaw         = false;
+    m_uiTrailer     = 0;
+    m_boEnd         = false;
+    m_boTruncated   = false;
+    m_poIndex       = NULL;
+    m_ullLines      = suPoint.ullLines;
+    m_chLast        = '\n';
+
+    open();
+
+    if( suPoint.boMemberStart )
+    {
+        if( !m_obFile.seek( suPoint.ullFileOffset ) )
+        {
+            throw cSevException( cSeverity::ERROR, QString( "Cannot seek in gzip file %1" ).arg( m_qsFileName ).toStdString() );
+        }
+        return;
+    }
+
+    // In the middle of a member the deflate stream is continued as a raw stream: the bits
+    // of the block left in the previous byte are primed, and the window is restored
+    char chByte = 0;
+    if( !m_obFile.seek( suPoint.ullFileOffset - (suPoint.uiBits ? 1 : 0) ) ||
+        (suPoint.uiBits && !m_obFile.getChar( &chByte )) ||
+        inflateReset2( &m_suStream, -MAX_WBITS ) != Z_OK ||
+        (suPoint.uiBits && inflatePrime( &m_suStream, suPoint.uiBits, (unsigned char)chByte >> (8 - suPoint.uiBits) ) != Z_OK) ||
+        (!suPoint.baWindow.isEmpty() &&
+         inflateSetDictionary( &m_suStream, (const Bytef *)suPoint.baWindow.constData(), suPoint.baWindow.size() ) != Z_OK) )
+    {
+        throw cSevException( cSeverity::ERROR, QString( "Cannot start inflating gzip file %1 at offset %2" ).arg( m_qsFileName ).arg( suPoint.ullOffset ).toStdString() );
+    }
+    m_boInMember = true;
+    m_boRaw      = true;
+}
+
+cGzipReader::~cGzipReader() throw()
+{
+    if( m_boInflating ) inflateEnd( &m_suStream );
+}
+
+unsigned int cGzipReader::read( char *p_poBuffer, const unsigned int p_uiSize ) throw( cSevException )
+{
+    m_suStream.next_out  = (Bytef *)p_poBuffer;
+    m_suStream.avail_out = p_uiSize;
+
+    while( m_suStream.avail_out && !m_boEnd )
+    {
+        if( !m_suStream.avail_in && !fill() )
+        {
+            m_boEnd       = true;
+            m_boTruncated = m_boInMember || m_uiTrailer;
+            break;
+        }
+
+        if( m_uiTrailer )
+        {
+            // The CRC and the size closing a member inflated as a raw stream are skipped
+            unsigned int uiSkip = m_uiTrailer < m_suStream.avail_in ? m_uiTrailer : m_suStream.avail_in;
+            m_suStream.next_in  += uiSkip;
+            m_suStream.avail_in -= uiSkip;
+            m_ullFileOffset     += uiSkip;
+            m_uiTrailer         -= uiSkip;
+            continue;
+        }
+
+        if( !m_boInMember )
+        {
+            // Anything but a gzip header after a member (usually zero padding) is ignored
+            if( *m_suStream.next_in != 0x1f )
+            {
+                m_boEnd = true;
+                break;
+            }
+            if( m_poIndex ) addPoint( 0, true );
+            if( inflateReset2( &m_suStream, MAX_WBITS + 16 ) != Z_OK )
+            {
+                throw cSevException( cSeverity::ERROR, QString( "Cannot start inflating gzip file %1" ).arg( m_qsFileName ).toStdString() );
+            }
+            m_boInMember = true;
+            m_boRaw      = false;
+        }
+
+        const char   *poOut = (const char *)m_suStream.next_out;
+        unsigned int  uiIn  = m_suStream.avail_in;
+        int inResult = inflate( &m_suStream, m_poIndex ? Z_BLOCK : Z_NO_FLUSH );
+        m_ullFileOffset += uiIn - m_suStream.avail_in;
+        m_ullOffset     += (const char *)m_suStream.next_out - poOut;
+        if( m_poIndex ) record( poOut, (const char *)m_suStream.next_out - poOut );
+
+        if( inResult == Z_STREAM_END )
+        {
+            m_boInMember = false;
+            if( m_boRaw ) m_uiTrailer = 8;
+            continue;
+        }
+        if( inResult != Z_OK && inResult != Z_BUF_ERROR )
+        {
+            throw cSevException( cSeverity::ERROR, QString( "Error inflating gzip file %1: %2" ).arg( m_qsFileName ).arg( m_suStream.msg ? m_suStream.msg : "corrupt data" ).toStdString() );
+        }
+
+        // An access point can be placed at the end of every deflate block but the last one
+        if( m_poIndex && (m_suStream.data_type & 128) && !(m_suStream.data_type & 64) &&
+            m_ullOffset - m_poIndex->m_vePoints.back().ullOffset >= m_poIndex->m_ullSpan )
+        {
+            addPoint( m_suStream.data_type & 7, false );
+        }
+    }
+
+    if( m_boEnd && m_poIndex && !m_boTruncated )
+    {
+        m_poIndex->m_ullSize    = m_ullOffset;
+        m_poIndex->m_boComplete = true;
+    }
+
+    return p_uiSize - m_suStream.avail_out;
+}
+
+bool cGzipReader::truncated() const throw()
+{
+    return m_boTruncated;
+}
+
+unsigned long long cGzipReader::offset() const throw()
+{
+    return m_ullOffset;
+}
+
+void cGzipReader::open() throw( cSevException )
+{
+    m_obFile.setFileName( m_qsFileName );
+    if( !m_obFile.open( QIODevice::ReadOnly ) )
+    {
+        throw cSevException( cSeverity::ERROR, QString( "Cannot open Input Log File %1: %2" ).arg( m_qsFileName ).arg( m_obFile.errorString() ).toStdString() );
+    }
+
+    m_veInput.resize( 262144 );
+    memset( &m_suStream, 0, sizeof( m_suStream ) );
+    if( inflateInit2( &m_suStream, MAX_WBITS + 16 ) != Z_OK )
+    {
+        throw cSevException( cSeverity::ERROR, QString( "Cannot initialize inflating gzip file %1" ).arg( m_qsFileName ).toStdString() );
+    }
+    m_boInflating = true;
+}
+
+bool cGzipReader::fill() throw( cSevException )
+{
+    qint64 inRead = m_obFile.read( &m_veInput[0], m_veInput.size() );
+    if( inRead < 0 )
+    {
+        throw cSevException( cSeverity::ERROR, QString( "Error reading gzip file %1: %2" ).arg( m_qsFileName ).arg( m_obFile.errorString() ).toStdString() );
+    }
+
+    m_suStream.next_in  = (Bytef *)&m_veInput[0];
+    m_suStream.avail_in = inRead;
+
+    return inRead > 0;
+}
+
+void cGzipReader::addPoint( const unsigned int p_uiBits, const bool p_boMemberStart ) throw()
+{
+    cGzipIndex::tsAccessPoint suPoint;
+    suPoint.ullOffset     = m_ullOffset;
+    suPoint.ullFileOffset = m_ullFileOffset;
+    suPoint.uiBits        = p_uiBits;
+    suPoint.ullLines      = m_ullLines;
+    suPoint.boMemberStart = p_boMemberStart;
+    suPoint.boLineStart   = m_chLast == '\n';
+
+    if( !p_boMemberStart )
+    {
+        unsigned int uiSize  = m_ullOffset < GZIP_WINDOW_SIZE ? m_ullOffset : GZIP_WINDOW_SIZE;
+        unsigned int uiStart = (m_ullOffset - uiSize) % GZIP_WINDOW_SIZE;
+        unsigned int uiFirst = GZIP_WINDOW_SIZE - uiStart < uiSize ? GZIP_WINDOW_SIZE - uiStart : uiSize;
+        suPoint.baWindow = QByteArray( &m_veHistory[uiStart], uiFirst );
+        suPoint.baWindow.append( QByteArray( &m_veHistory[0], uiSize - uiFirst ) );
+    }
+
+    m_poIndex->m_vePoints.push_back( suPoint );
+}
+
+void cGzipReader::record( const char *p_poData, const unsigned int p_uiSize ) throw()
+{
+    if( !p_uiSize ) return;
+
+    m_ullLines += cLineSplitter::countNewLines( p_poData, p_poData + p_uiSize );
+    m_chLast    = p_poData[p_uiSize - 1];
+
+    // Only the last 32 KB are kept, at their offsets modulo the size of the window
+    unsigned int uiSize  = p_uiSize < GZIP_WINDOW_SIZE ? p_uiSize : GZIP_WINDOW_SIZE;
+    unsigned int uiStart = (m_ullOffset - uiSize) % GZIP_WINDOW_SIZE;
+    unsigned int uiFirst = GZIP_WINDOW_SIZE - uiStart < uiSize ? GZIP_WINDOW_SIZE - uiStart : uiSize;
+    memcpy( &m_veHistory[uiStart], p_poData + p_uiSize - uiSize, uiFirst );
+    memcpy( &m_veHistory[0], p_poData + p_uiSize - uiSize + uiFirst, uiSize - uiFirst );
+}
@@ -0,0 +1,216 @@
+#ifndef GZIPINDEX_H
+#define GZIPINDEX_H
+
+#include <QString>
+#include <QFile>
+#include <QByteArray>
+#include <vector>
+#include <zlib.h>
+
+#include <sevexception.h>
+
+#include "streamcodec.h"
+
+//! \brief Random access index of a gzip compressed Input Log File
+/*! A deflate stream can only be inflated from its beginning, because the data refers back
+ *  to the last 32 KB of the inflated data. The index stores access points, roughly one in
+ *  every span bytes of inflated data: the position of a deflate block boundary in the
+ *  compressed file together with the 32 KB of inflated data in front of it (the window).
+ *  A cGzipReader started at an access point inflates the file from there, without
+ *  inflating anything in front of it.
+ *
+ *  Files made of several gzip members (for example concatenated daily logs) get an access
+ *  point at the start of every member, these need no window at all.
+ *
+ *  Each access point also stores the number of Log Lines ended in front of it, so the
+ *  Log Lines read from an access point (see cLineReader) get the same line numbers as if
+ *  the whole file was read.
+ *
+ *  The index is built while the file is inflated once by a cGzipReader, and is stored in
+ *  an index file in the index directory (see indexFileName()). The size and modification
+ *  time of the compressed file are stored with the index, so an index of a file that
+ *  changed since is not loaded.
+ */
+class cGzipIndex
+{
+public:
+    //! A point of the compressed file where inflating can be started
+    typedef struct
+    {
+        //! Offset of the point in the inflated data
+        unsigned long long  ullOffset;
+        //! Offset of the first compressed byte following the point in the compressed file
+        unsigned long long  ullFileOffset;
+        //! Number of bits of the byte in front of ullFileOffset that follow the point
+        unsigned int        uiBits;
+        //! Number of Log Lines ended in front of the point
+        unsigned long long  ullLines;
+        //! True if the point is at the start of a gzip member, its header is at ullFileOffset
+        bool                boMemberStart;
+        //! True if the point is at the start of a Log Line
+        bool                boLineStart;
+        //! The inflated data in front of the point, empty at the start of a gzip member
+        QByteArray          baWindow;
+    } tsAccessPoint;
+
+    //! \brief Constructor, creates an empty index of the given file
+    /*! \param p_qsFileName name of the gzip compressed file
+     *  \param p_ullSpan the minimum distance of the access points in the inflated data
+     */
+    cGzipIndex( const QString &p_qsFileName, const unsigned long long p_ullSpan = 16777216 ) throw();
+
+    //! \brief Destructor
+    ~cGzipIndex() throw();
+
+    //! \brief Returns the name of the indexed file
+    QString             fileName() const throw();
+
+    //! \brief Returns the minimum distance of the access points in the inflated data
+    unsigned long long  span() const throw();
+
+    //! \brief Returns <tt>true</tt> if the whole file is indexed
+    bool                complete() const throw();
+
+    //! \brief Returns the size of the inflated data, only valid for a complete index
+    unsigned long long  size() const throw();
+
+    //! \brief Returns the number of access points
+    unsigned int        pointCount() const throw();
+
+    //! \brief Returns the given access point
+    const tsAccessPoint &point( const unsigned int p_uiPoint ) const throw();
+
+    //! \brief Returns the last access point at or in front of the given inflated offset
+    unsigned int        findPoint( const unsigned long long p_ullOffset ) const throw();
+
+    //! \brief Inflates the whole file once to build the index
+    void                build() throw( cSevException );
+
+    //! \brief Loads the index from the given index file
+    /*! \return <tt>false</tt> if the index file does not exist, is corrupt, was made with
+     *          a different span, or belongs to a different version of the compressed file
+     */
+    bool                load( const QString &p_qsIndexFile ) throw();
+
+    //! \brief Saves a complete index to the given index file
+    /*! Failing to save the index is not fatal, the exceptions thrown are warnings.
+     */
+    void                save( const QString &p_qsIndexFile ) const throw( cSevException );
+
+    //! \brief Returns the name of the index file of a compressed file
+    /*! \param p_qsFileName name of the compressed file
+     *  \param p_qsIndexDir directory of the index files (see cPreferences::indexDir())
+     */
+    static QString      indexFileName( const QString &p_qsFileName, const QString &p_qsIndexDir ) throw();
+
+private:
+    //! Name of the indexed file
+    QString                     m_qsFileName;
+    //! Minimum distance of the access points in the inflated data
+    unsigned long long          m_ullSpan;
+    //! Size of the inflated data
+    unsigned long long          m_ullSize;
+    //! True if the whole file is indexed
+    bool                        m_boComplete;
+    //! The access points, in the order of their offsets
+    std::vector<tsAccessPoint>  m_vePoints;
+
+    //! \brief Returns the size and the modification time of the compressed file
+    bool                fileStamp( unsigned long long *p_poSize, unsigned int *p_poTime ) const throw();
+
+    friend class cGzipReader;
+};
+
+//! \brief Inflates a gzip compressed file, from its start or from an access point
+/*! Every gzip member of the file is inflated, one after the other, and the CRC of each
+ *  member read from its start is checked. Data following the last member that is not a
+ *  gzip header is ignored.
+ *
+ *  A reader started from the beginning of the file can record the access points of a
+ *  cGzipIndex while it inflates the file, so the index costs no extra pass over the file.
+ *
+ *  Each reader has its own file handle and inflate state, so different regions of the same
+ *  file can be inflated by several readers at the same time.
+ *
+ *  This is the reader of the gzip codec of cCodecRegistry.
+ */
+class cGzipReader : public cStreamReader
+{
+public:
+    //! \brief Constructor that starts inflating at the beginning of the file
+    /*! \param p_qsFileName name of the compressed file
+     *  \param p_poIndex if not NULL, the access points are recorded into this empty index
+     *         while the file is read, and the index is complete when the end of the file
+     *         is reached
+     */
+    cGzipReader( const QString &p_qsFileName, cGzipIndex *p_poIndex = NULL ) throw( cSevException );
+
+    //! \brief Constructor that starts inflating at an access point of an index
+    cGzipReader( const cGzipIndex *p_poIndex, const unsigned int p_uiPoint ) throw( cSevException );
+
+    //! \brief Destructor that closes the file
+    ~cGzipReader() throw();
+
+    //! \brief Reads the next part of the inflated data
+    /*! \param p_poBuffer the buffer that receives the data
+     *  \param p_uiSize size of the buffer in bytes
+     *  \return The number of bytes read, less than p_uiSize only at the end of the data
+     */
+    unsigned int        read( char *p_poBuffer, const unsigned int p_uiSize ) throw( cSevException );
+
+    //! \brief Returns <tt>true</tt> if the file ended in the middle of a gzip member
+    bool                truncated() const throw();
+
+    //! \brief Returns the offset of the next byte read in the inflated data
+    unsigned long long  offset() const throw();
+
+private:
+    //! Name of the file, used in error messages
+    QString             m_qsFileName;
+    //! The compressed file
+    QFile               m_obFile;
+    //! The inflate state
+    z_stream            m_suStream;
+    //! True when m_suStream is initialized
+    bool                m_boInflating;
+    //! The buffer of the compressed data
+    std::vector<char>   m_veInput;
+    //! Offset of the next compressed byte given to inflate in the file
+    unsigned long long  m_ullFileOffset;
+    //! Offset of the next inflated byte
+    unsigned long long  m_ullOffset;
+    //! True while inflating a gzip member, false in between members
+    bool                m_boInMember;
+    //! True if the member is inflated as a raw deflate stream, started from an access point
+    bool                m_boRaw;
+    //! Number of bytes of the member trailer still to skip after a raw deflate stream
+    unsigned int        m_uiTrailer;
+    //! True when the end of the compressed data is reached
+    bool                m_boEnd;
+    //! True if the file ended in the middle of a gzip member
+    bool                m_boTruncated;
+    //! The index being built, NULL if no index is built
+    cGzipIndex         *m_poIndex;
+    //! The last 32 KB of the inflated data, circular, only kept while building an index
+    std::vector<char>   m_veHistory;
+    //! Number of Log Lines ended so far, only counted while building an index
+    unsigned long long  m_ullLines;
+    //! The last inflated byte, only kept while building an index
+    char                m_chLast;
+
+    //! \brief Opens the file and initializes the inflate state
+    void                open() throw( cSevException );
+
+    //! \brief Reads the next part of the compressed file into m_veInput
+    /*! \return <tt>false</tt> at the end of the file
+     */
+    bool                fill() throw( cSevException );
+
+    //! \brief Appends an access point at the current position to the index being built
+    void                addPoint( const unsigned int p_uiBits, const bool p_boMemberStart ) throw();
+
+    //! \brief Updates the history, the line count and the last byte with inflated data
+    void                record( const char *p_poData, const unsigned int p_uiSize ) throw();
+};
+
+#endif // GZIPINDEX_H
@@ -17,6 +17,21 @@ HEADERS = ../../qtframework/severity.h \
     actiondeflist.h \
     actiondef.h \
     pattern.h \
+    literalfilter.h \
+    regexpset.h \
+    timestampparser.h \
+    linesplitter.h \
+    linereader.h \
+    ziparchive.h \
+    syserrordecoder.h \
+    gzipindex.h \
+    streamcodec.h \
+    preparedcache.h \
+    followstate.h \
+    checkpoint.h \
+    filediscovery.h \
+    timecatalog.h \
+    lineindex.h \
     action.h \
     outputcreator.h \
     countaction.h \
@@ -35,6 +50,21 @@ SOURCES = ../../qtframework/logger.cpp \
     actiondeflist.cpp \
     actiondef.cpp \
     pattern.cpp \
+    literalfilter.cpp \
+    regexpset.cpp \
+    timestampparser.cpp \
+    linesplitter.cpp \
+    linereader.cpp \
+    ziparchive.cpp \
+    syserrordecoder.cpp \
+    gzipindex.cpp \
+    streamcodec.cpp \
+    preparedcache.cpp \
+    followstate.cpp \
+    checkpoint.cpp \
+    filediscovery.cpp \
+    timecatalog.cpp \
+    lineindex.cpp \
     action.cpp \
     outputcreator.cpp \
     countaction.cpp \
@@ -46,3 +76,8 @@ QT += sql
 QT += xmlpatterns
 CONFIG += qt
 CONFIG += console
+LIBS += -lpcre2-8
+LIBS += -lz
+LIBS += -lzstd
+LIBS += -llzma
+LIBS += -lbz2
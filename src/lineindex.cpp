@@ -0,0 +1,234 @@
+#include <QDir>
+#include <QFile>
+#include <QFileInfo>
+#include <QDateTime>
+#include <QDataStream>
+#include <QCryptographicHash>
+
+#include "lineindex.h"
+#include "linereader.h"
+#include "linesplitter.h"
+
+// Identifies the index files, and the version of their format
+static const quint32 LINE_INDEX_MAGIC   = 0x4c4c4958UL;
+static const quint32 LINE_INDEX_VERSION = 1;
+
+// Size of the read buffer of lines(), longer Log Lines are truncated
+static const unsigned int LINE_INDEX_BUFFER_SIZE = 65536;
+static const unsigned int LINE_INDEX_MAX_LINE    = 1048576;
+
+cLineIndex::cLineIndex( const QString &p_qsFileName, const unsigned int p_uiSpan ) throw()
+{
+    m_qsFileName = p_qsFileName;
+    m_uiSpan     = p_uiSpan ? p_uiSpan : 1;
+}
+
+cLineIndex::~cLineIndex() throw()
+{
+}
+
+QString cLineIndex::fileName() const throw()
+{
+    return m_qsFileName;
+}
+
+unsigned int cLineIndex::pointCount() const throw()
+{
+    return m_vePoints.size();
+}
+
+void cLineIndex::addBlock( const char *p_poBegin, const char *p_poEnd,
+                           const unsigned long long p_ullOffset, const unsigned long long p_ullEndOffset,
+                           const unsigned long long p_ullLines ) throw()
+{
+    if( p_poBegin >= p_poEnd ) return;
+
+    // The offsets inside a decoded block do not match the offsets of the file
+    bool               boSplit   = p_ullEndOffset - p_ullOffset == (unsigned long long)(p_poEnd - p_poBegin);
+    unsigned long long ullEnd    = p_ullOffset + (p_poEnd - p_poBegin);
+    const char        *poPos     = p_poBegin;
+    unsigned long long ullLines  = p_ullLines;
+    while( poPos < p_poEnd )
+    {
+        unsigned long long ullOffset = p_ullOffset + (poPos - p_poBegin);
+        if( m_vePoints.empty() || ullOffset >= m_vePoints.back().ullOffset + m_uiSpan )
+        {
+            tsPoint suPoint = { ullLines, ullOffset };
+            m_vePoints.push_back( suPoint );
+        }
+        if( !boSplit ) break;
+
+        // The next point is the first Log Line starting at least a span after the last one
+        unsigned long long ullNext = m_vePoints.back().ullOffset + m_uiSpan;
+        if( ullNext >= ullEnd ) break;
+
+        const char *poLineEnd = cLineSplitter::findNewLine( p_poBegin + (ullNext - 1 - p_ullOffset), p_poEnd );
+        if( poLineEnd >= p_poEnd ) break;
+
+        ullLines += cLineSplitter::countNewLines( poPos, poLineEnd + 1 );
+        poPos     = poLineEnd + 1;
+    }
+}
+
+const cLineIndex::tsPoint *cLineIndex::findPoint( const unsigned long long p_ullLine ) const throw()
+{
+    // The points are ordered by their line counts too, the last one with fewer Log Lines in
+    // front of it than the number of the Log Line is searched for
+    unsigned int uiLow  = 0;
+    unsigned int uiHigh = m_vePoints.size();
+    while( uiLow < uiHigh )
+    {
+        unsigned int uiMiddle = uiLow + (uiHigh - uiLow) / 2;
+        if( m_vePoints[uiMiddle].ullLines < p_ullLine ) uiLow = uiMiddle + 1;
+        else uiHigh = uiMiddle;
+    }
+
+    return uiLow ? &m_vePoints[uiLow - 1] : NULL;
+}
+
+QStringList cLineIndex::lines( const unsigned long long p_ullFirst, const unsigned long long p_ullLast ) const throw( cSevException )
+{
+    QStringList slLines;
+    if( p_ullFirst > p_ullLast ) return slLines;
+
+    const tsPoint      *poPoint = findPoint( p_ullFirst );
+    unsigned long long  ullLine = poPoint ? poPoint->ullLines : 0;
+
+    cLineReader obReader( m_qsFileName, LINE_INDEX_BUFFER_SIZE, true );
+    obReader.setMaxLineLength( LINE_INDEX_MAX_LINE );
+    if( poPoint && poPoint->ullOffset ) obReader.seek( poPoint->ullOffset );
+
+    const char *poBegin = NULL;
+    const char *poEnd   = NULL;
+    while( ullLine < p_ullLast && obReader.readBlock( &poBegin, &poEnd ) )
+    {
+        const char *poPos = poBegin;
+        while( poPos < poEnd && ullLine < p_ullLast )
+        {
+            const char *poLineEnd = cLineSplitter::findNewLine( poPos, poEnd );
+            if( ++ullLine >= p_ullFirst )
+            {
+                const char *poTextEnd = poLineEnd;
+                if( poTextEnd > poPos && poTextEnd[-1] == '\r' ) poTextEnd--;
+                slLines.append( QString::fromAscii( poPos, poTextEnd - poPos ) );
+            }
+
+            poPos = (poLineEnd < poEnd) ? poLineEnd + 1 : poEnd;
+        }
+    }
+
+    return slLines;
+}
+
+bool cLineIndex::load( const QString &p_qsIndexFile ) throw()
+{
+    m_vePoints.clear();
+
+    unsigned long long ullFileSize = 0;
+    unsigned int       uiFileTime  = 0;
+    if( !fileStamp( &ullFileSize, &uiFileTime ) ) return false;
+
+    QFile obFile( p_qsIndexFile );
+    if( !obFile.open( QIODevice::ReadOnly ) ) return false;
+
+    QDataStream obStream( &obFile );
+    obStream.setVersion( QDataStream::Qt_4_0 );
+
+    quint32 uiMagic = 0, uiVersion = 0, uiTime = 0, uiSpan = 0, uiCount = 0;
+    quint64 ullSize = 0;
+    obStream >> uiMagic >> uiVersion >> ullSize >> uiTime >> uiSpan >> uiCount;
+    if( obStream.status() != QDataStream::Ok || uiMagic != LINE_INDEX_MAGIC || uiVersion != LINE_INDEX_VERSION ||
+        ullSize != ullFileSize || uiTime != uiFileTime )
+    {
+        return false;
+    }
+
+    for( quint32 i = 0; i < uiCount && obStream.status() == QDataStream::Ok; i++ )
+    {
+        quint64 ullLines = 0, ullOffset = 0;
+        obStream >> ullLines >> ullOffset;
+
+        if( ullOffset > ullFileSize ||
+            (!m_vePoints.empty() && (ullOffset <= m_vePoints.back().ullOffset || ullLines < m_vePoints.back().ullLines)) )
+        {
+            m_vePoints.clear();
+            return false;
+        }
+        tsPoint suPoint = { ullLines, ullOffset };
+        m_vePoints.push_back( suPoint );
+    }
+
+    if( obStream.status() != QDataStream::Ok )
+    {
+        m_vePoints.clear();
+        return false;
+    }
+
+    m_uiSpan = uiSpan ? uiSpan : 1;
+
+    return true;
+}
+
+void cLineIndex::save( const QString &p_qsIndexFile ) const throw( cSevException )
+{
+    unsigned long long ullFileSize = 0;
+    unsigned int       uiFileTime  = 0;
+    if( !fileStamp( &ullFileSize, &uiFileTime ) )
+    {
+        throw cSevException( cSeverity::WARNING, QString( "Cannot find Input Log File %1" ).arg( m_qsFileName ).toStdString() );
+    }
+
+    // The index is written under a temporary name first, so a partly written index is
+    // never loaded
+    QString qsTempFile = p_qsIndexFile + ".tmp";
+    QFile   obFile( qsTempFile );
+    if( !obFile.open( QIODevice::WriteOnly | QIODevice::Truncate ) )
+    {
+        throw cSevException( cSeverity::WARNING, QString( "Cannot create line index file %1: %2" ).arg( qsTempFile ).arg( obFile.errorString() ).toStdString() );
+    }
+
+    QDataStream obStream( &obFile );
+    obStream.setVersion( QDataStream::Qt_4_0 );
+    obStream << LINE_INDEX_MAGIC << LINE_INDEX_VERSION << (quint64)ullFileSize << (quint32)uiFileTime
+             << (quint32)m_uiSpan << (quint32)m_vePoints.size();
+
+    for( unsigned int i = 0; i < m_vePoints.size(); i++ )
+    {
+        obStream << (quint64)m_vePoints[i].ullLines << (quint64)m_vePoints[i].ullOffset;
+    }
+
+    obFile.close();
+    if( obStream.status() != QDataStream::Ok || obFile.error() != QFile::NoError )
+    {
+        QFile::remove( qsTempFile );
+        throw cSevException( cSeverity::WARNING, QString( "Cannot write line index file %1" ).arg( qsTempFile ).toStdString() );
+    }
+
+    QFile::remove( p_qsIndexFile );
+    if( !QFile::rename( qsTempFile, p_qsIndexFile ) )
+    {
+        QFile::remove( qsTempFile );
+        throw cSevException( cSeverity::WARNING, QString( "Cannot create line index file %1" ).arg( p_qsIndexFile ).toStdString() );
+    }
+}
+
+QString cLineIndex::indexFileName( const QString &p_qsFileName, const QString &p_qsIndexDir ) throw()
+{
+    // Files with the same name in different directories share the index directory, so the
+    // name of the index file also has a hash of the full path of the file
+    QFileInfo  obFileInfo( p_qsFileName );
+    QByteArray baHash = QCryptographicHash::hash( obFileInfo.absoluteFilePath().toUtf8(), QCryptographicHash::Md5 ).toHex();
+
+    return QDir( p_qsIndexDir ).filePath( QString( "%1.%2.lidx" ).arg( obFileInfo.fileName() ).arg( QString( baHash.left( 16 ) ) ) );
+}
+
+bool cLineIndex::fileStamp( unsigned long long *p_poSize, unsigned int *p_poTime ) const throw()
+{
+    QFileInfo obFileInfo( m_qsFileName );
+    if( !obFileInfo.exists() ) return false;
+
+    *p_poSize = obFileInfo.size();
+    *p_poTime = obFileInfo.lastModified().toTime_t();
+
+    return true;
+}
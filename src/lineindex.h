@@ -0,0 +1,113 @@
+#ifndef LINEINDEX_H
+#define LINEINDEX_H
+
+#include <QString>
+#include <QStringList>
+#include <vector>
+
+#include <sevexception.h>
+
+//! \brief Sparse line number index of an Input Log File, used to read Log Lines by number
+/*! The index holds points roughly one span (64 kB by default) apart, each holding the
+ *  offset of a Log Line and the number of Log Lines in front of it, so a point takes 16
+ *  bytes for each span of the file (0.025% of the file with the default span). lines()
+ *  seeks to the last point in front of the requested Log Lines and reads at most one span
+ *  of Log Lines to reach them, instead of reading the file from its beginning.
+ *
+ *  The index is built block by block while the file is searched (see
+ *  cLogAnalyser::findPatterns()), and is used to add the Log Lines around the Actions and
+ *  Combined Log entries to the reports (see cPreferences::contextLines()). It only works
+ *  on files read in place that can be read from the middle (see cLineReader::seekable()),
+ *  as the Log Lines are read again from the file when the reports are generated.
+ *
+ *  The index is stored in the output directory of the analysis (see indexFileName()), with
+ *  the size and modification time of the file, so a resumed analysis finds the indexes of
+ *  the files searched before it was interrupted, and an index of a file that changed since
+ *  is not loaded.
+ */
+class cLineIndex
+{
+public:
+    //! A point of the index
+    typedef struct
+    {
+        //! Number of Log Lines in front of the point
+        unsigned long long  ullLines;
+        //! Offset of the first Log Line following the point
+        unsigned long long  ullOffset;
+    } tsPoint;
+
+    //! \brief Constructor, creates an empty index of the given file
+    /*! \param p_qsFileName name of the Input Log File
+     *  \param p_uiSpan distance of the points in bytes
+     */
+    cLineIndex( const QString &p_qsFileName, const unsigned int p_uiSpan = 65536 ) throw();
+
+    //! \brief Destructor
+    ~cLineIndex() throw();
+
+    //! \brief Returns the name of the indexed Input Log File
+    QString             fileName() const throw();
+
+    //! \brief Returns the number of index points
+    unsigned int        pointCount() const throw();
+
+    //! \brief Adds the points of a block of whole Log Lines read from the file
+    /*! The blocks have to be added in the order they are read.
+     *  \param p_poBegin the first byte of the block
+     *  \param p_poEnd the past-the-end byte of the block
+     *  \param p_ullOffset offset of the block in the file
+     *  \param p_ullEndOffset offset in the file following the block, if the block is longer
+     *         or shorter than this (a decoded sysError file) only the beginning of the block
+     *         is added as a point
+     *  \param p_ullLines number of Log Lines in front of the block
+     */
+    void                addBlock( const char *p_poBegin, const char *p_poEnd,
+                                  const unsigned long long p_ullOffset, const unsigned long long p_ullEndOffset,
+                                  const unsigned long long p_ullLines ) throw();
+
+    //! \brief Returns the point the given Log Line is read from
+    /*! \param p_ullLine number of the Log Line, the first Log Line of the file is 1
+     *  \return The last point in front of the Log Line, NULL if the file has to be read from
+     *          its beginning
+     */
+    const tsPoint      *findPoint( const unsigned long long p_ullLine ) const throw();
+
+    //! \brief Reads a range of Log Lines from the file
+    /*! \param p_ullFirst number of the first Log Line
+     *  \param p_ullLast number of the last Log Line, included
+     *  \return The Log Lines without their new line characters, fewer than requested if the
+     *          file ends earlier
+     */
+    QStringList         lines( const unsigned long long p_ullFirst, const unsigned long long p_ullLast ) const throw( cSevException );
+
+    //! \brief Loads the index from the given index file
+    /*! \return <tt>false</tt> if the index file does not exist, is corrupt, or belongs to a
+     *          different version of the file
+     */
+    bool                load( const QString &p_qsIndexFile ) throw();
+
+    //! \brief Saves the index to the given index file
+    /*! Failing to save the index is not fatal, the exceptions thrown are warnings.
+     */
+    void                save( const QString &p_qsIndexFile ) const throw( cSevException );
+
+    //! \brief Returns the name of the index file of an Input Log File
+    /*! \param p_qsFileName name of the Input Log File
+     *  \param p_qsIndexDir directory of the index files
+     */
+    static QString      indexFileName( const QString &p_qsFileName, const QString &p_qsIndexDir ) throw();
+
+private:
+    //! Name of the Input Log File
+    QString               m_qsFileName;
+    //! Distance of the points in bytes
+    unsigned int          m_uiSpan;
+    //! The index points, in the order of their offsets
+    std::vector<tsPoint>  m_vePoints;
+
+    //! \brief Returns the size and the modification time of the Input Log File
+    bool                fileStamp( unsigned long long *p_poSize, unsigned int *p_poTime ) const throw();
+};
+
+#endif // LINEINDEX_H
@@ -0,0 +1,393 @@
+#include <QtGlobal>
+#include <cstring>
+#include <cerrno>
+#ifdef Q_OS_UNIX
+#include <sys/mman.h>
+#endif
+
+#include "linereader.h"
+#include "linesplitter.h"
+#include "ziparchive.h"
+#include "syserrordecoder.h"
+#include "gzipindex.h"
+#include "streamcodec.h"
+
+cLineReader::cLineReader( const QString &p_qsFileName, const unsigned int p_uiBufferSize,
+                          const bool p_boInPlace, cGzipIndex *p_poGzipIndex,
+                          const cZipArchive *p_poZipArchive ) throw( cSevException )
+        : m_obMapFile( p_qsFileName )
+{
+    init( p_qsFileName, p_uiBufferSize );
+
+    QString qsArchive;
+    QString qsEntry;
+    if( cZipArchive::splitMemberName( p_qsFileName, &qsArchive, &qsEntry ) )
+    {
+        if( p_poZipArchive ) m_poZipReader = new cZipEntryReader( p_poZipArchive, qsEntry );
+        else m_poZipReader = new cZipEntryReader( p_qsFileName );
+        m_poBuffer    = new char[m_uiBufferSize];
+        return;
+    }
+
+    const cStreamCodec *poCodec = cCodecRegistry::find( p_qsFileName );
+    if( poCodec )
+    {
+        if( p_poGzipIndex && poCodec->name() == "gzip" ) m_poStreamReader = new cGzipReader( p_qsFileName, p_poGzipIndex );
+        else m_poStreamReader = poCodec->open( p_qsFileName );
+        m_poBuffer = new char[m_uiBufferSize];
+        return;
+    }
+
+    if( p_boInPlace && p_qsFileName.indexOf( "sysError" ) != -1 ) m_poDecoder = new cSysErrorDecoder;
+
+    if( p_boInPlace && m_obMapFile.open( QIODevice::ReadOnly ) && m_obMapFile.size() > 0 )
+    {
+        m_ullMapSize = m_obMapFile.size();
+        m_poMap = (const char *)m_obMapFile.map( 0, m_obMapFile.size() );
+    }
+    if( m_poMap )
+    {
+#ifdef Q_OS_UNIX
+        madvise( (void *)m_poMap, m_ullMapSize, MADV_SEQUENTIAL );
+#endif
+        return;
+    }
+    m_obMapFile.close();
+    m_ullMapSize = 0;
+
+    m_poFile = fopen( p_qsFileName.toAscii(), "rb" );
+    if( !m_poFile )
+    {
+        throw cSevException( cSeverity::ERROR, QString( "Cannot open Input Log File %1: %2" ).arg( p_qsFileName ).arg( strerror( errno ) ).toStdString() );
+    }
+
+    m_poBuffer = new char[m_uiBufferSize];
+}
+
+cLineReader::cLineReader( const cGzipIndex *p_poIndex, const unsigned int p_uiFirstPoint,
+                          const unsigned int p_uiEndPoint, const unsigned int p_uiBufferSize ) throw( cSevException )
+        : m_obMapFile( p_poIndex->fileName() )
+{
+    init( p_poIndex->fileName(), p_uiBufferSize );
+
+    if( p_uiEndPoint < p_poIndex->pointCount() ) m_ullRegionEnd = p_poIndex->point( p_uiEndPoint ).ullOffset;
+    if( p_uiFirstPoint < p_poIndex->pointCount() )
+    {
+        // The Log Line the access point falls into belongs to the previous region
+        const cGzipIndex::tsAccessPoint &suPoint = p_poIndex->point( p_uiFirstPoint );
+        m_poStreamReader  = new cGzipReader( p_poIndex, p_uiFirstPoint );
+        m_ullBufferOffset = suPoint.ullOffset;
+        m_boSkipping      = !suPoint.boLineStart;
+        m_ullLinesBefore  = suPoint.ullLines + (suPoint.boLineStart ? 0 : 1);
+    }
+    else
+    {
+        m_boEOF = true;
+    }
+
+    m_poBuffer = new char[m_uiBufferSize];
+}
+
+cLineReader::~cLineReader() throw()
+{
+    if( m_poMap ) m_obMapFile.unmap( (uchar *)m_poMap );
+    if( m_poFile ) fclose( m_poFile );
+    delete m_poStreamReader;
+    delete m_poZipReader;
+    delete m_poDecoder;
+    delete[] m_poBuffer;
+}
+
+void cLineReader::init( const QString &p_qsFileName, const unsigned int p_uiBufferSize ) throw()
+{
+    m_qsFileName      = p_qsFileName;
+    m_poBuffer        = NULL;
+    m_uiBufferSize    = p_uiBufferSize;
+    m_uiMaxLineLength = p_uiBufferSize;
+    m_uiFilled        = 0;
+    m_uiConsumed      = 0;
+    m_boEOF           = false;
+    m_boSkipping      = false;
+    m_boCompleteLines = false;
+    m_ulTruncated     = 0;
+    m_ullBufferOffset = 0;
+    m_ullRegionEnd    = ~0ULL;
+    m_ullLinesBefore  = 0;
+    m_poFile          = NULL;
+    m_poStreamReader  = NULL;
+    m_poZipReader     = NULL;
+    m_poDecoder       = NULL;
+    m_poMap           = NULL;
+    m_ullMapSize      = 0;
+    m_ullMapPos       = 0;
+}
+
+bool cLineReader::readBlock( const char **p_poBegin, const char **p_poEnd ) throw( cSevException )
+{
+    if( !m_poDecoder ) return rawBlock( p_poBegin, p_poEnd );
+
+    const char *poBegin = NULL;
+    const char *poEnd   = NULL;
+    if( !rawBlock( &poBegin, &poEnd ) ) return false;
+
+    m_poDecoder->decodeBlock( poBegin, poEnd, &m_veDecoded );
+    if( !m_veDecoded.empty() ) poBegin = &m_veDecoded[0];
+    *p_poBegin = poBegin;
+    *p_poEnd   = poBegin + m_veDecoded.size();
+
+    return true;
+}
+
+bool cLineReader::rawBlock( const char **p_poBegin, const char **p_poEnd ) throw( cSevException )
+{
+    if( m_poMap ) return mapBlock( p_poBegin, p_poEnd );
+
+    // Moving the partial line left over from the previous block to the front of the buffer
+    if( m_uiConsumed )
+    {
+        memmove( m_poBuffer, m_poBuffer + m_uiConsumed, m_uiFilled - m_uiConsumed );
+        m_uiFilled        -= m_uiConsumed;
+        m_ullBufferOffset += m_uiConsumed;
+        m_uiConsumed       = 0;
+    }
+
+    if( m_boEOF && !m_uiFilled && !m_qsStreamError.isEmpty() )
+    {
+        throw cSevException( cSeverity::ERROR, QString( "Error decompressing Input Log File %1" ).arg( m_qsStreamError ).toStdString() );
+    }
+
+    for( ;; )
+    {
+        if( !m_boEOF && m_uiFilled < m_uiBufferSize )
+        {
+            m_uiFilled += readData( m_poBuffer + m_uiFilled, m_uiBufferSize - m_uiFilled );
+        }
+
+        if( m_boSkipping )
+        {
+            const char *poNewLine = cLineSplitter::findNewLine( m_poBuffer, m_poBuffer + m_uiFilled );
+            if( poNewLine == m_poBuffer + m_uiFilled )
+            {
+                m_ullBufferOffset += m_uiFilled;
+                m_uiFilled         = 0;
+                if( m_boEOF ) return false;
+                continue;
+            }
+            unsigned int uiSkipped = poNewLine + 1 - m_poBuffer;
+            memmove( m_poBuffer, m_poBuffer + uiSkipped, m_uiFilled - uiSkipped );
+            m_uiFilled        -= uiSkipped;
+            m_ullBufferOffset += uiSkipped;
+            m_boSkipping       = false;
+            continue;
+        }
+
+        if( !m_uiFilled || m_ullBufferOffset >= m_ullRegionEnd ) return false;
+
+        unsigned int uiBlockEnd = m_uiFilled;
+        while( uiBlockEnd && m_poBuffer[uiBlockEnd - 1] != '\n' ) uiBlockEnd--;
+
+        if( !uiBlockEnd )
+        {
+            // No complete line in the buffer: either this is the last line of the file
+            // without a new line character, or a line longer than the whole buffer. The
+            // buffer grows for a long line until it reaches the maximum line length.
+            if( !m_boEOF && m_uiBufferSize < m_uiMaxLineLength )
+            {
+                growBuffer();
+                continue;
+            }
+            if( !m_boEOF )
+            {
+                m_boSkipping = true;
+                m_ulTruncated++;
+            }
+            else if( m_boCompleteLines )
+            {
+                return false;
+            }
+            uiBlockEnd = m_uiFilled;
+        }
+
+        if( m_ullBufferOffset + uiBlockEnd > m_ullRegionEnd )
+        {
+            // The region ends with the Log Line its last byte belongs to
+            const char *poNewLine = cLineSplitter::findNewLine( m_poBuffer + (m_ullRegionEnd - 1 - m_ullBufferOffset),
+                                                                m_poBuffer + uiBlockEnd );
+            if( poNewLine < m_poBuffer + uiBlockEnd ) uiBlockEnd = poNewLine + 1 - m_poBuffer;
+        }
+
+        *p_poBegin   = m_poBuffer;
+        *p_poEnd     = m_poBuffer + uiBlockEnd;
+        m_uiConsumed = uiBlockEnd;
+
+        return true;
+    }
+}
+
+void cLineReader::setMaxLineLength( const unsigned int p_uiMaxLineLength ) throw()
+{
+    m_uiMaxLineLength = qMax( p_uiMaxLineLength, m_uiBufferSize );
+}
+
+unsigned long cLineReader::truncatedLines() const throw()
+{
+    return m_ulTruncated;
+}
+
+unsigned int cLineReader::readData( char *p_poBuffer, const unsigned int p_uiSize ) throw( cSevException )
+{
+    if( m_poZipReader )
+    {
+        unsigned int uiRead = m_poZipReader->read( p_poBuffer, p_uiSize );
+        m_boEOF = uiRead < p_uiSize;
+        return uiRead;
+    }
+
+    if( m_poStreamReader )
+    {
+        // A truncated file also ends with a short read, the error is kept until the data
+        // read before it is processed.
+        unsigned int uiRead = m_poStreamReader->read( p_poBuffer, p_uiSize );
+        m_boEOF = uiRead < p_uiSize;
+        if( m_boEOF && m_poStreamReader->truncated() ) m_qsStreamError = QString( "%1: unexpected end of file" ).arg( m_qsFileName );
+        return uiRead;
+    }
+
+    size_t uiRead = fread( p_poBuffer, 1, p_uiSize, m_poFile );
+    if( ferror( m_poFile ) )
+    {
+        throw cSevException( cSeverity::ERROR, QString( "Error reading Input Log File %1" ).arg( m_qsFileName ).toStdString() );
+    }
+    m_boEOF = feof( m_poFile );
+    return uiRead;
+}
+
+bool cLineReader::mapped() const throw()
+{
+    return m_poMap != NULL;
+}
+
+unsigned long long cLineReader::linesBefore() const throw()
+{
+    return m_ullLinesBefore;
+}
+
+void cLineReader::seek( const unsigned long long p_ullOffset ) throw( cSevException )
+{
+    if( m_poMap )
+    {
+        m_ullMapPos = qMin( p_ullOffset, m_ullMapSize );
+    }
+    else if( m_poFile )
+    {
+#ifdef Q_OS_UNIX
+        int inResult = fseeko( m_poFile, (off_t)p_ullOffset, SEEK_SET );
+#else
+        int inResult = fseek( m_poFile, (long)p_ullOffset, SEEK_SET );
+#endif
+        if( inResult )
+        {
+            throw cSevException( cSeverity::ERROR, QString( "Cannot seek in Input Log File %1: %2" ).arg( m_qsFileName ).arg( strerror( errno ) ).toStdString() );
+        }
+        m_ullBufferOffset = p_ullOffset;
+        m_uiFilled        = 0;
+        m_uiConsumed      = 0;
+    }
+    else
+    {
+        throw cSevException( cSeverity::ERROR, QString( "Cannot seek in compressed Input Log File %1" ).arg( m_qsFileName ).toStdString() );
+    }
+
+    if( m_poDecoder && p_ullOffset )
+    {
+        delete m_poDecoder;
+        m_poDecoder = new cSysErrorDecoder( false );
+    }
+}
+
+bool cLineReader::seekable() const throw()
+{
+    return m_poMap || m_poFile;
+}
+
+void cLineReader::setCompleteLines( const bool p_boCompleteLines ) throw()
+{
+    m_boCompleteLines = p_boCompleteLines;
+}
+
+unsigned long long cLineReader::offset() const throw()
+{
+    if( m_poMap ) return m_ullMapPos;
+    return m_ullBufferOffset + m_uiConsumed;
+}
+
+bool cLineReader::mapBlock( const char **p_poBegin, const char **p_poEnd ) throw()
+{
+    if( m_ullMapPos >= m_ullMapSize ) return false;
+
+    const char *poPos     = m_poMap + m_ullMapPos;
+    const char *poFileEnd = m_poMap + m_ullMapSize;
+    const char *poLimit   = (m_ullMapSize - m_ullMapPos > m_uiBufferSize) ? poPos + m_uiBufferSize : poFileEnd;
+
+    const char *poBlockEnd = poLimit;
+    const char *poNext     = poLimit;
+    if( poLimit < poFileEnd )
+    {
+        while( poBlockEnd > poPos && poBlockEnd[-1] != '\n' ) poBlockEnd--;
+
+        if( poBlockEnd == poPos )
+        {
+            // A line longer than the buffer would be: it is returned as a block of its own
+            // if the buffer could grow to hold it, otherwise it is truncated the same way,
+            // and the rest of it is skipped
+            const char *poLineLimit = (m_ullMapSize - m_ullMapPos > m_uiMaxLineLength) ? poPos + m_uiMaxLineLength : poFileEnd;
+            const char *poNewLine   = cLineSplitter::findNewLine( poLimit, poLineLimit );
+            if( poNewLine < poLineLimit )
+            {
+                poBlockEnd = poNewLine + 1;
+                poNext     = poBlockEnd;
+            }
+            else if( poLineLimit == poFileEnd )
+            {
+                if( m_boCompleteLines ) return false;
+                poBlockEnd = poFileEnd;
+                poNext     = poFileEnd;
+            }
+            else
+            {
+                m_ulTruncated++;
+                poBlockEnd = poLineLimit;
+                poNext     = cLineSplitter::findNewLine( poLineLimit, poFileEnd );
+                if( poNext < poFileEnd ) poNext++;
+            }
+        }
+        else
+        {
+            poNext = poBlockEnd;
+        }
+    }
+    else if( m_boCompleteLines )
+    {
+        while( poBlockEnd > poPos && poBlockEnd[-1] != '\n' ) poBlockEnd--;
+        if( poBlockEnd == poPos ) return false;
+        poNext = poBlockEnd;
+    }
+
+    *p_poBegin  = poPos;
+    *p_poEnd    = poBlockEnd;
+    m_ullMapPos = poNext - m_poMap;
+
+    return true;
+}
+
+void cLineReader::growBuffer() throw()
+{
+    unsigned int uiNewSize = (m_uiBufferSize > m_uiMaxLineLength / 2) ? m_uiMaxLineLength : m_uiBufferSize * 2;
+
+    char *poBuffer = new char[uiNewSize];
+    memcpy( poBuffer, m_poBuffer, m_uiFilled );
+    delete[] m_poBuffer;
+
+    m_poBuffer     = poBuffer;
+    m_uiBufferSize = uiNewSize;
+}
@@ -0,0 +1,201 @@
+#ifndef LINEREADER_H
+#define LINEREADER_H
+
+#include <QString>
+#include <QFile>
+#include <stdio.h>
+#include <vector>
+
+#include <sevexception.h>
+
+class cZipArchive;
+class cZipEntryReader;
+class cSysErrorDecoder;
+class cStreamReader;
+class cGzipIndex;
+
+//! \brief Reads an Input Log File in blocks of whole Log Lines
+/*! The file is read into a single buffer that is allocated once and reused for the whole
+ *  file. Each block returned by readBlock() consists of whole Log Lines, each terminated
+ *  by a '\\n' character, except the last line of the file which may have no new line
+ *  character at its end. The partial line at the end of the buffer is moved to the
+ *  beginning of the buffer and completed by the next read.
+ *
+ *  A Log Line that does not fit into the buffer makes the buffer grow, doubling its size
+ *  each time, so a line of any length takes a few allocations only, and the grown buffer
+ *  is reused for the rest of the file. The buffer never grows beyond the maximum line
+ *  length (see setMaxLineLength()): a longer Log Line is truncated to the maximum line
+ *  length and counted (see truncatedLines()), the rest of the line is skipped. This way the
+ *  line numbers are always correct.
+ *
+ *  An original Input Log File read in place is memory-mapped instead of read into the
+ *  buffer. In this case the blocks point directly into the mapping, so the file is neither
+ *  copied nor moved around in memory, and the kernel is told that the mapping is read
+ *  sequentially. The blocks are
+ *  at most as long as the buffer would be and long Log Lines are truncated the same way, so
+ *  the Log Lines returned are the same in both modes. If the file cannot be mapped (for
+ *  example it is empty, or too large for the address space) it is read into the buffer.
+ *
+ *  Files compressed with one of the codecs of cCodecRegistry (gzip, zstd, xz or bzip2) are
+ *  decompressed while they are read: the decompressed data is written straight into the
+ *  read buffer, so a compressed Input Log is analysed without unpacking it to a temporary
+ *  file first. The same applies to the entries of ZIP
+ *  archives, referred to by names like <tt>day1.zip#server.log</tt> (see cZipArchive).
+ *
+ *  A gzipped file with a random access index (see cGzipIndex) can also be read region by
+ *  region: a region starts at an access point of the index and holds the Log Lines that
+ *  start in front of the next access point. The regions of a file are independent of each
+ *  other, so they can be read by several readers at the same time, and the Log Lines
+ *  following an access point can be read without inflating the data in front of it.
+ *
+ *  The encrypted tags of uncompressed sysError files (files with 'sysError' in their name)
+ *  read in place are decoded block by block with a cSysErrorDecoder, so the blocks returned
+ *  hold the decoded Log Lines.
+ *
+ *  To follow a growing file (see cFollowState) an uncompressed file can be read from the
+ *  middle with seek(), and setCompleteLines() leaves out its unterminated last Log Line, as
+ *  the rest of it may still be written. offset() tells where the next read has to start.
+ *
+ *  The blocks can be split to Log Lines and the lines can be counted using the kernels
+ *  in cLineSplitter.
+ */
+class cLineReader
+{
+public:
+    //! \brief Constructor that opens the given file for reading
+    /*! \param p_qsFileName name of the file to read
+     *  \param p_uiBufferSize initial size of the read buffer in bytes, this is also the
+     *         maximum length of a Log Line unless setMaxLineLength() is called
+     *  \param p_boInPlace if <tt>true</tt>, the file is an original Input Log File read in
+     *         place (see cLogDataSource): it is memory-mapped instead of read unless it is
+     *         compressed, and it is decoded if it is a sysError file
+     *  \param p_poGzipIndex if not NULL and the file is gzipped, this empty index is built
+     *         while the file is read, it is complete when the end of the file is reached
+     *  \param p_poZipArchive if not NULL and the file is an entry of a ZIP archive, the
+     *         archive with its central directory already read, otherwise the central
+     *         directory is read again to find the entry
+     */
+    cLineReader( const QString &p_qsFileName, const unsigned int p_uiBufferSize = 1048576,
+                 const bool p_boInPlace = false, cGzipIndex *p_poGzipIndex = NULL,
+                 const cZipArchive *p_poZipArchive = NULL ) throw( cSevException );
+
+    //! \brief Constructor that opens a region of a gzipped file for reading
+    /*! \param p_poIndex the complete random access index of the file
+     *  \param p_uiFirstPoint the access point the region starts at
+     *  \param p_uiEndPoint the access point following the region, the region lasts until the
+     *         end of the file if it is cGzipIndex::pointCount()
+     *  \param p_uiBufferSize size of the read buffer in bytes
+     */
+    cLineReader( const cGzipIndex *p_poIndex, const unsigned int p_uiFirstPoint,
+                 const unsigned int p_uiEndPoint, const unsigned int p_uiBufferSize = 1048576 ) throw( cSevException );
+
+    //! \brief Destructor that closes the file and frees the read buffer
+    ~cLineReader() throw();
+
+    //! \brief Returns the next block of whole Log Lines
+    /*! The returned block remains valid until the next call of readBlock().
+     *  \param p_poBegin receives the pointer to the first byte of the block
+     *  \param p_poEnd receives the pointer to the past-the-end byte of the block
+     *  \return <tt>false</tt> if the end of the file is reached and there is no more data
+     */
+    bool          readBlock( const char **p_poBegin, const char **p_poEnd ) throw( cSevException );
+
+    //! \brief Sets the maximum length of a Log Line, longer lines are truncated
+    /*! The maximum is never less than the initial size of the read buffer.
+     */
+    void          setMaxLineLength( const unsigned int p_uiMaxLineLength ) throw();
+
+    //! \brief Returns the number of Log Lines truncated because they were longer than the maximum
+    unsigned long truncatedLines() const throw();
+
+    //! \brief Returns <tt>true</tt> if the file is read through a memory mapping
+    bool          mapped() const throw();
+
+    //! \brief Returns the number of Log Lines of the file in front of the first Log Line read
+    /*! This is only different from zero when a region of a gzipped file is read.
+     */
+    unsigned long long linesBefore() const throw();
+
+    //! \brief Starts reading an uncompressed file at the given offset
+    /*! Has to be called before the first readBlock(). The offset has to be the beginning of a
+     *  Log Line. A sysError file read from the middle has no header to skip.
+     */
+    void          seek( const unsigned long long p_ullOffset ) throw( cSevException );
+
+    //! \brief Returns <tt>true</tt> if the file can be read from the middle with seek()
+    bool          seekable() const throw();
+
+    //! \brief Sets whether an unterminated Log Line at the end of the file is left out
+    void          setCompleteLines( const bool p_boCompleteLines ) throw();
+
+    //! \brief Returns the offset in the file following the last block returned by readBlock()
+    unsigned long long offset() const throw();
+
+private:
+    //! Name of the file being read, used in error messages
+    QString       m_qsFileName;
+    //! The file being read
+    FILE         *m_poFile;
+    //! The compressed file being read, NULL if the file is not compressed
+    cStreamReader *m_poStreamReader;
+    //! Error found at the end of the compressed data, reported after the data before it
+    QString       m_qsStreamError;
+    //! The ZIP entry being read, NULL if the file is not an entry of a ZIP archive
+    cZipEntryReader *m_poZipReader;
+    //! Decoder of sysError files, NULL if the file is not a sysError file
+    cSysErrorDecoder *m_poDecoder;
+    //! The decoded Log Lines of the last block
+    std::vector<char> m_veDecoded;
+    //! The read buffer
+    char         *m_poBuffer;
+    //! Size of the read buffer in bytes
+    unsigned int  m_uiBufferSize;
+    //! Maximum length of a Log Line, the read buffer grows up to this size
+    unsigned int  m_uiMaxLineLength;
+    //! Number of bytes of valid data in the read buffer
+    unsigned int  m_uiFilled;
+    //! Number of bytes at the beginning of the buffer already returned by readBlock()
+    unsigned int  m_uiConsumed;
+    //! True when the end of the file is reached
+    bool          m_boEOF;
+    //! True while the rest of a truncated Log Line is being skipped
+    bool          m_boSkipping;
+    //! True if an unterminated Log Line at the end of the file is not returned
+    bool          m_boCompleteLines;
+    //! Number of truncated Log Lines
+    unsigned long m_ulTruncated;
+    //! Offset of the first byte of the read buffer in the (decompressed) file
+    unsigned long long m_ullBufferOffset;
+    //! Offset of the end of the region being read, the Log Lines starting there are not read
+    unsigned long long m_ullRegionEnd;
+    //! Number of Log Lines in front of the region being read
+    unsigned long long m_ullLinesBefore;
+    //! The file being mapped, only open in memory-mapped mode
+    QFile         m_obMapFile;
+    //! The memory mapping of the whole file, NULL if the file is read into the buffer
+    const char   *m_poMap;
+    //! Size of the memory mapping in bytes
+    unsigned long long m_ullMapSize;
+    //! Number of bytes at the beginning of the mapping already returned by readBlock()
+    unsigned long long m_ullMapPos;
+
+    //! \brief Initializes the members of a reader of the given file
+    void          init( const QString &p_qsFileName, const unsigned int p_uiBufferSize ) throw();
+
+    //! \brief Returns the next block of whole Log Lines as they are in the file
+    bool          rawBlock( const char **p_poBegin, const char **p_poEnd ) throw( cSevException );
+
+    //! \brief Returns the next block of whole Log Lines from the memory mapping
+    bool          mapBlock( const char **p_poBegin, const char **p_poEnd ) throw();
+
+    //! \brief Doubles the size of the read buffer, but not beyond the maximum line length
+    void          growBuffer() throw();
+
+    //! \brief Reads at most p_uiSize bytes from the file into the given buffer
+    /*! Sets m_boEOF when the end of the file is reached.
+     *  \return The number of bytes read
+     */
+    unsigned int  readData( char *p_poBuffer, const unsigned int p_uiSize ) throw( cSevException );
+};
+
+#endif // LINEREADER_H
@@ -0,0 +1,194 @@
+#include <cstring>
+
+#include "linesplitter.h"
+
+#if defined( __GNUC__ ) && ( defined( __x86_64__ ) || defined( __i386__ ) )
+#define LARA_X86_KERNELS
+#include <immintrin.h>
+#endif
+
+// Type of the kernel functions, selected at runtime
+typedef const char    *(*tfFindNewLine)( const char *, const char * );
+typedef unsigned long  (*tfCountNewLines)( const char *, const char * );
+
+static const char *findNewLineScalar( const char *p_poBegin, const char *p_poEnd )
+{
+    const char *poNewLine = (const char *)memchr( p_poBegin, '\n', p_poEnd - p_poBegin );
+    return poNewLine ? poNewLine : p_poEnd;
+}
+
+static unsigned long countNewLinesScalar( const char *p_poBegin, const char *p_poEnd )
+{
+    unsigned long ulCount = 0;
+    for( ; p_poBegin < p_poEnd; p_poBegin++ )
+    {
+        if( *p_poBegin == '\n' ) ulCount++;
+    }
+    return ulCount;
+}
+
+#ifdef LARA_X86_KERNELS
+
+__attribute__(( target( "sse2" ) ))
+static const char *findNewLineSSE2( const char *p_poBegin, const char *p_poEnd )
+{
+    const __m128i obNewLine = _mm_set1_epi8( '\n' );
+    for( ; p_poEnd - p_poBegin >= 16; p_poBegin += 16 )
+    {
+        __m128i obBlock = _mm_loadu_si128( (const __m128i *)p_poBegin );
+        int     inMask  = _mm_movemask_epi8( _mm_cmpeq_epi8( obBlock, obNewLine ) );
+        if( inMask ) return p_poBegin + __builtin_ctz( inMask );
+    }
+    return findNewLineScalar( p_poBegin, p_poEnd );
+}
+
+__attribute__(( target( "sse2" ) ))
+static unsigned long countNewLinesSSE2( const char *p_poBegin, const char *p_poEnd )
+{
+    const __m128i obNewLine = _mm_set1_epi8( '\n' );
+    const __m128i obZero    = _mm_setzero_si128();
+    unsigned long ulCount   = 0;
+    while( p_poEnd - p_poBegin >= 16 )
+    {
+        // Each byte lane counts up to 255 matches before it is summed up with psadbw
+        long     liBlocks = (p_poEnd - p_poBegin) / 16;
+        if( liBlocks > 255 ) liBlocks = 255;
+        __m128i  obAccumulator = _mm_setzero_si128();
+        for( long i = 0; i < liBlocks; i++, p_poBegin += 16 )
+        {
+            __m128i obBlock = _mm_loadu_si128( (const __m128i *)p_poBegin );
+            obAccumulator = _mm_sub_epi8( obAccumulator, _mm_cmpeq_epi8( obBlock, obNewLine ) );
+        }
+        __m128i obSum = _mm_sad_epu8( obAccumulator, obZero );
+        ulCount += _mm_cvtsi128_si32( obSum ) + _mm_extract_epi16( obSum, 4 );
+    }
+    return ulCount + countNewLinesScalar( p_poBegin, p_poEnd );
+}
+
+__attribute__(( target( "avx2" ) ))
+static const char *findNewLineAVX2( const char *p_poBegin, const char *p_poEnd )
+{
+    const __m256i obNewLine = _mm256_set1_epi8( '\n' );
+    for( ; p_poEnd - p_poBegin >= 32; p_poBegin += 32 )
+    {
+        __m256i  obBlock = _mm256_loadu_si256( (const __m256i *)p_poBegin );
+        unsigned uiMask  = (unsigned)_mm256_movemask_epi8( _mm256_cmpeq_epi8( obBlock, obNewLine ) );
+        if( uiMask ) return p_poBegin + __builtin_ctz( uiMask );
+    }
+    return findNewLineSSE2( p_poBegin, p_poEnd );
+}
+
+__attribute__(( target( "avx2" ) ))
+static unsigned long countNewLinesAVX2( const char *p_poBegin, const char *p_poEnd )
+{
+    const __m256i obNewLine = _mm256_set1_epi8( '\n' );
+    const __m256i obZero    = _mm256_setzero_si256();
+    unsigned long ulCount   = 0;
+    while( p_poEnd - p_poBegin >= 32 )
+    {
+        long     liBlocks = (p_poEnd - p_poBegin) / 32;
+        if( liBlocks > 255 ) liBlocks = 255;
+        __m256i  obAccumulator = _mm256_setzero_si256();
+        for( long i = 0; i < liBlocks; i++, p_poBegin += 32 )
+        {
+            __m256i obBlock = _mm256_loadu_si256( (const __m256i *)p_poBegin );
+            obAccumulator = _mm256_sub_epi8( obAccumulator, _mm256_cmpeq_epi8( obBlock, obNewLine ) );
+        }
+        unsigned long long poSums[4];
+        _mm256_storeu_si256( (__m256i *)poSums, _mm256_sad_epu8( obAccumulator, obZero ) );
+        ulCount += poSums[0] + poSums[1] + poSums[2] + poSums[3];
+    }
+    return ulCount + countNewLinesSSE2( p_poBegin, p_poEnd );
+}
+
+#endif // LARA_X86_KERNELS
+
+// The kernels start out as the functions selecting the best kernel on their first call
+static const char    *findNewLineFirst( const char *p_poBegin, const char *p_poEnd );
+static unsigned long  countNewLinesFirst( const char *p_poBegin, const char *p_poEnd );
+
+static cLineSplitter::teKernel  s_enKernel        = cLineSplitter::SCALAR;
+static tfFindNewLine            s_pfFindNewLine   = findNewLineFirst;
+static tfCountNewLines          s_pfCountNewLines = countNewLinesFirst;
+
+static void selectKernel()
+{
+    if( s_pfFindNewLine == findNewLineFirst ) cLineSplitter::setKernel( cLineSplitter::bestKernel() );
+}
+
+static const char *findNewLineFirst( const char *p_poBegin, const char *p_poEnd )
+{
+    selectKernel();
+    return s_pfFindNewLine( p_poBegin, p_poEnd );
+}
+
+static unsigned long countNewLinesFirst( const char *p_poBegin, const char *p_poEnd )
+{
+    selectKernel();
+    return s_pfCountNewLines( p_poBegin, p_poEnd );
+}
+
+const char *cLineSplitter::findNewLine( const char *p_poBegin, const char *p_poEnd ) throw()
+{
+    return s_pfFindNewLine( p_poBegin, p_poEnd );
+}
+
+unsigned long cLineSplitter::countNewLines( const char *p_poBegin, const char *p_poEnd ) throw()
+{
+    return s_pfCountNewLines( p_poBegin, p_poEnd );
+}
+
+cLineSplitter::teKernel cLineSplitter::kernel() throw()
+{
+    selectKernel();
+    return s_enKernel;
+}
+
+bool cLineSplitter::setKernel( const teKernel p_enKernel ) throw()
+{
+    switch( p_enKernel )
+    {
+        case SCALAR:
+            s_pfFindNewLine   = findNewLineScalar;
+            s_pfCountNewLines = countNewLinesScalar;
+            break;
+#ifdef LARA_X86_KERNELS
+        case SSE2:
+            if( !__builtin_cpu_supports( "sse2" ) ) return false;
+            s_pfFindNewLine   = findNewLineSSE2;
+            s_pfCountNewLines = countNewLinesSSE2;
+            break;
+        case AVX2:
+            if( !__builtin_cpu_supports( "avx2" ) ) return false;
+            s_pfFindNewLine   = findNewLineAVX2;
+            s_pfCountNewLines = countNewLinesAVX2;
+            break;
+#endif
+        default:
+            return false;
+    }
+
+    s_enKernel = p_enKernel;
+    return true;
+}
+
+cLineSplitter::teKernel cLineSplitter::bestKernel() throw()
+{
+#ifdef LARA_X86_KERNELS
+    __builtin_cpu_init();
+    if( __builtin_cpu_supports( "avx2" ) ) return AVX2;
+    if( __builtin_cpu_supports( "sse2" ) ) return SSE2;
+#endif
+    return SCALAR;
+}
+
+const char *cLineSplitter::toStr( const teKernel p_enKernel ) throw()
+{
+    switch( p_enKernel )
+    {
+        case SCALAR: return "SCALAR"; break;
+        case SSE2:   return "SSE2";   break;
+        case AVX2:   return "AVX2";   break;
+        default:     return "INVALID";
+    }
+}
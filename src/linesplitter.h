@@ -0,0 +1,55 @@
+#ifndef LINESPLITTER_H
+#define LINESPLITTER_H
+
+//! \brief Vectorized kernels to find line boundaries and count lines in a memory block
+/*! Finding the end of the Log Lines and counting the lines for the line numbers is the
+ *  inner loop of the Log Analysis. This class provides these two kernels with SSE2 and
+ *  AVX2 implementations and a scalar fallback. The fastest implementation supported by
+ *  the CPU is selected at runtime, when the kernels are used for the first time.
+ *
+ *  All functions are static, the class has no state other than the selected kernel.
+ */
+class cLineSplitter
+{
+public:
+    //! The available kernel implementations
+    enum teKernel
+    {
+        SCALAR = 0,
+        SSE2,
+        AVX2
+    };
+
+    //! \brief Finds the first new line character in the given memory block
+    /*! \param p_poBegin pointer to the first byte of the block
+     *  \param p_poEnd pointer to the past-the-end byte of the block
+     *  \return Pointer to the first '\\n' character, or p_poEnd if there is none
+     */
+    static const char  *findNewLine( const char *p_poBegin, const char *p_poEnd ) throw();
+
+    //! \brief Counts the new line characters in the given memory block
+    /*! \param p_poBegin pointer to the first byte of the block
+     *  \param p_poEnd pointer to the past-the-end byte of the block
+     *  \return The number of '\\n' characters in the block
+     */
+    static unsigned long countNewLines( const char *p_poBegin, const char *p_poEnd ) throw();
+
+    //! \brief Returns the kernel implementation currently in use
+    static teKernel     kernel() throw();
+
+    //! \brief Selects the given kernel implementation
+    /*! This is mainly for benchmarks and tests, so the implementations can be compared.
+     *  \param p_enKernel the kernel to use
+     *  \return <tt>false</tt> if the CPU does not support the requested kernel, in which
+     *          case the kernel in use is not changed
+     */
+    static bool         setKernel( const teKernel p_enKernel ) throw();
+
+    //! \brief Returns the best kernel implementation supported by the CPU
+    static teKernel     bestKernel() throw();
+
+    //! Conversion function to convert a kernel enum value to a string
+    static const char  *toStr( const teKernel p_enKernel ) throw();
+};
+
+#endif // LINESPLITTER_H
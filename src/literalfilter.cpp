@@ -0,0 +1,155 @@
+#include <queue>
+#include <cstring>
+
+#include "literalfilter.h"
+
+using namespace std;
+
+cLiteralFilter::cLiteralFilter() throw()
+{
+    m_uiPatternCount = 0;
+    m_uiClassCount   = 1;
+    memset( m_poClassOf, 0, sizeof( m_poClassOf ) );
+}
+
+cLiteralFilter::~cLiteralFilter() throw()
+{
+}
+
+void cLiteralFilter::build( const QStringList &p_slLiterals ) throw()
+{
+    m_uiPatternCount = p_slLiterals.size();
+    m_uiClassCount   = 1;
+    memset( m_poClassOf, 0, sizeof( m_poClassOf ) );
+    m_veTransitions.clear();
+    m_veOutputs.clear();
+    m_veAlwaysRun.clear();
+
+    vector<QByteArray> veLiterals;
+    for( int i = 0; i < p_slLiterals.size(); i++ )
+    {
+        veLiterals.push_back( p_slLiterals.at( i ).toAscii() );
+        if( veLiterals.back().contains( '\n' ) ) continue;
+        for( int c = 0; c < veLiterals.back().size(); c++ )
+        {
+            unsigned char ubChar = (unsigned char)veLiterals.back().at( c );
+            if( !m_poClassOf[ubChar] ) m_poClassOf[ubChar] = m_uiClassCount++;
+        }
+    }
+
+    // Building the trie. Missing transitions are marked with the root state (0) since
+    // no transition can ever lead back to the root in a trie.
+    m_veTransitions.resize( m_uiClassCount, 0 );
+    m_veOutputs.resize( 1 );
+    for( unsigned int i = 0; i < veLiterals.size(); i++ )
+    {
+        if( veLiterals[i].isEmpty() || veLiterals[i].contains( '\n' ) )
+        {
+            m_veAlwaysRun.push_back( i );
+            continue;
+        }
+
+        unsigned int uiState = 0;
+        for( int c = 0; c < veLiterals[i].size(); c++ )
+        {
+            unsigned int uiClass = m_poClassOf[(unsigned char)veLiterals[i].at( c )];
+            if( !m_veTransitions[uiState * m_uiClassCount + uiClass] )
+            {
+                m_veTransitions[uiState * m_uiClassCount + uiClass] = m_veOutputs.size();
+                m_veTransitions.resize( m_veTransitions.size() + m_uiClassCount, 0 );
+                m_veOutputs.resize( m_veOutputs.size() + 1 );
+            }
+            uiState = m_veTransitions[uiState * m_uiClassCount + uiClass];
+        }
+        m_veOutputs[uiState].push_back( i );
+    }
+
+    // Computing the failure links in breadth-first order and turning the trie into a
+    // complete automaton, so scanning needs exactly one table lookup per byte.
+    vector<unsigned int> veFail( m_veOutputs.size(), 0 );
+    queue<unsigned int>  obQueue;
+    for( unsigned int c = 0; c < m_uiClassCount; c++ )
+    {
+        if( m_veTransitions[c] ) obQueue.push( m_veTransitions[c] );
+    }
+    while( !obQueue.empty() )
+    {
+        unsigned int uiState = obQueue.front();
+        obQueue.pop();
+
+        for( unsigned int c = 0; c < m_uiClassCount; c++ )
+        {
+            unsigned int uiNext = m_veTransitions[uiState * m_uiClassCount + c];
+            unsigned int uiFallback = m_veTransitions[veFail[uiState] * m_uiClassCount + c];
+            if( uiNext )
+            {
+                veFail[uiNext] = uiFallback;
+                m_veOutputs[uiNext].insert( m_veOutputs[uiNext].end(),
+                                            m_veOutputs[uiFallback].begin(),
+                                            m_veOutputs[uiFallback].end() );
+                obQueue.push( uiNext );
+            }
+            else
+            {
+                m_veTransitions[uiState * m_uiClassCount + c] = uiFallback;
+            }
+        }
+    }
+}
+
+unsigned int cLiteralFilter::patternCount() const throw()
+{
+    return m_uiPatternCount;
+}
+
+unsigned int cLiteralFilter::candidates( const char *p_poText, const unsigned int p_uiLength,
+                                         vector<unsigned char> *p_poHits ) const throw()
+{
+    p_poHits->assign( m_uiPatternCount, 0 );
+
+    unsigned int uiHitCount = 0;
+    for( unsigned int i = 0; i < m_veAlwaysRun.size(); i++ )
+    {
+        (*p_poHits)[m_veAlwaysRun[i]] = 1;
+        uiHitCount++;
+    }
+
+    if( m_veOutputs.size() < 2 ) return uiHitCount;
+
+    const unsigned int *poTransitions = &m_veTransitions[0];
+    unsigned int        uiState = 0;
+    for( unsigned int i = 0; i < p_uiLength; i++ )
+    {
+        uiState = poTransitions[uiState * m_uiClassCount + m_poClassOf[(unsigned char)p_poText[i]]];
+
+        const vector<unsigned int> &veOutput = m_veOutputs[uiState];
+        for( unsigned int o = 0; o < veOutput.size(); o++ )
+        {
+            if( (*p_poHits)[veOutput[o]] ) continue;
+            (*p_poHits)[veOutput[o]] = 1;
+            uiHitCount++;
+        }
+    }
+
+    return uiHitCount;
+}
+
+bool cLiteralFilter::blockScan() const throw()
+{
+    return m_veAlwaysRun.empty();
+}
+
+const char *cLiteralFilter::findHit( const char *p_poBegin, const char *p_poEnd ) const throw()
+{
+    if( m_veOutputs.size() < 2 ) return p_poEnd;
+
+    const unsigned int *poTransitions = &m_veTransitions[0];
+    unsigned int        uiState = 0;
+    for( const char *poChar = p_poBegin; poChar < p_poEnd; poChar++ )
+    {
+        uiState = poTransitions[uiState * m_uiClassCount + m_poClassOf[(unsigned char)*poChar]];
+        if( !m_veOutputs[uiState].empty() ) return poChar;
+    }
+
+    return p_poEnd;
+}
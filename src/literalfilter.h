@@ -0,0 +1,84 @@
+#ifndef LITERALFILTER_H
+#define LITERALFILTER_H
+
+#include <QString>
+#include <QStringList>
+#include <vector>
+
+//! \brief Multi-literal prefilter that selects the Patterns worth running on a Log Line
+/*! Most Patterns contain a literal text that must be present in every Log Line they can
+ *  match (see cPattern::literal()). The cLiteralFilter collects these literals from all
+ *  the Patterns of an Action Definition file and builds a single Aho-Corasick automaton
+ *  from them. A single pass of the automaton over a Log Line tells which literals occur in
+ *  the line, so only the regular expressions of those Patterns have to be evaluated.
+ *  Patterns without a literal are always selected.
+ *
+ *  The automaton works on bytes. The characters of the literals are mapped to a small set
+ *  of character classes (every other byte falls into class 0), so the transition table
+ *  stays small even for hundreds of Patterns.
+ */
+class cLiteralFilter
+{
+public:
+    //! \brief Default constructor, creates an empty filter that selects nothing.
+    cLiteralFilter() throw();
+
+    //! \brief Destructor
+    /*! An empty destructor.
+     */
+    ~cLiteralFilter() throw();
+
+    //! \brief Builds the automaton from the given list of literals
+    /*! The literals are indexed the same way as the Patterns they were extracted from. An
+     *  empty literal means that the given Pattern has no required literal, so it has to be
+     *  run on every Log Line.
+     *  \param p_slLiterals the required literal of each Pattern, in Pattern order
+     */
+    void          build( const QStringList &p_slLiterals ) throw();
+
+    //! \brief Returns the number of Patterns the filter was built for
+    unsigned int  patternCount() const throw();
+
+    //! \brief Selects the Patterns whose literal occurs in the given text
+    /*! \param p_poText pointer to the Log Line (it does not have to be zero terminated)
+     *  \param p_uiLength length of the Log Line in bytes
+     *  \param p_poHits vector that is resized to patternCount() and filled with 1 for each
+     *         selected Pattern and 0 for every other Pattern
+     *  \return The number of selected Patterns
+     */
+    unsigned int  candidates( const char *p_poText, const unsigned int p_uiLength,
+                              std::vector<unsigned char> *p_poHits ) const throw();
+
+    //! \brief Checks if the filter can be run over whole blocks of Log Lines
+    /*! None of the literals contain a new line character, so the automaton always returns
+     *  to its initial state at the end of every Log Line. If every Pattern has a literal,
+     *  the Log Lines without any literal can be skipped without splitting the block to
+     *  lines, using findHit().
+     *  \return <tt>true</tt> if every Pattern has a required literal
+     */
+    bool          blockScan() const throw();
+
+    //! \brief Finds the first occurrence of any literal in the given block of Log Lines
+    /*! \param p_poBegin pointer to the first byte of the block
+     *  \param p_poEnd pointer to the past-the-end byte of the block
+     *  \return Pointer to the last character of the first literal found, or p_poEnd if
+     *          none of the literals occur in the block
+     */
+    const char   *findHit( const char *p_poBegin, const char *p_poEnd ) const throw();
+
+private:
+    //! Number of Patterns the filter was built for
+    unsigned int                              m_uiPatternCount;
+    //! Number of character classes (the width of the transition table)
+    unsigned int                              m_uiClassCount;
+    //! Maps each byte to its character class
+    unsigned int                              m_poClassOf[256];
+    //! Complete transition table of the automaton, m_uiClassCount entries per state
+    std::vector<unsigned int>                 m_veTransitions;
+    //! Indexes of the Patterns whose literal ends in the given state (including suffixes)
+    std::vector< std::vector<unsigned int> >  m_veOutputs;
+    //! Indexes of the Patterns without a required literal
+    std::vector<unsigned int>                 m_veAlwaysRun;
+};
+
+#endif // LITERALFILTER_H
@@ -1,14 +1,34 @@
 #include <QDir>
+#include <QFileInfo>
+#include <QDateTime>
+#include <QDataStream>
 #include <cstdlib>
 #include <stdio.h>
 #include <ctime>
+#include <vector>
 
 #include "lara.h"
 #include "loganalyser.h"
+#include "linereader.h"
+#include "linesplitter.h"
+#include "gzipindex.h"
+#include "lineindex.h"
+#include "streamcodec.h"
+#include "ziparchive.h"
+#include "followstate.h"
 
 using namespace std;
 
-cLogAnalyser::cLogAnalyser( const QString &p_qsPrefix, const QString &p_qsFiles, const QString &p_qsActions, cOutputCreator *p_poOC ) throw()
+// Size and modification time of a file, to tell if a checkpoint still refers to it
+static void fileStamp( const QString &p_qsFileName, unsigned long long *p_poSize, unsigned int *p_poTime )
+{
+    QFileInfo obFileInfo( p_qsFileName );
+    *p_poSize = obFileInfo.exists() ? obFileInfo.size() : 0;
+    *p_poTime = obFileInfo.exists() ? obFileInfo.lastModified().toTime_t() : 0;
+}
+
+cLogAnalyser::cLogAnalyser( const QString &p_qsPrefix, const QString &p_qsFiles, const QString &p_qsActions, cOutputCreator *p_poOC,
+                            cFileDiscovery *p_poDiscovery ) throw()
 {
     cTracer obTracer( &g_obLogger, "cLogAnalyser::cLogAnalyser",
                       QString( "prefix: \"%1\", files: \"%2\", actions:\"%3\"" ).arg( p_qsPrefix ).arg( p_qsFiles ).arg( p_qsActions ).toStdString() );
@@ -17,9 +37,36 @@ cLogAnalyser::cLogAnalyser( const QString &p_qsPrefix, const QString &p_qsFiles,
     qsInputDir += QDir::separator();
     qsInputDir += p_qsPrefix;
     qsInputDir = QDir::cleanPath( qsInputDir );
-    m_poDataSource    = new cLogDataSource( qsInputDir, p_qsFiles );
+    // A Log Analyser that finished before the checkpoint the analysis is resumed from has its
+    // results in the cOutputCreator already, so its files are not even prepared
+    m_poCheckpoint    = p_poOC ? p_poOC->checkpoint() : NULL;
+    m_boRestored      = false;
+    m_ullResumeOffset = 0;
+    m_ulResumeLines   = 0;
+    m_ullResumeSize   = 0;
+    m_uiResumeTime    = 0;
+    m_boTimeRange     = false;
+    m_ullFrom         = 0;
+    m_ullTo           = ~0ULL;
+    m_ullLinesRead    = 0;
+    if( m_poCheckpoint )
+    {
+        unsigned int uiIndex = m_poCheckpoint->beginAnalyser();
+        m_boRestored = uiIndex < m_poCheckpoint->analysersDone();
+        if( uiIndex == m_poCheckpoint->analysersDone() ) restoreCheckpoint();
+    }
+
+    // Following the Input Log Files needs the original files, not prepared copies of them
+    m_boInPlace       = g_poPrefs->readInPlace() || (p_poOC && p_poOC->followState());
+    m_poDataSource    = m_boRestored ? NULL : new cLogDataSource( qsInputDir, p_qsFiles, m_boInPlace, g_poPrefs->prefetchFiles(), p_poDiscovery, m_slFilesDone );
 
     m_poActionDefList = new cActionDefList( p_qsActions, "data/lara_actions.xsd" );
+    m_poRegExpSetCache = new cRegExpSetCache( g_poPrefs->regExpSetCacheSize() );
+    m_poPatternScratch   = new cPatternScratch;
+    m_poPatternScratch->setMatchBudget( g_poPrefs->matchBudget() );
+    m_veOverBudget.assign( m_poActionDefList->patternEnd() - m_poActionDefList->patternBegin(), 0 );
+    m_poTimeStampScratch = new cTimeStampScratch( &m_poActionDefList->timeStampParser() );
+    m_boFusedMatching = g_poPrefs->fusedMatching();
 
     m_poOC = p_poOC;
     if( !m_poOC ) g_obLogger << cSeverity::WARNING << "LogAnalyser: Non-existing OutputCreator received. Generating outputs is disabled!" << cLogMessage::EOM;
@@ -29,6 +76,9 @@ cLogAnalyser::~cLogAnalyser() throw()
 {
     cTracer  obTracer( &g_obLogger, "cLogAnalyser::~cLogAnalyser" );
 
+    delete m_poTimeStampScratch;
+    delete m_poPatternScratch;
+    delete m_poRegExpSetCache;
     delete m_poActionDefList;
     delete m_poDataSource;
 }
@@ -37,10 +87,38 @@ void cLogAnalyser::analyse() throw( cSevException )
 {
     cTracer  obTracer( &g_obLogger, "cLogAnalyser::analyse" );
 
-    QStringList slLogFiles = m_poDataSource->logFileList();
-    for( int i = 0; i < slLogFiles.size(); i++ )
+    if( m_boRestored )
     {
-        findPatterns( slLogFiles.at( i ) );
+        obTracer << "Results restored from the checkpoint";
+        return;
+    }
+
+    // The next files are prepared in the background while a file is searched, the files
+    // searched before the checkpoint the analysis was resumed from are not even prepared
+    QString qsLogFile;
+    while( m_poDataSource->nextLogFile( &qsLogFile ) )
+    {
+        findPatterns( qsLogFile );
+
+        if( m_poCheckpoint )
+        {
+            QByteArray  baData;
+            QDataStream obStream( &baData, QIODevice::WriteOnly );
+            obStream << m_poDataSource->origFileName( qsLogFile );
+            m_poCheckpoint->append( cCheckpoint::FILE_DONE, baData );
+            if( m_poCheckpoint->due() ) saveCheckpoint();
+        }
+    }
+
+    unsigned int uiPatternIdx = 0;
+    for( cActionDefList::tiPatternList itPattern = m_poActionDefList->patternBegin();
+         itPattern != m_poActionDefList->patternEnd();
+         itPattern++, uiPatternIdx++ )
+    {
+        if( !m_veOverBudget[uiPatternIdx] ) continue;
+        g_obLogger << cSeverity::WARNING
+                   << QString( "Pattern %1 ran out of the match budget on %2 Log Lines, these lines were skipped" ).arg( itPattern->name() ).arg( m_veOverBudget[uiPatternIdx] ).toStdString()
+                   << cLogMessage::EOM;
     }
 
     identifySingleLinerActions();
@@ -59,86 +137,544 @@ void cLogAnalyser::analyse() throw( cSevException )
 
     storeActions();
     storeAttributes();
+
+    if( m_poCheckpoint )
+    {
+        m_poCheckpoint->append( cCheckpoint::ANALYSER_DONE, QByteArray() );
+        saveCheckpoint();
+    }
+}
+
+void cLogAnalyser::setTimeRange( const unsigned long long p_ullFrom, const unsigned long long p_ullTo ) throw()
+{
+    m_boTimeRange = true;
+    m_ullFrom     = p_ullFrom;
+    m_ullTo       = p_ullTo;
 }
 
 void cLogAnalyser::findPatterns( const QString &p_qsFileName ) throw()
 {
     cTracer  obTracer( &g_obLogger, "cLogAnalyser::findPatterns", p_qsFileName.toStdString() );
 
-    unsigned int uiFileId = 0;
-    char poLogLine[500000] = "";
+    unsigned int        uiFileId         = 0;
+    unsigned long       ulCandidateLines = 0;
+    unsigned long long  ullRegExpRuns    = 0;
+
+    const cLiteralFilter  &obFilter = m_poActionDefList->literalFilter();
 
     if( m_poOC ) uiFileId = m_poOC->fileId( p_qsFileName );
 
-    for( cActionDefList::tiPatternList itPattern = m_poActionDefList->patternBegin();
-         itPattern != m_poActionDefList->patternEnd();
-         itPattern++ )
+    // The checkpoints refer to the original files, a prepared copy is made again by every run
+    QString qsOrigFile = m_poDataSource ? m_poDataSource->origFileName( p_qsFileName ) : p_qsFileName;
+
+    tsSearchRegion suRegion;
+    if( !seekStart( p_qsFileName, qsOrigFile, uiFileId, &suRegion ) ) return;
+
+    cFollowState *poFollowState = m_poOC ? m_poOC->followState() : NULL;
+    unsigned long ulLineNum     = suRegion.ulLineNum;
+    unsigned long ulFirstLine   = ulLineNum;
+    cLineReader  *poReader      = NULL;
+    cLineIndex   *poLineIndex   = NULL;
+    try
     {
-        QString qsCommand = QString( "pcregrep -n \"%1\" %2" ).arg( itPattern->pattern() ).arg( p_qsFileName );
+        if( suRegion.uiGzipPoint )
+        {
+            poReader  = new cLineReader( suRegion.poGzipIndex, suRegion.uiGzipPoint, suRegion.poGzipIndex->pointCount() );
+            ulLineNum   = poReader->linesBefore();
+            ulFirstLine = ulLineNum;
+            obTracer << QString( "Inflating from access point %1, line %2" ).arg( suRegion.uiGzipPoint ).arg( ulLineNum ).toStdString();
+        }
+        else
+        {
+            poReader = new cLineReader( p_qsFileName, 1048576, m_boInPlace, suRegion.boGzipIndexed ? NULL : suRegion.poGzipIndex,
+                                        m_poDataSource ? m_poDataSource->zipArchive( p_qsFileName ) : NULL );
+        }
+        poReader->setMaxLineLength( g_poPrefs->maxLineLength() );
+        if( poFollowState && !suRegion.boWhole ) poReader->setCompleteLines( true );
+        if( suRegion.ullOffset ) poReader->seek( suRegion.ullOffset );
 
-        tmFoundPatternList::iterator itLastPattern = m_maFoundPatterns.begin();
+        // The line index is only built for the files whose Log Lines can be read again
+        // from the middle when the reports are generated
+        if( m_poOC && g_poPrefs->contextLines() && m_boInPlace && poReader->seekable() )
+        {
+            poLineIndex = new cLineIndex( p_qsFileName );
+        }
 
-        FILE*  poGrepOutput = popen( qsCommand.toAscii(), "r" );
-        while( !feof( poGrepOutput ) )
+        const char         *poBegin        = NULL;
+        const char         *poEnd          = NULL;
+        unsigned long long  ullBlockOffset = poReader->offset();
+        while( poReader->readBlock( &poBegin, &poEnd ) )
         {
-            if( fgets( poLogLine, 500000, poGrepOutput ) )
+            if( suRegion.boCatalogue ) catalogueBlock( suRegion.poCatalog, poBegin, poEnd, ullBlockOffset, ulLineNum );
+            if( poLineIndex ) poLineIndex->addBlock( poBegin, poEnd, ullBlockOffset, poReader->offset(), ulLineNum );
+
+            scanRegion( uiFileId, poBegin, poEnd, &ulLineNum, &ulCandidateLines, &ullRegExpRuns );
+
+            // A compressed file cannot be continued from the middle, so the checkpoints
+            // only cover it once it is searched completely
+            if( m_poCheckpoint && poReader->seekable() && m_poCheckpoint->due() )
             {
-                try
-                {
-                    storePattern( uiFileId, itPattern, QString::fromAscii( poLogLine ), &itLastPattern );
-                } catch( cSevException &e )
-                {
-                    g_obLogger << e;
-                }
+                recordProgress( qsOrigFile, poReader->offset(), ulLineNum );
+            }
+
+            ullBlockOffset = poReader->offset();
+            if( ullBlockOffset >= suRegion.ullEndOffset )
+            {
+                obTracer << QString( "Time range ends at offset %1" ).arg( ullBlockOffset ).toStdString();
+                break;
+            }
+        }
+
+        if( suRegion.boCatalogue )
+        {
+            suRegion.poCatalog->finish();
+            try
+            {
+                suRegion.poCatalog->save( suRegion.qsCatalogFile );
+                obTracer << QString( "Stored %1 time catalog points in %2" ).arg( suRegion.poCatalog->pointCount() ).arg( suRegion.qsCatalogFile ).toStdString();
+            }
+            catch( cSevException &e )
+            {
+                g_obLogger << e;
             }
         }
 
-        pclose( poGrepOutput );
+        if( poLineIndex )
+        {
+            m_poOC->addLineIndex( uiFileId, poLineIndex );
+            poLineIndex = NULL;
+        }
+
+        if( suRegion.poGzipIndex && !suRegion.boGzipIndexed && suRegion.poGzipIndex->complete() )
+        {
+            try
+            {
+                suRegion.poGzipIndex->save( suRegion.qsIndexFile );
+                obTracer << QString( "Stored %1 access points in %2" ).arg( suRegion.poGzipIndex->pointCount() ).arg( suRegion.qsIndexFile ).toStdString();
+            }
+            catch( cSevException &e )
+            {
+                g_obLogger << e;
+            }
+        }
+
+        if( poFollowState ) poFollowState->setPosition( p_qsFileName, suRegion.boWhole ? suRegion.ullFileSize : poReader->offset(), ulLineNum );
+        m_ullLinesRead += ulLineNum - ulFirstLine;
+    }
+    catch( cSevException &e )
+    {
+        g_obLogger << e;
     }
 
+    if( poReader && poReader->truncatedLines() )
+    {
+        g_obLogger << cSeverity::WARNING
+                   << QString( "%1 Log Lines longer than %2 bytes were truncated in %3" ).arg( poReader->truncatedLines() ).arg( g_poPrefs->maxLineLength() ).arg( p_qsFileName ).toStdString()
+                   << cLogMessage::EOM;
+    }
+
+    delete poReader;
+    delete suRegion.poGzipIndex;
+    delete suRegion.poCatalog;
+    delete poLineIndex;
+
+    // Only the Log Lines read by this run are counted, not those skipped by a follow,
+    // resume or time range start
+    unsigned long      ulLinesRead    = ulLineNum - ulFirstLine;
+    unsigned long long ullRegExpTotal = (unsigned long long)ulLinesRead * obFilter.patternCount();
+    obTracer << QString( "Prefilter passed %1 of %2 lines, ran %3 of %4 regexps (%5%)" )
+                .arg( ulCandidateLines ).arg( ulLinesRead ).arg( ullRegExpRuns ).arg( ullRegExpTotal )
+                .arg( ullRegExpTotal ? 100.0 * ullRegExpRuns / ullRegExpTotal : 0.0, 0, 'f', 2 ).toStdString();
+    obTracer << QString( "Regexp set cache holds %1 states in %2 bytes, flushed %3 times" )
+                .arg( m_poRegExpSetCache->stateCount() ).arg( m_poRegExpSetCache->memoryUsage() )
+                .arg( m_poRegExpSetCache->flushCount() ).toStdString();
     obTracer << "Found " << m_maFoundPatterns.size() << " patterns so far";
 }
 
-void cLogAnalyser::storePattern( const unsigned int p_uiFileId, cActionDefList::tiPatternList p_itPattern, const QString &p_qsLogLine,
-                                 tmFoundPatternList::iterator  *p_poInsertPos ) throw( cSevException )
+bool cLogAnalyser::seekStart( const QString &p_qsFileName, const QString &p_qsOrigFile,
+                              const unsigned int p_uiFileId, tsSearchRegion *p_poRegion ) throw()
 {
-    cTracer  obTracer( &g_obLogger, "cLogAnalyser::storePattern", p_itPattern->name().toStdString() );
+    cTracer  obTracer( &g_obLogger, "cLogAnalyser::seekStart", p_qsFileName.toStdString() );
+
+    p_poRegion->ullOffset     = 0;
+    p_poRegion->ulLineNum     = 0;
+    p_poRegion->boWhole       = false;
+    p_poRegion->ullFileSize   = 0;
+    p_poRegion->poGzipIndex   = NULL;
+    p_poRegion->boGzipIndexed = false;
+    p_poRegion->uiGzipPoint   = 0;
+    p_poRegion->poCatalog     = NULL;
+    p_poRegion->ullEndOffset  = ~0ULL;
+    p_poRegion->boCatalogue   = false;
+
+    // In follow mode an uncompressed file is read from where the previous run stopped. A
+    // compressed file or ZIP entry is only read again as a whole if the file changed.
+    cFollowState *poFollowState = m_poOC ? m_poOC->followState() : NULL;
+    if( poFollowState )
+    {
+        QString qsArchive;
+        QString qsEntry;
+        p_poRegion->boWhole = cZipArchive::splitMemberName( p_qsFileName, &qsArchive, &qsEntry ) || cCodecRegistry::find( p_qsFileName );
 
-    QString qsLogLine = p_qsLogLine.section( ':', 1 ); // Remove line number from front
-    qsLogLine.chop( 1 );                               // and the new line character from end
+        unsigned long long ullLines = 0;
+        p_poRegion->ullOffset = poFollowState->position( p_qsFileName, &ullLines );
+        if( p_poRegion->boWhole )
+        {
+            p_poRegion->ullFileSize = QFileInfo( qsArchive.isEmpty() ? p_qsFileName : qsArchive ).size();
+            if( p_poRegion->ullOffset && p_poRegion->ullOffset == p_poRegion->ullFileSize )
+            {
+                obTracer << "File not changed since the previous run";
+                return false;
+            }
+            p_poRegion->ullOffset = 0;
+            ullLines              = 0;
+        }
+        p_poRegion->ulLineNum = ullLines;
+        obTracer << QString( "Following from offset %1, line %2" ).arg( p_poRegion->ullOffset ).arg( ullLines ).toStdString();
+    }
 
-    QRegExp obTimeStampRegExp = m_poActionDefList->timeStampRegExp();
-    if( obTimeStampRegExp.indexIn( qsLogLine ) == -1 )
-        throw cSevException( cSeverity::ERROR,
-                             QString( "TimeStamp Regular Expression does not match on Log Line \"%1\"" ).arg( qsLogLine ).toStdString() );
+    if( m_poCheckpoint && p_qsOrigFile == m_qsResumeFile )
+    {
+        m_qsResumeFile = "";
 
-    QStringList    slTimeStampParts = obTimeStampRegExp.capturedTexts();
-    tsFoundPattern suFoundPattern;
+        unsigned long long ullResumeSize = 0;
+        unsigned int       uiResumeTime  = 0;
+        fileStamp( p_qsOrigFile, &ullResumeSize, &uiResumeTime );
+        if( ullResumeSize == m_ullResumeSize && uiResumeTime == m_uiResumeTime )
+        {
+            p_poRegion->ullOffset = m_ullResumeOffset;
+            p_poRegion->ulLineNum = m_ulResumeLines;
+            obTracer << QString( "Resuming from offset %1, line %2" ).arg( p_poRegion->ullOffset ).arg( p_poRegion->ulLineNum ).toStdString();
+        }
+        else
+        {
+            // The Patterns found in the old content of the file are dropped, and the file is
+            // searched again from its beginning
+            dropFoundPatterns( p_uiFileId );
+            if( m_poOC ) m_poOC->restartFile( p_uiFileId );
+            obTracer << "File changed since the checkpoint, searched from its beginning";
+        }
+    }
+
+    // A gzipped file without an up to date random access index is indexed while it is read,
+    // the index of a file indexed by an earlier run lets a time range start in its middle
+    if( g_poPrefs->gzipIndexSpan() && cCodecRegistry::find( p_qsFileName ) == cCodecRegistry::codec( "gzip" ) )
+    {
+        p_poRegion->qsIndexFile   = cGzipIndex::indexFileName( p_qsFileName, g_poPrefs->indexDir() );
+        p_poRegion->poGzipIndex   = new cGzipIndex( p_qsFileName, g_poPrefs->gzipIndexSpan() );
+        p_poRegion->boGzipIndexed = p_poRegion->poGzipIndex->load( p_poRegion->qsIndexFile );
+    }
+
+    // With a time range the time catalog tells if the file has to be searched at all, and
+    // where the search can start and stop. A file without an up to date catalog is searched
+    // as a whole, and catalogued while it is read. Uncompressed files and indexed gzipped
+    // files can be entered in the middle, the others are only stopped early. The catalog
+    // belongs to the original file, as a prepared copy is made again by every run; only a
+    // decoded sysError copy has offsets that differ from those of the original file.
+    if( m_boTimeRange && !poFollowState && QFileInfo( p_qsOrigFile ).exists() )
+    {
+        QString qsCatalogKey = p_qsFileName.endsWith( ".decoded" ) ? p_qsOrigFile + ".decoded" : p_qsOrigFile;
+        p_poRegion->qsCatalogFile = cTimeCatalog::catalogFileName( qsCatalogKey, g_poPrefs->indexDir() );
+        p_poRegion->poCatalog     = new cTimeCatalog( p_qsOrigFile, m_poActionDefList->timeStampRegExp().pattern() );
+        if( p_poRegion->poCatalog->load( p_poRegion->qsCatalogFile ) )
+        {
+            if( !p_poRegion->poCatalog->overlaps( m_ullFrom, m_ullTo ) )
+            {
+                obTracer << "File is outside the time range";
+                delete p_poRegion->poCatalog;
+                delete p_poRegion->poGzipIndex;
+                return false;
+            }
+
+            const cTimeCatalog::tsPoint *poStart = p_poRegion->poCatalog->startPoint( m_ullFrom );
+            if( poStart && poStart->ullOffset > p_poRegion->ullOffset && !cCodecRegistry::find( p_qsFileName ) )
+            {
+                p_poRegion->ullOffset = poStart->ullOffset;
+                p_poRegion->ulLineNum = poStart->ullLines;
+            }
+            else if( poStart && p_poRegion->boGzipIndexed )
+            {
+                // Inflating starts at the last access point in front of the time range
+                p_poRegion->uiGzipPoint = p_poRegion->poGzipIndex->findPoint( poStart->ullOffset );
+            }
+            p_poRegion->ullEndOffset = p_poRegion->poCatalog->endOffset( m_ullTo );
+            obTracer << QString( "Time range is searched from offset %1, line %2" ).arg( p_poRegion->ullOffset ).arg( p_poRegion->ulLineNum ).toStdString();
+        }
+        else
+        {
+            p_poRegion->boCatalogue = !p_poRegion->ullOffset;
+        }
+    }
+
+    return true;
+}
 
-    suFoundPattern.qsTimeStamp = slTimeStampParts.at( 0 );
+void cLogAnalyser::scanRegion( const unsigned int p_uiFileId, const char *p_poBegin, const char *p_poEnd,
+                               unsigned long *p_poLineNum, unsigned long *p_poCandidateLines,
+                               unsigned long long *p_poRegExpRuns ) throw()
+{
+    const cLiteralFilter  &obFilter = m_poActionDefList->literalFilter();
+    const char            *poPos    = p_poBegin;
+
+    if( obFilter.blockScan() )
+    {
+        // Every Pattern has a literal, so the lines in between the literal hits are not
+        // split up one by one, they are only counted for the line numbers.
+        for( const char *poHit = obFilter.findHit( poPos, p_poEnd );
+             poHit != p_poEnd;
+             poHit = obFilter.findHit( poPos, p_poEnd ) )
+        {
+            const char *poLineStart = poHit;
+            while( poLineStart > poPos && poLineStart[-1] != '\n' ) poLineStart--;
+            const char *poLineEnd = cLineSplitter::findNewLine( poHit, p_poEnd );
+
+            *p_poLineNum += cLineSplitter::countNewLines( poPos, poLineStart ) + 1;
+            unsigned int uiRuns = matchLine( p_uiFileId, *p_poLineNum, poLineStart, poLineEnd - poLineStart );
+            if( uiRuns ) (*p_poCandidateLines)++;
+            *p_poRegExpRuns += uiRuns;
+
+            poPos = (poLineEnd < p_poEnd) ? poLineEnd + 1 : p_poEnd;
+        }
+
+        if( poPos < p_poEnd )
+        {
+            *p_poLineNum += cLineSplitter::countNewLines( poPos, p_poEnd );
+            if( p_poEnd[-1] != '\n' ) (*p_poLineNum)++;
+        }
+    }
+    else
+    {
+        while( poPos < p_poEnd )
+        {
+            const char *poLineEnd = cLineSplitter::findNewLine( poPos, p_poEnd );
+
+            unsigned int uiRuns = matchLine( p_uiFileId, ++(*p_poLineNum), poPos, poLineEnd - poPos );
+            if( uiRuns ) (*p_poCandidateLines)++;
+            *p_poRegExpRuns += uiRuns;
+
+            poPos = (poLineEnd < p_poEnd) ? poLineEnd + 1 : p_poEnd;
+        }
+    }
+}
+
+void cLogAnalyser::recordProgress( const QString &p_qsOrigFile, const unsigned long long p_ullOffset,
+                                   const unsigned long p_ulLineNum ) throw()
+{
+    // The size and modification time tell if the offset is still valid on resume
+    unsigned long long ullStampSize = 0;
+    unsigned int       uiStampTime  = 0;
+    fileStamp( p_qsOrigFile, &ullStampSize, &uiStampTime );
+
+    QByteArray  baData;
+    QDataStream obStream( &baData, QIODevice::WriteOnly );
+    obStream << p_qsOrigFile << (quint64)p_ullOffset << (quint64)p_ulLineNum
+             << (quint64)ullStampSize << (quint32)uiStampTime;
+    m_poCheckpoint->append( cCheckpoint::PROGRESS, baData );
+    saveCheckpoint();
+}
+
+unsigned int cLogAnalyser::matchLine( const unsigned int p_uiFileId, const unsigned long p_ulLineNum,
+                                      const char *p_poLine, const unsigned int p_uiLength ) throw()
+{
+    unsigned int uiCandidates = m_poActionDefList->literalFilter().candidates( p_poLine, p_uiLength, &m_veCandidates );
+    Q_ASSERT( m_veCandidates.size() == (unsigned int)(m_poActionDefList->patternEnd() - m_poActionDefList->patternBegin()) );
+    if( !uiCandidates ) return 0;
+
+    // The covered Patterns are matched in a single pass, unless the DFA cache is full. In
+    // fused mode the fused Patterns are evaluated exactly once instead.
+    const cRegExpSet &obRegExpSet = m_poActionDefList->regExpSet();
+    bool boSetMatched = !m_boFusedMatching && obRegExpSet.coveredCount() &&
+                        obRegExpSet.match( p_poLine, p_uiLength, m_poRegExpSetCache, &m_veSetMatches );
+
+    QString     qsLogLine;
+    QStringList slTimeStampTexts;
+    QStringList slCapturedTexts;
+
+    unsigned int uiPatternIdx = 0;
+    for( cActionDefList::tiPatternList itPattern = m_poActionDefList->patternBegin();
+         itPattern != m_poActionDefList->patternEnd();
+         itPattern++, uiPatternIdx++ )
+    {
+        if( !m_veCandidates[uiPatternIdx] ) continue;
+
+        bool boFused = m_boFusedMatching && itPattern->fused();
+        if( boFused )
+        {
+            if( !itPattern->matchFused( p_poLine, p_uiLength, &slTimeStampTexts, &slCapturedTexts, m_poPatternScratch ) )
+            {
+                if( m_poPatternScratch->overBudget() ) m_veOverBudget[uiPatternIdx]++;
+                continue;
+            }
+        }
+        else if( boSetMatched && obRegExpSet.covers( uiPatternIdx ) )
+        {
+            if( !m_veSetMatches[uiPatternIdx] ) continue;
+        }
+        else if( !itPattern->matches( p_poLine, p_uiLength, m_poPatternScratch ) )
+        {
+            if( m_poPatternScratch->overBudget() ) m_veOverBudget[uiPatternIdx]++;
+            continue;
+        }
+
+        if( qsLogLine.isNull() ) qsLogLine = QString::fromAscii( p_poLine, p_uiLength );
+
+        try
+        {
+            storePattern( p_uiFileId, p_ulLineNum, itPattern, p_poLine, p_uiLength, qsLogLine,
+                          boFused ? &slTimeStampTexts : NULL, boFused ? &slCapturedTexts : NULL );
+        } catch( cSevException &e )
+        {
+            g_obLogger << e;
+        }
+    }
+
+    return uiCandidates;
+}
+
+void cLogAnalyser::catalogueBlock( cTimeCatalog *p_poCatalog, const char *p_poBegin, const char *p_poEnd,
+                                   const unsigned long long p_ullOffset, const unsigned long p_ulLines ) throw()
+{
+    const cTimeStampParser &obTimeStampParser = m_poActionDefList->timeStampParser();
+    QString                 qsTimeStamp;
+
+    // Continuation lines have no time-stamp, so a few lines are tried at the start of the block
+    const char *poLine = p_poBegin;
+    for( int i = 0; i < 16 && poLine < p_poEnd; i++ )
+    {
+        const char          *poLineEnd   = cLineSplitter::findNewLine( poLine, p_poEnd );
+        cAction::tsTimeStamp suTimeStamp = { 0, 0, 0, 0, 0, 0, 0 };
+        if( obTimeStampParser.parse( poLine, poLineEnd - poLine, &qsTimeStamp, &suTimeStamp, m_poTimeStampScratch ) )
+        {
+            p_poCatalog->addPoint( cTimeCatalog::timeKey( suTimeStamp ), p_ullOffset, p_ulLines );
+            break;
+        }
+        poLine = (poLineEnd < p_poEnd) ? poLineEnd + 1 : p_poEnd;
+    }
 
-    for( int i = 1; i < slTimeStampParts.size(); i++ )
+    const char *poLastEnd = (p_poEnd > p_poBegin && p_poEnd[-1] == '\n') ? p_poEnd - 1 : p_poEnd;
+    const char *poLast    = poLastEnd;
+    while( poLast > p_poBegin && poLast[-1] != '\n' ) poLast--;
+
+    cAction::tsTimeStamp suTimeStamp = { 0, 0, 0, 0, 0, 0, 0 };
+    if( obTimeStampParser.parse( poLast, poLastEnd - poLast, &qsTimeStamp, &suTimeStamp, m_poTimeStampScratch ) )
     {
-        switch( m_poActionDefList->timeStampPart( i - 1 ) )
+        p_poCatalog->addTime( cTimeCatalog::timeKey( suTimeStamp ) );
+    }
+}
+
+void cLogAnalyser::restoreCheckpoint() throw()
+{
+    cTracer  obTracer( &g_obLogger, "cLogAnalyser::restoreCheckpoint" );
+
+    const std::vector<cCheckpoint::tsRecord> &veRecords = m_poCheckpoint->records();
+    for( unsigned int i = m_poCheckpoint->resumeRecord(); i < veRecords.size(); i++ )
+    {
+        QDataStream obStream( veRecords[i].baData );
+        switch( veRecords[i].enType )
         {
-            case cTimeStampPart::YEAR:    suFoundPattern.suTimeStamp.uiYear    = slTimeStampParts.at( i ).toUInt(); break;
-            case cTimeStampPart::MONTH:   suFoundPattern.suTimeStamp.uiMonth   = slTimeStampParts.at( i ).toUInt(); break;
-            case cTimeStampPart::DAY:     suFoundPattern.suTimeStamp.uiDay     = slTimeStampParts.at( i ).toUInt(); break;
-            case cTimeStampPart::HOUR:    suFoundPattern.suTimeStamp.uiHour    = slTimeStampParts.at( i ).toUInt(); break;
-            case cTimeStampPart::MINUTE:  suFoundPattern.suTimeStamp.uiMinute  = slTimeStampParts.at( i ).toUInt(); break;
-            case cTimeStampPart::SECOND:  suFoundPattern.suTimeStamp.uiSecond  = slTimeStampParts.at( i ).toUInt(); break;
-            case cTimeStampPart::MSECOND: suFoundPattern.suTimeStamp.uiMSecond = slTimeStampParts.at( i ).toUInt(); break;
-            default: ;
+            case cCheckpoint::FOUND_PATTERN:
+            {
+                QString        qsPattern;
+                tsFoundPattern suFoundPattern;
+                quint32        uiFileId;
+                quint64        ulLineNum;
+                obStream >> qsPattern >> uiFileId >> ulLineNum >> suFoundPattern.qsTimeStamp;
+                cCheckpoint::readTimeStamp( obStream, &suFoundPattern.suTimeStamp );
+                cCheckpoint::readAttributes( obStream, &suFoundPattern.maCapturedAttribs );
+                suFoundPattern.uiFileId  = uiFileId;
+                suFoundPattern.ulLineNum = ulLineNum;
+                m_maFoundPatterns.insert( pair<QString, tsFoundPattern>( qsPattern, suFoundPattern ) );
+                break;
+            }
+            case cCheckpoint::FILE_DONE:
+            {
+                QString qsFileName;
+                obStream >> qsFileName;
+                m_slFilesDone.append( qsFileName );
+                break;
+            }
+            case cCheckpoint::PROGRESS:
+            {
+                quint64 ullOffset, ullLines, ullSize = 0;
+                quint32 uiTime = 0;
+                obStream >> m_qsResumeFile >> ullOffset >> ullLines >> ullSize >> uiTime;
+                m_ullResumeOffset = ullOffset;
+                m_ulResumeLines   = ullLines;
+                m_ullResumeSize   = ullSize;
+                m_uiResumeTime    = uiTime;
+                break;
+            }
+            case cCheckpoint::FILE_RESTART:
+            {
+                quint32 uiFileId;
+                obStream >> uiFileId;
+                dropFoundPatterns( uiFileId );
+                break;
+            }
+            default:
+                // The results stored in the cOutputCreator are restored by it
+                break;
         }
     }
 
+    obTracer << QString( "Restored %1 Found Patterns, %2 Input Log Files searched" )
+                .arg( m_maFoundPatterns.size() ).arg( m_slFilesDone.size() ).toStdString();
+}
+
+void cLogAnalyser::dropFoundPatterns( const unsigned int p_uiFileId ) throw()
+{
+    tmFoundPatternList::iterator itPattern = m_maFoundPatterns.begin();
+    while( itPattern != m_maFoundPatterns.end() )
+    {
+        if( itPattern->second.uiFileId == p_uiFileId ) m_maFoundPatterns.erase( itPattern++ );
+        else itPattern++;
+    }
+}
+
+void cLogAnalyser::saveCheckpoint() throw()
+{
+    try
+    {
+        m_poCheckpoint->commit();
+    }
+    catch( cSevException &e )
+    {
+        g_obLogger << e;
+    }
+}
+
+void cLogAnalyser::storePattern( const unsigned int p_uiFileId, const unsigned long p_ulLineNum,
+                                 cActionDefList::tiPatternList p_itPattern,
+                                 const char *p_poLogLine, const unsigned int p_uiLength,
+                                 const QString &p_qsLogLine,
+                                 const QStringList *p_poTimeStampTexts,
+                                 const QStringList *p_poCapturedTexts ) throw( cSevException )
+{
+    cTracer  obTracer( &g_obLogger, "cLogAnalyser::storePattern", p_itPattern->name().toStdString() );
+
+    tsFoundPattern suFoundPattern;
+
+    const cTimeStampParser &obTimeStampParser = m_poActionDefList->timeStampParser();
+    bool boTimeStamp = p_poTimeStampTexts ?
+                       obTimeStampParser.setParts( *p_poTimeStampTexts, &suFoundPattern.qsTimeStamp, &suFoundPattern.suTimeStamp ) :
+                       obTimeStampParser.parse( p_poLogLine, p_uiLength, &suFoundPattern.qsTimeStamp, &suFoundPattern.suTimeStamp, m_poTimeStampScratch );
+    if( !boTimeStamp )
+        throw cSevException( cSeverity::ERROR,
+                             QString( "TimeStamp Regular Expression does not match on Log Line \"%1\"" ).arg( p_qsLogLine ).toStdString() );
+
+    if( m_boTimeRange )
+    {
+        unsigned long long ullTime = cTimeCatalog::timeKey( suFoundPattern.suTimeStamp );
+        if( ullTime < m_ullFrom || ullTime >= m_ullTo ) return;
+    }
+
     suFoundPattern.uiFileId = p_uiFileId;
-    suFoundPattern.ulLineNum = p_qsLogLine.section( ':', 0, 0 ).toULong();
+    suFoundPattern.ulLineNum = p_ulLineNum;
 
     QStringList  slCaptures = p_itPattern->captures();
     if( slCaptures.size() )
     {
-        QStringList  slCapturedTexts = p_itPattern->capturedTexts( qsLogLine );
+        QStringList  slCapturedTexts = p_poCapturedTexts ? *p_poCapturedTexts : p_itPattern->capturedTexts( p_qsLogLine, m_poPatternScratch );
         for( int i = 0; i < slCaptures.size(); i++ )
         {
             if( i < slCapturedTexts.size() - 1 )
@@ -151,7 +687,17 @@ void cLogAnalyser::storePattern( const unsigned int p_uiFileId, cActionDefList::
         }
     }
 
-    *p_poInsertPos = m_maFoundPatterns.insert( *p_poInsertPos, pair<QString, tsFoundPattern>( p_itPattern->name(), suFoundPattern ) );
+    m_maFoundPatterns.insert( pair<QString, tsFoundPattern>( p_itPattern->name(), suFoundPattern ) );
+
+    if( m_poCheckpoint )
+    {
+        QByteArray  baData;
+        QDataStream obStream( &baData, QIODevice::WriteOnly );
+        obStream << p_itPattern->name() << (quint32)p_uiFileId << (quint64)p_ulLineNum << suFoundPattern.qsTimeStamp;
+        cCheckpoint::writeTimeStamp( obStream, suFoundPattern.suTimeStamp );
+        cCheckpoint::writeAttributes( obStream, suFoundPattern.maCapturedAttribs );
+        m_poCheckpoint->append( cCheckpoint::FOUND_PATTERN, baData );
+    }
 
     if( m_poActionDefList->combilogColor() != "" )
     {
@@ -168,7 +714,7 @@ void cLogAnalyser::storePattern( const unsigned int p_uiFileId, cActionDefList::
         time_t  uiTime  = mktime( &tmTime );
         unsigned long long ulTime = (unsigned long long)uiTime * 1000LL;
         ulTime += suFoundPattern.suTimeStamp.uiMSecond;
-        if( m_poOC ) m_poOC->addCombilogEntry( ulTime, qsLogLine, m_poActionDefList->combilogColor() );
+        if( m_poOC ) m_poOC->addCombilogEntry( ulTime, p_qsLogLine, m_poActionDefList->combilogColor(), p_uiFileId, p_ulLineNum );
     }
 }
 
@@ -286,3 +832,8 @@ unsigned int cLogAnalyser::actionCount() throw()
 {
     return m_mmActionList.size();
 }
+
+unsigned long long cLogAnalyser::linesRead() throw()
+{
+    return m_ullLinesRead;
+}
@@ -2,7 +2,9 @@
 #define LOGANALYSER_H
 
 #include <QString>
+#include <QStringList>
 #include <map>
+#include <vector>
 
 #include <sevexception.h>
 
@@ -10,10 +12,15 @@
 #include "actiondeflist.h"
 #include "action.h"
 #include "outputcreator.h"
+#include "timestampparser.h"
+#include "timecatalog.h"
+
+class cGzipIndex;
 
 //! \brief Performs the full Log Analysis of the given Input Logs
 /*! The full Log Analysis means that this class first prepares all the specified Input Logs
- *  (using cLogDataSource), reads in the Action Definitions (using cActionDefList), then
+ *  (using cLogDataSource, which can prepare the next files while a file is searched),
+ *  reads in the Action Definitions (using cActionDefList), then
  *  after the analysis is complete, it will also genereate the outputs (using
  *  cOutputCreator).
  *
@@ -21,11 +28,15 @@
  *  Analysis, because there can be only one of them). cLogAnalyser objects are created by
  *  cBatchAnalyser, one for each <tt>analysis</tt> defined in the XML configuration file.
  *
- *  First step of the analysis is using the <tt>pcregrep</tt> command to find occurrences of
- *  the defined Patterns (functions findPatterns() and storePattern()). The list of found
+ *  First step of the analysis is reading each Input Log once and testing every defined
+ *  Pattern against each Log Line to find occurrences of the defined Patterns (functions
+ *  findPatterns() and storePattern()). The list of found
  *  Patterns is then used to create a list of Actions (functions
  *  identifySingleLinerActions(), storeActions() and storeAttributes()). The final step is to
  *  calculate the results of the Count Actions (function countActions()).
+ *
+ *  The Found Patterns and the searched Input Log Files are recorded in the checkpoint of
+ *  the analysis, so an interrupted analysis can be resumed (see cCheckpoint).
  */
 class cLogAnalyser
 {
@@ -61,14 +72,19 @@ public:
      *  \param p_qsFiles  Input Files as it appears in the XML configuration file
      *  \param p_qsActions Name of the Action Definition XML file
      *  \param p_poOC Pointer to the cOutputCreator instance
+     *  \param p_poDiscovery Pointer to the cFileDiscovery shared by the cLogAnalyser
+     *         instances of the Batch Analysis, NULL if the Input Files are found by a new one
      */
-    cLogAnalyser( const QString &p_qsPrefix, const QString &p_qsFiles, const QString &p_qsActions, cOutputCreator *p_poOC ) throw();
+    cLogAnalyser( const QString &p_qsPrefix, const QString &p_qsFiles, const QString &p_qsActions, cOutputCreator *p_poOC,
+                  cFileDiscovery *p_poDiscovery = NULL ) throw();
 
     //! \brief Destructor
     ~cLogAnalyser() throw();
 
     //! \brief Main function of the cLogAnalyser class, performs the full log analysis.
-    /*! The full log analysis consists of the following steps:
+    /*! The full log analysis consists of the following steps (a Log Analyser that finished
+     *  before the checkpoint the analysis is resumed from skips all of them, its results are
+     *  restored by the cOutputCreator):
      *  \li Finding and storing the defined Patterns in all the Input Logs (findPatterns()
      *  and storePatterns())
      *  \li Identify Actions using the stored Patterns (identifySingleLinerActions())
@@ -93,6 +109,24 @@ public:
      */
     unsigned int  actionCount()  throw();
 
+    //! \brief Returns with the number of Log Lines read from the Input Log Files.
+    /*! This function is for the Unit Tests, to check that the files outside a time range
+     *  are skipped, and that the search of the others starts in their middle. The Log Lines
+     *  a search skipped by seeking are not counted.
+     */
+    unsigned long long linesRead() throw();
+
+    //! \brief Limits the analysis to the Log Lines in the given time range
+    /*! The Patterns found in Log Lines with a time-stamp outside the range are dropped. The
+     *  Input Log Files are catalogued (see cTimeCatalog) the first time they are searched,
+     *  and later only the part of them that can hold the range is searched. The catalog of
+     *  a prepared copy belongs to the original file, so it stays valid while the original
+     *  file does not change, and the time catalogs are not used in follow mode.
+     *  \param p_ullFrom start of the range as a cTimeCatalog::timeKey(), included
+     *  \param p_ullTo end of the range as a cTimeCatalog::timeKey(), not included
+     */
+    void          setTimeRange( const unsigned long long p_ullFrom, const unsigned long long p_ullTo ) throw();
+
 private:
     //! The Data Source that provides access to all the Input Log Files
     cLogDataSource      *m_poDataSource;
@@ -104,28 +138,202 @@ private:
     tmActionList         m_mmActionList;
     //! Pointer to the cOutputCreator object that is shared between different Log Analysers.
     cOutputCreator      *m_poOC;
+    //! Reused buffer holding the Patterns selected by the prefilter for the current Log Line
+    std::vector<unsigned char>  m_veCandidates;
+    //! Reused buffer holding the Patterns matched by the regular expression set
+    std::vector<unsigned char>  m_veSetMatches;
+    //! The DFA states of the regular expression set built during the analysis
+    cRegExpSetCache     *m_poRegExpSetCache;
+    //! Match state of the Patterns used by this Log Analyser
+    cPatternScratch     *m_poPatternScratch;
+    //! State of parsing the time-stamps of the Found Patterns
+    cTimeStampScratch   *m_poTimeStampScratch;
+    //! Number of Log Lines each Pattern gave up on because of the match budget
+    std::vector<unsigned long>  m_veOverBudget;
+    //! True if the fused Patterns are matched with the time-stamp (see cPattern::matchFused())
+    bool                 m_boFusedMatching;
+    //! True if the original Input Log Files are read in place, always in follow mode
+    bool                 m_boInPlace;
+    //! The checkpoint of the analysis (see cOutputCreator::checkpoint()), NULL if disabled
+    cCheckpoint         *m_poCheckpoint;
+    //! True if this Log Analyser finished before the checkpoint the analysis was resumed from
+    bool                 m_boRestored;
+    //! The Input Log Files searched before the checkpoint the analysis was resumed from
+    QStringList          m_slFilesDone;
+    //! The Input Log File being searched at the checkpoint the analysis was resumed from
+    QString              m_qsResumeFile;
+    //! Offset in m_qsResumeFile the search continues from
+    unsigned long long   m_ullResumeOffset;
+    //! Number of Log Lines in front of m_ullResumeOffset
+    unsigned long        m_ulResumeLines;
+    //! Size of m_qsResumeFile at the checkpoint
+    unsigned long long   m_ullResumeSize;
+    //! Modification time of m_qsResumeFile at the checkpoint
+    unsigned int         m_uiResumeTime;
+    //! True if the analysis is limited to a time range (see setTimeRange())
+    bool                 m_boTimeRange;
+    //! Start of the time range, included
+    unsigned long long   m_ullFrom;
+    //! End of the time range, not included
+    unsigned long long   m_ullTo;
+    //! Number of Log Lines read from the Input Log Files (see linesRead())
+    unsigned long long   m_ullLinesRead;
+
+    //! Where the search of an Input Log File starts and stops, and the indexes used by it
+    typedef struct
+    {
+        //! Offset the search starts at
+        unsigned long long  ullOffset;
+        //! Number of Log Lines in front of ullOffset
+        unsigned long       ulLineNum;
+        //! True if the file is read as a whole in follow mode (compressed files, ZIP entries)
+        bool                boWhole;
+        //! Size of a file read as a whole, stored as its follow position
+        unsigned long long  ullFileSize;
+        //! The random access index of a gzipped file, NULL if none
+        cGzipIndex         *poGzipIndex;
+        //! True if poGzipIndex was loaded, false if it is built while the file is read
+        bool                boGzipIndexed;
+        //! The access point of poGzipIndex inflating starts at, 0 for the beginning
+        unsigned int        uiGzipPoint;
+        //! Name of the file poGzipIndex is stored in
+        QString             qsIndexFile;
+        //! The time catalog of the file, NULL without a time range
+        cTimeCatalog       *poCatalog;
+        //! Name of the file poCatalog is stored in
+        QString             qsCatalogFile;
+        //! Offset the search stops at, when a block reaches it
+        unsigned long long  ullEndOffset;
+        //! True if poCatalog is built while the file is read
+        bool                boCatalogue;
+    } tsSearchRegion;
 
     //! \brief Finds the occurrences of the defined Regular Expressions within the Input Logs
-    /*! This function runs a <tt>pcregrep</tt> command on the given Input Log for ecah
-     *  defined Regular Expression to find matching Log lines. All the matching lines are
-     *  stored as Patterns using the storePattern() function.
+    /*! This function reads the given Input Log in a single pass (using cLineReader), from
+     *  the start found by seekStart(), and searches each block of Log Lines with
+     *  scanRegion(). All the matching lines are stored as Patterns using the storePattern()
+     *  function.
+     *
+     *  If cPreferences::gzipIndexSpan() is set, a gzipped file without an up to date random
+     *  access index is indexed while it is read, and the index is stored (see cGzipIndex).
+     *  With a time range a file without an up to date time catalog is catalogued while it is
+     *  read (see cTimeCatalog). If the file can be read from the middle, the position reached
+     *  is saved with each checkpoint (see recordProgress()). In follow mode (see
+     *  cOutputCreator::followState()) only complete Log Lines are read, and the position
+     *  reached is stored for the next run. If cPreferences::contextLines() is set, a line
+     *  index of a file read in place is built while it is searched and is handed to the
+     *  cOutputCreator (see cLineIndex).
      *  \param p_qsFileName Name of the Input Log File to search for Patterns
      */
     void findPatterns( const QString &p_qsFileName ) throw();
 
+    //! \brief Determines where the search of an Input Log File starts and stops
+    /*! In follow mode the search continues where the previous run stopped, and the line
+     *  numbers continue those of the previous run; a compressed file or ZIP entry is skipped
+     *  while it does not change. A resumed analysis continues the file it was searching at
+     *  the checkpoint, if the file did not change since. With a time range (see
+     *  setTimeRange()) the time catalog of the file decides whether the file is searched at
+     *  all, and where the search starts and stops; the search of an indexed gzipped file
+     *  starts at the last access point in front of the range.
+     *  \param p_qsFileName Name of the Input Log File
+     *  \param p_qsOrigFile Name of the original Input Log File (see
+     *         cLogDataSource::origFileName())
+     *  \param p_uiFileId Id of the Input Log File
+     *  \param p_poRegion receives the start and the end of the search, the indexes it
+     *         holds have to be deleted by the caller
+     *  \return <tt>false</tt> if the file does not have to be searched
+     */
+    bool seekStart( const QString &p_qsFileName, const QString &p_qsOrigFile,
+                    const unsigned int p_uiFileId, tsSearchRegion *p_poRegion ) throw();
+
+    //! \brief Tests the Log Lines of a block against the defined Regular Expressions
+    /*! Each Log Line is tested against the Patterns selected by the literal prefilter (see
+     *  cLiteralFilter and matchLine()). The selected Patterns are matched together with the
+     *  combined automaton (see cRegExpSet), only the Patterns it does not cover are run one
+     *  by one. In fused matching mode (see cPreferences::fusedMatching()) the fused Patterns
+     *  skip the combined automaton: a single evaluation of the fused regular expression
+     *  detects the Pattern and captures its attributes and the time-stamp at the same time.
+     *  If every Pattern has a literal, the lines without a literal hit are only counted (see
+     *  cLineSplitter::countNewLines()) and never split up one by one.
+     *  \param p_uiFileId Id of the Input Log File
+     *  \param p_poBegin the first character of the block
+     *  \param p_poEnd the character following the block
+     *  \param p_poLineNum the number of Log Lines in front of the block, the Log Lines of
+     *         the block are added to it
+     *  \param p_poCandidateLines the number of Log Lines passing the prefilter is added to
+     *         it
+     *  \param p_poRegExpRuns the number of Regular Expressions evaluated is added to it
+     */
+    void scanRegion( const unsigned int p_uiFileId, const char *p_poBegin, const char *p_poEnd,
+                     unsigned long *p_poLineNum, unsigned long *p_poCandidateLines,
+                     unsigned long long *p_poRegExpRuns ) throw();
+
+    //! \brief Writes a checkpoint with the position reached in an Input Log File
+    /*! The size and modification time of the file are recorded too, so a resumed analysis
+     *  only continues the file from the position if it did not change.
+     *  \param p_qsOrigFile Name of the original Input Log File
+     *  \param p_ullOffset offset following the last Log Line searched
+     *  \param p_ulLineNum number of Log Lines in front of p_ullOffset
+     */
+    void recordProgress( const QString &p_qsOrigFile, const unsigned long long p_ullOffset,
+                         const unsigned long p_ulLineNum ) throw();
+
+    //! \brief Adds an index point of a block of Log Lines to the time catalog being built
+    /*! The time-stamp of the first Log Line of the block that has one becomes an index
+     *  point, and the time-stamp of the last Log Line of the block is also recorded.
+     *  \param p_poCatalog the catalog being built
+     *  \param p_poBegin the first character of the block
+     *  \param p_poEnd the character following the block
+     *  \param p_ullOffset offset of the block in the Input Log File
+     *  \param p_ulLines number of Log Lines in front of the block
+     */
+    void catalogueBlock( cTimeCatalog *p_poCatalog, const char *p_poBegin, const char *p_poEnd,
+                         const unsigned long long p_ullOffset, const unsigned long p_ulLines ) throw();
+
+    //! \brief Restores the Found Patterns and the searched files from the checkpoint
+    void restoreCheckpoint() throw();
+
+    //! \brief Writes a checkpoint, a failure is only logged
+    void saveCheckpoint() throw();
+
+    //! \brief Drops the Found Patterns of an Input Log File that is searched again
+    void dropFoundPatterns( const unsigned int p_uiFileId ) throw();
+
+    //! \brief Tests a single Log Line against the Patterns selected by the prefilter
+    /*! A Pattern that runs out of the match budget of the Pattern scratch on the Log Line
+     *  is treated as not matching, and the line is counted in m_veOverBudget.
+     *  \param p_uiFileId Id of the Input Log File the Log Line comes from
+     *  \param p_ulLineNum Line number of the Log Line within the Input Log File
+     *  \param p_poLine pointer to the first character of the Log Line
+     *  \param p_uiLength length of the Log Line without the new line character
+     *  \return The number of Regular Expressions evaluated on the Log Line
+     */
+    unsigned int matchLine( const unsigned int p_uiFileId, const unsigned long p_ulLineNum,
+                            const char *p_poLine, const unsigned int p_uiLength ) throw();
+
     //! \brief Stores a given Log line as a "Found Pattern" to be processed later.
     /*! Storing a Pattern means filling in a tsFoundPattern type struct and store it in the
      *  m_maFoundPatterns container. The time-stamp of the Log Line is extracted using the
-     *  time-stamp regular expression returned by cActionDefList::timeStampRegExp(). If any
-     *  attributes are defined within the Pattern, their value is also captured and stored.
+     *  cTimeStampParser returned by cActionDefList::timeStampParser(). If any attributes
+     *  are defined within the Pattern, their value is also captured and stored.
      *  \param p_uiFileId Id of the Input Log File where the Pattern was found
+     *  \param p_ulLineNum Line number within the Input Log File where the Pattern was found
      *  \param p_itPattern Iterator (pointer) to the cPattern definition
-     *  \param p_qsLogLine The full Log Line as found in the Input Log File
-     *  \param p_poInsertPos Iterator to the position where the new Found Pattern should be
-     *         inserted.
+     *  \param p_poLogLine pointer to the bytes of the Log Line
+     *  \param p_uiLength length of the Log Line in bytes, without the new line character
+     *  \param p_qsLogLine The full Log Line as found in the Input Log File (without the new
+     *         line character)
+     *  \param p_poTimeStampTexts the time-stamp texts captured by cPattern::matchFused(), or
+     *         NULL if the time-stamp has to be parsed from the Log Line
+     *  \param p_poCapturedTexts the texts captured by cPattern::matchFused(), or NULL if the
+     *         Pattern has to be matched again to capture its attributes
      */
-    void storePattern( const unsigned int p_uiFileId, cActionDefList::tiPatternList p_itPattern,
-                       const QString &p_qsLogLine, tmFoundPatternList::iterator  *p_poInsertPos ) throw( cSevException );
+    void storePattern( const unsigned int p_uiFileId, const unsigned long p_ulLineNum,
+                       cActionDefList::tiPatternList p_itPattern,
+                       const char *p_poLogLine, const unsigned int p_uiLength,
+                       const QString &p_qsLogLine,
+                       const QStringList *p_poTimeStampTexts = NULL,
+                       const QStringList *p_poCapturedTexts = NULL ) throw( cSevException );
 
     //! \brief Identifies Singe Liner Actions based on the list of Found Patterns
     /*! This function walks through the whole list of Single Liner Action Definitions
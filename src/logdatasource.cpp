@@ -1,36 +1,136 @@
 #include <QDir>
 #include <QFile>
-#include <QTextStream>
+#include <QFileInfo>
+#include <QCryptographicHash>
 #include <QString>
 #include <QStringList>
-#include <cstdlib>
 
 #include "lara.h"
 #include "logdatasource.h"
-
-cLogDataSource::cLogDataSource( const QString &p_qsInputDir, const QString &p_qsFiles )
-        throw()
+#include "ziparchive.h"
+#include "preparedcache.h"
+#include "streamcodec.h"
+#include "linereader.h"
+#include "syserrordecoder.h"
+
+cLogDataSource::cLogDataSource( const QString &p_qsInputDir, const QString &p_qsFiles,
+                                const bool p_boInPlace, const unsigned int p_uiPrefetch,
+                                cFileDiscovery *p_poDiscovery, const QStringList &p_slFilesDone ) throw()
 {
     cTracer obTracer( &g_obLogger, "cLogDataSource::cLogDataSource",
                       QString( "inputdir: \"%1\", files: \"%2\"" ).arg( p_qsInputDir ).arg( p_qsFiles ).toStdString() );
 
-    parseFileNames( p_qsInputDir, p_qsFiles );
-    prepareFiles();
+    m_poCache          = NULL;
+    m_uiPrefetch       = p_boInPlace ? 0 : p_uiPrefetch;
+    m_poPrefetchThread = NULL;
+    m_inPrepared       = 0;
+    m_inNext           = 0;
+    m_boStopping       = false;
+    m_slFilesDone      = p_slFilesDone;
+
+    if( !p_boInPlace && !g_poPrefs->cacheDir().isEmpty() )
+    {
+        try
+        {
+            m_poCache = new cPreparedCache( g_poPrefs->cacheDir(), g_poPrefs->cacheSize() );
+        }
+        catch( cSevException &e )
+        {
+            g_obLogger << e;
+        }
+    }
+
+    parseFileNames( p_qsInputDir, p_qsFiles, p_poDiscovery );
+    listInputLogs();
+
+    if( m_uiPrefetch )
+    {
+        // Files read in place need no preparation, only the copied files are prefetched
+        tsPrepared  suEmpty = { QString(), false, NULL };
+        m_vePrepared.assign( m_slInputLogs.size(), suEmpty );
+        m_poPrefetchThread = new cPrefetchThread( this );
+        m_poPrefetchThread->start();
+    }
+    else
+    {
+        prepareFiles( p_boInPlace );
+    }
 }
 
 cLogDataSource::~cLogDataSource()
 {
     cTracer  obTracer( &g_obLogger, "cLogDataSource::~cLogDataSource" );
 
+    if( m_poPrefetchThread )
+    {
+        m_obMutex.lock();
+        m_boStopping = true;
+        m_obFileTaken.wakeAll();
+        m_obMutex.unlock();
+
+        m_poPrefetchThread->wait();
+        delete m_poPrefetchThread;
+
+        // Files prepared ahead but never taken
+        for( int i = m_inNext; i < m_inPrepared; i++ )
+        {
+            if( m_vePrepared[i].boTemp ) m_slTempFiles.push_back( m_vePrepared[i].qsLogFile );
+            delete m_vePrepared[i].poError;
+        }
+    }
+
     for( int i = 0; i < m_slTempFiles.size(); i++ )
     {
         QFile::remove( m_slTempFiles.at( i ) );
     }
+
+    for( tmZipArchives::iterator itArchive = m_maZipArchives.begin(); itArchive != m_maZipArchives.end(); itArchive++ )
+    {
+        delete itArchive->second;
+    }
+
+    delete m_poCache;
 }
 
 QStringList cLogDataSource::logFileList() const throw()
 {
-    return m_slTempFiles;
+    return m_slLogFiles;
+}
+
+bool cLogDataSource::nextLogFile( QString *p_poFileName ) throw()
+{
+    if( !m_poPrefetchThread )
+    {
+        if( m_inNext >= m_slLogFiles.size() ) return false;
+
+        *p_poFileName = m_slLogFiles.at( m_inNext++ );
+        return true;
+    }
+
+    // The previous file is no longer read
+    for( int i = 0; i < m_slTempFiles.size(); i++ )
+    {
+        QFile::remove( m_slTempFiles.at( i ) );
+    }
+    m_slTempFiles.clear();
+
+    while( m_inNext < m_slInputLogs.size() )
+    {
+        m_obMutex.lock();
+        while( m_inPrepared <= m_inNext ) m_obFilePrepared.wait( &m_obMutex );
+        tsPrepared  suPrepared = m_vePrepared[m_inNext];
+        int         inIndex    = m_inNext++;
+        m_obFileTaken.wakeAll();
+        m_obMutex.unlock();
+
+        if( takePrepared( inIndex, &suPrepared ) )
+        {
+            *p_poFileName = m_slLogFiles.last();
+            return true;
+        }
+    }
+
+    return false;
 }
 
 QStringList cLogDataSource::origFileList() const throw()
@@ -38,8 +138,24 @@ QStringList cLogDataSource::origFileList() const throw()
     return m_slOrigFiles;
 }
 
-void cLogDataSource::parseFileNames( const QString &p_qsInputDir, const QString &p_qsFiles )
-        throw()
+QString cLogDataSource::origFileName( const QString &p_qsLogFile ) const throw()
+{
+    tmOrigNames::const_iterator itOrigName = m_maOrigNames.find( p_qsLogFile );
+    return itOrigName == m_maOrigNames.end() ? p_qsLogFile : itOrigName->second;
+}
+
+const cZipArchive *cLogDataSource::zipArchive( const QString &p_qsFileName ) const throw()
+{
+    QString qsArchive;
+    QString qsEntry;
+    if( !cZipArchive::splitMemberName( p_qsFileName, &qsArchive, &qsEntry ) ) return NULL;
+
+    tmZipArchives::const_iterator itArchive = m_maZipArchives.find( qsArchive );
+    return itArchive == m_maZipArchives.end() ? NULL : itArchive->second;
+}
+
+void cLogDataSource::parseFileNames( const QString &p_qsInputDir, const QString &p_qsFiles,
+                                     cFileDiscovery *p_poDiscovery ) throw()
 {
     cTracer obTracer( &g_obLogger, "cLogDataSource::parseFileNames",
                       QString( "inputdir: \"%1\", files: \"%2\"" ).arg( p_qsInputDir ).arg( p_qsFiles ).toStdString() );
@@ -53,6 +169,9 @@ void cLogDataSource::parseFileNames( const QString &p_qsInputDir, const QString
     // must be resolved. This will potentially result in multiple real file names for
     // each item in the slFiles list. The result will be a new list that contains one
     // item for each real file (m_slOrigFiles).
+    cFileDiscovery  obDiscovery( g_poPrefs->discoveryThreads() );
+    cFileDiscovery *poDiscovery = p_poDiscovery ? p_poDiscovery : &obDiscovery;
+
     QString      qsInputDir = p_qsInputDir;
     if( (qsInputDir.at( qsInputDir.length() - 1 ) != '/') && (qsInputDir.at( qsInputDir.length() - 1 ) != '\\') )
     {
@@ -62,90 +181,282 @@ void cLogDataSource::parseFileNames( const QString &p_qsInputDir, const QString
     {
         // Each entry in slFilesWithWildCards can contain additional subdirectories, not only
         // file-names. Because of this, first the full path mast be constructed by appending
-        // the file-name to the InputDir, then it has to be split again to two parts: a path
-        // and a file-name. These are then passed to the QDir object to retrieve the list
-        // of files matching the wild-cards specified in the original slFilesWithWildCards item.
-        QString qsPath = qsInputDir + slFilesWithWildCards.at( i );
-        QString qsFileFilter = qsPath.section( QRegExp( "[/\\\\]" ), -1, -1 );
-        qsPath = qsPath.section( QRegExp( "[/\\\\]" ), 0, -2 );
-
-        QDir obDir( qsPath, qsFileFilter );
-        QStringList slEntryList  = obDir.entryList( QDir::Files | QDir::NoSymLinks | QDir::NoDotAndDotDot );
-        for( int j = 0; j < slEntryList.size(); j++ )
-        {
-            m_slOrigFiles.push_back( obDir.absoluteFilePath( slEntryList.at( j ) ) );
+        // the file-name to the InputDir. This is then passed to the cFileDiscovery object to
+        // retrieve the list of files matching the wild-cards specified in the original
+        // slFilesWithWildCards item, in its directories as well as in its file-name.
+        // A '#' separates the filter of the entries read from ZIP archives
+        QString qsEntryFilter = slFilesWithWildCards.at( i ).section( '#', 1 );
+        if( qsEntryFilter.isEmpty() ) qsEntryFilter = "*";
+
+        QString qsPath = qsInputDir + slFilesWithWildCards.at( i ).section( '#', 0, 0 );
+
+        cFileDiscovery::tvFileEntries veEntries = poDiscovery->find( qsPath );
+        for( unsigned int j = 0; j < veEntries.size(); j++ )
+        {
+            // The files searched by an interrupted analysis are not prepared again
+            if( m_slFilesDone.contains( veEntries[j].qsFileName ) ) continue;
+
+            m_slOrigFiles.push_back( veEntries[j].qsFileName );
+            m_slEntryFilters.push_back( qsEntryFilter );
         }
     }
 }
 
-void cLogDataSource::prepareFiles()
-        throw()
+void cLogDataSource::listInputLogs() throw()
 {
-    cTracer  obTracer( &g_obLogger, "cLogDataSource::prepareFiles" );
+    cTracer  obTracer( &g_obLogger, "cLogDataSource::listInputLogs" );
 
     for( int i = 0; i < m_slOrigFiles.size(); i++ )
     {
+        QString qsFileName = m_slOrigFiles.at( i );
+        if( qsFileName.indexOf( ".zip", qsFileName.size() - 4, Qt::CaseInsensitive ) == -1 )
+        {
+            m_slInputLogs.push_back( qsFileName );
+            continue;
+        }
+
+        // Each entry is a separate Input Log, the archive is kept so its central directory
+        // is read only once
         try
         {
-            QString qsFileName = m_slOrigFiles.at( i );
-            if( qsFileName.indexOf( ".zip", qsFileName.size() - 4, Qt::CaseInsensitive ) != -1 )
+            cZipArchive *poArchive = new cZipArchive( qsFileName );
+            delete m_maZipArchives[qsFileName];
+            m_maZipArchives[qsFileName] = poArchive;
+            QStringList  slEntries = poArchive->entryNames( m_slEntryFilters.at( i ) );
+            for( int j = 0; j < slEntries.size(); j++ )
             {
-                m_slTempFiles.push_back( unzipFile( qsFileName ) );
-                continue;
+                QString qsMemberName = cZipArchive::memberName( qsFileName, slEntries.at( j ) );
+                if( m_slFilesDone.contains( qsMemberName ) ) continue;
+                m_slInputLogs.push_back( qsMemberName );
             }
+            obTracer << QString( "%1 entries of %2 match \"%3\"" ).arg( slEntries.size() ).arg( qsFileName ).arg( m_slEntryFilters.at( i ) ).toStdString();
+        }
+        catch( cSevException &e )
+        {
+            g_obLogger << e;
+        }
+    }
+}
 
-            if( qsFileName.indexOf( ".gz", qsFileName.size() - 3, Qt::CaseInsensitive ) != -1 )
-            {
-                m_slTempFiles.push_back( gunzipFile( qsFileName ) );
-                continue;
-            }
+void cLogDataSource::prepareFiles( const bool p_boInPlace )
+        throw()
+{
+    cTracer  obTracer( &g_obLogger, "cLogDataSource::prepareFiles", p_boInPlace ? "in place" : "copy" );
 
-            if( qsFileName.indexOf( "sysError" ) != -1 )
-            {
-                m_slTempFiles.push_back( decodeFile( qsFileName ) );
-                continue;
-            }
+    for( int i = 0; i < m_slInputLogs.size(); i++ )
+    {
+        if( !p_boInPlace )
+        {
+            tsPrepared  suPrepared;
+            prepareFile( i, &suPrepared );
+            takePrepared( i, &suPrepared );
+            continue;
+        }
+
+        // The original file or archive entry is read directly, compressed files and entries
+        // are decompressed and sysError files are decoded by cLineReader while they are
+        // read, nothing to remove afterwards
+        m_slLogFiles.push_back( m_slInputLogs.at( i ) );
+        m_maOrigNames[m_slInputLogs.at( i )] = m_slInputLogs.at( i );
+    }
+}
+
+void cLogDataSource::prepareFile( const int p_inIndex, tsPrepared *p_poPrepared ) throw()
+{
+    p_poPrepared->qsLogFile = "";
+    p_poPrepared->boTemp    = false;
+    p_poPrepared->poError   = NULL;
+
+    QString qsFileName = m_slInputLogs.at( p_inIndex );
+    QString qsArchive;
+    QString qsEntry;
+    bool    boZip      = cZipArchive::splitMemberName( qsFileName, &qsArchive, &qsEntry );
+    const cStreamCodec *poCodec = boZip ? NULL : cCodecRegistry::find( qsFileName );
+    bool    boSysError = !boZip && !poCodec && qsFileName.indexOf( "sysError" ) != -1;
+
+    QString qsPreparedName;
+    QString qsKey;
+    try
+    {
+        // A file prepared by an earlier run is taken from the cache as it is
+        if( m_poCache )
+        {
+            // The entries of an archive are told apart by the method
+            qsKey = boZip ? cPreparedCache::key( qsArchive, "unzip#" + qsEntry )
+                          : cPreparedCache::key( qsFileName, poCodec ? poCodec->name() : boSysError ? "decode" : "copy" );
+            // Storing the files prepared after this one must not remove it from the cache
+            // before it is analysed
+            m_poCache->pin( qsKey );
+            p_poPrepared->qsLogFile = m_poCache->find( qsKey );
+            if( !p_poPrepared->qsLogFile.isEmpty() ) return;
+        }
+
+        if( boZip )           qsPreparedName = unzipEntry( qsFileName );
+        else if( poCodec )    qsPreparedName = decompressFile( qsFileName, poCodec );
+        else if( boSysError ) qsPreparedName = decodeFile( qsFileName );
+        else                  qsPreparedName = copyFile( qsFileName );
+    }
+    catch( cSevException &e )
+    {
+        p_poPrepared->poError = new cSevException( e );
+        return;
+    }
 
-            m_slTempFiles.push_back( copyFile( qsFileName ) );
+    if( m_poCache )
+    {
+        try
+        {
+            p_poPrepared->qsLogFile = m_poCache->store( qsKey, qsPreparedName );
+            return;
         }
         catch( cSevException &e )
         {
-            g_obLogger << e;
+            p_poPrepared->poError = new cSevException( e );
         }
     }
+
+    p_poPrepared->qsLogFile = qsPreparedName;
+    p_poPrepared->boTemp    = true;
+}
+
+bool cLogDataSource::takePrepared( const int p_inIndex, tsPrepared *p_poPrepared ) throw()
+{
+    cTracer  obTracer( &g_obLogger, "cLogDataSource::takePrepared", m_slInputLogs.at( p_inIndex ).toStdString() );
+
+    if( p_poPrepared->poError )
+    {
+        g_obLogger << *p_poPrepared->poError;
+        delete p_poPrepared->poError;
+        p_poPrepared->poError = NULL;
+    }
+
+    if( p_poPrepared->qsLogFile.isEmpty() ) return false;
+
+    obTracer << p_poPrepared->qsLogFile.toStdString();
+
+    m_slLogFiles.push_back( p_poPrepared->qsLogFile );
+    m_maOrigNames[p_poPrepared->qsLogFile] = m_slInputLogs.at( p_inIndex );
+    if( p_poPrepared->boTemp ) m_slTempFiles.push_back( p_poPrepared->qsLogFile );
+
+    return true;
 }
 
-QString cLogDataSource::unzipFile( const QString &p_qsFileName )
+void cLogDataSource::prefetch() throw()
+{
+    for( int i = 0; i < m_slInputLogs.size(); i++ )
+    {
+        m_obMutex.lock();
+        while( !m_boStopping && i - m_inNext >= (int)m_uiPrefetch ) m_obFileTaken.wait( &m_obMutex );
+        bool boStopping = m_boStopping;
+        m_obMutex.unlock();
+
+        if( boStopping ) break;
+
+        tsPrepared  suPrepared;
+        prepareFile( i, &suPrepared );
+
+        m_obMutex.lock();
+        m_vePrepared[i] = suPrepared;
+        m_inPrepared++;
+        m_obFilePrepared.wakeAll();
+        m_obMutex.unlock();
+    }
+}
+
+QString cLogDataSource::unzipEntry( const QString &p_qsMemberName )
         throw( cSevException )
 {
-    cTracer  obTracer( &g_obLogger, "cLogDataSource::unzipFile", p_qsFileName.toStdString() );
+    QString qsTempFileName = tempFileName( p_qsMemberName );
 
-    QString qsTempFileName = copyFile( p_qsFileName );
-    QString qsCommand = QString( "unzip -o -d %1 %2" ).arg( g_poPrefs->tempDir() ).arg( qsTempFileName );
-    if( system( qsCommand.toAscii() ) != 0 ) throw cSevException( cSeverity::ERROR, "Error in unzip command" );
+    QFile   obUnzippedFile( qsTempFileName );
+    if( !obUnzippedFile.open( QIODevice::WriteOnly | QIODevice::Truncate ) )
+    {
+        throw cSevException( cSeverity::ERROR, QString( "%1: %2" ).arg( qsTempFileName ).arg( obUnzippedFile.errorString() ).toStdString() );
+    }
 
-    QFile::remove( qsTempFileName ); // Remove the .zip file since unzip leaves it there
+    QString qsArchive;
+    QString qsEntry;
+    cZipArchive::splitMemberName( p_qsMemberName, &qsArchive, &qsEntry );
 
-    qsTempFileName.chop( 4 );  // Remove the ".zip" from file-name
-    qsTempFileName.append( ".log" );
+    cZipEntryReader *poReader = NULL;
+    try
+    {
+        // The archives are listed before the files are prepared, and not changed afterwards
+        tmZipArchives::const_iterator itArchive = m_maZipArchives.find( qsArchive );
+        if( itArchive != m_maZipArchives.end() ) poReader = new cZipEntryReader( itArchive->second, qsEntry );
+        else                                     poReader = new cZipEntryReader( p_qsMemberName );
+
+        std::vector<char> veBuffer( 1048576 );
+        unsigned int      uiRead = 0;
+        do
+        {
+            uiRead = poReader->read( &veBuffer[0], veBuffer.size() );
+            if( obUnzippedFile.write( &veBuffer[0], uiRead ) != (qint64)uiRead )
+            {
+                throw cSevException( cSeverity::ERROR, QString( "%1: %2" ).arg( qsTempFileName ).arg( obUnzippedFile.errorString() ).toStdString() );
+            }
+        } while( uiRead == veBuffer.size() );
+    }
+    catch( cSevException & )
+    {
+        delete poReader;
+        obUnzippedFile.close();
+        QFile::remove( qsTempFileName );
+        throw;
+    }
 
-    obTracer << qsTempFileName.toStdString();
+    delete poReader;
+    obUnzippedFile.close();
 
     return qsTempFileName;
 }
 
-QString cLogDataSource::gunzipFile( const QString &p_qsFileName )
+QString cLogDataSource::decompressFile( const QString &p_qsFileName, const cStreamCodec *p_poCodec )
         throw( cSevException )
 {
-    cTracer  obTracer( &g_obLogger, "cLogDataSource::gunzipFile", p_qsFileName.toStdString() );
+    QString qsTempFileName = tempFileName( p_qsFileName );
+    if( qsTempFileName.endsWith( p_poCodec->extension(), Qt::CaseInsensitive ) )
+    {
+        qsTempFileName.chop( p_poCodec->extension().size() );
+    }
+
+    QFile   obDecompressedFile( qsTempFileName );
+    if( !obDecompressedFile.open( QIODevice::WriteOnly | QIODevice::Truncate ) )
+    {
+        throw cSevException( cSeverity::ERROR, QString( "%1: %2" ).arg( qsTempFileName ).arg( obDecompressedFile.errorString() ).toStdString() );
+    }
+
+    cStreamReader *poReader = NULL;
+    try
+    {
+        poReader = p_poCodec->open( p_qsFileName );
 
-    QString qsTempFileName = copyFile( p_qsFileName );
-    QString qsCommand = "gzip -d -q -f " + qsTempFileName;
-    if( system( qsCommand.toAscii() ) != 0 ) throw cSevException( cSeverity::ERROR, "Error in gunzip command" );
+        std::vector<char> veBuffer( 1048576 );
+        unsigned int      uiRead = 0;
+        do
+        {
+            uiRead = poReader->read( &veBuffer[0], veBuffer.size() );
+            if( obDecompressedFile.write( &veBuffer[0], uiRead ) != (qint64)uiRead )
+            {
+                throw cSevException( cSeverity::ERROR, QString( "%1: %2" ).arg( qsTempFileName ).arg( obDecompressedFile.errorString() ).toStdString() );
+            }
+        } while( uiRead == veBuffer.size() );
 
-    qsTempFileName.chop( 3 );  // Remove the ".gz" from file-name
+        if( poReader->truncated() )
+        {
+            throw cSevException( cSeverity::ERROR, QString( "Error decompressing %1: unexpected end of file" ).arg( p_qsFileName ).toStdString() );
+        }
+    }
+    catch( cSevException & )
+    {
+        delete poReader;
+        obDecompressedFile.close();
+        QFile::remove( qsTempFileName );
+        throw;
+    }
 
-    obTracer << qsTempFileName.toStdString();
+    delete poReader;
+    obDecompressedFile.close();
 
     return qsTempFileName;
 }
@@ -153,84 +464,76 @@ QString cLogDataSource::gunzipFile( const QString &p_qsFileName )
 QString cLogDataSource::copyFile( const QString &p_qsFileName )
         throw( cSevException )
 {
-    cTracer  obTracer( &g_obLogger, "cLogDataSource::copyFile", p_qsFileName.toStdString() );
+    QString qsTempFileName = tempFileName( p_qsFileName );
+
+    QFile::remove( qsTempFileName );
+    if( !QFile::copy( p_qsFileName, qsTempFileName ) )
+    {
+        throw cSevException( cSeverity::ERROR, "Cannot copy file " + p_qsFileName.toStdString() + " to " + qsTempFileName.toStdString() );
+    }
 
+    return qsTempFileName;
+}
+
+QString cLogDataSource::tempFileName( const QString &p_qsFileName ) throw()
+{
     QString qsTempFileName = g_poPrefs->tempDir();
     if( (qsTempFileName.at( qsTempFileName.length() - 1 ) != '/') &&
         (qsTempFileName.at( qsTempFileName.length() - 1 ) != '\\') )
     {
         qsTempFileName.append( QDir::separator() );
     }
-    qsTempFileName.append( p_qsFileName.section( QRegExp( "[/\\\\]" ), -1, -1 ) );
 
-    QFile::remove( qsTempFileName );
-    if( !QFile::copy( p_qsFileName, qsTempFileName ) )
-    {
-        throw cSevException( cSeverity::ERROR, "Cannot copy file " + p_qsFileName.toStdString() + " to " + qsTempFileName.toStdString() );
-    }
+    // The entries of ZIP archives are named after the entry, without the archive
+    QString qsName = p_qsFileName;
+    QString qsArchive;
+    QString qsEntry;
+    if( cZipArchive::splitMemberName( p_qsFileName, &qsArchive, &qsEntry ) ) qsName = qsEntry;
 
-    obTracer << qsTempFileName.toStdString();
+    // The hash comes first, so the extensions of the file stay at the end of the name
+    QByteArray baHash = QCryptographicHash::hash( QFileInfo( p_qsFileName ).absoluteFilePath().toUtf8(), QCryptographicHash::Md5 ).toHex();
+    qsTempFileName.append( QString( "%1.%2" ).arg( QString( baHash.left( 16 ) ) ).arg( qsName.section( QRegExp( "[/\\\\]" ), -1, -1 ) ) );
 
     return qsTempFileName;
 }
 
 QString cLogDataSource::decodeFile( const QString &p_qsFileName ) throw( cSevException )
 {
-    cTracer  obTracer( &g_obLogger, "cLogDataSource::decodeFile", p_qsFileName.toStdString() );
-
-    QString qsTempFileName = copyFile( p_qsFileName );
-    QString qsDecodedFileName = qsTempFileName + ".decoded";
-
-    QFile   obCodedFile( qsTempFileName );
-    if( !obCodedFile.open( QIODevice::ReadOnly | QIODevice::Text ) )
-    {
-        throw cSevException( cSeverity::ERROR, QString( "%1: %2" ).arg( qsTempFileName ).arg( obCodedFile.errorString() ).toStdString() );
-    }
+    QString qsDecodedFileName = tempFileName( p_qsFileName ) + ".decoded";
 
     QFile   obDecodedFile( qsDecodedFileName );
-    if( !obDecodedFile.open( QIODevice::WriteOnly | QIODevice::Truncate | QIODevice::Text ) )
+    if( !obDecodedFile.open( QIODevice::WriteOnly | QIODevice::Truncate ) )
     {
-        obCodedFile.close();
         throw cSevException( cSeverity::ERROR, QString( "%1: %2" ).arg( qsDecodedFileName ).arg( obDecodedFile.errorString() ).toStdString() );
     }
 
-    QTextStream srCodedStream( &obCodedFile );
-    QTextStream srDecodedStream( &obDecodedFile );
-    bool boFirstLine = true;
-    for( QString qsCodedLine = srCodedStream.readLine();
-         !qsCodedLine.isNull();
-         qsCodedLine = srCodedStream.readLine() )
+    // The file is decoded the same way as a file read in place, so both give the same Log
+    // Lines, the original file is not copied
+    try
     {
-        QStringList slCodedTags = qsCodedLine.split( ',' );
-        bool boFirstTag = true;
-        for( int i = 0; i < slCodedTags.size(); i++ )
+        cLineReader        obReader( p_qsFileName );
+        cSysErrorDecoder   obDecoder;
+        std::vector<char>  veDecoded;
+        const char        *poBegin = NULL;
+        const char        *poEnd   = NULL;
+        while( obReader.readBlock( &poBegin, &poEnd ) )
         {
-            if( boFirstTag ) boFirstTag = false;
-            else srDecodedStream << ",";
-
-            //only need to decode the 5. 9. 10. and 11. tags
-            if( boFirstLine || ( i != 5 && i != 9 && i != 10 && i != 11 ) )
-            {
-                srDecodedStream << slCodedTags.at( i );
-            }
-            else
+            obDecoder.decodeBlock( poBegin, poEnd, &veDecoded );
+            if( !veDecoded.empty() && obDecodedFile.write( &veDecoded[0], veDecoded.size() ) != (qint64)veDecoded.size() )
             {
-                srDecodedStream << decodeString( slCodedTags.at( i ) );
+                throw cSevException( cSeverity::ERROR, QString( "%1: %2" ).arg( qsDecodedFileName ).arg( obDecodedFile.errorString() ).toStdString() );
             }
         }
-        srDecodedStream << "\n";
-        srDecodedStream.flush();
-
-        if( boFirstLine ) boFirstLine = false;
     }
-
-    obCodedFile.close();
-    QFile::remove( qsTempFileName );
+    catch( cSevException & )
+    {
+        obDecodedFile.close();
+        QFile::remove( qsDecodedFileName );
+        throw;
+    }
 
     obDecodedFile.close();
 
-    obTracer << qsTempFileName.toStdString();
-
     return qsDecodedFileName;
 }
 
@@ -250,3 +553,13 @@ QString cLogDataSource::decodeString( const QString &p_qsInput ) throw()
 
     return qsDecodedString;
 }
+
+cPrefetchThread::cPrefetchThread( cLogDataSource *p_poDataSource ) throw()
+{
+    m_poDataSource = p_poDataSource;
+}
+
+void cPrefetchThread::run()
+{
+    m_poDataSource->prefetch();
+}
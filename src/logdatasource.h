@@ -3,9 +3,21 @@
 
 #include <QString>
 #include <QStringList>
+#include <QThread>
+#include <QMutex>
+#include <QWaitCondition>
+#include <vector>
+#include <map>
 
 #include <sevexception.h>
 
+#include "filediscovery.h"
+
+class cPreparedCache;
+class cStreamCodec;
+class cPrefetchThread;
+class cZipArchive;
+
 //! \brief Prepares the Input Log Files for analysis.
 /*! Input Log Files are defined in the various XML configuration files. First the full path
  *  to the log files has to be created. If the file name refers to multiple files (contains
@@ -13,6 +25,29 @@
  *  all the files must be copied to the temporary directory (as defined in the preferences),
  *  possibly compressed or encoded files must also be restored to their original form so the
  *  log analysis can read them.
+ *
+ *  Compressed files are recognized by the codecs of cCodecRegistry (gzip, zstd, xz and
+ *  bzip2), and decompressed while they are copied.
+ *
+ *  Every entry of a ZIP archive is a separate Input Log File (see cZipArchive), and the
+ *  entries can be selected by a filter after a '#' character in the file name, for example
+ *  <tt>day*.zip#server*.log</tt>. Copied entries are inflated one by one into the Temporary
+ *  Directory.
+ *
+ *  Plain text, sysError and compressed files and the entries of ZIP archives do not have to
+ *  be copied if they are read in place: in this mode the original files are passed to the
+ *  log analysis, which memory-maps the plain files, decodes the sysError files and inflates
+ *  or decompresses the others while reading them (see cLineReader), so no temporary file is
+ *  created or removed.
+ *
+ *  If a Cache Directory is set in the preferences, the prepared files are kept in a
+ *  cPreparedCache instead of being removed, and a file prepared by an earlier run is taken
+ *  from the cache without preparing it again.
+ *
+ *  Copied files can also be prepared in the background while the log analysis reads the
+ *  files prepared before them (see nextLogFile()). Only a limited number of files are
+ *  prepared ahead, and each file is removed as soon as the next one is taken, so the
+ *  Temporary Directory never has to hold all the files at the same time.
  */
 class cLogDataSource
 {
@@ -21,9 +56,25 @@ public:
     /*! \param p_qsInputDir path of the Input Directory where the Input Log Files can be
      *                      found
      *  \param p_qsFiles    Input Log File name, that can refer to multiple files (can
-     *                      contain '*' or '?' characters)
+     *                      contain '*' or '?' characters, and <tt>**</tt> directories),
+     *                      optionally followed by a '#' and a filter of the entries of
+     *                      ZIP archives
+     *  \param p_boInPlace  if <tt>true</tt>, plain text, sysError, compressed and zipped
+     *                      files are read from the Input Directory instead of being
+     *                      copied to the Temporary Directory
+     *  \param p_uiPrefetch if not 0, the copied files are prepared by a background thread,
+     *                      at most this many files ahead of nextLogFile(), instead of
+     *                      being prepared by the constructor
+     *  \param p_poDiscovery the file discovery finding the Input Log Files, shared by the
+     *                      data sources of a Batch Analysis, NULL if the data source uses
+     *                      its own
+     *  \param p_slFilesDone the files searched completely by the interrupted analysis that
+     *                      is resumed, as returned by origFileName(), these are not prepared
      */
-    cLogDataSource( const QString &p_qsInputDir, const QString &p_qsFiles ) throw();
+    cLogDataSource( const QString &p_qsInputDir, const QString &p_qsFiles,
+                    const bool p_boInPlace = false, const unsigned int p_uiPrefetch = 0,
+                    cFileDiscovery *p_poDiscovery = NULL,
+                    const QStringList &p_slFilesDone = QStringList() ) throw();
 
     //! \brief Destructor that removes the temporary files created during preparation.
     ~cLogDataSource();
@@ -31,13 +82,25 @@ public:
     //! \brief Returns the list of prepared Input Log Files
     /*! The list of prepared files is created by the prepareFiles() function, and can contain
      *  more than one element if the originally specified file-name contained '*' or '?'
-     *  characters. They all point to files in the Temporary Directory, since they are all
-     *  results of the preparation process. This list will be used by cLogAnalyser, it will
-     *  search for the definied Patterns in these files.
+     *  characters. They point to files in the Temporary Directory, since they are results
+     *  of the preparation process, except the files read in place, which point to the
+     *  original files in the Input Directory. This list will be used by cLogAnalyser, it
+     *  will search for the definied Patterns in these files. If the files are prepared in
+     *  the background, the list only holds the files returned by nextLogFile() so far.
      *  \sa prepareFiles()
      */
     QStringList logFileList() const throw();
 
+    //! \brief Returns the next prepared Input Log File
+    /*! If the files are prepared in the background, this function waits until the next file
+     *  is prepared, and removes the temporary files of the file returned by the previous
+     *  call, so a returned file can only be read until the next call. Files that failed to
+     *  be prepared are skipped.
+     *  \param p_poFileName receives the name of the prepared file
+     *  \return <tt>false</tt> if there are no more files
+     */
+    bool        nextLogFile( QString *p_poFileName ) throw();
+
     //! \brief Returns the list of original Input Log Files
     /*! The list of original files is created by the parseFileNames() function, and can
      *  contain more than one element if the originally specified file-name contained '*' or
@@ -48,6 +111,45 @@ public:
      */
     QStringList origFileList() const throw();
 
+    //! \brief Returns the original Input Log File a prepared file was made from
+    /*! \param p_qsLogFile an Input Log File returned by nextLogFile()
+     *  \return The original file in the Input Directory, the entry name for the entries of
+     *          ZIP archives (see cZipArchive::memberName()), or p_qsLogFile itself if it was
+     *          not returned by this data source
+     */
+    QString     origFileName( const QString &p_qsLogFile ) const throw();
+
+    //! \brief Returns the ZIP archive of an entry read in place
+    /*! The central directory of each archive is read once, when its entries are listed, and
+     *  the archive is kept until the data source is destroyed, so the readers of its entries
+     *  do not have to read the central directory again.
+     *  \param p_qsFileName an Input Log File returned by nextLogFile()
+     *  \return The archive, or NULL if the file is not an entry of a ZIP archive
+     */
+    const cZipArchive *zipArchive( const QString &p_qsFileName ) const throw();
+
+    //! \brief Decodes a single string using a custom decoding algorythm
+    /*! The input string is decoded using a 8-bytes long Key. The algorythm is a simple loop
+     *  that walks over the input string character-by-character and the Key byte-by-byte. It
+     *  performs a bitwise XOR operation between the current character of the input string,
+     *  and the current byte of the Key. The resulting character is the decoded character, it
+     *  is appended to the output string.
+     *
+     *  This is the reference implementation of cSysErrorDecoder::decodeTag(), the kernels of
+     *  the decoder are checked against it.
+     *  \param p_qsInput The input string that needs to be decoded
+     *  \return The decoded string as a QString
+     */
+    static QString decodeString( const QString &p_qsInput ) throw();
+
+    //! \brief Returns the name of the given file in the Temporary Directory
+    /*! Files with the same name in different directories share the Temporary Directory, so
+     *  the name starts with a hash of the full path of the file, for example
+     *  <tt>3f2a9c01d4e5b687.test.log</tt>.
+     *  \param p_qsFileName the original Input Log File
+     */
+    static QString tempFileName( const QString &p_qsFileName ) throw();
+
 private:
     //! \brief Determines list of actual Input Log File names
     /*! Since the input file name can refer to multiple files (if it contains '*' or '?'
@@ -58,43 +160,61 @@ private:
      *  file, this path is then followed by the p_qsInputDir parameter, and finally the
      *  file-name mask received in p_qsFiles may contain additional directories as well.
      *  All these directories are appended after each other to form the full path, then the
-     *  list of matching file names is determined using Qt's QDir class.
+     *  list of matching file names is determined by cFileDiscovery, which also expands the
+     *  wild-cards of the directories and the <tt>**</tt> recursive directories. A filter of
+     *  the entries of ZIP archives following a '#' character is stored in m_slEntryFilters.
+     *  The files in m_slFilesDone are left out.
      *  \param p_qsInputDir path of the Input Directory where the Input Log Files can be
      *                      found
      *  \param p_qsFiles    Input Log File name, that can refer to multiple files (can
      *                      contain '*' or '?' characters)
+     *  \param p_poDiscovery the file discovery finding the files, NULL to use a new one
+     */
+    void    parseFileNames( const QString &p_qsInputDir, const QString &p_qsFiles,
+                            cFileDiscovery *p_poDiscovery ) throw();
+
+    //! \brief Lists the Input Log Files in m_slInputLogs
+    /*! The original files are listed as they are, ZIP archives are replaced by their entries
+     *  matching the filter in m_slEntryFilters. The entries in m_slFilesDone are left out.
      */
-    void    parseFileNames( const QString &p_qsInputDir, const QString &p_qsFiles ) throw();
+    void    listInputLogs() throw();
 
     //! \brief Prepares Input Log Files so they can be read and analysed
     /*! Preparing the Input Log Files means copying them to the Temporary Directory (as
      *  defined in the LARA configuration file) and unpack or decode them as necessary. The
      *  preparation method needed (simple copy, or unpack, decode, etc) is determined from
-     *  the file name. If a file name ends in '.gz' or '.zip' it will be unpacked, if the
-     *  name has 'sysError' in it, it will be decoded, etc. The names of the prepared files
-     *  are pushed to the m_slTempFiles list. The resulting files are simple text files that
-     *  can be processed by the cLogAnalyser, and will be removed by the destructor
-     *  ~cLogDataSource when they're no longer needed.
+     *  the file name. If the file is an entry of a ZIP archive it will be inflated, if the
+     *  file is compressed with one of the codecs of cCodecRegistry it will be decompressed,
+     *  if the name has 'sysError' in it, it will be decoded, etc. The names of the prepared
+     *  files are pushed to the m_slLogFiles list. The resulting files are simple text files
+     *  that can be processed by the cLogAnalyser. The files created in the Temporary
+     *  Directory are also pushed to the m_slTempFiles list, and will be removed by the destructor
+     *  ~cLogDataSource when they're no longer needed. With a Cache Directory set, the
+     *  prepared files are moved into the cache instead, and the files found in the cache
+     *  are not prepared again.
+     *  \param p_boInPlace if <tt>true</tt>, the files of m_slInputLogs are not copied but
+     *                     pushed to the m_slLogFiles list as they are
      */
-    void    prepareFiles() throw();
+    void    prepareFiles( const bool p_boInPlace ) throw();
 
-    //! \brief Unpacks a file using the "unzip" external program
-    /*! This function receives a file name pointing to a file in the Output Directory. The
-     *  file is then copied to the Temporary Directory and unpacked using "unzip". This
-     *  function assumes that the file packed into the original ".zip" file has the same name
-     *  as the packed file, but has a ".log" at the end instead of ".zip".
-     *  \return The name of the unpacked file as a QString.
+    //! \brief Inflates an entry of a ZIP archive into the Temporary Directory
+    /*! The entry is read with a cZipEntryReader of the archive listed by listInputLogs(),
+     *  the archive is not copied. The inflated file is named after the entry.
+     *  \param p_qsMemberName the entry, see cZipArchive::memberName()
+     *  \return The name of the inflated file as a QString.
      */
-    QString unzipFile( const QString &p_qsFileName ) throw( cSevException );
+    QString unzipEntry( const QString &p_qsMemberName ) throw( cSevException );
 
-    //! \brief Unpacks a file using the "gzip" external program
+    //! \brief Decompresses a file into the Temporary Directory
     /*! This function receives a file name pointing to a file in the Output Directory. The
-     *  file is then copied to the Temporary Directory and unpacked using "gzip". This
-     *  function assumes that the file packed into the original ".gz" file has the same name
-     *  as the packed file, but without the ".gz" part.
-     *  \return The name of the unpacked file as a QString.
+     *  file is decompressed with the reader of the given codec straight into the Temporary
+     *  Directory, the compressed file is not copied. The decompressed file has the name of
+     *  the compressed file, without the extension of the codec.
+     *  \param p_qsFileName the compressed file
+     *  \param p_poCodec the codec of the file
+     *  \return The name of the decompressed file as a QString.
      */
-    QString gunzipFile( const QString &p_qsFileName ) throw( cSevException );
+    QString decompressFile( const QString &p_qsFileName, const cStreamCodec *p_poCodec ) throw( cSevException );
 
     //! \brief Simply copies the given file to the Temporary Directory
     /*! This function receives a file name pointing to a file in the Output Directory. The
@@ -108,29 +228,52 @@ private:
      *  separated by commas. In each line the 5th, 9th, 10th and 11th tags are encrypted, so
      *  these tags must be de-crypted, the rest must remain untouched. The first line of the
      *  file is just a header, it contains no encrypted information. This function reads
-     *  the sysError file line-by-line, splits up each line using the ',' character as the
-     *  separator, calls the decodeString() function to perform decoding on the encrypted tags.
-     *  Finally it creates an output file that have all the tags de-coded.
+     *  the sysError file block by block with a cLineReader and decodes the blocks with a
+     *  cSysErrorDecoder, the same way a file read in place is decoded, into an output file
+     *  in the Temporary Directory that has all the tags de-coded.
      *  \return The name of the decoded file as a QString.
-     *  \sa decodeString()
      */
     QString decodeFile( const QString &p_qsFileName ) throw( cSevException );
 
-    //! \brief Decodes a single string using a custom decoding algorythm
-    /*! The input string is decoded using a 8-bytes long Key. The algorythm is a simple loop
-     *  that walks over the input string character-by-character and the Key byte-by-byte. It
-     *  performs a bitwise XOR operation between the current character of the input string,
-     *  and the current byte of the Key. The resulting character is the decoded character, it
-     *  is appended to the output string.
-     *  \param p_qsInput The input string that needs to be decoded
-     *  \return The decoded string as a QString
-     *  \sa decodeFile()
+    //! Structure to hold the result of preparing a single copied Input Log File
+    typedef struct
+    {
+        //! Name of the prepared file, empty if the preparation failed
+        QString         qsLogFile;
+        //! True if the prepared file is a temporary file that has to be removed
+        bool            boTemp;
+        //! The error of the preparation, NULL if there was none
+        cSevException  *poError;
+    } tsPrepared;
+
+    //! \brief Copies a single Input Log File to the Temporary Directory and prepares it
+    /*! This is the part of prepareFiles() that runs on the background thread when the files
+     *  are prepared ahead, so it does not write to the log: the errors are passed back in
+     *  p_poPrepared and logged by takePrepared().
+     *  \param p_inIndex   index of the file in m_slInputLogs
+     *  \param p_poPrepared receives the result
+     */
+    void    prepareFile( const int p_inIndex, tsPrepared *p_poPrepared ) throw();
+
+    //! \brief Logs the result of prepareFile() and appends the prepared file to the lists
+    /*! \return <tt>true</tt> if a file was prepared
      */
-    QString decodeString( const QString &p_qsInput ) throw();
+    bool    takePrepared( const int p_inIndex, tsPrepared *p_poPrepared ) throw();
 
-    //! \brief Holds the names of prepared files located in the Temporary Directory
+    //! \brief Prepares the files one after the other, run by the background thread
+    /*! Waits before each file while m_uiPrefetch files are prepared but not yet taken by
+     *  nextLogFile(), and stops when m_boStopping is set.
+     */
+    void    prefetch() throw();
+
+    //! \brief Holds the names of prepared files the log analysis has to read
     /*! \sa logFileList()
      *  \sa prepareFiles()
+     */
+    QStringList m_slLogFiles;
+
+    //! \brief Holds the names of files created in the Temporary Directory
+    /*! \sa prepareFiles()
      *  \sa ~cLogDataSource()
      */
     QStringList m_slTempFiles;
@@ -140,6 +283,87 @@ private:
      *  \sa prepareFiles()
      */
     QStringList m_slOrigFiles;
+
+    //! \brief Holds the Input Log Files to prepare, the entries of ZIP archives separately
+    /*! \sa listInputLogs()
+     */
+    QStringList m_slInputLogs;
+
+    //! \brief Holds the files that are not prepared, searched by an interrupted analysis
+    /*! \sa parseFileNames()
+     */
+    QStringList m_slFilesDone;
+
+    //! Type of the original Input Log Files, by the names of the prepared files
+    typedef std::map<QString, QString>  tmOrigNames;
+
+    //! \brief Holds the original Input Log File of each prepared file
+    /*! \sa origFileName()
+     */
+    tmOrigNames m_maOrigNames;
+
+    //! \brief Holds the filter of the ZIP archive entries for each original Input Log File
+    /*! \sa parseFileNames()
+     */
+    QStringList m_slEntryFilters;
+
+    //! Type of the ZIP archives, by their names
+    typedef std::map<QString, cZipArchive *>  tmZipArchives;
+
+    //! \brief The ZIP archives whose entries are read
+    /*! \sa zipArchive()
+     */
+    tmZipArchives            m_maZipArchives;
+
+    //! \brief The cache of the prepared files, NULL if there is no Cache Directory
+    cPreparedCache          *m_poCache;
+
+    //! \brief The number of files prepared ahead, 0 if the constructor prepares all files
+    unsigned int             m_uiPrefetch;
+
+    //! \brief The background thread preparing the files, NULL if there is none
+    cPrefetchThread         *m_poPrefetchThread;
+
+    //! \brief The results of the background thread, one for each original Input Log File
+    std::vector<tsPrepared>  m_vePrepared;
+
+    //! \brief Number of original Input Log Files prepared by the background thread
+    int                      m_inPrepared;
+
+    //! \brief Index of the next file returned by nextLogFile()
+    int                      m_inNext;
+
+    //! \brief True when the background thread has to stop
+    bool                     m_boStopping;
+
+    //! \brief Protects m_vePrepared, m_inPrepared, m_inNext and m_boStopping
+    QMutex                   m_obMutex;
+
+    //! \brief Signalled by the background thread when a file is prepared
+    QWaitCondition           m_obFilePrepared;
+
+    //! \brief Signalled by nextLogFile() when a file is taken, and when stopping
+    QWaitCondition           m_obFileTaken;
+
+    friend class cPrefetchThread;
+};
+
+//! \brief Background thread of cLogDataSource preparing the Input Log Files ahead
+class cPrefetchThread : public QThread
+{
+public:
+    //! \brief Constructor
+    /*! \param p_poDataSource the data source whose files are prepared
+     */
+    cPrefetchThread( cLogDataSource *p_poDataSource ) throw();
+
+protected:
+    //! \brief Runs cLogDataSource::prefetch()
+    void run();
+
+private:
+    //! The data source whose files are prepared
+    cLogDataSource  *m_poDataSource;
 };
 
 #endif // LOGDATASOURCE_H
@@ -1,5 +1,6 @@
 #include <QCoreApplication>
 #include <QStringList>
+#include <QThread>
 
 #include <iostream>
 
@@ -16,6 +17,13 @@ cPreferences           *g_poPrefs;
 
 using namespace std;
 
+//! \brief Makes the protected sleep function of QThread usable by the main thread
+class cSleeper : public QThread
+{
+public:
+    static void sleep( unsigned long p_ulSeconds ) { QThread::sleep( p_ulSeconds ); }
+};
+
 class cParamError : public cSevException
 {
 public:
@@ -42,15 +50,59 @@ int main( int argc, char *argv[] )
     int inRet = 0;
     try
     {
-        if( argc == 1 ) throw cParamError();
-
-        cBatchAnalyser  obAnalyser( QString::fromAscii( argv[1] ), "data/lara_batch.xsd" );
-        obAnalyser.analyse();
+        QString      qsBatchDefFile  = "";
+        bool         boFollow        = false;
+        bool         boResume        = false;
+        unsigned int uiPollSeconds   = 0;
+        for( int i = 1; i < argc; i++ )
+        {
+            QString qsArg = QString::fromAscii( argv[i] );
+            if( qsArg == "--follow" )
+            {
+                boFollow = true;
+            }
+            else if( qsArg == "--resume" )
+            {
+                boResume = true;
+            }
+            else if( qsArg == "--poll" )
+            {
+                if( ++i == argc ) throw cParamError();
+                bool boOk = false;
+                uiPollSeconds = QString::fromAscii( argv[i] ).toUInt( &boOk );
+                if( !boOk || !uiPollSeconds ) throw cParamError();
+                boFollow = true;
+            }
+            else if( qsBatchDefFile.isEmpty() && !qsArg.startsWith( "--" ) )
+            {
+                qsBatchDefFile = qsArg;
+            }
+            else
+            {
+                throw cParamError();
+            }
+        }
+        if( qsBatchDefFile.isEmpty() ) throw cParamError();
+
+        cBatchAnalyser  obAnalyser( qsBatchDefFile, "data/lara_batch.xsd" );
+        obAnalyser.analyse( boFollow, boResume );
+
+        // Polling goes on until the process is stopped
+        while( uiPollSeconds )
+        {
+            cSleeper::sleep( uiPollSeconds );
+
+            obAnalyser.analyse( boFollow );
+        }
     }
     catch( cParamError & )
     {
-        cerr << "Usage: lara <batch definition file>" << endl;
+        cerr << "Usage: lara [--follow] [--poll <seconds>] [--resume] <batch definition file>" << endl;
         cerr << "          <batch definition file>: XML file containing the list of logs to analyse." << endl;
+        cerr << "          --follow: only analyse the log lines appended since the previous run," << endl;
+        cerr << "                    and add the results to those of the previous run." << endl;
+        cerr << "          --poll <seconds>: follow the logs, analysing them again every <seconds> seconds." << endl;
+        cerr << "          --resume: continue an interrupted run from its last checkpoint." << endl;
     }
     catch( cSevException &e )
     {
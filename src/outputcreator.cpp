@@ -1,6 +1,7 @@
 #include <QDir>
 #include <QFile>
 #include <QDateTime>
+#include <QDataStream>
 #include <set>
 
 #include "lara.h"
@@ -8,7 +9,7 @@
 
 using namespace std;
 
-cOutputCreator::cOutputCreator( const QString &p_qsDirPrefix )
+cOutputCreator::cOutputCreator( const QString &p_qsDirPrefix, const bool p_boFollow, const bool p_boResume )
 {
     cTracer  obTracer( &g_obLogger, "cOutputCreator::cOutputCreator" );
 
@@ -27,6 +28,44 @@ cOutputCreator::cOutputCreator( const QString &p_qsDirPrefix )
     }
 
     m_qsOutDir = QDir::cleanPath( g_poPrefs->outputDir() + "/" + p_qsDirPrefix );
+
+    m_ulBatchId     = 0;
+    m_poFollowState = NULL;
+    m_poCheckpoint  = NULL;
+    if( p_boFollow )
+    {
+        m_poFollowState = new cFollowState( m_qsOutDir + "/followstate.ini" );
+        if( m_poFollowState->loaded() ) obTracer << "Continuing the results of the previous run";
+
+        m_slInputFiles = m_poFollowState->inputFiles();
+        m_maAttributes = m_poFollowState->attributes();
+        m_ulBatchId    = m_poFollowState->batchId();
+        for( cFollowState::tiCounts itCount = m_poFollowState->counts().begin();
+             itCount != m_poFollowState->counts().end();
+             itCount++ )
+        {
+            addCountAction( itCount->first, itCount->second.first, itCount->second.second );
+        }
+    }
+
+    // The results are restored before the checkpoint is opened, so they are not recorded again
+    if( g_poPrefs->checkpointInterval() )
+    {
+        cCheckpoint *poCheckpoint = new cCheckpoint( m_qsOutDir + "/checkpoint.dat", g_poPrefs->checkpointInterval() );
+        if( p_boResume && poCheckpoint->load() ) restoreCheckpoint( poCheckpoint );
+        try
+        {
+            QDir().mkpath( m_qsOutDir );
+            poCheckpoint->open( p_boResume );
+            m_poCheckpoint = poCheckpoint;
+        }
+        catch( cSevException &e )
+        {
+            g_obLogger << e;
+            g_obLogger << cSeverity::WARNING << "Could not open checkpoint file. Checkpoints are disabled." << cLogMessage::EOM;
+            delete poCheckpoint;
+        }
+    }
 }
 
 cOutputCreator::~cOutputCreator()
@@ -38,7 +77,14 @@ cOutputCreator::~cOutputCreator()
         delete itActionCount->second;
     }
 
+    for( tiLineIndexes itIndex = m_maLineIndexes.begin(); itIndex != m_maLineIndexes.end(); itIndex++ )
+    {
+        delete itIndex->second;
+    }
+
     delete m_poDB;
+    delete m_poFollowState;
+    delete m_poCheckpoint;
 }
 
 unsigned int cOutputCreator::fileId( const QString & p_qsFileName ) throw( cSevException )
@@ -50,6 +96,14 @@ unsigned int cOutputCreator::fileId( const QString & p_qsFileName ) throw( cSevE
     {
         m_slInputFiles.append( p_qsFileName );
         inIndex = m_slInputFiles.size() - 1;
+
+        if( m_poCheckpoint )
+        {
+            QByteArray  baData;
+            QDataStream obStream( &baData, QIODevice::WriteOnly );
+            obStream << p_qsFileName;
+            m_poCheckpoint->append( cCheckpoint::FILE_ID, baData );
+        }
     }
 
     obTracer << inIndex;
@@ -75,6 +129,18 @@ void cOutputCreator::addAction( const cAction *p_poAction ) throw( cSevException
     unsigned long long ulTime = (unsigned long long)uiTime * 1000LL;
     ulTime += suTimeStamp.uiMSecond;
     m_mmActionList.insert( pair<unsigned long long, cAction>( ulTime, *p_poAction ) );
+
+    if( m_poCheckpoint )
+    {
+        QByteArray  baData;
+        QDataStream obStream( &baData, QIODevice::WriteOnly );
+        obStream << p_poAction->name() << p_poAction->timeStamp();
+        cCheckpoint::writeTimeStamp( obStream, suTimeStamp );
+        obStream << (quint32)p_poAction->fileId() << (quint64)p_poAction->lineNum()
+                 << (qint32)p_poAction->result() << (qint32)p_poAction->upload();
+        cCheckpoint::writeAttributes( obStream, tmActionAttribs( p_poAction->attributesBegin(), p_poAction->attributesEnd() ) );
+        m_poCheckpoint->append( cCheckpoint::ACTION, baData );
+    }
 }
 
 void cOutputCreator::addCountAction( const QString &p_qsCountName,
@@ -102,6 +168,14 @@ void cOutputCreator::addCountAction( const QString &p_qsCountName,
     poResCount->ulOk += p_ulOk;
     poResCount->ulFailed += p_ulFailed;
 
+    if( m_poCheckpoint )
+    {
+        QByteArray  baData;
+        QDataStream obStream( &baData, QIODevice::WriteOnly );
+        obStream << p_qsCountName << (quint64)p_ulOk << (quint64)p_ulFailed;
+        m_poCheckpoint->append( cCheckpoint::COUNT_ACTION, baData );
+    }
+
     obTracer << QString( "Total Ok: %1 Total Failed: %2" ).arg( poResCount->ulOk ).arg( poResCount->ulFailed ).toStdString();
 }
 
@@ -111,18 +185,86 @@ void cOutputCreator::addAttribute( const QString &p_qsName, const QString &p_qsV
                        QString( "Name: \"%1\" Value: \"%2\"" ).arg( p_qsName ).arg( p_qsValue ).toStdString() );
 
     m_maAttributes.insert( pair<QString, QString>( p_qsName, p_qsValue ) );
+
+    if( m_poCheckpoint )
+    {
+        QByteArray  baData;
+        QDataStream obStream( &baData, QIODevice::WriteOnly );
+        obStream << p_qsName << p_qsValue;
+        m_poCheckpoint->append( cCheckpoint::ATTRIBUTE, baData );
+    }
 }
 
 void cOutputCreator::addCombilogEntry( const unsigned long long p_ulTime,
                                        const QString &p_qsLogLine,
-                                       const QString &p_qsColor ) throw()
+                                       const QString &p_qsColor,
+                                       const unsigned int p_uiFileId,
+                                       const unsigned long p_ulLineNum ) throw()
 {
     cTracer  obTracer( &g_obLogger, "cOutputCreator::addCombilogEntry", p_qsLogLine.toStdString() );
 
     tsCombilogEntry  suEntry;
     suEntry.qsLogLine = p_qsLogLine;
     suEntry.qsColor = p_qsColor;
+    suEntry.uiFileId = p_uiFileId;
+    suEntry.ulLineNum = p_ulLineNum;
     m_mmCombilogEntries.insert( pair<unsigned long long, tsCombilogEntry>(p_ulTime, suEntry) );
+
+    if( m_poCheckpoint )
+    {
+        QByteArray  baData;
+        QDataStream obStream( &baData, QIODevice::WriteOnly );
+        obStream << (quint64)p_ulTime << p_qsLogLine << p_qsColor << (quint32)p_uiFileId << (quint64)p_ulLineNum;
+        m_poCheckpoint->append( cCheckpoint::COMBILOG_ENTRY, baData );
+    }
+}
+
+void cOutputCreator::restartFile( const unsigned int p_uiFileId ) throw()
+{
+    cTracer  obTracer( &g_obLogger, "cOutputCreator::restartFile", QString::number( p_uiFileId ).toStdString() );
+
+    tmCombilogEntries::iterator itEntry = m_mmCombilogEntries.begin();
+    while( itEntry != m_mmCombilogEntries.end() )
+    {
+        if( itEntry->second.uiFileId == p_uiFileId ) m_mmCombilogEntries.erase( itEntry++ );
+        else itEntry++;
+    }
+
+    if( m_poCheckpoint )
+    {
+        QByteArray  baData;
+        QDataStream obStream( &baData, QIODevice::WriteOnly );
+        obStream << (quint32)p_uiFileId;
+        m_poCheckpoint->append( cCheckpoint::FILE_RESTART, baData );
+    }
+}
+
+void cOutputCreator::addLineIndex( const unsigned int p_uiFileId, cLineIndex *p_poIndex ) throw()
+{
+    cTracer  obTracer( &g_obLogger, "cOutputCreator::addLineIndex", p_poIndex->fileName().toStdString() );
+
+    tmLineIndexes::iterator itIndex = m_maLineIndexes.find( p_uiFileId );
+    if( itIndex != m_maLineIndexes.end() )
+    {
+        delete itIndex->second;
+        itIndex->second = p_poIndex;
+    }
+    else
+    {
+        m_maLineIndexes.insert( pair<unsigned int, cLineIndex*>( p_uiFileId, p_poIndex ) );
+    }
+
+    QString qsIndexDir = m_qsOutDir + "/lineindex";
+    try
+    {
+        QDir().mkpath( qsIndexDir );
+        p_poIndex->save( cLineIndex::indexFileName( p_poIndex->fileName(), qsIndexDir ) );
+        obTracer << QString( "Stored %1 line index points" ).arg( p_poIndex->pointCount() ).toStdString();
+    }
+    catch( cSevException &e )
+    {
+        g_obLogger << e;
+    }
 }
 
 void cOutputCreator::generateActionSummary() const throw( cSevException )
@@ -214,23 +356,30 @@ unsigned long long cOutputCreator::uploadActionSummary() throw( cSevException )
         addAttribute( "examName", "UNKNOWN" );
     }
 
-    QString qsQuery = "SELECT cyclerconfigId FROM cyclerconfigs WHERE cellName =\"";
-    qsQuery += qsCellName;
-    qsQuery += "\" AND startDate=\"";
-    qsQuery += qsStartDate;
-    qsQuery += "\" AND endDate=\"";
-    qsQuery += qsEndDate;
-    qsQuery += "\"";
-    QSqlQuery *poQueryRes = m_poDB->executeQTQuery( qsQuery );
-    if( poQueryRes->first() )
+    // A followed analysis updates the record uploaded by its previous runs
+    bool boUpdate = m_poFollowState && m_ulBatchId;
+
+    QString qsQuery;
+    if( !boUpdate )
     {
-        QString qsError = QString( "Analysis result already exists as cyclerconfigId=%1" ).arg( poQueryRes->value( 0 ).toInt() );
+        qsQuery = "SELECT cyclerconfigId FROM cyclerconfigs WHERE cellName =\"";
+        qsQuery += qsCellName;
+        qsQuery += "\" AND startDate=\"";
+        qsQuery += qsStartDate;
+        qsQuery += "\" AND endDate=\"";
+        qsQuery += qsEndDate;
+        qsQuery += "\"";
+        QSqlQuery *poQueryRes = m_poDB->executeQTQuery( qsQuery );
+        if( poQueryRes->first() )
+        {
+            QString qsError = QString( "Analysis result already exists as cyclerconfigId=%1" ).arg( poQueryRes->value( 0 ).toInt() );
+            delete poQueryRes;
+            throw cSevException( cSeverity::ERROR, qsError.toStdString() );
+        }
         delete poQueryRes;
-        throw cSevException( cSeverity::ERROR, qsError.toStdString() );
     }
-    delete poQueryRes;
 
-    qsQuery = "INSERT INTO cyclerconfigs SET ";
+    qsQuery = boUpdate ? "UPDATE cyclerconfigs SET " : "INSERT INTO cyclerconfigs SET ";
     bool boFieldPresent = false;
     for( itAttrib = m_maAttributes.begin();
          itAttrib != m_maAttributes.end();
@@ -252,9 +401,17 @@ unsigned long long cOutputCreator::uploadActionSummary() throw( cSevException )
         qsQuery += QString( "%1=\"%2\"" ).arg( itAction->first ).arg( itAction->second->ulOk + itAction->second->ulFailed );
     }
 
-    poQueryRes = m_poDB->executeQTQuery( qsQuery );
-    m_ulBatchId = poQueryRes->lastInsertId().toULongLong();
-    delete poQueryRes;
+    if( boUpdate )
+    {
+        qsQuery += QString( " WHERE cyclerconfigId=%1" ).arg( m_ulBatchId );
+        m_poDB->executeQuery( qsQuery );
+    }
+    else
+    {
+        QSqlQuery *poQueryRes = m_poDB->executeQTQuery( qsQuery );
+        m_ulBatchId = poQueryRes->lastInsertId().toULongLong();
+        delete poQueryRes;
+    }
 
     return m_ulBatchId;
 }
@@ -268,23 +425,29 @@ void cOutputCreator::generateActionList() const throw( cSevException )
 
     QString qsFileName = m_qsOutDir + "/actionlist.txt";
     QFile   obActionListFile( qsFileName );
-    if( !obActionListFile.open( QIODevice::WriteOnly | QIODevice::Truncate | QIODevice::Text ) )
+
+    // A followed analysis appends the Actions of this run to those of the previous runs
+    bool boAppend = m_poFollowState && m_poFollowState->loaded() && obActionListFile.exists();
+    if( !obActionListFile.open( QIODevice::WriteOnly | (boAppend ? QIODevice::Append : QIODevice::Truncate) | QIODevice::Text ) )
         throw cSevException( cSeverity::ERROR, QString( "%1: %2" ).arg( qsFileName ).arg( obActionListFile.errorString() ).toStdString() );
 
-    obActionListFile.write( "This is an Action List file generated by " + g_poPrefs->appName().toAscii() );
-    obActionListFile.write( " version " + g_poPrefs->version().toAscii() + "\n" );
+    if( !boAppend )
+    {
+        obActionListFile.write( "This is an Action List file generated by " + g_poPrefs->appName().toAscii() );
+        obActionListFile.write( " version " + g_poPrefs->version().toAscii() + "\n" );
 
-    obActionListFile.write( "Generation time: " );
-    obActionListFile.write( QDateTime::currentDateTime().toString( "dd-MMM-yyyy hh:mm:ss" ).toAscii() + "\n\n" );
+        obActionListFile.write( "Generation time: " );
+        obActionListFile.write( QDateTime::currentDateTime().toString( "dd-MMM-yyyy hh:mm:ss" ).toAscii() + "\n\n" );
 
-    obActionListFile.write( "Input files:\n" );
-    for( int i = 0; i < m_slInputFiles.size(); i++ )
-    {
-        obActionListFile.write( m_slInputFiles.at( i ).toAscii() + "\n" );
-    }
-    obActionListFile.write( "\n" );
+        obActionListFile.write( "Input files:\n" );
+        for( int i = 0; i < m_slInputFiles.size(); i++ )
+        {
+            obActionListFile.write( m_slInputFiles.at( i ).toAscii() + "\n" );
+        }
+        obActionListFile.write( "\n" );
 
-    obActionListFile.write( "Identified Actions:\n" );
+        obActionListFile.write( "Identified Actions:\n" );
+    }
     for( tiActionList itAction = m_mmActionList.begin(); itAction != m_mmActionList.end(); itAction++ )
     {
         obActionListFile.write( itAction->second.timeStamp().toAscii() + " " );
@@ -298,6 +461,15 @@ void cOutputCreator::generateActionList() const throw( cSevException )
         }
         obActionListFile.write( " " + m_slInputFiles.at( itAction->second.fileId() ).toAscii() + ":" );
         obActionListFile.write( QString::number( itAction->second.lineNum() ).toAscii() + "\n" );
+
+        QStringList   slLines;
+        unsigned long ulFirst = contextLines( itAction->second.fileId(), itAction->second.lineNum(), &slLines );
+        for( int i = 0; ulFirst && i < slLines.size(); i++ )
+        {
+            unsigned long ulLine = ulFirst + i;
+            obActionListFile.write( QString( "    %1 %2: %3\n" ).arg( ulLine == itAction->second.lineNum() ? ">" : " " )
+                                    .arg( ulLine ).arg( slLines.at( i ) ).toAscii() );
+        }
     }
 
     obActionListFile.flush();
@@ -347,43 +519,84 @@ void cOutputCreator::generateCombilog() const throw( cSevException )
 
     QString qsFileName = m_qsOutDir + "/combilog.html";
     QFile   obCombilogFile( qsFileName );
-    if( !obCombilogFile.open( QIODevice::WriteOnly | QIODevice::Truncate | QIODevice::Text ) )
+
+    // A followed analysis writes the entries of this run in place of the closing tags of the
+    // Combined Log of the previous runs
+    const QByteArray baClosingTags = "</body></html>";
+    bool boAppend = m_poFollowState && m_poFollowState->loaded() && obCombilogFile.exists();
+    if( boAppend )
+    {
+        if( !obCombilogFile.open( QIODevice::ReadWrite ) )
+            throw cSevException( cSeverity::ERROR, QString( "%1: %2" ).arg( qsFileName ).arg( obCombilogFile.errorString() ).toStdString() );
+
+        qint64 inEnd = obCombilogFile.size() - baClosingTags.size();
+        boAppend = inEnd >= 0 && obCombilogFile.seek( inEnd ) && obCombilogFile.read( baClosingTags.size() ) == baClosingTags &&
+                   obCombilogFile.resize( inEnd ) && obCombilogFile.seek( inEnd );
+        if( !boAppend ) obCombilogFile.close();
+    }
+    if( !boAppend && !obCombilogFile.open( QIODevice::WriteOnly | QIODevice::Truncate | QIODevice::Text ) )
         throw cSevException( cSeverity::ERROR, QString( "%1: %2" ).arg( qsFileName ).arg( obCombilogFile.errorString() ).toStdString() );
 
-    obCombilogFile.write( "<html>\n" );
-    obCombilogFile.write( "<head>\n" );
-    obCombilogFile.write( "<title>LARA Combined Log</title>\n" );
-    obCombilogFile.write( "<style type=\"text/css\">\n" );
-    obCombilogFile.write( ".combilogline\n" );
-    obCombilogFile.write( "{\n" );
-    obCombilogFile.write( "margin:0px;\n" );
-    obCombilogFile.write( "padding:0px;\n" );
-    obCombilogFile.write( "}\n" );
-    obCombilogFile.write( "</style>\n" );
-    obCombilogFile.write( "</head>\n" );
-    obCombilogFile.write( "<body>\n" );
-    obCombilogFile.write( "<div style=\"text-align: center;\"><h3>This is a Combined Log generated by " + g_poPrefs->appName().toAscii() );
-    obCombilogFile.write( " version " + g_poPrefs->version().toAscii() + "</h3></div>\n" );
-    obCombilogFile.write( "<div>\n" );
-    obCombilogFile.write( "Generation time: " );
-    obCombilogFile.write( QDateTime::currentDateTime().toString( "dd-MMM-yyyy hh:mm:ss" ).toAscii() + "<br/><br/>\n" );
-    obCombilogFile.write( "Input files:<br/>\n" );
-    for( int i = 0; i < m_slInputFiles.size(); i++ )
+    if( !boAppend )
     {
-        obCombilogFile.write( m_slInputFiles.at( i ).toAscii() + "<br/>\n" );
+        obCombilogFile.write( "<html>\n" );
+        obCombilogFile.write( "<head>\n" );
+        obCombilogFile.write( "<title>LARA Combined Log</title>\n" );
+        obCombilogFile.write( "<style type=\"text/css\">\n" );
+        obCombilogFile.write( ".combilogline\n" );
+        obCombilogFile.write( "{\n" );
+        obCombilogFile.write( "margin:0px;\n" );
+        obCombilogFile.write( "padding:0px;\n" );
+        obCombilogFile.write( "}\n" );
+        obCombilogFile.write( ".combilogcontext\n" );
+        obCombilogFile.write( "{\n" );
+        obCombilogFile.write( "margin:0px;\n" );
+        obCombilogFile.write( "padding:0px 0px 0px 2em;\n" );
+        obCombilogFile.write( "color:#666666;\n" );
+        obCombilogFile.write( "}\n" );
+        obCombilogFile.write( "</style>\n" );
+        obCombilogFile.write( "</head>\n" );
+        obCombilogFile.write( "<body>\n" );
+        obCombilogFile.write( "<div style=\"text-align: center;\"><h3>This is a Combined Log generated by " + g_poPrefs->appName().toAscii() );
+        obCombilogFile.write( " version " + g_poPrefs->version().toAscii() + "</h3></div>\n" );
+        obCombilogFile.write( "<div>\n" );
+        obCombilogFile.write( "Generation time: " );
+        obCombilogFile.write( QDateTime::currentDateTime().toString( "dd-MMM-yyyy hh:mm:ss" ).toAscii() + "<br/><br/>\n" );
+        obCombilogFile.write( "Input files:<br/>\n" );
+        for( int i = 0; i < m_slInputFiles.size(); i++ )
+        {
+            obCombilogFile.write( m_slInputFiles.at( i ).toAscii() + "<br/>\n" );
+        }
+        obCombilogFile.write( "</div>\n" );
+        obCombilogFile.write( "<br/>\n" );
     }
-    obCombilogFile.write( "</div>\n" );
-    obCombilogFile.write( "<br/>\n" );
 
     for( tiCombilogEntries itEntry = m_mmCombilogEntries.begin();
          itEntry != m_mmCombilogEntries.end();
          itEntry++ )
     {
+        // The context of the entry is split into the lines before and after the entry
+        QStringList   slLines;
+        unsigned long ulFirst  = contextLines( itEntry->second.uiFileId, itEntry->second.ulLineNum, &slLines );
+        int           inBefore = ulFirst ? qMin( (int)(itEntry->second.ulLineNum - ulFirst), slLines.size() ) : 0;
+
+        if( inBefore > 0 )
+        {
+            obCombilogFile.write( "<div><pre class=\"combilogcontext\">" );
+            obCombilogFile.write( QStringList( slLines.mid( 0, inBefore ) ).join( "\n" ).toAscii() );
+            obCombilogFile.write( "</pre></div>\n" );
+        }
         obCombilogFile.write( "<div><pre class=\"combilogline\" style=\"background: " );
         obCombilogFile.write( itEntry->second.qsColor.toAscii() );
         obCombilogFile.write( "\">" );
         obCombilogFile.write( itEntry->second.qsLogLine.toAscii() );
         obCombilogFile.write( "</pre></div>\n" );
+        if( inBefore + 1 < slLines.size() )
+        {
+            obCombilogFile.write( "<div><pre class=\"combilogcontext\">" );
+            obCombilogFile.write( QStringList( slLines.mid( inBefore + 1 ) ).join( "\n" ).toAscii() );
+            obCombilogFile.write( "</pre></div>\n" );
+        }
     }
 
     obCombilogFile.write( "</body>" );
@@ -391,3 +604,182 @@ void cOutputCreator::generateCombilog() const throw( cSevException )
     obCombilogFile.flush();
     obCombilogFile.close();
 }
+
+cFollowState *cOutputCreator::followState() const throw()
+{
+    return m_poFollowState;
+}
+
+void cOutputCreator::saveFollowState() const throw( cSevException )
+{
+    cTracer  obTracer( &g_obLogger, "cOutputCreator::saveFollowState" );
+
+    if( !m_poFollowState ) return;
+
+    cFollowState::tmCounts maCounts;
+    for( tiActionCountList itAction = m_maActionCounts.begin(); itAction != m_maActionCounts.end(); itAction++ )
+    {
+        maCounts[itAction->first] = make_pair( itAction->second->ulOk, itAction->second->ulFailed );
+    }
+
+    m_poFollowState->setInputFiles( m_slInputFiles );
+    m_poFollowState->setAttributes( m_maAttributes );
+    m_poFollowState->setCounts( maCounts );
+    m_poFollowState->setBatchId( m_ulBatchId );
+    m_poFollowState->save();
+}
+
+cCheckpoint *cOutputCreator::checkpoint() const throw()
+{
+    return m_poCheckpoint;
+}
+
+void cOutputCreator::finishCheckpoint() throw( cSevException )
+{
+    if( !m_poCheckpoint ) return;
+
+    m_poCheckpoint->append( cCheckpoint::ANALYSIS_DONE, QByteArray() );
+    m_poCheckpoint->commit();
+}
+
+void cOutputCreator::restoreCheckpoint( const cCheckpoint *p_poCheckpoint ) throw()
+{
+    cTracer  obTracer( &g_obLogger, "cOutputCreator::restoreCheckpoint" );
+
+    const std::vector<cCheckpoint::tsRecord> &veRecords = p_poCheckpoint->records();
+    for( unsigned int i = 0; i < veRecords.size(); i++ )
+    {
+        QDataStream obStream( veRecords[i].baData );
+        switch( veRecords[i].enType )
+        {
+            case cCheckpoint::FILE_ID:
+            {
+                QString qsFileName;
+                obStream >> qsFileName;
+                if( obStream.status() != QDataStream::Ok ) break;
+                if( !m_slInputFiles.contains( qsFileName ) )
+                {
+                    m_slInputFiles.append( qsFileName );
+                    loadLineIndex( m_slInputFiles.size() - 1 );
+                }
+                break;
+            }
+            case cCheckpoint::COMBILOG_ENTRY:
+            {
+                quint64 ulTime;
+                QString qsLogLine, qsColor;
+                quint32 uiFileId;
+                quint64 ulLineNum;
+                obStream >> ulTime >> qsLogLine >> qsColor >> uiFileId >> ulLineNum;
+                if( obStream.status() != QDataStream::Ok ) break;
+                addCombilogEntry( ulTime, qsLogLine, qsColor, uiFileId, ulLineNum );
+                break;
+            }
+            case cCheckpoint::ACTION:
+            {
+                QString              qsName, qsTimeStamp;
+                cAction::tsTimeStamp suTimeStamp;
+                quint32              uiFileId;
+                quint64              ulLineNum;
+                qint32               inResult, inUpload;
+                tmActionAttribs      maAttributes;
+                obStream >> qsName >> qsTimeStamp;
+                cCheckpoint::readTimeStamp( obStream, &suTimeStamp );
+                obStream >> uiFileId >> ulLineNum >> inResult >> inUpload;
+                cCheckpoint::readAttributes( obStream, &maAttributes );
+                if( obStream.status() != QDataStream::Ok ) break;
+
+                cAction obAction( qsName, qsTimeStamp, &suTimeStamp, uiFileId, ulLineNum,
+                                  (cActionResult::teResult)inResult, (cActionUpload::teUpload)inUpload );
+                for( tiActionAttribs itAttrib = maAttributes.begin(); itAttrib != maAttributes.end(); itAttrib++ )
+                {
+                    obAction.addAttribute( itAttrib->first, itAttrib->second );
+                }
+                addAction( &obAction );
+                break;
+            }
+            case cCheckpoint::COUNT_ACTION:
+            {
+                QString qsCountName;
+                quint64 ulOk, ulFailed;
+                obStream >> qsCountName >> ulOk >> ulFailed;
+                if( obStream.status() != QDataStream::Ok ) break;
+                addCountAction( qsCountName, ulOk, ulFailed );
+                break;
+            }
+            case cCheckpoint::ATTRIBUTE:
+            {
+                QString qsName, qsValue;
+                obStream >> qsName >> qsValue;
+                if( obStream.status() != QDataStream::Ok ) break;
+                addAttribute( qsName, qsValue );
+                break;
+            }
+            case cCheckpoint::FILE_RESTART:
+            {
+                quint32 uiFileId;
+                obStream >> uiFileId;
+                if( obStream.status() != QDataStream::Ok ) break;
+                restartFile( uiFileId );
+                break;
+            }
+            default:
+                // The records of the Log Analysers are restored by them
+                break;
+        }
+
+        // A record shorter than its type requires is dropped as a whole
+        if( obStream.status() != QDataStream::Ok )
+        {
+            g_obLogger << cSeverity::WARNING << QString( "Malformed checkpoint record %1 dropped" ).arg( i ).toStdString() << cLogMessage::EOM;
+        }
+    }
+
+    obTracer << QString( "Restored %1 checkpoint records, %2 Log Analysers finished" )
+                .arg( veRecords.size() ).arg( p_poCheckpoint->analysersDone() ).toStdString();
+}
+
+void cOutputCreator::loadLineIndex( const unsigned int p_uiFileId ) throw()
+{
+    if( !g_poPrefs->contextLines() ) return;
+
+    QString     qsFileName = m_slInputFiles.at( p_uiFileId );
+    cLineIndex *poIndex    = new cLineIndex( qsFileName );
+    if( poIndex->load( cLineIndex::indexFileName( qsFileName, m_qsOutDir + "/lineindex" ) ) )
+    {
+        m_maLineIndexes.insert( pair<unsigned int, cLineIndex*>( p_uiFileId, poIndex ) );
+    }
+    else
+    {
+        delete poIndex;
+    }
+}
+
+unsigned long cOutputCreator::contextLines( const unsigned int p_uiFileId,
+                                            const unsigned long p_ulLineNum,
+                                            QStringList *p_poLines ) const throw()
+{
+    p_poLines->clear();
+
+    unsigned long ulContext = g_poPrefs->contextLines();
+    if( !ulContext || !p_ulLineNum ) return 0;
+
+    tiLineIndexes itIndex = m_maLineIndexes.find( p_uiFileId );
+    if( itIndex == m_maLineIndexes.end() ) return 0;
+
+    unsigned long ulFirst = p_ulLineNum > ulContext ? p_ulLineNum - ulContext : 1;
+    try
+    {
+        *p_poLines = itIndex->second->lines( ulFirst, p_ulLineNum + ulContext );
+    }
+    catch( cSevException & )
+    {
+        // The file may have been removed since it was searched, the report is written
+        // without its context
+        cTracer  obTracer( &g_obLogger, "cOutputCreator::contextLines", itIndex->second->fileName().toStdString() );
+        obTracer << "Input Log File cannot be read";
+        return 0;
+    }
+
+    return p_poLines->empty() ? 0 : ulFirst;
+}
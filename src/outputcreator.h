@@ -9,6 +9,9 @@
 
 #include "logdatasource.h"
 #include "action.h"
+#include "followstate.h"
+#include "checkpoint.h"
+#include "lineindex.h"
 
 //! \brief Generates the LARA output (database upload and text file reports)
 /*! There are two different types of LARA outputs, DataBase entries and text file reports in
@@ -20,6 +23,17 @@
  *  generateActionSummary()) and an Action List (see generateActionList()). The results are
  *  also uploaded to database (see uploadActionSummary() and uploadActionList()) using the
  *  database connection details specified in the laratest.ini configuration file.
+ *
+ *  In follow mode (see followState()) the results of a run are added to the results of the
+ *  previous runs of the same analysis instead of replacing them.
+ *
+ *  Every change of the results is also recorded in the checkpoint of the analysis (see
+ *  checkpoint()), so an interrupted analysis can be resumed.
+ *
+ *  If cPreferences::contextLines() is not 0, the Action List and the Combined Log show the
+ *  Log Lines around each Action and entry. They are read from the Input Log Files with the
+ *  line indexes built during the analysis (see addLineIndex()), so only the lines shown
+ *  are read again.
  */
 class cOutputCreator
 {
@@ -28,8 +42,20 @@ public:
     /*! Using the preferences stored in the LARA configuration file, a new MySQL database
      *  connection is created. The full path to the generated output files is also created
      *  using the Output Directory from the same configuration file.
+     *
+     *  In follow mode the results of the previous runs are loaded from the state file
+     *  <tt>followstate.ini</tt> in the output directory, so the Input Log Files, the global
+     *  Attributes and the Count Action results of this run are added to them.
+     *
+     *  If cPreferences::checkpointInterval() is not 0, the checkpoint file
+     *  <tt>checkpoint.dat</tt> is started in the output directory. When resuming, the results
+     *  stored in its last checkpoint are restored first, and the new checkpoints are appended
+     *  to it.
+     *  \param p_qsDirPrefix the output directory relative to the Output Directory
+     *  \param p_boFollow if <tt>true</tt>, the Input Log Files are followed (see cFollowState)
+     *  \param p_boResume if <tt>true</tt>, the analysis is resumed from its last checkpoint
      */
-    cOutputCreator( const QString &p_qsDirPrefix );
+    cOutputCreator( const QString &p_qsDirPrefix, const bool p_boFollow = false, const bool p_boResume = false );
 
     //! \brief Destructor that frees up allocated memory and closes the database connection.
     ~cOutputCreator();
@@ -94,10 +120,32 @@ public:
      *  \param p_ulTime Time-stamp of the log line
      *  \param p_qsLogLine The log line to be entered in the Combined Log
      *  \param p_qsColor Color of the log line in \#XXXXXX format (X is a hexadecimal digit)
+     *  \param p_uiFileId id of the Input Log File of the log line (see fileId())
+     *  \param p_ulLineNum number of the log line in the Input Log File, 0 if it is not known
      */
     void         addCombilogEntry( const unsigned long long p_ulTime,
                                    const QString &p_qsLogLine,
-                                   const QString &p_qsColor )           throw();
+                                   const QString &p_qsColor,
+                                   const unsigned int p_uiFileId = 0,
+                                   const unsigned long p_ulLineNum = 0 ) throw();
+
+    //! \brief Drops the Combined Log entries of an Input Log File searched again from its beginning
+    /*! Used when a resumed analysis finds that the file it was searching changed since the
+     *  checkpoint, so the entries found in the old content are not reported.
+     *  \param p_uiFileId id of the Input Log File (see fileId())
+     */
+    void         restartFile( const unsigned int p_uiFileId )           throw();
+
+    //! \brief Adds the line index of a searched Input Log File
+    /*! The index is used to read the Log Lines around the Actions and the Combined Log
+     *  entries found in the file. It replaces the index of an earlier search of the file, and
+     *  is stored in the <tt>lineindex</tt> directory of the output directory, so a resumed
+     *  analysis can load it again.
+     *  \param p_uiFileId id of the Input Log File (see fileId())
+     *  \param p_poIndex the index, owned by the cOutputCreator from now on
+     */
+    void         addLineIndex( const unsigned int p_uiFileId,
+                               cLineIndex *p_poIndex )                  throw();
 
     //! \brief Generates the Action Summary text file.
     /*! The Action Summary text file contains the list of Input Log files that were processed
@@ -112,6 +160,8 @@ public:
      *  a column name in the <tt>cyclerconfigs</tt> table. The columns <tt>startDate</tt>,
      *  <tt>endDate</tt>, <tt>cellName</tt> and <tt>examName</tt> must have a value, so if
      *  there are no Attributes defined with these names, a default value is used.
+     *  In follow mode the record uploaded by a previous run is updated with the summed
+     *  results instead of inserting a new one.
      *  \return Value of the <tt>cyclerconfigId</tt> column of the new database record
      */
     unsigned long long uploadActionSummary()                            throw( cSevException );
@@ -120,7 +170,9 @@ public:
     /*! The Action List text file contains a detailed list of all the Action that has been
      *  found during analysis. Next to each Action the names and values of their Attributes
      *  are also listed, together with the name of the Input File and line number where they
-     *  were found.
+     *  were found. In follow mode the Actions found by this run are appended to the Action
+     *  List of the previous runs. The Log Lines around the line of each Action follow it,
+     *  indented, if cPreferences::contextLines() is not 0.
      */
     void         generateActionList()                             const throw( cSevException );
 
@@ -136,9 +188,26 @@ public:
      *  Input Log files. Each Pattern that has been found in any of the Input Log files will
      *  be part of the Combined Log using the color defined in their respective XML
      *  configuration file. The Combined Log lines are ordered based on their time-stamp.
+     *  In follow mode the Combined Log only holds the lines found by this run. The Log Lines
+     *  around each line are shown before and after it if cPreferences::contextLines() is not
+     *  0.
      */
     void         generateCombilog()                               const throw( cSevException );
 
+    //! \brief Returns the state of the followed Input Log Files, NULL if not in follow mode
+    cFollowState *followState()                                   const throw();
+
+    //! \brief Saves the results of this and the previous runs for the next run in follow mode
+    void         saveFollowState()                                const throw( cSevException );
+
+    //! \brief Returns the checkpoint of the analysis, NULL if checkpoints are disabled
+    cCheckpoint *checkpoint()                                     const throw();
+
+    //! \brief Writes the last checkpoint, after the outputs were generated
+    /*! An analysis resumed from this checkpoint is not run again.
+     */
+    void         finishCheckpoint()                                     throw( cSevException );
+
 private:
 
     //! Multimap container type to hold all the Actions found during log Analysis
@@ -177,6 +246,10 @@ private:
         QString qsLogLine;
         //! Background color of the Combined Log entry
         QString qsColor;
+        //! Id of the Input Log File of the entry
+        unsigned int  uiFileId;
+        //! Number of the Log Line of the entry, 0 if it is not known
+        unsigned long ulLineNum;
     } tsCombilogEntry;
     //! Multimap container type to hold all Combined Log entries
     typedef std::multimap<unsigned long long, tsCombilogEntry> tmCombilogEntries;
@@ -185,6 +258,13 @@ private:
     //! Multimap container to store all Combined Log entries
     tmCombilogEntries   m_mmCombilogEntries;
 
+    //! Map container type to hold the line indexes of the Input Log Files, by their file ids
+    typedef std::map<unsigned int, cLineIndex*>  tmLineIndexes;
+    //! Const Iterator type for the map container holding the line indexes
+    typedef tmLineIndexes::const_iterator        tiLineIndexes;
+    //! Map container to store the line indexes of the Input Log Files
+    tmLineIndexes       m_maLineIndexes;
+
     //! The Database connection needed to upload results to the MySQL database.
     cQTMySQLConnection *m_poDB;
     //! Name of the Output Directory where the generated text files will be placed
@@ -193,6 +273,27 @@ private:
     QStringList         m_slInputFiles;
     //! Record id of the uploaded Action Summary (in <tt>cyclerconfigs</tt>), needed to upload the Action List (to <tt>occurrences</tt>).
     unsigned long long  m_ulBatchId;
+    //! State of the followed Input Log Files, NULL if not in follow mode
+    cFollowState       *m_poFollowState;
+    //! Checkpoint of the analysis, NULL if checkpoints are disabled
+    cCheckpoint        *m_poCheckpoint;
+
+    //! \brief Restores the results stored in the given checkpoint
+    void         restoreCheckpoint( const cCheckpoint *p_poCheckpoint ) throw();
+
+    //! \brief Loads the stored line index of an Input Log File, if it is up to date
+    void         loadLineIndex( const unsigned int p_uiFileId )         throw();
+
+    //! \brief Reads the Log Lines around a Log Line of an Input Log File
+    /*! \param p_uiFileId id of the Input Log File
+     *  \param p_ulLineNum number of the Log Line
+     *  \param p_poLines receives the Log Lines, including the Log Line itself
+     *  \return Number of the first Log Line received, 0 if the file has no line index or
+     *          cannot be read
+     */
+    unsigned long contextLines( const unsigned int p_uiFileId,
+                                const unsigned long p_ulLineNum,
+                                QStringList *p_poLines )          const throw();
 };
 
 #endif // OUTPUTCREATOR_H
@@ -1,6 +1,52 @@
+#include <cstring>
+
 #include "lara.h"
 #include "pattern.h"
 
+cPatternScratch::cPatternScratch() throw()
+{
+    m_poMatchData  = NULL;
+    m_uiPairs      = 0;
+    m_boOverBudget = false;
+    m_poJitStack   = pcre2_jit_stack_create( 32 * 1024, 1024 * 1024, NULL );
+    m_poContext    = pcre2_match_context_create( NULL );
+    if( m_poContext && m_poJitStack ) pcre2_jit_stack_assign( m_poContext, NULL, m_poJitStack );
+}
+
+cPatternScratch::~cPatternScratch() throw()
+{
+    if( m_poMatchData ) pcre2_match_data_free( m_poMatchData );
+    if( m_poContext )   pcre2_match_context_free( m_poContext );
+    if( m_poJitStack )  pcre2_jit_stack_free( m_poJitStack );
+}
+
+pcre2_match_data *cPatternScratch::matchData( const uint32_t p_uiPairs ) throw()
+{
+    if( p_uiPairs > m_uiPairs )
+    {
+        if( m_poMatchData ) pcre2_match_data_free( m_poMatchData );
+        m_poMatchData = pcre2_match_data_create( p_uiPairs, NULL );
+        m_uiPairs     = m_poMatchData ? p_uiPairs : 0;
+    }
+    return m_poMatchData;
+}
+
+pcre2_match_context *cPatternScratch::context() const throw()
+{
+    return m_poContext;
+}
+
+void cPatternScratch::setMatchBudget( const unsigned int p_uiSteps ) throw()
+{
+    // 10000000 is the default match limit of the PCRE2 library
+    if( m_poContext ) pcre2_set_match_limit( m_poContext, p_uiSteps ? p_uiSteps : 10000000 );
+}
+
+bool cPatternScratch::overBudget() const throw()
+{
+    return m_boOverBudget;
+}
+
 cPattern::cPattern()
 {
     cTracer  obTracer( &g_obLogger, "cPattern::cPattern" );
@@ -8,14 +54,18 @@ cPattern::cPattern()
     init();
 }
 
-cPattern::cPattern( const QDomElement *p_poElem )
+cPattern::cPattern( const QDomElement *p_poElem ) throw( cSevException )
 {
     init();
 
     if( p_poElem )
     {
-        m_qsName = p_poElem->attribute( "name" );
-        m_obRegExp.setPattern( p_poElem->attribute( "regexp" ) );
+        m_qsName    = p_poElem->attribute( "name" );
+        m_qsPattern = p_poElem->attribute( "regexp" );
+        m_qsLiteral = extractLiteral( m_qsPattern );
+        compile( m_qsPattern );
+        classify();
+        m_boBacktrackingProne = m_enEngine == REGEXP && checkBacktracking( m_qsPattern );
 
         for( QDomElement obElem = p_poElem->firstChildElement( "captured_attrib" );
             !obElem.isNull();
@@ -26,8 +76,52 @@ cPattern::cPattern( const QDomElement *p_poElem )
     }
 }
 
+cPattern::cPattern( const cPattern &p_obPattern ) throw()
+{
+    m_qsName         = p_obPattern.m_qsName;
+    m_qsPattern      = p_obPattern.m_qsPattern;
+    m_qsLiteral      = p_obPattern.m_qsLiteral;
+    m_slCaptures     = p_obPattern.m_slCaptures;
+    m_enEngine       = p_obPattern.m_enEngine;
+    m_boBacktrackingProne = p_obPattern.m_boBacktrackingProne;
+    m_obFastLiteral  = p_obPattern.m_obFastLiteral;
+    m_boAnchorStart  = p_obPattern.m_boAnchorStart;
+    m_boAnchorEnd    = p_obPattern.m_boAnchorEnd;
+    m_chCaptureClass = p_obPattern.m_chCaptureClass;
+    m_uiCaptureMin   = p_obPattern.m_uiCaptureMin;
+    m_poCompiled     = p_obPattern.m_poCompiled;
+    m_poFused        = p_obPattern.m_poFused;
+    if( m_poCompiled ) m_poCompiled->obRefCount.ref();
+    if( m_poFused )    m_poFused->obRefCount.ref();
+}
+
 cPattern::~cPattern()
 {
+    release();
+}
+
+cPattern &cPattern::operator=( const cPattern &p_obPattern ) throw()
+{
+    if( this != &p_obPattern )
+    {
+        release();
+        m_qsName         = p_obPattern.m_qsName;
+        m_qsPattern      = p_obPattern.m_qsPattern;
+        m_qsLiteral      = p_obPattern.m_qsLiteral;
+        m_slCaptures     = p_obPattern.m_slCaptures;
+        m_enEngine       = p_obPattern.m_enEngine;
+        m_boBacktrackingProne = p_obPattern.m_boBacktrackingProne;
+        m_obFastLiteral  = p_obPattern.m_obFastLiteral;
+        m_boAnchorStart  = p_obPattern.m_boAnchorStart;
+        m_boAnchorEnd    = p_obPattern.m_boAnchorEnd;
+        m_chCaptureClass = p_obPattern.m_chCaptureClass;
+        m_uiCaptureMin   = p_obPattern.m_uiCaptureMin;
+        m_poCompiled     = p_obPattern.m_poCompiled;
+        m_poFused        = p_obPattern.m_poFused;
+        if( m_poCompiled ) m_poCompiled->obRefCount.ref();
+        if( m_poFused )    m_poFused->obRefCount.ref();
+    }
+    return *this;
 }
 
 QString cPattern::name() const throw()
@@ -37,7 +131,7 @@ QString cPattern::name() const throw()
 
 QString cPattern::pattern() const throw()
 {
-    return m_obRegExp.pattern();
+    return m_qsPattern;
 }
 
 QStringList cPattern::captures() const throw()
@@ -45,14 +139,612 @@ QStringList cPattern::captures() const throw()
     return m_slCaptures;
 }
 
-QStringList cPattern::capturedTexts( const QString &p_qsLogLine ) const throw()
+QString cPattern::literal() const throw()
+{
+    return m_qsLiteral;
+}
+
+cPattern::teEngine cPattern::engine() const throw()
+{
+    return m_enEngine;
+}
+
+bool cPattern::backtrackingProne() const throw()
+{
+    return m_boBacktrackingProne;
+}
+
+const char *cPattern::engineName( const teEngine p_enEngine ) throw()
+{
+    switch( p_enEngine )
+    {
+        case LITERAL: return "literal";       break;
+        case PREFIX:  return "literal prefix"; break;
+        default:      return "regexp";
+    }
+}
+
+bool cPattern::matches( const QString &p_qsLogLine, cPatternScratch *p_poScratch ) const throw()
+{
+    QByteArray obLogLine = p_qsLogLine.toAscii();
+    return matches( obLogLine.constData(), obLogLine.size(), p_poScratch );
+}
+
+bool cPattern::matches( const char *p_poLogLine, const unsigned int p_uiLength,
+                        cPatternScratch *p_poScratch ) const throw()
+{
+    if( p_poScratch ) p_poScratch->m_boOverBudget = false;
+
+    if( m_enEngine != REGEXP )
+    {
+        unsigned int uiStart, uiCaptureStart, uiEnd;
+        return matchFast( p_poLogLine, p_uiLength, &uiStart, &uiCaptureStart, &uiEnd );
+    }
+
+    cPatternScratch *poScratch = p_poScratch ? p_poScratch : new cPatternScratch;
+    bool             boMatched = match( m_poCompiled, p_poLogLine, p_uiLength, poScratch ) != NULL;
+    if( !p_poScratch ) delete poScratch;
+
+    return boMatched;
+}
+
+QStringList cPattern::capturedTexts( const QString &p_qsLogLine, cPatternScratch *p_poScratch ) const throw()
+{
+    QStringList slCapturedTexts;
+
+    uint32_t uiCaptureCount = m_poCompiled ? m_poCompiled->uiCaptureCount : 0;
+
+    // Just like QRegExp, the list has an item for every capture group, even if the regular
+    // expression did not match or some of the groups did not participate in the match.
+    QByteArray        obLogLine   = p_qsLogLine.toAscii();
+    if( m_enEngine != REGEXP )
+    {
+        unsigned int uiStart, uiCaptureStart, uiEnd;
+        bool boMatched = matchFast( obLogLine.constData(), obLogLine.size(), &uiStart, &uiCaptureStart, &uiEnd );
+        slCapturedTexts.push_back( boMatched ? QString::fromAscii( obLogLine.constData() + uiStart, uiEnd - uiStart ) : "" );
+        if( m_enEngine == PREFIX )
+        {
+            slCapturedTexts.push_back( boMatched ? QString::fromAscii( obLogLine.constData() + uiCaptureStart, uiEnd - uiCaptureStart ) : "" );
+        }
+        return slCapturedTexts;
+    }
+
+    cPatternScratch  *poScratch   = p_poScratch ? p_poScratch : new cPatternScratch;
+    pcre2_match_data *poMatchData = match( m_poCompiled, obLogLine.constData(), obLogLine.size(), poScratch );
+    collectTexts( obLogLine.constData(), poMatchData ? pcre2_get_ovector_pointer( poMatchData ) : NULL,
+                  0, uiCaptureCount + 1, &slCapturedTexts );
+    if( !p_poScratch ) delete poScratch;
+
+    return slCapturedTexts;
+}
+
+void cPattern::fuse( const QString &p_qsTimeStampRegExp ) throw()
+{
+    releaseCode( &m_poFused );
+    if( !m_poCompiled || p_qsTimeStampRegExp.isEmpty() ) return;
+    if( !fusable( m_qsPattern ) || !fusable( p_qsTimeStampRegExp ) ) return;
+
+    // The look-ahead groups are atomic, so a failing time-stamp cannot make the Pattern
+    // match differently, and the empty alternative keeps the Pattern match even if the
+    // time-stamp is missing from the Log Line.
+    QString qsFused = "^(?=[\\s\\S]*?(" + m_qsPattern + "))(?:(?=[\\s\\S]*?(" + p_qsTimeStampRegExp + "))|)";
+
+    int        inErrorCode = 0;
+    PCRE2_SIZE uiErrorPos  = 0;
+    m_poFused = compileCode( qsFused, &inErrorCode, &uiErrorPos );
+}
+
+bool cPattern::fused() const throw()
 {
-    m_obRegExp.indexIn( p_qsLogLine );
-    return m_obRegExp.capturedTexts();
+    return m_poFused != NULL;
+}
+
+bool cPattern::matchFused( const char *p_poLogLine, const unsigned int p_uiLength,
+                           QStringList *p_poTimeStampTexts, QStringList *p_poCapturedTexts,
+                           cPatternScratch *p_poScratch ) const throw()
+{
+    p_poTimeStampTexts->clear();
+    p_poCapturedTexts->clear();
+    if( p_poScratch ) p_poScratch->m_boOverBudget = false;
+
+    cPatternScratch  *poScratch   = p_poScratch ? p_poScratch : new cPatternScratch;
+    pcre2_match_data *poMatchData = match( m_poFused, p_poLogLine, p_uiLength, poScratch );
+    if( !poMatchData )
+    {
+        if( !p_poScratch ) delete poScratch;
+        return false;
+    }
+
+    // Group 1 is the whole Pattern match followed by the groups of the Pattern, then comes
+    // the whole time-stamp match followed by the groups of the time-stamp.
+    PCRE2_SIZE *poOVector      = pcre2_get_ovector_pointer( poMatchData );
+    uint32_t    uiPatternCount = m_poCompiled->uiCaptureCount + 1;
+    collectTexts( p_poLogLine, poOVector, 1, uiPatternCount, p_poCapturedTexts );
+    if( poOVector[2 * (uiPatternCount + 1)] != PCRE2_UNSET )
+    {
+        collectTexts( p_poLogLine, poOVector, uiPatternCount + 1,
+                      m_poFused->uiCaptureCount - uiPatternCount, p_poTimeStampTexts );
+    }
+    if( !p_poScratch ) delete poScratch;
+
+    return true;
 }
 
 void cPattern::init() throw()
 {
-    m_qsName = "";
-    m_obRegExp.setPattern( "" );
+    m_qsName     = "";
+    m_qsPattern  = "";
+    m_qsLiteral  = "";
+    m_poCompiled = NULL;
+    m_poFused    = NULL;
+
+    m_enEngine       = REGEXP;
+    m_boBacktrackingProne = false;
+    m_obFastLiteral  = "";
+    m_boAnchorStart  = false;
+    m_boAnchorEnd    = false;
+    m_chCaptureClass = 0;
+    m_uiCaptureMin   = 0;
+}
+
+void cPattern::classify() throw()
+{
+    QByteArray   obRegExp = m_qsPattern.toAscii();
+    unsigned int uiLength = obRegExp.size();
+    unsigned int uiPos    = 0;
+    QByteArray   obLiteral;
+
+    if( uiPos < uiLength && obRegExp.at( uiPos ) == '^' )
+    {
+        m_boAnchorStart = true;
+        uiPos++;
+    }
+
+    // The literal part: plain characters and escaped punctuation, none of them quantified
+    while( uiPos < uiLength )
+    {
+        char chChar = obRegExp.at( uiPos );
+        if( chChar == '\\' )
+        {
+            if( uiPos + 1 >= uiLength ) break;
+            char chNext = obRegExp.at( uiPos + 1 );
+            if( (chNext >= '0' && chNext <= '9') || (chNext >= 'a' && chNext <= 'z') || (chNext >= 'A' && chNext <= 'Z') ) break;
+            obLiteral.append( chNext );
+            uiPos += 2;
+        }
+        else if( strchr( ".^$|?*+()[]{}", chChar ) || !chChar )
+        {
+            break;
+        }
+        else
+        {
+            obLiteral.append( chChar );
+            uiPos++;
+        }
+
+        if( uiPos < uiLength && strchr( "?*+{", obRegExp.at( uiPos ) ) ) break;
+    }
+
+    teEngine enEngine = LITERAL;
+    if( obLiteral.isEmpty() ) enEngine = REGEXP;
+
+    // An optional capture group of a simple class with a greedy quantifier
+    QByteArray obRest = obRegExp.mid( uiPos );
+    if( enEngine != REGEXP && !obRest.isEmpty() && obRest != "$" )
+    {
+        enEngine = REGEXP;
+        const char *poClasses[] = { "(.", "(\\S", "(\\d", "(\\w" };
+        for( unsigned int i = 0; i < 4 && enEngine == REGEXP; i++ )
+        {
+            if( !obRest.startsWith( poClasses[i] ) ) continue;
+            QByteArray obQuantifier = obRest.mid( strlen( poClasses[i] ) );
+            if( obQuantifier == "*)" || obQuantifier == "*)$" || obQuantifier == "+)" || obQuantifier == "+)$" )
+            {
+                enEngine         = PREFIX;
+                m_chCaptureClass = poClasses[i][strlen( poClasses[i] ) - 1];
+                m_uiCaptureMin   = obQuantifier.at( 0 ) == '+' ? 1 : 0;
+            }
+        }
+    }
+
+    if( enEngine == REGEXP )
+    {
+        m_boAnchorStart  = false;
+        m_chCaptureClass = 0;
+        m_uiCaptureMin   = 0;
+        return;
+    }
+
+    m_enEngine      = enEngine;
+    m_obFastLiteral = obLiteral;
+    m_boAnchorEnd   = obRest.endsWith( "$" );
+}
+
+bool cPattern::matchFast( const char *p_poLogLine, const unsigned int p_uiLength,
+                          unsigned int *p_poStart, unsigned int *p_poCaptureStart,
+                          unsigned int *p_poEnd ) const throw()
+{
+    const char   *poLiteral       = m_obFastLiteral.constData();
+    unsigned int  uiLiteralLength = m_obFastLiteral.size();
+
+    // Trying the occurrences of the literal from left to right, the first one the rest of
+    // the Pattern matches after is the leftmost match of the regular expression as well
+    for( unsigned int uiFrom = 0; uiFrom + uiLiteralLength <= p_uiLength; )
+    {
+        const char *poHit = NULL;
+        if( m_boAnchorStart )
+        {
+            if( uiFrom == 0 && memcmp( p_poLogLine, poLiteral, uiLiteralLength ) == 0 ) poHit = p_poLogLine;
+        }
+        else
+        {
+            // memchr() is vectorized by the C library, so it skips most of the line quickly
+            const char *poLast = p_poLogLine + p_uiLength - uiLiteralLength;
+            for( const char *poPos = p_poLogLine + uiFrom; poPos <= poLast; poPos++ )
+            {
+                poPos = (const char *)memchr( poPos, poLiteral[0], poLast - poPos + 1 );
+                if( !poPos ) break;
+                if( memcmp( poPos + 1, poLiteral + 1, uiLiteralLength - 1 ) == 0 )
+                {
+                    poHit = poPos;
+                    break;
+                }
+            }
+        }
+        if( !poHit ) return false;
+
+        unsigned int uiStart = poHit - p_poLogLine;
+        unsigned int uiEnd   = uiStart + uiLiteralLength;
+        if( m_enEngine == PREFIX )
+        {
+            // The capture is bounded by the first character outside of its class
+            for( ; uiEnd < p_uiLength; uiEnd++ )
+            {
+                unsigned char chChar = p_poLogLine[uiEnd];
+                bool boInClass = false;
+                switch( m_chCaptureClass )
+                {
+                    case '.': boInClass = chChar != '\n'; break;
+                    case 'S': boInClass = !strchr( " \t\n\v\f\r", chChar ) || !chChar; break;
+                    case 'd': boInClass = chChar >= '0' && chChar <= '9'; break;
+                    case 'w': boInClass = (chChar >= '0' && chChar <= '9') || (chChar >= 'a' && chChar <= 'z') ||
+                                          (chChar >= 'A' && chChar <= 'Z') || chChar == '_'; break;
+                }
+                if( !boInClass ) break;
+            }
+        }
+
+        if( uiEnd - (uiStart + uiLiteralLength) >= m_uiCaptureMin && (!m_boAnchorEnd || uiEnd == p_uiLength) )
+        {
+            *p_poStart        = uiStart;
+            *p_poCaptureStart = uiStart + uiLiteralLength;
+            *p_poEnd          = uiEnd;
+            return true;
+        }
+
+        if( m_boAnchorStart ) return false;
+        uiFrom = uiStart + 1;
+    }
+
+    return false;
+}
+
+void cPattern::compile( const QString &p_qsRegExp ) throw( cSevException )
+{
+    int         inErrorCode  = 0;
+    PCRE2_SIZE  uiErrorPos   = 0;
+    m_poCompiled = compileCode( p_qsRegExp, &inErrorCode, &uiErrorPos );
+    if( !m_poCompiled )
+    {
+        PCRE2_UCHAR poMessage[256];
+        pcre2_get_error_message( inErrorCode, poMessage, sizeof( poMessage ) );
+        throw cSevException( cSeverity::ERROR,
+                             QString( "Invalid regular expression in Pattern %1 at offset %2: %3" ).arg( m_qsName ).arg( (unsigned long long)uiErrorPos ).arg( (const char *)poMessage ).toStdString() );
+    }
+
+}
+
+cPattern::tsCompiledRegExp *cPattern::compileCode( const QString &p_qsRegExp, int *p_poErrorCode,
+                                                   PCRE2_SIZE *p_poErrorPos ) throw()
+{
+    QByteArray  obRegExp = p_qsRegExp.toAscii();
+    pcre2_code *poCode   = pcre2_compile( (PCRE2_SPTR)obRegExp.constData(), obRegExp.size(), 0,
+                                          p_poErrorCode, p_poErrorPos, NULL );
+    if( !poCode ) return NULL;
+
+    // If the JIT compiler is not available, pcre2_match() falls back to the interpreter
+    pcre2_jit_compile( poCode, PCRE2_JIT_COMPLETE );
+
+    tsCompiledRegExp *poCompiled = new tsCompiledRegExp;
+    poCompiled->poCode     = poCode;
+    poCompiled->obRefCount = 1;
+    pcre2_pattern_info( poCode, PCRE2_INFO_CAPTURECOUNT, &poCompiled->uiCaptureCount );
+
+    return poCompiled;
+}
+
+void cPattern::release() throw()
+{
+    releaseCode( &m_poCompiled );
+    releaseCode( &m_poFused );
+}
+
+void cPattern::releaseCode( tsCompiledRegExp **p_poCompiled ) throw()
+{
+    if( *p_poCompiled && !(*p_poCompiled)->obRefCount.deref() )
+    {
+        pcre2_code_free( (*p_poCompiled)->poCode );
+        delete *p_poCompiled;
+    }
+    *p_poCompiled = NULL;
+}
+
+pcre2_match_data *cPattern::match( const tsCompiledRegExp *p_poCompiled,
+                                   const char *p_poLogLine, const unsigned int p_uiLength,
+                                   cPatternScratch *p_poScratch ) throw()
+{
+    // Patterns not created from an XML element have no regular expression at all
+    if( !p_poCompiled ) return NULL;
+
+    pcre2_match_data *poMatchData = p_poScratch->matchData( p_poCompiled->uiCaptureCount + 1 );
+    if( !poMatchData ) return NULL;
+
+    int inResult = pcre2_match( p_poCompiled->poCode, (PCRE2_SPTR)p_poLogLine, p_uiLength, 0, 0,
+                                poMatchData, p_poScratch->context() );
+    p_poScratch->m_boOverBudget = inResult == PCRE2_ERROR_MATCHLIMIT || inResult == PCRE2_ERROR_DEPTHLIMIT ||
+                                  inResult == PCRE2_ERROR_JIT_STACKLIMIT;
+
+    return inResult >= 0 ? poMatchData : NULL;
+}
+
+void cPattern::collectTexts( const char *p_poLogLine, const PCRE2_SIZE *p_poOVector,
+                             const uint32_t p_uiFirst, const uint32_t p_uiCount,
+                             QStringList *p_poTexts ) throw()
+{
+    for( uint32_t i = p_uiFirst; i < p_uiFirst + p_uiCount; i++ )
+    {
+        if( !p_poOVector || p_poOVector[2 * i] == PCRE2_UNSET )
+        {
+            p_poTexts->push_back( "" );
+            continue;
+        }
+        p_poTexts->push_back( QString::fromAscii( p_poLogLine + p_poOVector[2 * i],
+                                                  p_poOVector[2 * i + 1] - p_poOVector[2 * i] ) );
+    }
+}
+
+bool cPattern::checkBacktracking( const QString &p_qsRegExp ) throw()
+{
+    QByteArray   obRegExp    = p_qsRegExp.toAscii();
+    int          inLength    = obRegExp.size();
+    unsigned int uiWideLoops = 0;
+
+    // One item per open group: true if the group contains an unbounded quantifier
+    std::vector<bool> veGroups( 1, false );
+
+    for( int i = 0; i < inLength; i++ )
+    {
+        char chChar  = obRegExp.at( i );
+        bool boWide  = false;
+        bool boLoopy = false;
+
+        if( chChar == '\\' )
+        {
+            if( ++i >= inLength ) break;
+            boWide = strchr( "SDWHVN", obRegExp.at( i ) ) != NULL;
+        }
+        else if( chChar == '[' )
+        {
+            // Skipping the whole character class, only negated classes are wide
+            i++;
+            boWide = i < inLength && obRegExp.at( i ) == '^';
+            if( boWide ) i++;
+            if( i < inLength && obRegExp.at( i ) == ']' ) i++;
+            for( ; i < inLength && obRegExp.at( i ) != ']'; i++ )
+            {
+                if( obRegExp.at( i ) == '\\' ) i++;
+            }
+        }
+        else if( chChar == '(' )
+        {
+            veGroups.push_back( false );
+            continue;
+        }
+        else if( chChar == ')' )
+        {
+            if( veGroups.size() < 2 ) continue;
+            boLoopy = veGroups.back();
+            veGroups.pop_back();
+        }
+        else if( chChar == '.' )
+        {
+            boWide = true;
+        }
+
+        // Checking the quantifier of the atom, possessive quantifiers never backtrack
+        bool boUnbounded = false;
+        if( i + 1 < inLength )
+        {
+            char chNext = obRegExp.at( i + 1 );
+            if( chNext == '*' || chNext == '+' )
+            {
+                boUnbounded = true;
+                i++;
+            }
+            else if( chNext == '?' )
+            {
+                i++;
+            }
+            else if( chNext == '{' )
+            {
+                int inClose = obRegExp.indexOf( '}', i + 1 );
+                if( inClose > 0 )
+                {
+                    boUnbounded = obRegExp.at( inClose - 1 ) == ',';
+                    i = inClose;
+                }
+            }
+
+            if( i + 1 < inLength && obRegExp.at( i + 1 ) == '+' )
+            {
+                boUnbounded = false;
+                i++;
+            }
+            else if( i + 1 < inLength && obRegExp.at( i + 1 ) == '?' )
+            {
+                i++;
+            }
+        }
+
+        if( boUnbounded && boLoopy ) return true;
+        if( boUnbounded && boWide ) uiWideLoops++;
+        if( boUnbounded || boLoopy ) veGroups.back() = true;
+    }
+
+    return uiWideLoops > 1;
+}
+
+bool cPattern::fusable( const QString &p_qsRegExp ) throw()
+{
+    QByteArray obRegExp = p_qsRegExp.toAscii();
+    int        inLength = obRegExp.size();
+
+    for( int i = 0; i < inLength; i++ )
+    {
+        char chChar = obRegExp.at( i );
+        if( chChar == '\\' && i + 1 < inLength )
+        {
+            // Numbered and named back references, \G and \K depend on the enclosing
+            // expression. Escapes inside character classes are never back references,
+            // but they are rare enough to be treated the same way.
+            char chNext = obRegExp.at( ++i );
+            if( (chNext >= '1' && chNext <= '9') || (chNext && strchr( "gkGK", chNext )) ) return false;
+        }
+        else if( chChar == '(' && i + 2 < inLength && obRegExp.at( i + 1 ) == '?' )
+        {
+            // Recursion, subroutine calls, branch reset groups and named references
+            char chNext = obRegExp.at( i + 2 );
+            if( (chNext >= '0' && chNext <= '9') || (chNext && strchr( "R+-&|", chNext )) ) return false;
+            if( chNext == 'P' && i + 3 < inLength && obRegExp.at( i + 3 ) != '<' ) return false;
+        }
+        else if( chChar == '(' && i + 1 < inLength && obRegExp.at( i + 1 ) == '*' )
+        {
+            // Verbs like (*ACCEPT) or (*COMMIT) act on the whole expression
+            return false;
+        }
+    }
+
+    return true;
+}
+
+QString cPattern::extractLiteral( const QString &p_qsRegExp ) throw()
+{
+    // Inline options (for example case insensitive matching) change the meaning of the
+    // literal characters, so no literal is extracted from such expressions.
+    if( p_qsRegExp.contains( "(?" ) ) return "";
+
+    QString qsLongest = "";
+    QString qsCurrent = "";
+    int     inLength  = p_qsRegExp.length();
+
+    for( int i = 0; i < inLength; i++ )
+    {
+        QChar obChar    = p_qsRegExp.at( i );
+        bool  boLiteral = false;
+
+        if( obChar == '\\' )
+        {
+            if( ++i >= inLength ) return "";
+            obChar = p_qsRegExp.at( i );
+            // Escaped letters and digits are character classes, anchors or back references,
+            // every other escaped character stands for itself.
+            boLiteral = !obChar.isLetterOrNumber();
+        }
+        else if( obChar == '[' )
+        {
+            // Skipping the whole character class, a ']' right after the opening bracket
+            // (or after the negating '^') is part of the class.
+            i++;
+            if( i < inLength && p_qsRegExp.at( i ) == '^' ) i++;
+            if( i < inLength && p_qsRegExp.at( i ) == ']' ) i++;
+            for( ; i < inLength && p_qsRegExp.at( i ) != ']'; i++ )
+            {
+                if( p_qsRegExp.at( i ) == '\\' ) i++;
+            }
+            if( i >= inLength ) return "";
+        }
+        else if( obChar == '(' )
+        {
+            // Groups are skipped as a whole, their content is never used as a literal
+            int inDepth = 1;
+            for( i++; i < inLength && inDepth; i++ )
+            {
+                if( p_qsRegExp.at( i ) == '\\' ) i++;
+                else if( p_qsRegExp.at( i ) == '(' ) inDepth++;
+                else if( p_qsRegExp.at( i ) == ')' ) inDepth--;
+            }
+            if( inDepth ) return "";
+            i--;
+        }
+        else if( obChar == '|' )
+        {
+            return "";
+        }
+        else if( obChar == '*' || obChar == '+' || obChar == '?' || obChar == '{' || obChar == ')' )
+        {
+            return "";
+        }
+        else
+        {
+            boLiteral = obChar != '.' && obChar != '^' && obChar != '$' && obChar.unicode() < 128;
+        }
+
+        // Checking the quantifier of the atom: optional atoms cannot be part of the
+        // literal, and an atom that may repeat ends the literal.
+        bool boOptional = false;
+        bool boRepeated = false;
+        if( i + 1 < inLength )
+        {
+            QChar obNext = p_qsRegExp.at( i + 1 );
+            if( obNext == '*' || obNext == '?' )
+            {
+                boOptional = true;
+                i++;
+            }
+            else if( obNext == '+' )
+            {
+                boRepeated = true;
+                i++;
+            }
+            else if( obNext == '{' )
+            {
+                int inClose = p_qsRegExp.indexOf( '}', i + 1 );
+                if( inClose == -1 ) return "";
+                bool boOk = false;
+                int  inMin = p_qsRegExp.mid( i + 2, inClose - i - 2 ).section( ',', 0, 0 ).toInt( &boOk );
+                if( !boOk ) return "";
+                boOptional = (inMin == 0);
+                boRepeated = !boOptional;
+                i = inClose;
+            }
+            // Lazy or possessive quantifier modifiers
+            if( (boOptional || boRepeated) && i + 1 < inLength &&
+                (p_qsRegExp.at( i + 1 ) == '?' || p_qsRegExp.at( i + 1 ) == '+') )
+            {
+                i++;
+            }
+        }
+
+        if( boLiteral && !boOptional ) qsCurrent.append( obChar );
+
+        if( !boLiteral || boOptional || boRepeated )
+        {
+            if( qsCurrent.length() > qsLongest.length() ) qsLongest = qsCurrent;
+            qsCurrent = "";
+        }
+    }
+
+    if( qsCurrent.length() > qsLongest.length() ) qsLongest = qsCurrent;
+
+    return qsLongest;
 }
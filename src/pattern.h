@@ -3,8 +3,76 @@
 
 #include <QString>
 #include <QStringList>
+#include <QByteArray>
 #include <QDomElement>
-#include <QRegExp>
+#include <QAtomicInt>
+
+#include <sevexception.h>
+
+#ifndef PCRE2_CODE_UNIT_WIDTH
+#define PCRE2_CODE_UNIT_WIDTH 8
+#endif
+#include <pcre2.h>
+
+//! \brief Mutable state needed to run the compiled regular expressions of the Patterns
+/*! The compiled Patterns never change after the Action Definitions are loaded, everything a
+ *  match writes to (the match data, the match context and the JIT stack) lives in a
+ *  cPatternScratch instead. Each thread matching Log Lines owns one cPatternScratch and
+ *  passes it to the cPattern functions, so any number of threads can share the same
+ *  Patterns without locks. A cPatternScratch can be used with any Pattern, but only by one
+ *  thread at a time.
+ *
+ *  The scratch also holds the match budget: the maximum number of internal steps a
+ *  single regular expression may take on a single Log Line (see setMatchBudget()). A
+ *  Pattern prone to catastrophic backtracking gives up on the line when the budget runs
+ *  out instead of stalling the analysis, and overBudget() tells the caller that the
+ *  Pattern did not match because of the budget.
+ */
+class cPatternScratch
+{
+public:
+    //! \brief Constructor, allocates the match context and the JIT stack
+    cPatternScratch() throw();
+
+    //! \brief Destructor, frees the PCRE2 resources
+    ~cPatternScratch() throw();
+
+    //! \brief Returns match data with room for at least the given number of captured substrings
+    /*! \param p_uiPairs number of (start, end) pairs needed
+     *  \return The match data, or NULL if it cannot be allocated
+     */
+    pcre2_match_data    *matchData( const uint32_t p_uiPairs ) throw();
+
+    //! \brief Returns the match context using the JIT stack of the scratch
+    pcre2_match_context *context() const throw();
+
+    //! \brief Sets the match budget of the scratch
+    /*! \param p_uiSteps maximum number of steps (PCRE2 match limit) of a single match,
+     *         0 restores the default limit of the PCRE2 library
+     */
+    void                 setMatchBudget( const unsigned int p_uiSteps ) throw();
+
+    //! \brief Returns <tt>true</tt> if the last match ran out of the match budget
+    bool                 overBudget() const throw();
+
+private:
+    //! The match data, grown on demand
+    pcre2_match_data    *m_poMatchData;
+    //! Number of pairs m_poMatchData has room for
+    uint32_t             m_uiPairs;
+    //! The match context, NULL if it could not be allocated
+    pcre2_match_context *m_poContext;
+    //! The JIT stack assigned to the match context
+    pcre2_jit_stack     *m_poJitStack;
+    //! True if the last match ran out of the match budget
+    bool                 m_boOverBudget;
+
+    //! The scratch is never copied, each copy would free the same resources
+    cPatternScratch( const cPatternScratch & );
+    cPatternScratch &operator=( const cPatternScratch & );
+
+    friend class cPattern;
+};
 
 //! \brief Represents a Pattern (regular expression) used to identify actions in the input log file.
 /*! cPattern is basically a regular expression that can match input log lines. It uses
@@ -12,10 +80,32 @@
  *  regular expression syntax, and can capture parts of the matched text as well.
  *  Every Pattern has a unique Name, so Action Definitions (cActionDef) can refer to what
  *  pattern(s) they consist of.
+ *
+ *  The regular expression is compiled with the PCRE2 library (including JIT compilation if
+ *  the platform supports it) once, when the Pattern is created from the XML configuration.
+ *  Copies of a cPattern share the same compiled code.
+ *
+ *  After the Action Definitions are loaded a cPattern is immutable: the functions used
+ *  during Log Analysis are <tt>const</tt> and write only to the cPatternScratch passed to
+ *  them. A single set of Patterns can therefore be shared by several scanner threads, each
+ *  with its own cPatternScratch, without locks and without copying the Patterns. If no
+ *  scratch is passed, a temporary one is created for the call, which is correct but slow.
+ *
+ *  When the Pattern is created its regular expression is also classified (see engine()).
+ *  Plain literals and a literal followed by a single simple capture group do not need a
+ *  regular expression engine at all, they are matched with a substring search instead.
  */
 class cPattern
 {
 public:
+    //! The ways a Pattern can be matched, from the cheapest to the most expensive
+    enum teEngine
+    {
+        LITERAL,    //!< plain literal, optionally anchored: substring search
+        PREFIX,     //!< literal followed by one capture of a simple character class
+        REGEXP      //!< everything else: the compiled regular expression
+    };
+
     //! \brief The default (empty) constructor.
     /*! It only calls the init() function to initialise the member variables with default
      *  values.
@@ -28,13 +118,20 @@ public:
      *  lara_actions.xsd XML Schema.
      *  \sa cPattern()
      */
-    cPattern( const QDomElement *p_poElem );
+    cPattern( const QDomElement *p_poElem ) throw( cSevException );
+
+    //! \brief Copy constructor, the copy shares the compiled regular expression
+    cPattern( const cPattern &p_obPattern ) throw();
 
     //! \brief Destructor
-    /*! An empty destructor.
+    /*! Releases the compiled regular expression when the last copy of the Pattern is
+     *  destroyed.
      */
     ~cPattern();
 
+    //! \brief Assignment operator, the target shares the compiled regular expression
+    cPattern    &operator=( const cPattern &p_obPattern ) throw();
+
     //! \brief Returns with the <tt>name</tt> attribute of the Pattern.
     /*! The <tt>name</tt> attribute is a unique identifier. It is used by the different
      *  Action classes to specify which Pattern(s) define the given Action. This way the
@@ -63,6 +160,68 @@ public:
      */
     QStringList  captures() const throw();
 
+    //! \brief Returns a literal text that must be present in every Log Line the Pattern matches.
+    /*! The literal is extracted from the regular expression when the Pattern is created. It
+     *  is the longest run of plain characters that is mandatory in every match, for example
+     *  <tt>"Spotted a "</tt> for the regular expression <tt>"Spotted a (.*)$"</tt>. If no
+     *  such literal can be determined safely (for example the regular expression has an
+     *  alternation on its top level) an empty string is returned.
+     *  \sa cLiteralFilter
+     *  \return The required literal as a QString, or an empty string.
+     */
+    QString      literal() const throw();
+
+    //! \brief Returns the engine the Pattern is matched with
+    /*! The engine is chosen when the Pattern is created:
+     *  \li LITERAL if the regular expression has no metacharacters apart from the optional
+     *      <tt>^</tt> and <tt>$</tt> anchors, for example <tt>"Holy Hand Grenade"</tt>
+     *  \li PREFIX if the regular expression is a literal followed by a single capture group
+     *      of <tt>.</tt>, <tt>\S</tt>, <tt>\d</tt> or <tt>\w</tt> with a greedy
+     *      <tt>*</tt> or <tt>+</tt> quantifier, for example <tt>"Spotted a (.*)$"</tt>
+     *  \li REGEXP for every other regular expression
+     *
+     *  The results of matches() and capturedTexts() do not depend on the engine.
+     *  \return The engine of the Pattern
+     */
+    teEngine     engine() const throw();
+
+    //! \brief Returns the name of the given engine for the trace output
+    static const char *engineName( const teEngine p_enEngine ) throw();
+
+    //! \brief Returns <tt>true</tt> if the regular expression is prone to backtracking
+    /*! The check is a static analysis of the regular expression done when the Pattern is
+     *  created. A regular expression is flagged if it has an unbounded quantifier nested in
+     *  another unbounded quantifier (for example <tt>(a+)+</tt>), or if it has more than
+     *  one unbounded repetition of a wide atom (<tt>.</tt>, <tt>\S</tt>, <tt>\D</tt>,
+     *  <tt>\W</tt> or a negated character class), for example <tt>.*foo.*bar</tt>. Such
+     *  expressions can take polynomial or exponential time on long Log Lines that almost
+     *  match. Only the REGEXP engine can backtrack, Patterns using the other engines are
+     *  never flagged.
+     *  \sa cPatternScratch::setMatchBudget()
+     */
+    bool         backtrackingProne() const throw();
+
+    //! \brief Checks if the regular expression of the Pattern matches the input string.
+    /*! This is the detection step of the Log Analysis, it is called for every line of the
+     *  Input Logs, so it does not collect the captured texts. Use capturedTexts() on the
+     *  lines where the Pattern matched to get the values of the Captured Attributes.
+     *  \param p_qsLogLine the input string (one Log Line without the new line character)
+     *  \param p_poScratch the match state of the calling thread, or NULL to use a temporary one
+     *  \return <tt>true</tt> if the regular expression matches anywhere in the input string
+     */
+    bool         matches( const QString &p_qsLogLine, cPatternScratch *p_poScratch = NULL ) const throw();
+
+    //! \brief Checks if the regular expression of the Pattern matches the given bytes.
+    /*! Same as matches( const QString& ) but runs directly on the bytes read from the
+     *  Input Log, so no QString has to be created for the Log Lines that do not match.
+     *  \param p_poLogLine pointer to the Log Line (it does not have to be zero terminated)
+     *  \param p_uiLength length of the Log Line in bytes, without the new line character
+     *  \param p_poScratch the match state of the calling thread, or NULL to use a temporary one
+     *  \return <tt>true</tt> if the regular expression matches anywhere in the Log Line
+     */
+    bool         matches( const char *p_poLogLine, const unsigned int p_uiLength,
+                          cPatternScratch *p_poScratch = NULL ) const throw();
+
     //! \brief Returns the captured texts if the regular expression matches the input string.
     /*! If the regular expression of the Pattern matches the input string and the regular
      *  expression contains capture text commands ('(' and ')' characters) the values of
@@ -72,10 +231,44 @@ public:
      *  result list will contain the captured texts in the same order as they occurred in the
      *  input string.
      *  \param p_qsLogLine the input string to capture texts from
+     *  \param p_poScratch the match state of the calling thread, or NULL to use a temporary one
      *  \return The list of captured texts as a QStringList or an empty list if the input
      *  string did not match the regular expression.
      */
-    QStringList  capturedTexts( const QString &p_qsLogLine ) const throw();
+    QStringList  capturedTexts( const QString &p_qsLogLine, cPatternScratch *p_poScratch = NULL ) const throw();
+
+    //! \brief Builds the fused regular expression of the Pattern
+    /*! The fused regular expression finds the Pattern and the time-stamp of the Log Line in
+     *  a single evaluation: <tt>^(?=[\s\S]*?(PATTERN))(?:(?=[\s\S]*?(TIMESTAMP))|)</tt>.
+     *  Both look-ahead groups find the leftmost match of their own expression, so the
+     *  result is the same as matching the two expressions separately. Patterns that refer
+     *  to their own groups by number or need the position of the match (back references,
+     *  recursion, <tt>\G</tt>, <tt>\K</tt>, etc) are not fused, neither are Patterns whose
+     *  group names clash with the group names of the time-stamp.
+     *  \param p_qsTimeStampRegExp the time-stamp regular expression of the Action
+     *         Definitions
+     *  \sa fused() matchFused()
+     */
+    void         fuse( const QString &p_qsTimeStampRegExp ) throw();
+
+    //! \brief Returns <tt>true</tt> if the Pattern has a fused regular expression
+    bool         fused() const throw();
+
+    //! \brief Matches the Pattern and the time-stamp with the fused regular expression
+    /*! The captured texts of the Pattern and of the time-stamp are taken from the same
+     *  match result, so neither of them has to be matched again.
+     *  \param p_poLogLine pointer to the Log Line (it does not have to be zero terminated)
+     *  \param p_uiLength length of the Log Line in bytes, without the new line character
+     *  \param p_poTimeStampTexts receives the captured texts of the time-stamp in the same
+     *         layout as QRegExp::capturedTexts(), or an empty list if the time-stamp regular
+     *         expression does not match the Log Line
+     *  \param p_poCapturedTexts receives the same list as capturedTexts()
+     *  \param p_poScratch the match state of the calling thread, or NULL to use a temporary one
+     *  \return <tt>true</tt> if the regular expression of the Pattern matches the Log Line
+     */
+    bool         matchFused( const char *p_poLogLine, const unsigned int p_uiLength,
+                             QStringList *p_poTimeStampTexts, QStringList *p_poCapturedTexts,
+                             cPatternScratch *p_poScratch = NULL ) const throw();
 
 private:
 
@@ -85,11 +278,58 @@ private:
     QString      m_qsName;
 
     //! Holds the <tt>pattern</tt> attribute of the Pattern
-    /*! The <tt>pattern</tt> attribute is stored as a QRegExp object to make matching and
-     *  capturing simpler.
-     *  \sa pattern() capturedTexts()
+    /*! \sa pattern()
+     */
+    QString      m_qsPattern;
+
+    //! Compiled regular expression shared by the copies of the Pattern
+    typedef struct
+    {
+        //! The compiled (and if possible JIT compiled) regular expression
+        pcre2_code   *poCode;
+        //! Number of capture groups in the regular expression
+        uint32_t      uiCaptureCount;
+        //! Number of cPattern objects sharing the compiled code
+        QAtomicInt    obRefCount;
+    } tsCompiledRegExp;
+
+    //! Holds the compiled regular expression, or NULL if the Pattern is empty
+    /*! \sa matches() capturedTexts()
+     */
+    tsCompiledRegExp *m_poCompiled;
+
+    //! Holds the fused regular expression, or NULL if the Pattern is not fused
+    /*! \sa fuse() matchFused()
+     */
+    tsCompiledRegExp *m_poFused;
+
+    //! Holds the literal that must be present in every matching Log Line
+    /*! \sa literal()
+     */
+    QString      m_qsLiteral;
+
+    //! The engine chosen by classify()
+    teEngine     m_enEngine;
+
+    //! True if the regular expression is prone to backtracking
+    /*! \sa backtrackingProne()
      */
-    QRegExp      m_obRegExp;
+    bool         m_boBacktrackingProne;
+
+    //! The literal searched by the LITERAL and PREFIX engines
+    QByteArray   m_obFastLiteral;
+
+    //! True if the LITERAL or PREFIX match has to start at the beginning of the line
+    bool         m_boAnchorStart;
+
+    //! True if the LITERAL or PREFIX match has to end at the end of the line
+    bool         m_boAnchorEnd;
+
+    //! The character class captured by the PREFIX engine: '.', 'S', 'd' or 'w'
+    char         m_chCaptureClass;
+
+    //! The minimum number of characters captured by the PREFIX engine
+    unsigned int m_uiCaptureMin;
 
     //! Holds the list of the names of Captured Attributes
     /*! \sa captures() capturedTexts()
@@ -101,6 +341,85 @@ private:
      *  values.
      */
     void         init()                 throw();
+
+    //! \brief Internal function to choose the engine of the Pattern
+    /*! \sa engine()
+     */
+    void         classify() throw();
+
+    //! \brief Internal function to run the LITERAL and PREFIX engines
+    /*! \param p_poLogLine pointer to the Log Line
+     *  \param p_uiLength length of the Log Line in bytes
+     *  \param p_poStart receives the offset of the match
+     *  \param p_poCaptureStart receives the offset of the captured text (PREFIX only)
+     *  \param p_poEnd receives the offset of the end of the match
+     *  \return <tt>true</tt> if the Pattern matches the Log Line
+     */
+    bool         matchFast( const char *p_poLogLine, const unsigned int p_uiLength,
+                            unsigned int *p_poStart, unsigned int *p_poCaptureStart,
+                            unsigned int *p_poEnd ) const throw();
+
+    //! \brief Internal function to compile the regular expression of the Pattern
+    /*! \param p_qsRegExp the regular expression in PCRE syntax
+     *  \throw cSevException if the regular expression is invalid
+     */
+    void         compile( const QString &p_qsRegExp ) throw( cSevException );
+
+    //! \brief Internal function to compile a regular expression into shared code
+    /*! \param p_qsRegExp the regular expression in PCRE syntax
+     *  \param p_poErrorCode receives the PCRE2 error code if the compilation fails
+     *  \param p_poErrorPos receives the offset of the error if the compilation fails
+     *  \return The compiled code with a reference count of 1, or NULL on error
+     */
+    static tsCompiledRegExp *compileCode( const QString &p_qsRegExp, int *p_poErrorCode,
+                                          PCRE2_SIZE *p_poErrorPos ) throw();
+
+    //! \brief Internal function to release the shared compiled regular expressions
+    void         release()              throw();
+
+    //! \brief Internal function to drop a reference to shared compiled code
+    static void  releaseCode( tsCompiledRegExp **p_poCompiled ) throw();
+
+    //! \brief Internal function to run the compiled regular expression
+    /*! \param p_poCompiled the compiled code to run, NULL never matches
+     *  \param p_poLogLine pointer to the Log Line
+     *  \param p_uiLength length of the Log Line in bytes
+     *  \param p_poScratch the match state to use
+     *  \return The match data of the scratch holding the result of the match, or NULL if
+     *  the regular expression did not match
+     */
+    static pcre2_match_data *match( const tsCompiledRegExp *p_poCompiled,
+                                    const char *p_poLogLine, const unsigned int p_uiLength,
+                                    cPatternScratch *p_poScratch ) throw();
+
+    //! \brief Internal function to collect captured texts from a match result
+    /*! \param p_poLogLine the Log Line the match ran on
+     *  \param p_poOVector the offset vector of the match, NULL if there was no match
+     *  \param p_uiFirst the first group to collect
+     *  \param p_uiCount number of groups to collect
+     *  \param p_poTexts receives one item for every group, empty for the unset groups
+     */
+    static void  collectTexts( const char *p_poLogLine, const PCRE2_SIZE *p_poOVector,
+                               const uint32_t p_uiFirst, const uint32_t p_uiCount,
+                               QStringList *p_poTexts ) throw();
+
+    //! \brief Internal function to find nested or repeated unbounded quantifiers
+    /*! \sa backtrackingProne()
+     */
+    static bool  checkBacktracking( const QString &p_qsRegExp ) throw();
+
+    //! \brief Internal function to check if a regular expression can be fused
+    /*! \return <tt>false</tt> if the regular expression depends on its group numbers or
+     *  on the start of the match
+     */
+    static bool  fusable( const QString &p_qsRegExp ) throw();
+
+    //! \brief Internal function to extract the required literal from a regular expression
+    /*! \param p_qsRegExp the regular expression in PCRE syntax
+     *  \return The longest mandatory literal of the regular expression, or an empty string
+     *  \sa literal()
+     */
+    static QString extractLiteral( const QString &p_qsRegExp ) throw();
 };
 
 #endif // PATTERN_H
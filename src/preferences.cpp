@@ -1,4 +1,5 @@
 #include <QSettings>
+#include <QDir>
 
 #include "lara.h"
 #include "preferences.h"
@@ -13,6 +14,19 @@ cPreferences::cPreferences( const QString &p_qsAppName, const QString &p_qsVersi
     m_qsInputDir  = "";
     m_qsOutputDir = "";
     m_qsTempDir   = "";
+    m_qsIndexDir  = "";
+    m_qsCacheDir  = "";
+    m_ulRegExpSetCacheSize = 8192 * 1024;
+    m_boFusedMatching = false;
+    m_uiMatchBudget   = 1000000;
+    m_boReadInPlace   = false;
+    m_ulGzipIndexSpan = 0;
+    m_ullCacheSize    = 4096ULL * 1024 * 1024;
+    m_uiPrefetchFiles = 2;
+    m_uiCheckpointInterval = 10;
+    m_uiMaxLineLength = 64 * 1024 * 1024;
+    m_uiDiscoveryThreads = 4;
+    m_uiContextLines = 0;
     m_qsFileName  = QString( "./%1.ini" ).arg( p_qsAppName );
     m_qsDBHost    = "";
     m_qsDBSchema  = "";
@@ -77,6 +91,71 @@ QString cPreferences::tempDir() const
     return m_qsTempDir;
 }
 
+QString cPreferences::indexDir() const
+{
+    return m_qsIndexDir;
+}
+
+QString cPreferences::cacheDir() const
+{
+    return m_qsCacheDir;
+}
+
+unsigned long cPreferences::regExpSetCacheSize() const
+{
+    return m_ulRegExpSetCacheSize;
+}
+
+bool cPreferences::fusedMatching() const
+{
+    return m_boFusedMatching;
+}
+
+unsigned int cPreferences::matchBudget() const
+{
+    return m_uiMatchBudget;
+}
+
+bool cPreferences::readInPlace() const
+{
+    return m_boReadInPlace;
+}
+
+unsigned long cPreferences::gzipIndexSpan() const
+{
+    return m_ulGzipIndexSpan;
+}
+
+unsigned long long cPreferences::cacheSize() const
+{
+    return m_ullCacheSize;
+}
+
+unsigned int cPreferences::prefetchFiles() const
+{
+    return m_uiPrefetchFiles;
+}
+
+unsigned int cPreferences::checkpointInterval() const
+{
+    return m_uiCheckpointInterval;
+}
+
+unsigned int cPreferences::maxLineLength() const
+{
+    return m_uiMaxLineLength;
+}
+
+unsigned int cPreferences::discoveryThreads() const
+{
+    return m_uiDiscoveryThreads;
+}
+
+unsigned int cPreferences::contextLines() const
+{
+    return m_uiContextLines;
+}
+
 QString cPreferences::dbHost() const
 {
     return m_qsDBHost;
@@ -126,6 +205,23 @@ void cPreferences::load() throw(cSevException)
     m_qsInputDir  = obPrefFile.value( QString::fromAscii( "Directories/InputDir" ), "." ).toString();
     m_qsOutputDir = obPrefFile.value( QString::fromAscii( "Directories/OutputDir" ), "." ).toString();
     m_qsTempDir   = obPrefFile.value( QString::fromAscii( "Directories/TempDir" ), "." ).toString();
+    m_qsIndexDir  = obPrefFile.value( QString::fromAscii( "Directories/IndexDir" ), "" ).toString();
+    // The index files are never stored next to the Input Log Files, where the file masks of
+    // the next run would find them
+    if( m_qsIndexDir.isEmpty() ) m_qsIndexDir = QDir( m_qsOutputDir ).filePath( "index" );
+    m_qsCacheDir  = obPrefFile.value( QString::fromAscii( "Directories/CacheDir" ), "" ).toString();
+
+    m_ulRegExpSetCacheSize = obPrefFile.value( QString::fromAscii( "Analysis/RegExpSetCacheKB" ), 8192 ).toUInt() * 1024UL;
+    m_boFusedMatching      = obPrefFile.value( QString::fromAscii( "Analysis/FusedMatching" ), false ).toBool();
+    m_uiMatchBudget        = obPrefFile.value( QString::fromAscii( "Analysis/MatchBudget" ), 1000000 ).toUInt();
+    m_boReadInPlace        = obPrefFile.value( QString::fromAscii( "Analysis/ReadInPlace" ), false ).toBool();
+    m_ulGzipIndexSpan      = obPrefFile.value( QString::fromAscii( "Analysis/GzipIndexSpanKB" ), 0 ).toUInt() * 1024UL;
+    m_ullCacheSize         = obPrefFile.value( QString::fromAscii( "Analysis/CacheSizeMB" ), 4096 ).toULongLong() * 1024ULL * 1024ULL;
+    m_uiPrefetchFiles      = obPrefFile.value( QString::fromAscii( "Analysis/PrefetchFiles" ), 2 ).toUInt();
+    m_uiCheckpointInterval = obPrefFile.value( QString::fromAscii( "Analysis/CheckpointSeconds" ), 10 ).toUInt();
+    m_uiMaxLineLength      = obPrefFile.value( QString::fromAscii( "Analysis/MaxLineKB" ), 65536 ).toUInt() * 1024U;
+    m_uiDiscoveryThreads   = obPrefFile.value( QString::fromAscii( "Analysis/DiscoveryThreads" ), 4 ).toUInt();
+    m_uiContextLines       = obPrefFile.value( QString::fromAscii( "Analysis/ContextLines" ), 0 ).toUInt();
 
     m_qsDBHost    = obPrefFile.value( QString::fromAscii( "DataBase/Host" ), "" ).toString();
     m_qsDBSchema  = obPrefFile.value( QString::fromAscii( "DataBase/Schema" ), "" ).toString();
@@ -23,6 +23,19 @@ public:
     QString                    inputDir() const;
     QString                    outputDir() const;
     QString                    tempDir() const;
+    QString                    indexDir() const;
+    QString                    cacheDir() const;
+    unsigned long              regExpSetCacheSize() const;
+    bool                       fusedMatching() const;
+    unsigned int               matchBudget() const;
+    bool                       readInPlace() const;
+    unsigned long              gzipIndexSpan() const;
+    unsigned long long         cacheSize() const;
+    unsigned int               prefetchFiles() const;
+    unsigned int               checkpointInterval() const;
+    unsigned int               maxLineLength() const;
+    unsigned int               discoveryThreads() const;
+    unsigned int               contextLines() const;
     QString                    dbHost() const;
     QString                    dbSchema() const;
     QString                    dbUser() const;
@@ -37,6 +50,19 @@ private:
     QString                    m_qsInputDir;
     QString                    m_qsOutputDir;
     QString                    m_qsTempDir;
+    QString                    m_qsIndexDir;
+    QString                    m_qsCacheDir;
+    unsigned long              m_ulRegExpSetCacheSize;
+    bool                       m_boFusedMatching;
+    unsigned int               m_uiMatchBudget;
+    bool                       m_boReadInPlace;
+    unsigned long              m_ulGzipIndexSpan;
+    unsigned long long         m_ullCacheSize;
+    unsigned int               m_uiPrefetchFiles;
+    unsigned int               m_uiCheckpointInterval;
+    unsigned int               m_uiMaxLineLength;
+    unsigned int               m_uiDiscoveryThreads;
+    unsigned int               m_uiContextLines;
     QString                    m_qsDBHost;
     QString                    m_qsDBSchema;
     QString                    m_qsDBUser;
@@ -0,0 +1,312 @@
+#include <QtGlobal>
+#include <QDir>
+#include <QFile>
+#include <QFileInfo>
+#include <QDateTime>
+#include <QCoreApplication>
+#include <vector>
+#ifdef Q_OS_UNIX
+#include <utime.h>
+#endif
+
+#include "preparedcache.h"
+
+// Files up to this size are hashed as a whole, larger files are sampled
+static const unsigned int  CACHE_SAMPLE_SIZE  = 65536;
+static const unsigned int  CACHE_SAMPLE_COUNT = 16;
+
+// Primes of the 64 bit xxHash algorithm
+static const unsigned long long XXH_PRIME1 = 11400714785074694791ULL;
+static const unsigned long long XXH_PRIME2 = 14029467366897019727ULL;
+static const unsigned long long XXH_PRIME3 = 1609587929392839161ULL;
+static const unsigned long long XXH_PRIME4 = 9650029242287828579ULL;
+static const unsigned long long XXH_PRIME5 = 2870177450012600261ULL;
+
+static inline unsigned long long rotateLeft( const unsigned long long p_ullValue, const unsigned int p_uiBits )
+{
+    return (p_ullValue << p_uiBits) | (p_ullValue >> (64 - p_uiBits));
+}
+
+static inline unsigned long long readUInt64( const unsigned char *p_poData )
+{
+    unsigned long long ullValue = 0;
+    for( int i = 7; i >= 0; i-- ) ullValue = (ullValue << 8) | p_poData[i];
+    return ullValue;
+}
+
+static inline unsigned long long readUInt32( const unsigned char *p_poData )
+{
+    return (unsigned long long)p_poData[0] | ((unsigned long long)p_poData[1] << 8) |
+           ((unsigned long long)p_poData[2] << 16) | ((unsigned long long)p_poData[3] << 24);
+}
+
+static inline unsigned long long xxhRound( unsigned long long p_ullAccumulator, const unsigned long long p_ullInput )
+{
+    p_ullAccumulator += p_ullInput * XXH_PRIME2;
+    return rotateLeft( p_ullAccumulator, 31 ) * XXH_PRIME1;
+}
+
+static inline unsigned long long xxhMerge( const unsigned long long p_ullHash, const unsigned long long p_ullAccumulator )
+{
+    return (p_ullHash ^ xxhRound( 0, p_ullAccumulator )) * XXH_PRIME1 + XXH_PRIME4;
+}
+
+// Marks a cache entry as the most recently used one
+static void touch( const QString &p_qsPath )
+{
+#ifdef Q_OS_UNIX
+    utime( QFile::encodeName( p_qsPath ).constData(), NULL );
+#else
+    Q_UNUSED( p_qsPath );
+#endif
+}
+
+cPreparedCache::cPreparedCache( const QString &p_qsCacheDir, const unsigned long long p_ullMaxSize ) throw( cSevException )
+{
+    m_qsCacheDir = p_qsCacheDir;
+    m_ullMaxSize = p_ullMaxSize;
+    m_ullSize    = 0;
+    m_ullLastUse = 0;
+
+    if( !QDir().mkpath( m_qsCacheDir ) )
+    {
+        throw cSevException( cSeverity::ERROR, QString( "Cannot create Cache Directory %1" ).arg( m_qsCacheDir ).toStdString() );
+    }
+
+    // The entries are touched when used, so the oldest modification time is the least
+    // recently used entry. Entries being filled by other processes are not counted.
+    QFileInfoList obEntries = QDir( m_qsCacheDir ).entryInfoList( QDir::Dirs | QDir::NoDotAndDotDot, QDir::Time | QDir::Reversed );
+    for( int i = 0; i < obEntries.size(); i++ )
+    {
+        QString qsEntry = obEntries.at( i ).fileName();
+        if( qsEntry.endsWith( ".tmp" ) ) continue;
+
+        unsigned long long ullSize = 0;
+        QFileInfoList      obFiles = QDir( obEntries.at( i ).filePath() ).entryInfoList( QDir::Files );
+        for( int j = 0; j < obFiles.size(); j++ ) ullSize += obFiles.at( j ).size();
+        use( qsEntry, ullSize );
+    }
+}
+
+cPreparedCache::~cPreparedCache() throw()
+{
+}
+
+QString cPreparedCache::find( const QString &p_qsKey ) throw()
+{
+    QDir        obEntryDir( QDir( m_qsCacheDir ).filePath( p_qsKey ) );
+    QStringList slFiles = obEntryDir.entryList( QDir::Files | QDir::NoDotAndDotDot );
+    if( slFiles.size() != 1 ) return "";
+
+    touch( obEntryDir.path() );
+    tmEntries::const_iterator itEntry = m_maEntries.find( p_qsKey );
+    use( p_qsKey, itEntry != m_maEntries.end() ? itEntry->second.ullSize : QFileInfo( obEntryDir.filePath( slFiles.at( 0 ) ) ).size() );
+
+    return obEntryDir.filePath( slFiles.at( 0 ) );
+}
+
+void cPreparedCache::pin( const QString &p_qsKey ) throw()
+{
+    m_sePinned.insert( p_qsKey );
+}
+
+QString cPreparedCache::store( const QString &p_qsKey, const QString &p_qsPreparedFile ) throw( cSevException )
+{
+    // The entry is filled under a name of its own first, so another process looking for
+    // the same key never finds a half-copied file
+    QDir    obCacheDir( m_qsCacheDir );
+    QString qsFileName = QFileInfo( p_qsPreparedFile ).fileName();
+    QString qsTempDir  = QString( "%1.%2.tmp" ).arg( p_qsKey ).arg( QCoreApplication::applicationPid() );
+    QString qsTempFile = QDir( obCacheDir.filePath( qsTempDir ) ).filePath( qsFileName );
+    unsigned long long ullSize = QFileInfo( p_qsPreparedFile ).size();
+
+    if( !obCacheDir.mkpath( qsTempDir ) )
+    {
+        throw cSevException( cSeverity::ERROR, QString( "Cannot create cache entry %1" ).arg( obCacheDir.filePath( qsTempDir ) ).toStdString() );
+    }
+    if( !QFile::rename( p_qsPreparedFile, qsTempFile ) )
+    {
+        // Renaming fails across file systems
+        if( !QFile::copy( p_qsPreparedFile, qsTempFile ) )
+        {
+            obCacheDir.rmdir( qsTempDir );
+            throw cSevException( cSeverity::ERROR, QString( "Cannot copy %1 to the cache" ).arg( p_qsPreparedFile ).toStdString() );
+        }
+        QFile::remove( p_qsPreparedFile );
+    }
+
+    if( !obCacheDir.rename( qsTempDir, p_qsKey ) )
+    {
+        // Another process stored the same file in the meantime
+        QFile::remove( qsTempFile );
+        obCacheDir.rmdir( qsTempDir );
+        QString qsCachedFile = find( p_qsKey );
+        if( qsCachedFile.isEmpty() )
+        {
+            throw cSevException( cSeverity::ERROR, QString( "Cannot create cache entry %1" ).arg( obCacheDir.filePath( p_qsKey ) ).toStdString() );
+        }
+        return qsCachedFile;
+    }
+
+    use( p_qsKey, ullSize );
+    evict( p_qsKey );
+
+    return QDir( obCacheDir.filePath( p_qsKey ) ).filePath( qsFileName );
+}
+
+unsigned long long cPreparedCache::size() const throw()
+{
+    return m_ullSize;
+}
+
+QString cPreparedCache::key( const QString &p_qsFileName, const QString &p_qsMethod ) throw( cSevException )
+{
+    QFile obFile( p_qsFileName );
+    if( !obFile.open( QIODevice::ReadOnly ) )
+    {
+        throw cSevException( cSeverity::ERROR, QString( "Cannot open Input Log File %1: %2" ).arg( p_qsFileName ).arg( obFile.errorString() ).toStdString() );
+    }
+
+    // Small files are hashed as a whole, of larger files only evenly spaced samples
+    // (including the first and the last bytes) are read
+    unsigned long long ullSize = obFile.size();
+    std::vector<char>  veData;
+    if( ullSize <= (unsigned long long)CACHE_SAMPLE_SIZE * CACHE_SAMPLE_COUNT )
+    {
+        veData.resize( ullSize + 1 );
+        if( obFile.read( &veData[0], ullSize ) != (qint64)ullSize ) veData.clear();
+        else veData.resize( ullSize );
+    }
+    else
+    {
+        veData.resize( CACHE_SAMPLE_SIZE * CACHE_SAMPLE_COUNT );
+        for( unsigned int i = 0; i < CACHE_SAMPLE_COUNT && !veData.empty(); i++ )
+        {
+            unsigned long long ullOffset = (ullSize - CACHE_SAMPLE_SIZE) * i / (CACHE_SAMPLE_COUNT - 1);
+            if( !obFile.seek( ullOffset ) ||
+                obFile.read( &veData[i * CACHE_SAMPLE_SIZE], CACHE_SAMPLE_SIZE ) != (qint64)CACHE_SAMPLE_SIZE )
+            {
+                veData.clear();
+            }
+        }
+    }
+    if( veData.empty() && ullSize )
+    {
+        throw cSevException( cSeverity::ERROR, QString( "Error reading Input Log File %1" ).arg( p_qsFileName ).toStdString() );
+    }
+
+    unsigned long long ullHash = hash64( veData.empty() ? "" : &veData[0], veData.size(), ullSize );
+
+    return QString( "%1-%2-%3-%4" ).arg( p_qsMethod ).arg( ullSize )
+           .arg( QFileInfo( p_qsFileName ).lastModified().toTime_t() ).arg( ullHash, 16, 16, QChar( '0' ) );
+}
+
+unsigned long long cPreparedCache::hash64( const char *p_poData, const unsigned int p_uiLength,
+                                           const unsigned long long p_ullSeed ) throw()
+{
+    const unsigned char *poPos = (const unsigned char *)p_poData;
+    const unsigned char *poEnd = poPos + p_uiLength;
+    unsigned long long   ullHash;
+
+    if( p_uiLength >= 32 )
+    {
+        unsigned long long ullAcc1 = p_ullSeed + XXH_PRIME1 + XXH_PRIME2;
+        unsigned long long ullAcc2 = p_ullSeed + XXH_PRIME2;
+        unsigned long long ullAcc3 = p_ullSeed;
+        unsigned long long ullAcc4 = p_ullSeed - XXH_PRIME1;
+        for( ; poPos + 32 <= poEnd; poPos += 32 )
+        {
+            ullAcc1 = xxhRound( ullAcc1, readUInt64( poPos ) );
+            ullAcc2 = xxhRound( ullAcc2, readUInt64( poPos + 8 ) );
+            ullAcc3 = xxhRound( ullAcc3, readUInt64( poPos + 16 ) );
+            ullAcc4 = xxhRound( ullAcc4, readUInt64( poPos + 24 ) );
+        }
+        ullHash = rotateLeft( ullAcc1, 1 ) + rotateLeft( ullAcc2, 7 ) + rotateLeft( ullAcc3, 12 ) + rotateLeft( ullAcc4, 18 );
+        ullHash = xxhMerge( ullHash, ullAcc1 );
+        ullHash = xxhMerge( ullHash, ullAcc2 );
+        ullHash = xxhMerge( ullHash, ullAcc3 );
+        ullHash = xxhMerge( ullHash, ullAcc4 );
+    }
+    else
+    {
+        ullHash = p_ullSeed + XXH_PRIME5;
+    }
+    ullHash += p_uiLength;
+
+    for( ; poPos + 8 <= poEnd; poPos += 8 )
+    {
+        ullHash ^= xxhRound( 0, readUInt64( poPos ) );
+        ullHash  = rotateLeft( ullHash, 27 ) * XXH_PRIME1 + XXH_PRIME4;
+    }
+    if( poPos + 4 <= poEnd )
+    {
+        ullHash ^= readUInt32( poPos ) * XXH_PRIME1;
+        ullHash  = rotateLeft( ullHash, 23 ) * XXH_PRIME2 + XXH_PRIME3;
+        poPos += 4;
+    }
+    for( ; poPos < poEnd; poPos++ )
+    {
+        ullHash ^= *poPos * XXH_PRIME5;
+        ullHash  = rotateLeft( ullHash, 11 ) * XXH_PRIME1;
+    }
+
+    ullHash ^= ullHash >> 33;
+    ullHash *= XXH_PRIME2;
+    ullHash ^= ullHash >> 29;
+    ullHash *= XXH_PRIME3;
+    ullHash ^= ullHash >> 32;
+
+    return ullHash;
+}
+
+void cPreparedCache::use( const QString &p_qsKey, const unsigned long long p_ullSize ) throw()
+{
+    tmEntries::iterator itEntry = m_maEntries.find( p_qsKey );
+    if( itEntry != m_maEntries.end() )
+    {
+        m_maUseOrder.erase( itEntry->second.ullUsed );
+        m_ullSize -= itEntry->second.ullSize;
+    }
+    else
+    {
+        itEntry = m_maEntries.insert( std::make_pair( p_qsKey, tsEntry() ) ).first;
+    }
+
+    itEntry->second.ullSize = p_ullSize;
+    itEntry->second.ullUsed = ++m_ullLastUse;
+    m_maUseOrder[m_ullLastUse] = p_qsKey;
+    m_ullSize += p_ullSize;
+}
+
+void cPreparedCache::evict( const QString &p_qsKeep ) throw()
+{
+    QDir obCacheDir( m_qsCacheDir );
+
+    tmUseOrder::iterator itUse = m_maUseOrder.begin();
+    while( itUse != m_maUseOrder.end() && m_ullSize > m_ullMaxSize )
+    {
+        // Entries still used are left alone
+        QString qsEntry = itUse->second;
+        if( qsEntry == p_qsKeep || m_sePinned.contains( qsEntry ) )
+        {
+            itUse++;
+            continue;
+        }
+
+        QDir        obEntryDir( obCacheDir.filePath( qsEntry ) );
+        QStringList slFiles = obEntryDir.entryList( QDir::Files );
+        for( int j = 0; j < slFiles.size(); j++ ) obEntryDir.remove( slFiles.at( j ) );
+
+        // An entry removed by another process is forgotten as well
+        if( !obCacheDir.rmdir( qsEntry ) && obCacheDir.exists( qsEntry ) )
+        {
+            itUse++;
+            continue;
+        }
+
+        tmEntries::iterator itEntry = m_maEntries.find( qsEntry );
+        m_ullSize -= itEntry->second.ullSize;
+        m_maEntries.erase( itEntry );
+        m_maUseOrder.erase( itUse++ );
+    }
+}
@@ -0,0 +1,119 @@
+#ifndef PREPAREDCACHE_H
+#define PREPAREDCACHE_H
+
+#include <QString>
+#include <QSet>
+#include <map>
+
+#include <sevexception.h>
+
+//! \brief Persistent cache of prepared Input Log Files
+/*! Unpacking and decoding the Input Log Files (see cLogDataSource) is repeated every time
+ *  the same file is analysed, for example when the same archive appears in several
+ *  batches, or when a batch is run again with different Action Definitions. The cache keeps
+ *  the prepared files in the Cache Directory, so a file is only prepared once.
+ *
+ *  The prepared files are looked up by a key made from the original file (see key()): its
+ *  size, modification time and a hash of samples of its content, so computing the key reads
+ *  at most 1 MB of the file, whatever its size. Each prepared file is stored with its own
+ *  name in a sub-directory named after its key, so the names in the outputs stay readable.
+ *
+ *  The total size of the cache is limited: when a new file is stored, the least recently
+ *  used files are removed until the cache fits the limit again. The files still used by
+ *  the current analysis are pinned (see pin()) and never removed, even if the cache stays
+ *  over its limit because of them.
+ *
+ *  The sizes and the order of use of the entries are read from the Cache Directory once,
+ *  by the constructor, and kept up to date by this object, so storing a file does not scan
+ *  the whole cache. The entries stored by other processes in the meantime are not counted.
+ */
+class cPreparedCache
+{
+public:
+    //! \brief Constructor that creates the Cache Directory if it does not exist yet
+    /*! \param p_qsCacheDir the Cache Directory
+     *  \param p_ullMaxSize the maximum total size of the cached files in bytes
+     */
+    cPreparedCache( const QString &p_qsCacheDir, const unsigned long long p_ullMaxSize ) throw( cSevException );
+
+    //! \brief Destructor
+    ~cPreparedCache() throw();
+
+    //! \brief Returns the cached prepared file with the given key
+    /*! The file becomes the most recently used one.
+     *  \return The name of the cached file, or an empty string if it is not cached
+     */
+    QString            find( const QString &p_qsKey ) throw();
+
+    //! \brief Keeps the file with the given key in the cache while this object exists
+    /*! Pinned files are not removed when other files are stored, so a prepared file is
+     *  not removed while it is waiting to be analysed or being analysed. The key does not
+     *  have to be in the cache yet.
+     */
+    void               pin( const QString &p_qsKey ) throw();
+
+    //! \brief Moves a prepared file into the cache
+    /*! The stored file is never removed by its own storing, even if it is larger than the
+     *  size limit of the cache.
+     *  \param p_qsKey the key of the original file
+     *  \param p_qsPreparedFile the prepared file, it is moved (not copied) into the cache
+     *  \return The name of the cached file
+     */
+    QString            store( const QString &p_qsKey, const QString &p_qsPreparedFile ) throw( cSevException );
+
+    //! \brief Returns the total size of the cached files in bytes
+    unsigned long long size() const throw();
+
+    //! \brief Returns the key of an original Input Log File
+    /*! \param p_qsFileName the original Input Log File
+     *  \param p_qsMethod the name of the preparation method, the same file prepared with
+     *         different methods gets different keys
+     */
+    static QString     key( const QString &p_qsFileName, const QString &p_qsMethod ) throw( cSevException );
+
+    //! \brief Returns the 64 bit xxHash of the given data
+    static unsigned long long hash64( const char *p_poData, const unsigned int p_uiLength,
+                                      const unsigned long long p_ullSeed = 0 ) throw();
+
+private:
+    //! The Cache Directory
+    QString             m_qsCacheDir;
+    //! The maximum total size of the cached files in bytes
+    unsigned long long  m_ullMaxSize;
+    //! The keys of the pinned files
+    QSet<QString>       m_sePinned;
+
+    //! A cached prepared file
+    typedef struct
+    {
+        //! Size of the file in bytes
+        unsigned long long  ullSize;
+        //! When the file was last used, the key of the entry in m_maUseOrder
+        unsigned long long  ullUsed;
+    } tsEntry;
+
+    //! Map container type to hold the cached files, by their keys
+    typedef std::map<QString, tsEntry>             tmEntries;
+    //! Map container type to hold the keys of the cached files, by the time of their last use
+    typedef std::map<unsigned long long, QString>  tmUseOrder;
+
+    //! The cached files
+    tmEntries           m_maEntries;
+    //! The keys of the cached files, the least recently used one first
+    tmUseOrder          m_maUseOrder;
+    //! The total size of the cached files in bytes
+    unsigned long long  m_ullSize;
+    //! The time of the last use, counted in uses
+    unsigned long long  m_ullLastUse;
+
+    //! \brief Marks the entry of the given key as the most recently used one
+    void               use( const QString &p_qsKey, const unsigned long long p_ullSize ) throw();
+
+    //! \brief Removes the least recently used files until the cache fits its size limit
+    /*! Pinned files are never removed.
+     *  \param p_qsKeep key of the file that is not removed even if it is the oldest
+     */
+    void               evict( const QString &p_qsKeep ) throw();
+};
+
+#endif // PREPAREDCACHE_H
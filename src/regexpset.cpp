@@ -0,0 +1,861 @@
+#include <algorithm>
+#include <cctype>
+#include <cstring>
+#include <string>
+
+#include "regexpset.h"
+
+using namespace std;
+
+// Limits that keep the NFA of a single Pattern reasonably small. Patterns exceeding them are
+// not covered by the set.
+static const int          MAX_REPEAT        = 255;
+static const unsigned int MAX_PATTERN_NODES = 4096;
+
+// Number of cache flushes after which the cache stops building states
+static const unsigned int MAX_CACHE_FLUSHES = 16;
+
+//! Parses a regular expression and compiles it into the NFA of a cRegExpSet
+/*! The regular expression is first parsed into a syntax tree, so quantified sub-expressions
+ *  can be compiled more than once (for example <tt>a{2,3}</tt> becomes <tt>aaa?</tt>).
+ */
+class cRegExpSetCompiler
+{
+public:
+    cRegExpSetCompiler( cRegExpSet *p_poSet, const QByteArray &p_obRegExp ) throw()
+    {
+        m_poSet  = p_poSet;
+        m_stText = string( p_obRegExp.constData(), p_obRegExp.size() );
+        m_uiPos  = 0;
+        m_uiFirstNode = p_poSet->m_veNodes.size();
+    }
+
+    //! Compiles the regular expression, returns false if it uses an unsupported feature
+    bool compile( const unsigned int p_uiPattern ) throw()
+    {
+        int inRoot = parseAlternation();
+        if( inRoot < 0 || m_uiPos != m_stText.size() ) return false;
+
+        tsFragment suFragment;
+        if( !compileNode( inRoot, &suFragment ) )
+        {
+            m_poSet->m_veNodes.resize( m_uiFirstNode );
+            return false;
+        }
+
+        patch( suFragment.vePatches, addNode( cRegExpSet::MATCH, p_uiPattern ) );
+        m_poSet->m_veStarts.push_back( suFragment.uiStart );
+        return true;
+    }
+
+private:
+    enum teAstType
+    {
+        AST_CHARS,
+        AST_EMPTY,
+        AST_BOL,
+        AST_EOL,
+        AST_CONCAT,
+        AST_ALTERNATION,
+        AST_REPEAT
+    };
+
+    typedef struct
+    {
+        teAstType       enType;
+        bitset<256>     obChars;
+        vector<int>     veChildren;
+        int             inMin;
+        int             inMax;   // -1 means unlimited
+    } tsAstNode;
+
+    // A partially compiled NFA: its start node and the list of dangling outputs, each
+    // encoded as node index * 2 + output number
+    typedef struct
+    {
+        unsigned int          uiStart;
+        vector<unsigned int>  vePatches;
+    } tsFragment;
+
+    cRegExpSet          *m_poSet;
+    string               m_stText;
+    unsigned int         m_uiPos;
+    unsigned int         m_uiFirstNode;
+    vector<tsAstNode>    m_veAst;
+
+    bool atEnd() const { return m_uiPos >= m_stText.size(); }
+    char peek() const  { return m_stText[m_uiPos]; }
+
+    int newAst( const teAstType p_enType )
+    {
+        tsAstNode suNode;
+        suNode.enType = p_enType;
+        suNode.inMin  = 0;
+        suNode.inMax  = 0;
+        m_veAst.push_back( suNode );
+        return m_veAst.size() - 1;
+    }
+
+    int parseAlternation()
+    {
+        int inFirst = parseConcatenation();
+        if( inFirst < 0 || atEnd() || peek() != '|' ) return inFirst;
+
+        int inNode = newAst( AST_ALTERNATION );
+        m_veAst[inNode].veChildren.push_back( inFirst );
+        while( !atEnd() && peek() == '|' )
+        {
+            m_uiPos++;
+            int inNext = parseConcatenation();
+            if( inNext < 0 ) return -1;
+            m_veAst[inNode].veChildren.push_back( inNext );
+        }
+        return inNode;
+    }
+
+    int parseConcatenation()
+    {
+        int inNode = newAst( AST_CONCAT );
+        while( !atEnd() && peek() != '|' && peek() != ')' )
+        {
+            int inAtom = parseRepeat();
+            if( inAtom < 0 ) return -1;
+            m_veAst[inNode].veChildren.push_back( inAtom );
+        }
+        return inNode;
+    }
+
+    int parseRepeat()
+    {
+        int inAtom = parseAtom();
+        if( inAtom < 0 ) return -1;
+
+        while( !atEnd() )
+        {
+            int inMin = 0;
+            int inMax = -1;
+            if( peek() == '*' )      { m_uiPos++; }
+            else if( peek() == '+' ) { m_uiPos++; inMin = 1; }
+            else if( peek() == '?' ) { m_uiPos++; inMax = 1; }
+            else if( peek() == '{' )
+            {
+                if( !parseCounts( &inMin, &inMax ) ) break;
+            }
+            else break;
+
+            // Anchors cannot be quantified in a meaningful way
+            if( m_veAst[inAtom].enType == AST_BOL || m_veAst[inAtom].enType == AST_EOL ) return -1;
+
+            if( !atEnd() && peek() == '?' ) m_uiPos++;          // lazy: same set of matches
+            else if( !atEnd() && peek() == '+' ) return -1;     // possessive: not supported
+
+            int inNode = newAst( AST_REPEAT );
+            m_veAst[inNode].veChildren.push_back( inAtom );
+            m_veAst[inNode].inMin = inMin;
+            m_veAst[inNode].inMax = inMax;
+            inAtom = inNode;
+        }
+
+        return inAtom;
+    }
+
+    // Parses a {n}, {n,} or {n,m} quantifier. Anything else starting with '{' is a literal
+    // in PCRE, so it is left for parseAtom().
+    bool parseCounts( int *p_poMin, int *p_poMax )
+    {
+        unsigned int uiPos = m_uiPos + 1;
+        int          inMin = 0;
+        int          inMax = 0;
+        unsigned int uiDigits = 0;
+
+        for( ; uiPos < m_stText.size() && isdigit( (unsigned char)m_stText[uiPos] ); uiPos++, uiDigits++ )
+        {
+            if( inMin <= MAX_REPEAT ) inMin = inMin * 10 + (m_stText[uiPos] - '0');
+        }
+        if( !uiDigits || uiPos >= m_stText.size() ) return false;
+
+        if( m_stText[uiPos] == '}' )
+        {
+            inMax = inMin;
+        }
+        else if( m_stText[uiPos] == ',' )
+        {
+            uiPos++;
+            uiDigits = 0;
+            for( ; uiPos < m_stText.size() && isdigit( (unsigned char)m_stText[uiPos] ); uiPos++, uiDigits++ )
+            {
+                if( inMax <= MAX_REPEAT ) inMax = inMax * 10 + (m_stText[uiPos] - '0');
+            }
+            if( uiPos >= m_stText.size() || m_stText[uiPos] != '}' ) return false;
+            if( !uiDigits ) inMax = -1;
+        }
+        else return false;
+
+        m_uiPos  = uiPos + 1;
+        *p_poMin = inMin;
+        *p_poMax = inMax;
+        return true;
+    }
+
+    int parseAtom()
+    {
+        char chChar = peek();
+        m_uiPos++;
+
+        switch( chChar )
+        {
+            case '^':
+                return newAst( AST_BOL );
+
+            case '$':
+                return newAst( AST_EOL );
+
+            case '.':
+            {
+                int inNode = newAst( AST_CHARS );
+                m_veAst[inNode].obChars.set();
+                m_veAst[inNode].obChars.reset( '\n' );
+                return inNode;
+            }
+
+            case '(':
+            {
+                // Plain, non-capturing and named groups are supported, every other
+                // construct starting with "(?" or "(*" is not.
+                if( !atEnd() && peek() == '*' ) return -1;
+                if( !atEnd() && peek() == '?' )
+                {
+                    m_uiPos++;
+                    if( atEnd() ) return -1;
+                    if( peek() == ':' ) m_uiPos++;
+                    else
+                    {
+                        if( peek() == 'P' ) m_uiPos++;
+                        if( atEnd() || (peek() != '<' && peek() != '\'') ) return -1;
+                        char chClose = peek() == '<' ? '>' : '\'';
+                        m_uiPos++;
+                        if( atEnd() || !(isalpha( (unsigned char)peek() ) || peek() == '_') ) return -1;
+                        while( !atEnd() && peek() != chClose ) m_uiPos++;
+                        if( atEnd() ) return -1;
+                        m_uiPos++;
+                    }
+                }
+                int inNode = parseAlternation();
+                if( inNode < 0 || atEnd() || peek() != ')' ) return -1;
+                m_uiPos++;
+                return inNode;
+            }
+
+            case '[':
+                return parseClass();
+
+            case '\\':
+            {
+                int inNode = newAst( AST_CHARS );
+                int inSpecial = 0;
+                if( !parseEscape( &m_veAst[inNode].obChars, &inSpecial ) ) return -1;
+                if( inSpecial ) m_veAst[inNode].enType = (inSpecial == '^') ? AST_BOL : AST_EOL;
+                return inNode;
+            }
+
+            case '*': case '+': case '?': case ')':
+                return -1;
+
+            default:
+            {
+                int inNode = newAst( AST_CHARS );
+                m_veAst[inNode].obChars.set( (unsigned char)chChar );
+                return inNode;
+            }
+        }
+    }
+
+    // Parses an escape sequence after the '\' character. Anchor escapes are only accepted
+    // outside character classes, they are reported in p_poSpecial as '^' or '$'.
+    bool parseEscape( bitset<256> *p_poChars, int *p_poSpecial )
+    {
+        if( atEnd() ) return false;
+
+        char chChar = peek();
+        m_uiPos++;
+
+        switch( chChar )
+        {
+            case 'd': case 'D':
+                for( int c = '0'; c <= '9'; c++ ) p_poChars->set( c );
+                break;
+            case 'w': case 'W':
+                for( int c = '0'; c <= '9'; c++ ) p_poChars->set( c );
+                for( int c = 'a'; c <= 'z'; c++ ) p_poChars->set( c );
+                for( int c = 'A'; c <= 'Z'; c++ ) p_poChars->set( c );
+                p_poChars->set( '_' );
+                break;
+            case 's': case 'S':
+                p_poChars->set( ' ' );
+                p_poChars->set( '\t' );
+                p_poChars->set( '\n' );
+                p_poChars->set( '\v' );
+                p_poChars->set( '\f' );
+                p_poChars->set( '\r' );
+                break;
+            case 't': p_poChars->set( '\t' ); break;
+            case 'n': p_poChars->set( '\n' ); break;
+            case 'r': p_poChars->set( '\r' ); break;
+            case 'f': p_poChars->set( '\f' ); break;
+            case 'e': p_poChars->set( 27 );   break;
+            case 'a': p_poChars->set( 7 );    break;
+            case 'x':
+            {
+                // The \x{hhh} form is not supported
+                if( !atEnd() && peek() == '{' ) return false;
+                int inValue = 0;
+                for( int i = 0; i < 2 && !atEnd() && isxdigit( (unsigned char)peek() ); i++, m_uiPos++ )
+                {
+                    char chDigit = tolower( peek() );
+                    inValue = inValue * 16 + (isdigit( (unsigned char)chDigit ) ? chDigit - '0' : chDigit - 'a' + 10);
+                }
+                p_poChars->set( inValue );
+                break;
+            }
+            case 'A':
+                if( !p_poSpecial ) return false;
+                *p_poSpecial = '^';
+                break;
+            case 'z': case 'Z':
+                if( !p_poSpecial ) return false;
+                *p_poSpecial = '$';
+                break;
+            default:
+                // Other escaped letters and digits are back references, word boundaries,
+                // property classes, etc. Every other escaped character stands for itself.
+                if( isalnum( (unsigned char)chChar ) ) return false;
+                p_poChars->set( (unsigned char)chChar );
+        }
+
+        if( chChar == 'D' || chChar == 'W' || chChar == 'S' ) p_poChars->flip();
+
+        return true;
+    }
+
+    int parseClass()
+    {
+        int         inNode = newAst( AST_CHARS );
+        bitset<256> obChars;
+        bool        boNegated = false;
+
+        if( !atEnd() && peek() == '^' ) { boNegated = true; m_uiPos++; }
+
+        bool boFirst = true;
+        while( !atEnd() && (peek() != ']' || boFirst) )
+        {
+            boFirst = false;
+
+            // POSIX classes like [:alpha:] are not supported
+            if( peek() == '[' && m_uiPos + 1 < m_stText.size() &&
+                (m_stText[m_uiPos + 1] == ':' || m_stText[m_uiPos + 1] == '.' || m_stText[m_uiPos + 1] == '=') ) return -1;
+
+            bitset<256> obItem;
+            int         inFrom = -1;
+            if( peek() == '\\' )
+            {
+                m_uiPos++;
+                if( !parseEscape( &obItem, NULL ) ) return -1;
+                if( obItem.count() == 1 )
+                {
+                    for( int c = 0; c < 256; c++ ) if( obItem.test( c ) ) inFrom = c;
+                }
+            }
+            else
+            {
+                inFrom = (unsigned char)peek();
+                obItem.set( inFrom );
+                m_uiPos++;
+            }
+
+            // Range, unless the '-' is the last character of the class
+            if( m_uiPos + 1 < m_stText.size() && peek() == '-' && m_stText[m_uiPos + 1] != ']' )
+            {
+                if( inFrom < 0 ) return -1;
+                m_uiPos++;
+                int inTo = -1;
+                if( peek() == '\\' )
+                {
+                    m_uiPos++;
+                    bitset<256> obTo;
+                    if( !parseEscape( &obTo, NULL ) || obTo.count() != 1 ) return -1;
+                    for( int c = 0; c < 256; c++ ) if( obTo.test( c ) ) inTo = c;
+                }
+                else
+                {
+                    if( peek() == '[' ) return -1;
+                    inTo = (unsigned char)peek();
+                    m_uiPos++;
+                }
+                if( inTo < inFrom ) return -1;
+                for( int c = inFrom; c <= inTo; c++ ) obItem.set( c );
+            }
+
+            obChars |= obItem;
+        }
+        if( atEnd() ) return -1;
+        m_uiPos++;
+
+        if( boNegated ) obChars.flip();
+        m_veAst[inNode].obChars = obChars;
+        return inNode;
+    }
+
+    unsigned int addNode( const cRegExpSet::teNodeType p_enType, const unsigned int p_uiArg = 0 )
+    {
+        cRegExpSet::tsNode suNode;
+        suNode.enType = p_enType;
+        suNode.uiOut1 = 0;
+        suNode.uiOut2 = 0;
+        suNode.uiArg  = p_uiArg;
+        m_poSet->m_veNodes.push_back( suNode );
+        return m_poSet->m_veNodes.size() - 1;
+    }
+
+    void patch( const vector<unsigned int> &p_vePatches, const unsigned int p_uiTarget )
+    {
+        for( unsigned int i = 0; i < p_vePatches.size(); i++ )
+        {
+            cRegExpSet::tsNode &suNode = m_poSet->m_veNodes[p_vePatches[i] / 2];
+            if( p_vePatches[i] % 2 ) suNode.uiOut2 = p_uiTarget;
+            else suNode.uiOut1 = p_uiTarget;
+        }
+    }
+
+    unsigned int charSet( const bitset<256> &p_obChars )
+    {
+        for( unsigned int i = 0; i < m_poSet->m_veCharSets.size(); i++ )
+        {
+            if( m_poSet->m_veCharSets[i] == p_obChars ) return i;
+        }
+        m_poSet->m_veCharSets.push_back( p_obChars );
+        return m_poSet->m_veCharSets.size() - 1;
+    }
+
+    bool compileNode( const int p_inAst, tsFragment *p_poFragment )
+    {
+        // Checked on the way, so a huge repetition does not build a huge NFA first
+        if( m_poSet->m_veNodes.size() - m_uiFirstNode > MAX_PATTERN_NODES ) return false;
+
+        const tsAstNode &suAst = m_veAst[p_inAst];
+        p_poFragment->vePatches.clear();
+
+        switch( suAst.enType )
+        {
+            case AST_CHARS:
+            case AST_EMPTY:
+            case AST_BOL:
+            case AST_EOL:
+            {
+                cRegExpSet::teNodeType enType = cRegExpSet::JUMP;
+                unsigned int           uiArg  = 0;
+                if( suAst.enType == AST_CHARS ) { enType = cRegExpSet::CHARSET; uiArg = charSet( suAst.obChars ); }
+                if( suAst.enType == AST_BOL ) enType = cRegExpSet::BOL;
+                if( suAst.enType == AST_EOL ) enType = cRegExpSet::EOL;
+                p_poFragment->uiStart = addNode( enType, uiArg );
+                p_poFragment->vePatches.push_back( p_poFragment->uiStart * 2 );
+                return true;
+            }
+
+            case AST_CONCAT:
+            {
+                if( suAst.veChildren.empty() )
+                {
+                    p_poFragment->uiStart = addNode( cRegExpSet::JUMP );
+                    p_poFragment->vePatches.push_back( p_poFragment->uiStart * 2 );
+                    return true;
+                }
+                for( unsigned int i = 0; i < suAst.veChildren.size(); i++ )
+                {
+                    tsFragment suChild;
+                    if( !compileNode( suAst.veChildren[i], &suChild ) ) return false;
+                    if( i == 0 ) p_poFragment->uiStart = suChild.uiStart;
+                    else patch( p_poFragment->vePatches, suChild.uiStart );
+                    p_poFragment->vePatches.swap( suChild.vePatches );
+                }
+                return true;
+            }
+
+            case AST_ALTERNATION:
+            {
+                unsigned int uiLastSplit = 0;
+                for( unsigned int i = 0; i < suAst.veChildren.size(); i++ )
+                {
+                    tsFragment suChild;
+                    if( !compileNode( suAst.veChildren[i], &suChild ) ) return false;
+
+                    unsigned int uiEntry = suChild.uiStart;
+                    if( i + 1 < suAst.veChildren.size() )
+                    {
+                        uiEntry = addNode( cRegExpSet::SPLIT );
+                        m_poSet->m_veNodes[uiEntry].uiOut1 = suChild.uiStart;
+                    }
+                    if( i == 0 ) p_poFragment->uiStart = uiEntry;
+                    else m_poSet->m_veNodes[uiLastSplit].uiOut2 = uiEntry;
+                    uiLastSplit = uiEntry;
+
+                    p_poFragment->vePatches.insert( p_poFragment->vePatches.end(),
+                                                    suChild.vePatches.begin(), suChild.vePatches.end() );
+                }
+                return true;
+            }
+
+            case AST_REPEAT:
+            {
+                int inMin = suAst.inMin;
+                int inMax = suAst.inMax;
+                if( inMin > MAX_REPEAT || inMax > MAX_REPEAT ) return false;
+                if( inMax >= 0 && inMax < inMin ) return false;
+
+                int          inChild = suAst.veChildren[0];
+                unsigned int uiEntry = addNode( cRegExpSet::JUMP );
+                p_poFragment->uiStart = uiEntry;
+                p_poFragment->vePatches.push_back( uiEntry * 2 );
+
+                // The mandatory copies
+                for( int i = 0; i < inMin; i++ )
+                {
+                    tsFragment suChild;
+                    if( !compileNode( inChild, &suChild ) ) return false;
+                    patch( p_poFragment->vePatches, suChild.uiStart );
+                    p_poFragment->vePatches.swap( suChild.vePatches );
+                }
+
+                if( inMax < 0 )
+                {
+                    // Unlimited: a loop through a split node
+                    unsigned int uiSplit = addNode( cRegExpSet::SPLIT );
+                    tsFragment   suChild;
+                    if( !compileNode( inChild, &suChild ) ) return false;
+                    patch( p_poFragment->vePatches, uiSplit );
+                    m_poSet->m_veNodes[uiSplit].uiOut1 = suChild.uiStart;
+                    patch( suChild.vePatches, uiSplit );
+                    p_poFragment->vePatches.clear();
+                    p_poFragment->vePatches.push_back( uiSplit * 2 + 1 );
+                    return true;
+                }
+
+                // The optional copies, each one can be skipped to the end
+                vector<unsigned int> veSkips;
+                for( int i = inMin; i < inMax; i++ )
+                {
+                    unsigned int uiSplit = addNode( cRegExpSet::SPLIT );
+                    tsFragment   suChild;
+                    if( !compileNode( inChild, &suChild ) ) return false;
+                    patch( p_poFragment->vePatches, uiSplit );
+                    m_poSet->m_veNodes[uiSplit].uiOut1 = suChild.uiStart;
+                    veSkips.push_back( uiSplit * 2 + 1 );
+                    p_poFragment->vePatches.swap( suChild.vePatches );
+                }
+                p_poFragment->vePatches.insert( p_poFragment->vePatches.end(), veSkips.begin(), veSkips.end() );
+                return true;
+            }
+        }
+
+        return false;
+    }
+};
+
+cRegExpSet::cRegExpSet() throw()
+{
+    m_uiPatternCount = 0;
+    m_uiCoveredCount = 0;
+    memset( m_poByteClass, 0, sizeof( m_poByteClass ) );
+    m_veClassBytes.assign( 1, 0 );
+}
+
+cRegExpSet::~cRegExpSet() throw()
+{
+}
+
+void cRegExpSet::build( const QStringList &p_slRegExps ) throw()
+{
+    m_uiPatternCount = p_slRegExps.size();
+    m_uiCoveredCount = 0;
+    m_veCovered.assign( m_uiPatternCount, 0 );
+    m_veNodes.clear();
+    m_veStarts.clear();
+    m_veCharSets.clear();
+
+    for( unsigned int i = 0; i < m_uiPatternCount; i++ )
+    {
+        cRegExpSetCompiler obCompiler( this, p_slRegExps.at( i ).toAscii() );
+        if( obCompiler.compile( i ) )
+        {
+            m_veCovered[i] = 1;
+            m_uiCoveredCount++;
+        }
+    }
+
+    buildByteClasses();
+}
+
+unsigned int cRegExpSet::patternCount() const throw()
+{
+    return m_uiPatternCount;
+}
+
+unsigned int cRegExpSet::coveredCount() const throw()
+{
+    return m_uiCoveredCount;
+}
+
+bool cRegExpSet::covers( const unsigned int p_uiPattern ) const throw()
+{
+    return p_uiPattern < m_veCovered.size() && m_veCovered[p_uiPattern];
+}
+
+bool cRegExpSet::match( const char *p_poText, const unsigned int p_uiLength,
+                        cRegExpSetCache *p_poCache,
+                        vector<unsigned char> *p_poMatches ) const throw()
+{
+    if( p_poCache->m_poSet != this )
+    {
+        p_poCache->clear();
+        p_poCache->m_uiFlushCount = 0;
+        p_poCache->m_poSet = this;
+    }
+    if( p_poCache->disabled() ) return false;
+
+    p_poMatches->assign( m_uiPatternCount, 0 );
+
+    if( !p_uiLength )
+    {
+        // The only position of an empty line is both its beginning and its end
+        vector<unsigned int> veClosure;
+        closure( m_veStarts, true, true, p_poCache, &veClosure );
+        for( unsigned int i = 0; i < veClosure.size(); i++ )
+        {
+            if( m_veNodes[veClosure[i]].enType == MATCH ) (*p_poMatches)[m_veNodes[veClosure[i]].uiArg] = 1;
+        }
+        return true;
+    }
+
+    int inState = 0;
+    if( p_poCache->m_veStates.empty() )
+    {
+        vector<unsigned int> veClosure;
+        closure( m_veStarts, true, false, p_poCache, &veClosure );
+        inState = addState( veClosure, p_poCache );
+    }
+
+    const unsigned int uiClassCount = m_veClassBytes.size();
+    for( unsigned int i = 0; inState >= 0; i++ )
+    {
+        const vector<unsigned int> &veMatches = p_poCache->m_veStates[inState].veMatches;
+        for( unsigned int m = 0; m < veMatches.size(); m++ ) (*p_poMatches)[veMatches[m]] = 1;
+
+        if( i == p_uiLength ) break;
+
+        unsigned int uiClass = m_poByteClass[(unsigned char)p_poText[i]];
+        int          inNext  = p_poCache->m_veTransitions[inState * uiClassCount + uiClass];
+        if( inNext < 0 ) inNext = nextState( inState, uiClass, p_poCache );
+        inState = inNext;
+    }
+
+    if( inState < 0 )
+    {
+        // Memory limit reached: starting over with an empty cache on the next line
+        p_poCache->clear();
+        p_poCache->m_uiFlushCount++;
+        return false;
+    }
+
+    const vector<unsigned int> &veEndMatches = endMatches( inState, p_poCache );
+    for( unsigned int m = 0; m < veEndMatches.size(); m++ ) (*p_poMatches)[veEndMatches[m]] = 1;
+
+    return true;
+}
+
+void cRegExpSet::buildByteClasses() throw()
+{
+    // Two bytes are in the same class if every character set contains both or neither
+    map<string, unsigned int> maClasses;
+    m_veClassBytes.clear();
+    for( int c = 0; c < 256; c++ )
+    {
+        string stSignature( m_veCharSets.size(), '0' );
+        for( unsigned int s = 0; s < m_veCharSets.size(); s++ )
+        {
+            if( m_veCharSets[s].test( c ) ) stSignature[s] = '1';
+        }
+
+        map<string, unsigned int>::iterator itClass = maClasses.find( stSignature );
+        if( itClass == maClasses.end() )
+        {
+            itClass = maClasses.insert( make_pair( stSignature, (unsigned int)m_veClassBytes.size() ) ).first;
+            m_veClassBytes.push_back( c );
+        }
+        m_poByteClass[c] = itClass->second;
+    }
+}
+
+void cRegExpSet::closure( const vector<unsigned int> &p_veSeeds, const bool p_boLineStart,
+                          const bool p_boLineEnd, cRegExpSetCache *p_poCache,
+                          vector<unsigned int> *p_poClosure ) const throw()
+{
+    if( p_poCache->m_veMarks.size() != m_veNodes.size() || ++p_poCache->m_uiMark == 0 )
+    {
+        p_poCache->m_veMarks.assign( m_veNodes.size(), 0 );
+        p_poCache->m_uiMark = 1;
+    }
+    const unsigned int uiMark = p_poCache->m_uiMark;
+
+    p_poClosure->clear();
+    vector<unsigned int> &veStack = p_poCache->m_veStack;
+    veStack.assign( p_veSeeds.rbegin(), p_veSeeds.rend() );
+    while( !veStack.empty() )
+    {
+        unsigned int uiNode = veStack.back();
+        veStack.pop_back();
+        if( p_poCache->m_veMarks[uiNode] == uiMark ) continue;
+        p_poCache->m_veMarks[uiNode] = uiMark;
+
+        const tsNode &suNode = m_veNodes[uiNode];
+        switch( suNode.enType )
+        {
+            case CHARSET:
+            case MATCH:
+                p_poClosure->push_back( uiNode );
+                break;
+            case SPLIT:
+                veStack.push_back( suNode.uiOut2 );
+                veStack.push_back( suNode.uiOut1 );
+                break;
+            case JUMP:
+                veStack.push_back( suNode.uiOut1 );
+                break;
+            case BOL:
+                if( p_boLineStart ) veStack.push_back( suNode.uiOut1 );
+                break;
+            case EOL:
+                // Kept in the state, so it can be followed if the line ends here
+                if( p_boLineEnd ) veStack.push_back( suNode.uiOut1 );
+                else p_poClosure->push_back( uiNode );
+                break;
+        }
+    }
+
+    sort( p_poClosure->begin(), p_poClosure->end() );
+}
+
+int cRegExpSet::addState( const vector<unsigned int> &p_veNodes, cRegExpSetCache *p_poCache ) const throw()
+{
+    map< vector<unsigned int>, unsigned int >::const_iterator itState = p_poCache->m_maStateIds.find( p_veNodes );
+    if( itState != p_poCache->m_maStateIds.end() ) return itState->second;
+
+    // The node list is stored twice (in the state and as the key of the map), plus the
+    // transitions and an estimate of the container overheads
+    unsigned long ulSize = 2 * p_veNodes.size() * sizeof( unsigned int ) +
+                           m_veClassBytes.size() * sizeof( int ) +
+                           sizeof( cRegExpSetCache::tsState ) + 64;
+    if( p_poCache->m_ulMemoryUsage + ulSize > p_poCache->m_ulMemoryLimit ) return -1;
+    p_poCache->m_ulMemoryUsage += ulSize;
+
+    cRegExpSetCache::tsState suState;
+    suState.veNodes       = p_veNodes;
+    suState.boEndComputed = false;
+    for( unsigned int i = 0; i < p_veNodes.size(); i++ )
+    {
+        if( m_veNodes[p_veNodes[i]].enType == MATCH ) suState.veMatches.push_back( m_veNodes[p_veNodes[i]].uiArg );
+    }
+
+    unsigned int uiState = p_poCache->m_veStates.size();
+    p_poCache->m_veStates.push_back( suState );
+    p_poCache->m_veTransitions.resize( p_poCache->m_veTransitions.size() + m_veClassBytes.size(), -1 );
+    p_poCache->m_maStateIds.insert( make_pair( p_veNodes, uiState ) );
+
+    return uiState;
+}
+
+int cRegExpSet::nextState( const unsigned int p_uiState, const unsigned int p_uiClass,
+                           cRegExpSetCache *p_poCache ) const throw()
+{
+    const unsigned char ubByte = m_veClassBytes[p_uiClass];
+
+    // The start nodes are added in every step, since a match can start at any position
+    vector<unsigned int> &veSeeds = p_poCache->m_veSeeds;
+    veSeeds.clear();
+    const vector<unsigned int> &veNodes = p_poCache->m_veStates[p_uiState].veNodes;
+    for( unsigned int i = 0; i < veNodes.size(); i++ )
+    {
+        const tsNode &suNode = m_veNodes[veNodes[i]];
+        if( suNode.enType == CHARSET && m_veCharSets[suNode.uiArg].test( ubByte ) ) veSeeds.push_back( suNode.uiOut1 );
+    }
+    veSeeds.insert( veSeeds.end(), m_veStarts.begin(), m_veStarts.end() );
+
+    closure( veSeeds, false, false, p_poCache, &p_poCache->m_veClosure );
+
+    int inNext = addState( p_poCache->m_veClosure, p_poCache );
+    if( inNext >= 0 ) p_poCache->m_veTransitions[p_uiState * m_veClassBytes.size() + p_uiClass] = inNext;
+
+    return inNext;
+}
+
+const vector<unsigned int> &cRegExpSet::endMatches( const unsigned int p_uiState, cRegExpSetCache *p_poCache ) const throw()
+{
+    cRegExpSetCache::tsState &suState = p_poCache->m_veStates[p_uiState];
+    if( !suState.boEndComputed )
+    {
+        vector<unsigned int> veSeeds;
+        for( unsigned int i = 0; i < suState.veNodes.size(); i++ )
+        {
+            if( m_veNodes[suState.veNodes[i]].enType == EOL ) veSeeds.push_back( suState.veNodes[i] );
+        }
+
+        vector<unsigned int> veClosure;
+        if( !veSeeds.empty() ) closure( veSeeds, false, true, p_poCache, &veClosure );
+        for( unsigned int i = 0; i < veClosure.size(); i++ )
+        {
+            if( m_veNodes[veClosure[i]].enType == MATCH ) suState.veEndMatches.push_back( m_veNodes[veClosure[i]].uiArg );
+        }
+        suState.boEndComputed = true;
+    }
+
+    return suState.veEndMatches;
+}
+
+cRegExpSetCache::cRegExpSetCache( const unsigned long p_ulMemoryLimit ) throw()
+{
+    m_poSet         = NULL;
+    m_ulMemoryLimit = p_ulMemoryLimit;
+    m_ulMemoryUsage = 0;
+    m_uiFlushCount  = 0;
+    m_uiMark        = 0;
+}
+
+cRegExpSetCache::~cRegExpSetCache() throw()
+{
+}
+
+void cRegExpSetCache::clear() throw()
+{
+    m_veStates.clear();
+    m_veTransitions.clear();
+    m_maStateIds.clear();
+    m_ulMemoryUsage = 0;
+}
+
+unsigned int cRegExpSetCache::stateCount() const throw()
+{
+    return m_veStates.size();
+}
+
+unsigned long cRegExpSetCache::memoryUsage() const throw()
+{
+    return m_ulMemoryUsage;
+}
+
+unsigned int cRegExpSetCache::flushCount() const throw()
+{
+    return m_uiFlushCount;
+}
+
+bool cRegExpSetCache::disabled() const throw()
+{
+    return m_uiFlushCount >= MAX_CACHE_FLUSHES;
+}
@@ -0,0 +1,218 @@
+#ifndef REGEXPSET_H
+#define REGEXPSET_H
+
+#include <QString>
+#include <QStringList>
+#include <vector>
+#include <map>
+#include <bitset>
+
+class cRegExpSetCache;
+
+//! \brief Combined automaton that matches all the Patterns of an Action Definition file at once
+/*! The regular expressions of all the Patterns are compiled into a single non-deterministic
+ *  automaton (NFA). During Log Analysis the automaton is turned into a deterministic one
+ *  (DFA) lazily: a DFA state is only built the first time it is reached, and then it is
+ *  stored in a cRegExpSetCache. A single pass over a Log Line tells which of the Patterns
+ *  match the line, and the cost of the pass does not depend on the number of Patterns once
+ *  the states needed by the input are cached.
+ *
+ *  The automaton only knows whether a regular expression matches, captured texts still
+ *  have to be collected with cPattern::capturedTexts() for the Patterns that matched.
+ *
+ *  Only the subset of the PCRE syntax that can be matched without backtracking is
+ *  supported: literals, character classes, the '.' wildcard, groups, alternation, greedy
+ *  and lazy quantifiers and the '^' and '$' anchors. Patterns using anything else (back
+ *  references, look-around assertions, word boundaries, inline options, etc) are not
+ *  covered by the set, see covers(). These Patterns have to be matched one by one with
+ *  cPattern::matches().
+ */
+class cRegExpSet
+{
+public:
+    //! \brief Default constructor, creates an empty set that covers no Patterns
+    cRegExpSet() throw();
+
+    //! \brief Destructor
+    /*! An empty destructor.
+     */
+    ~cRegExpSet() throw();
+
+    //! \brief Builds the automaton from the given list of regular expressions
+    /*! The regular expressions are indexed the same way as the Patterns they belong to.
+     *  \param p_slRegExps the regular expression of each Pattern, in Pattern order
+     */
+    void          build( const QStringList &p_slRegExps ) throw();
+
+    //! \brief Returns the number of Patterns the set was built for
+    unsigned int  patternCount() const throw();
+
+    //! \brief Returns the number of Patterns covered by the set
+    unsigned int  coveredCount() const throw();
+
+    //! \brief Checks if the given Pattern is matched by the set
+    /*! \param p_uiPattern index of the Pattern
+     *  \return <tt>false</tt> if the regular expression of the Pattern uses a feature the
+     *          automaton does not support
+     */
+    bool          covers( const unsigned int p_uiPattern ) const throw();
+
+    //! \brief Matches all the covered Patterns against the given text in a single pass
+    /*! \param p_poText pointer to the Log Line (it does not have to be zero terminated)
+     *  \param p_uiLength length of the Log Line in bytes, without the new line character
+     *  \param p_poCache the DFA states built so far, new states are added to it
+     *  \param p_poMatches vector that is resized to patternCount() and filled with 1 for
+     *         each covered Pattern that matches the text and 0 for every other Pattern
+     *  \return <tt>false</tt> if the memory limit of the cache was reached, in this case
+     *          p_poMatches is not valid and the Patterns have to be matched one by one
+     */
+    bool          match( const char *p_poText, const unsigned int p_uiLength,
+                         cRegExpSetCache *p_poCache,
+                         std::vector<unsigned char> *p_poMatches ) const throw();
+
+private:
+    //! Types of the NFA nodes
+    enum teNodeType
+    {
+        CHARSET,    //!< consumes a byte of the character set uiArg, continues at uiOut1
+        SPLIT,      //!< continues at both uiOut1 and uiOut2
+        JUMP,       //!< continues at uiOut1
+        BOL,        //!< continues at uiOut1 at the beginning of the line only
+        EOL,        //!< continues at uiOut1 at the end of the line only
+        MATCH       //!< the regular expression of Pattern uiArg matched
+    };
+
+    //! A node of the NFA
+    typedef struct
+    {
+        teNodeType    enType;
+        unsigned int  uiOut1;
+        unsigned int  uiOut2;
+        unsigned int  uiArg;
+    } tsNode;
+
+    //! Number of Patterns the set was built for
+    unsigned int                    m_uiPatternCount;
+    //! Number of Patterns covered by the set
+    unsigned int                    m_uiCoveredCount;
+    //! Holds 1 for each covered Pattern
+    std::vector<unsigned char>      m_veCovered;
+    //! The nodes of the NFA
+    std::vector<tsNode>             m_veNodes;
+    //! Start node of each covered Pattern
+    std::vector<unsigned int>       m_veStarts;
+    //! The distinct character sets used by the CHARSET nodes
+    std::vector< std::bitset<256> > m_veCharSets;
+    //! Maps each byte to its equivalence class (bytes no character set can tell apart)
+    unsigned char                   m_poByteClass[256];
+    //! A byte of each equivalence class
+    std::vector<unsigned char>      m_veClassBytes;
+
+    //! Computes the byte equivalence classes from the character sets
+    void         buildByteClasses() throw();
+
+    //! \brief Collects the nodes reachable from the given nodes without consuming a byte
+    /*! \param p_veSeeds the nodes to start from
+     *  \param p_boLineStart true if the position is the beginning of the line
+     *  \param p_boLineEnd true if the position is the end of the line
+     *  \param p_poCache provides the scratch space of the traversal
+     *  \param p_poClosure receives the sorted list of CHARSET, EOL and MATCH nodes
+     */
+    void         closure( const std::vector<unsigned int> &p_veSeeds, const bool p_boLineStart,
+                          const bool p_boLineEnd, cRegExpSetCache *p_poCache,
+                          std::vector<unsigned int> *p_poClosure ) const throw();
+
+    //! \brief Returns the cached DFA state of the given set of nodes, adding it if needed
+    /*! \return The index of the state, or -1 if the memory limit of the cache is reached
+     */
+    int          addState( const std::vector<unsigned int> &p_veNodes, cRegExpSetCache *p_poCache ) const throw();
+
+    //! \brief Computes the state reached from the given state with a byte of the given class
+    /*! \return The index of the next state, or -1 if the memory limit of the cache is reached
+     */
+    int          nextState( const unsigned int p_uiState, const unsigned int p_uiClass,
+                            cRegExpSetCache *p_poCache ) const throw();
+
+    //! \brief Returns the Patterns matching at the end of the line in the given state
+    const std::vector<unsigned int> &endMatches( const unsigned int p_uiState, cRegExpSetCache *p_poCache ) const throw();
+
+    friend class cRegExpSetCompiler;
+};
+
+//! \brief Holds the lazily built DFA states of a cRegExpSet
+/*! The cache is the only part of the regular expression set that changes during Log
+ *  Analysis, so every thread matching the set needs its own cache. The memory used by the
+ *  cached states is limited: if the limit is reached while a Log Line is matched, the cache
+ *  is flushed and the line has to be matched by the Patterns one by one. If the cache has to
+ *  be flushed too many times, the input is considered too diverse for the automaton and the
+ *  cache stops building states altogether.
+ */
+class cRegExpSetCache
+{
+public:
+    //! \brief Constructor
+    /*! \param p_ulMemoryLimit maximum number of bytes the cached DFA states can use
+     */
+    cRegExpSetCache( const unsigned long p_ulMemoryLimit = 8388608 ) throw();
+
+    //! \brief Destructor
+    ~cRegExpSetCache() throw();
+
+    //! \brief Drops all the cached states
+    void          clear() throw();
+
+    //! \brief Returns the number of cached DFA states
+    unsigned int  stateCount() const throw();
+
+    //! \brief Returns the estimated number of bytes used by the cached DFA states
+    unsigned long memoryUsage() const throw();
+
+    //! \brief Returns how many times the cache was flushed because of the memory limit
+    unsigned int  flushCount() const throw();
+
+    //! \brief Returns <tt>true</tt> if the cache gave up building states
+    bool          disabled() const throw();
+
+private:
+    //! A state of the DFA
+    typedef struct
+    {
+        //! The sorted list of NFA nodes the state consists of
+        std::vector<unsigned int>  veNodes;
+        //! The Patterns that matched when the state is reached
+        std::vector<unsigned int>  veMatches;
+        //! The Patterns that match if the line ends in this state
+        std::vector<unsigned int>  veEndMatches;
+        //! True when veEndMatches is already computed
+        bool                       boEndComputed;
+    } tsState;
+
+    //! The set the states were built for
+    const cRegExpSet                                *m_poSet;
+    //! The cached states, the first one is the start state
+    std::vector<tsState>                             m_veStates;
+    //! The transition table, one entry per byte class per state, -1 if not computed yet
+    std::vector<int>                                 m_veTransitions;
+    //! Maps the node lists to the index of the state
+    std::map< std::vector<unsigned int>, unsigned int > m_maStateIds;
+    //! Maximum number of bytes the cached states can use
+    unsigned long                                    m_ulMemoryLimit;
+    //! Estimated number of bytes used by the cached states
+    unsigned long                                    m_ulMemoryUsage;
+    //! Number of times the cache was flushed
+    unsigned int                                     m_uiFlushCount;
+    //! Scratch space of cRegExpSet::closure(): visit marks of the NFA nodes
+    std::vector<unsigned int>                        m_veMarks;
+    //! Scratch space of cRegExpSet::closure(): the current visit mark
+    unsigned int                                     m_uiMark;
+    //! Scratch space of cRegExpSet::closure(): the nodes still to visit
+    std::vector<unsigned int>                        m_veStack;
+    //! Scratch space of cRegExpSet::nextState(): the nodes reached by a byte
+    std::vector<unsigned int>                        m_veSeeds;
+    //! Scratch space of cRegExpSet::nextState(): the node list of the next state
+    std::vector<unsigned int>                        m_veClosure;
+
+    friend class cRegExpSet;
+};
+
+#endif // REGEXPSET_H
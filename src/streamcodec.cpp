@@ -0,0 +1,413 @@
+#include <QFile>
+#include <cstring>
+
+#include "streamcodec.h"
+#include "gzipindex.h"
+
+// Size of the buffers of the compressed data
+static const unsigned int CODEC_INPUT_SIZE = 262144;
+
+// Number of bytes read from the beginning of a file to find its codec
+static const unsigned int CODEC_HEAD_SIZE  = 8;
+
+QString cGzipCodec::name() const throw()
+{
+    return "gzip";
+}
+
+QString cGzipCodec::extension() const throw()
+{
+    return ".gz";
+}
+
+bool cGzipCodec::matches( const QByteArray &p_baHead ) const throw()
+{
+    return p_baHead.startsWith( QByteArray( "\x1f\x8b", 2 ) );
+}
+
+cStreamReader *cGzipCodec::open( const QString &p_qsFileName ) const throw( cSevException )
+{
+    return new cGzipReader( p_qsFileName );
+}
+
+QString cZstdCodec::name() const throw()
+{
+    return "zstd";
+}
+
+QString cZstdCodec::extension() const throw()
+{
+    return ".zst";
+}
+
+bool cZstdCodec::matches( const QByteArray &p_baHead ) const throw()
+{
+    // A zstd frame, or a skippable frame that is usually followed by zstd frames
+    if( p_baHead.startsWith( QByteArray( "\x28\xb5\x2f\xfd", 4 ) ) ) return true;
+
+    return p_baHead.size() >= 4 && ((unsigned char)p_baHead.at( 0 ) & 0xf0) == 0x50 &&
+           p_baHead.mid( 1, 3 ) == QByteArray( "\x2a\x4d\x18", 3 );
+}
+
+cStreamReader *cZstdCodec::open( const QString &p_qsFileName ) const throw( cSevException )
+{
+    return new cZstdReader( p_qsFileName );
+}
+
+QString cXzCodec::name() const throw()
+{
+    return "xz";
+}
+
+QString cXzCodec::extension() const throw()
+{
+    return ".xz";
+}
+
+bool cXzCodec::matches( const QByteArray &p_baHead ) const throw()
+{
+    return p_baHead.startsWith( QByteArray( "\xfd" "7zXZ\x00", 6 ) );
+}
+
+cStreamReader *cXzCodec::open( const QString &p_qsFileName ) const throw( cSevException )
+{
+    return new cXzReader( p_qsFileName );
+}
+
+QString cBzip2Codec::name() const throw()
+{
+    return "bzip2";
+}
+
+QString cBzip2Codec::extension() const throw()
+{
+    return ".bz2";
+}
+
+bool cBzip2Codec::matches( const QByteArray &p_baHead ) const throw()
+{
+    // The block size follows the "BZh" signature as a digit
+    return p_baHead.size() >= 4 && p_baHead.startsWith( "BZh" ) && p_baHead.at( 3 ) >= '1' && p_baHead.at( 3 ) <= '9';
+}
+
+cStreamReader *cBzip2Codec::open( const QString &p_qsFileName ) const throw( cSevException )
+{
+    return new cBzip2Reader( p_qsFileName );
+}
+
+void cCodecRegistry::registerCodec( cStreamCodec *p_poCodec ) throw()
+{
+    codecs().push_back( p_poCodec );
+}
+
+const cStreamCodec *cCodecRegistry::find( const QString &p_qsFileName ) throw()
+{
+    std::vector<cStreamCodec *> &veCodecs = codecs();
+
+    QFile obFile( p_qsFileName );
+    if( obFile.open( QIODevice::ReadOnly ) )
+    {
+        QByteArray baHead = obFile.read( CODEC_HEAD_SIZE );
+        obFile.close();
+
+        for( unsigned int i = 0; i < veCodecs.size(); i++ )
+        {
+            if( veCodecs[i]->matches( baHead ) ) return veCodecs[i];
+        }
+    }
+
+    for( unsigned int i = 0; i < veCodecs.size(); i++ )
+    {
+        if( p_qsFileName.endsWith( veCodecs[i]->extension(), Qt::CaseInsensitive ) ) return veCodecs[i];
+    }
+
+    return NULL;
+}
+
+const cStreamCodec *cCodecRegistry::codec( const QString &p_qsName ) throw()
+{
+    std::vector<cStreamCodec *> &veCodecs = codecs();
+    for( unsigned int i = 0; i < veCodecs.size(); i++ )
+    {
+        if( veCodecs[i]->name() == p_qsName ) return veCodecs[i];
+    }
+
+    return NULL;
+}
+
+QStringList cCodecRegistry::names() throw()
+{
+    QStringList slNames;
+
+    std::vector<cStreamCodec *> &veCodecs = codecs();
+    for( unsigned int i = 0; i < veCodecs.size(); i++ ) slNames.push_back( veCodecs[i]->name() );
+
+    return slNames;
+}
+
+static std::vector<cStreamCodec *> builtInCodecs() throw()
+{
+    std::vector<cStreamCodec *> veCodecs;
+    veCodecs.push_back( new cGzipCodec );
+    veCodecs.push_back( new cZstdCodec );
+    veCodecs.push_back( new cXzCodec );
+    veCodecs.push_back( new cBzip2Codec );
+
+    return veCodecs;
+}
+
+std::vector<cStreamCodec *> &cCodecRegistry::codecs() throw()
+{
+    // The codecs live as long as the program. The initialization of the static is
+    // thread-safe, so the first call can come from any thread.
+    static std::vector<cStreamCodec *> veCodecs = builtInCodecs();
+
+    return veCodecs;
+}
+
+cZstdReader::cZstdReader( const QString &p_qsFileName ) throw( cSevException )
+{
+    m_qsFileName  = p_qsFileName;
+    m_poStream    = NULL;
+    m_boInFrame   = false;
+    m_boPending   = false;
+    m_boEnd       = false;
+    m_boTruncated = false;
+
+    m_obFile.setFileName( m_qsFileName );
+    if( !m_obFile.open( QIODevice::ReadOnly ) )
+    {
+        throw cSevException( cSeverity::ERROR, QString( "Cannot open Input Log File %1: %2" ).arg( m_qsFileName ).arg( m_obFile.errorString() ).toStdString() );
+    }
+
+    m_veInput.resize( CODEC_INPUT_SIZE );
+    m_suInput.src  = &m_veInput[0];
+    m_suInput.size = 0;
+    m_suInput.pos  = 0;
+
+    m_poStream = ZSTD_createDStream();
+    if( !m_poStream || ZSTD_isError( ZSTD_initDStream( m_poStream ) ) )
+    {
+        ZSTD_freeDStream( m_poStream );
+        throw cSevException( cSeverity::ERROR, QString( "Cannot initialize decompressing zstd file %1" ).arg( m_qsFileName ).toStdString() );
+    }
+}
+
+cZstdReader::~cZstdReader() throw()
+{
+    ZSTD_freeDStream( m_poStream );
+}
+
+unsigned int cZstdReader::read( char *p_poBuffer, const unsigned int p_uiSize ) throw( cSevException )
+{
+    ZSTD_outBuffer suOutput;
+    suOutput.dst  = p_poBuffer;
+    suOutput.size = p_uiSize;
+    suOutput.pos  = 0;
+
+    while( suOutput.pos < suOutput.size && !m_boEnd )
+    {
+        if( m_suInput.pos == m_suInput.size && !m_boPending && !fill() )
+        {
+            m_boEnd       = true;
+            m_boTruncated = m_boInFrame;
+            break;
+        }
+
+        size_t uiResult = ZSTD_decompressStream( m_poStream, &suOutput, &m_suInput );
+        if( ZSTD_isError( uiResult ) )
+        {
+            throw cSevException( cSeverity::ERROR, QString( "Error decompressing zstd file %1: %2" ).arg( m_qsFileName ).arg( ZSTD_getErrorName( uiResult ) ).toStdString() );
+        }
+        m_boInFrame = uiResult != 0;
+        m_boPending = suOutput.pos == suOutput.size;
+    }
+
+    return suOutput.pos;
+}
+
+bool cZstdReader::truncated() const throw()
+{
+    return m_boTruncated;
+}
+
+bool cZstdReader::fill() throw( cSevException )
+{
+    qint64 inRead = m_obFile.read( &m_veInput[0], m_veInput.size() );
+    if( inRead < 0 )
+    {
+        throw cSevException( cSeverity::ERROR, QString( "Error reading zstd file %1: %2" ).arg( m_qsFileName ).arg( m_obFile.errorString() ).toStdString() );
+    }
+
+    m_suInput.size = inRead;
+    m_suInput.pos  = 0;
+
+    return inRead > 0;
+}
+
+cXzReader::cXzReader( const QString &p_qsFileName ) throw( cSevException )
+{
+    lzma_stream suInit = LZMA_STREAM_INIT;
+
+    m_qsFileName  = p_qsFileName;
+    m_suStream    = suInit;
+    m_boInputEnd  = false;
+    m_boEnd       = false;
+    m_boTruncated = false;
+
+    m_obFile.setFileName( m_qsFileName );
+    if( !m_obFile.open( QIODevice::ReadOnly ) )
+    {
+        throw cSevException( cSeverity::ERROR, QString( "Cannot open Input Log File %1: %2" ).arg( m_qsFileName ).arg( m_obFile.errorString() ).toStdString() );
+    }
+
+    m_veInput.resize( CODEC_INPUT_SIZE );
+    if( lzma_stream_decoder( &m_suStream, UINT64_MAX, LZMA_CONCATENATED ) != LZMA_OK )
+    {
+        throw cSevException( cSeverity::ERROR, QString( "Cannot initialize decompressing xz file %1" ).arg( m_qsFileName ).toStdString() );
+    }
+}
+
+cXzReader::~cXzReader() throw()
+{
+    lzma_end( &m_suStream );
+}
+
+unsigned int cXzReader::read( char *p_poBuffer, const unsigned int p_uiSize ) throw( cSevException )
+{
+    m_suStream.next_out  = (uint8_t *)p_poBuffer;
+    m_suStream.avail_out = p_uiSize;
+
+    while( m_suStream.avail_out && !m_boEnd )
+    {
+        if( !m_suStream.avail_in && !m_boInputEnd && !fill() ) m_boInputEnd = true;
+
+        // The end of the input has to be told to the decoder of concatenated streams
+        lzma_ret enResult = lzma_code( &m_suStream, m_boInputEnd ? LZMA_FINISH : LZMA_RUN );
+        if( enResult == LZMA_STREAM_END )
+        {
+            m_boEnd = true;
+            break;
+        }
+        if( enResult == LZMA_BUF_ERROR && m_boInputEnd )
+        {
+            m_boEnd       = true;
+            m_boTruncated = true;
+            break;
+        }
+        if( enResult != LZMA_OK )
+        {
+            throw cSevException( cSeverity::ERROR, QString( "Error decompressing xz file %1: error %2" ).arg( m_qsFileName ).arg( (int)enResult ).toStdString() );
+        }
+    }
+
+    return p_uiSize - m_suStream.avail_out;
+}
+
+bool cXzReader::truncated() const throw()
+{
+    return m_boTruncated;
+}
+
+bool cXzReader::fill() throw( cSevException )
+{
+    qint64 inRead = m_obFile.read( &m_veInput[0], m_veInput.size() );
+    if( inRead < 0 )
+    {
+        throw cSevException( cSeverity::ERROR, QString( "Error reading xz file %1: %2" ).arg( m_qsFileName ).arg( m_obFile.errorString() ).toStdString() );
+    }
+
+    m_suStream.next_in  = (const uint8_t *)&m_veInput[0];
+    m_suStream.avail_in = inRead;
+
+    return inRead > 0;
+}
+
+cBzip2Reader::cBzip2Reader( const QString &p_qsFileName ) throw( cSevException )
+{
+    m_qsFileName  = p_qsFileName;
+    m_boInStream  = false;
+    m_boPending   = false;
+    m_boEnd       = false;
+    m_boTruncated = false;
+    memset( &m_suStream, 0, sizeof( m_suStream ) );
+
+    m_obFile.setFileName( m_qsFileName );
+    if( !m_obFile.open( QIODevice::ReadOnly ) )
+    {
+        throw cSevException( cSeverity::ERROR, QString( "Cannot open Input Log File %1: %2" ).arg( m_qsFileName ).arg( m_obFile.errorString() ).toStdString() );
+    }
+
+    m_veInput.resize( CODEC_INPUT_SIZE );
+}
+
+cBzip2Reader::~cBzip2Reader() throw()
+{
+    if( m_boInStream ) BZ2_bzDecompressEnd( &m_suStream );
+}
+
+unsigned int cBzip2Reader::read( char *p_poBuffer, const unsigned int p_uiSize ) throw( cSevException )
+{
+    m_suStream.next_out  = p_poBuffer;
+    m_suStream.avail_out = p_uiSize;
+
+    while( m_suStream.avail_out && !m_boEnd )
+    {
+        if( !m_suStream.avail_in && !(m_boInStream && m_boPending) && !fill() )
+        {
+            m_boEnd       = true;
+            m_boTruncated = m_boInStream;
+            break;
+        }
+
+        if( !m_boInStream )
+        {
+            // Anything but a bzip2 header after a stream is ignored
+            if( *m_suStream.next_in != 'B' )
+            {
+                m_boEnd = true;
+                break;
+            }
+            if( BZ2_bzDecompressInit( &m_suStream, 0, 0 ) != BZ_OK )
+            {
+                throw cSevException( cSeverity::ERROR, QString( "Cannot initialize decompressing bzip2 file %1" ).arg( m_qsFileName ).toStdString() );
+            }
+            m_boInStream = true;
+        }
+
+        int inResult = BZ2_bzDecompress( &m_suStream );
+        if( inResult == BZ_STREAM_END )
+        {
+            BZ2_bzDecompressEnd( &m_suStream );
+            m_boInStream = false;
+            m_boPending  = false;
+            continue;
+        }
+        if( inResult != BZ_OK )
+        {
+            throw cSevException( cSeverity::ERROR, QString( "Error decompressing bzip2 file %1: error %2" ).arg( m_qsFileName ).arg( inResult ).toStdString() );
+        }
+        m_boPending = !m_suStream.avail_out;
+    }
+
+    return p_uiSize - m_suStream.avail_out;
+}
+
+bool cBzip2Reader::truncated() const throw()
+{
+    return m_boTruncated;
+}
+
+bool cBzip2Reader::fill() throw( cSevException )
+{
+    qint64 inRead = m_obFile.read( &m_veInput[0], m_veInput.size() );
+    if( inRead < 0 )
+    {
+        throw cSevException( cSeverity::ERROR, QString( "Error reading bzip2 file %1: %2" ).arg( m_qsFileName ).arg( m_obFile.errorString() ).toStdString() );
+    }
+
+    m_suStream.next_in  = &m_veInput[0];
+    m_suStream.avail_in = inRead;
+
+    return inRead > 0;
+}
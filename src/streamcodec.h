@@ -0,0 +1,257 @@
+#ifndef STREAMCODEC_H
+#define STREAMCODEC_H
+
+#include <QString>
+#include <QStringList>
+#include <QByteArray>
+#include <QFile>
+#include <vector>
+#include <zstd.h>
+#include <lzma.h>
+#include <bzlib.h>
+
+#include <sevexception.h>
+
+//! \brief Reads the decompressed data of a compressed file
+/*! The file is decompressed while it is read, so the decompressed data is never stored
+ *  anywhere but in the buffer of the caller. Each reader has its own file handle and
+ *  decompression state.
+ */
+class cStreamReader
+{
+public:
+    //! \brief Destructor that closes the file
+    virtual ~cStreamReader() throw() {}
+
+    //! \brief Reads the next part of the decompressed data
+    /*! \param p_poBuffer the buffer that receives the data
+     *  \param p_uiSize size of the buffer in bytes
+     *  \return The number of bytes read, less than p_uiSize only at the end of the data
+     */
+    virtual unsigned int read( char *p_poBuffer, const unsigned int p_uiSize ) throw( cSevException ) = 0;
+
+    //! \brief Returns <tt>true</tt> if the file ended in the middle of the compressed data
+    virtual bool         truncated() const throw() = 0;
+};
+
+//! \brief A compression format the Input Log Files can be stored in
+/*! A codec recognizes its files by the magic bytes at their beginning or by their
+ *  extension, and creates the cStreamReader that decompresses them. The codecs are
+ *  collected by cCodecRegistry.
+ */
+class cStreamCodec
+{
+public:
+    //! \brief Destructor
+    virtual ~cStreamCodec() throw() {}
+
+    //! \brief Returns the name of the codec, for example "gzip"
+    virtual QString       name() const throw() = 0;
+
+    //! \brief Returns the file name extension of the codec, including the '.'
+    virtual QString       extension() const throw() = 0;
+
+    //! \brief Returns <tt>true</tt> if the data starts with the magic bytes of the codec
+    /*! \param p_baHead the first few bytes of the file, maybe less if the file is short
+     */
+    virtual bool          matches( const QByteArray &p_baHead ) const throw() = 0;
+
+    //! \brief Opens the given file for decompressing
+    /*! \return The reader of the file, owned by the caller
+     */
+    virtual cStreamReader *open( const QString &p_qsFileName ) const throw( cSevException ) = 0;
+};
+
+//! \brief The gzip codec, read by cGzipReader
+class cGzipCodec : public cStreamCodec
+{
+public:
+    QString        name() const throw();
+    QString        extension() const throw();
+    bool           matches( const QByteArray &p_baHead ) const throw();
+    cStreamReader *open( const QString &p_qsFileName ) const throw( cSevException );
+};
+
+//! \brief The zstd codec, read by cZstdReader
+class cZstdCodec : public cStreamCodec
+{
+public:
+    QString        name() const throw();
+    QString        extension() const throw();
+    bool           matches( const QByteArray &p_baHead ) const throw();
+    cStreamReader *open( const QString &p_qsFileName ) const throw( cSevException );
+};
+
+//! \brief The xz codec, read by cXzReader
+class cXzCodec : public cStreamCodec
+{
+public:
+    QString        name() const throw();
+    QString        extension() const throw();
+    bool           matches( const QByteArray &p_baHead ) const throw();
+    cStreamReader *open( const QString &p_qsFileName ) const throw( cSevException );
+};
+
+//! \brief The bzip2 codec, read by cBzip2Reader
+class cBzip2Codec : public cStreamCodec
+{
+public:
+    QString        name() const throw();
+    QString        extension() const throw();
+    bool           matches( const QByteArray &p_baHead ) const throw();
+    cStreamReader *open( const QString &p_qsFileName ) const throw( cSevException );
+};
+
+//! \brief Collects the codecs of the compressed Input Log Files
+/*! The gzip, zstd, xz and bzip2 codecs are registered when the registry is first used,
+ *  further codecs can be added with registerCodec(). A file is assigned to the first codec
+ *  whose magic bytes it starts with, and only if there is none, to the first codec whose
+ *  extension it has. So a compressed file is recognized whatever its name is, for example
+ *  after log rotation renamed it to <tt>server.log.1</tt>.
+ *
+ *  The codecs are registered at start-up and only read afterwards, so the registry can be
+ *  used by several threads.
+ */
+class cCodecRegistry
+{
+public:
+    //! \brief Adds a codec to the registry
+    /*! \param p_poCodec the codec, owned by the registry from now on
+     */
+    static void                registerCodec( cStreamCodec *p_poCodec ) throw();
+
+    //! \brief Returns the codec of the given file
+    /*! \return The codec, or NULL if the file is not compressed with any of the codecs
+     */
+    static const cStreamCodec *find( const QString &p_qsFileName ) throw();
+
+    //! \brief Returns the codec with the given name, NULL if there is no such codec
+    static const cStreamCodec *codec( const QString &p_qsName ) throw();
+
+    //! \brief Returns the names of the registered codecs
+    static QStringList         names() throw();
+
+private:
+    //! \brief Returns the registered codecs, registering the built-in ones at the first call
+    static std::vector<cStreamCodec *> &codecs() throw();
+};
+
+//! \brief Decompresses a zstd compressed file
+/*! Files made of several zstd frames are read frame by frame, as a single stream.
+ */
+class cZstdReader : public cStreamReader
+{
+public:
+    //! \brief Constructor that opens the given file
+    cZstdReader( const QString &p_qsFileName ) throw( cSevException );
+
+    //! \brief Destructor that closes the file
+    ~cZstdReader() throw();
+
+    unsigned int        read( char *p_poBuffer, const unsigned int p_uiSize ) throw( cSevException );
+    bool                truncated() const throw();
+
+private:
+    //! Name of the file, used in error messages
+    QString             m_qsFileName;
+    //! The compressed file
+    QFile               m_obFile;
+    //! The decompression state
+    ZSTD_DStream       *m_poStream;
+    //! The buffer of the compressed data
+    std::vector<char>   m_veInput;
+    //! The compressed data not yet decompressed
+    ZSTD_inBuffer       m_suInput;
+    //! True while a frame is not completely decompressed
+    bool                m_boInFrame;
+    //! True if the last call filled the output, so there can be more output without input
+    bool                m_boPending;
+    //! True when the end of the compressed data is reached
+    bool                m_boEnd;
+    //! True if the file ended in the middle of a frame
+    bool                m_boTruncated;
+
+    //! \brief Reads the next part of the compressed file into m_veInput
+    /*! \return <tt>false</tt> at the end of the file
+     */
+    bool                fill() throw( cSevException );
+};
+
+//! \brief Decompresses an xz compressed file
+/*! Files made of several xz streams are read as a single stream.
+ */
+class cXzReader : public cStreamReader
+{
+public:
+    //! \brief Constructor that opens the given file
+    cXzReader( const QString &p_qsFileName ) throw( cSevException );
+
+    //! \brief Destructor that closes the file
+    ~cXzReader() throw();
+
+    unsigned int        read( char *p_poBuffer, const unsigned int p_uiSize ) throw( cSevException );
+    bool                truncated() const throw();
+
+private:
+    //! Name of the file, used in error messages
+    QString             m_qsFileName;
+    //! The compressed file
+    QFile               m_obFile;
+    //! The decompression state
+    lzma_stream         m_suStream;
+    //! The buffer of the compressed data
+    std::vector<char>   m_veInput;
+    //! True when the end of the compressed file is reached
+    bool                m_boInputEnd;
+    //! True when the end of the compressed data is reached
+    bool                m_boEnd;
+    //! True if the file ended in the middle of a stream
+    bool                m_boTruncated;
+
+    //! \brief Reads the next part of the compressed file into m_veInput
+    /*! \return <tt>false</tt> at the end of the file
+     */
+    bool                fill() throw( cSevException );
+};
+
+//! \brief Decompresses a bzip2 compressed file
+/*! Files made of several bzip2 streams (for example made by pbzip2) are read as a single
+ *  stream. Data following the last stream that is not a bzip2 header is ignored.
+ */
+class cBzip2Reader : public cStreamReader
+{
+public:
+    //! \brief Constructor that opens the given file
+    cBzip2Reader( const QString &p_qsFileName ) throw( cSevException );
+
+    //! \brief Destructor that closes the file
+    ~cBzip2Reader() throw();
+
+    unsigned int        read( char *p_poBuffer, const unsigned int p_uiSize ) throw( cSevException );
+    bool                truncated() const throw();
+
+private:
+    //! Name of the file, used in error messages
+    QString             m_qsFileName;
+    //! The compressed file
+    QFile               m_obFile;
+    //! The decompression state
+    bz_stream           m_suStream;
+    //! The buffer of the compressed data
+    std::vector<char>   m_veInput;
+    //! True while decompressing a stream, false in between streams
+    bool                m_boInStream;
+    //! True if the last call filled the output, so there can be more output without input
+    bool                m_boPending;
+    //! True when the end of the compressed data is reached
+    bool                m_boEnd;
+    //! True if the file ended in the middle of a stream
+    bool                m_boTruncated;
+
+    //! \brief Reads the next part of the compressed file into m_veInput
+    /*! \return <tt>false</tt> at the end of the file
+     */
+    bool                fill() throw( cSevException );
+};
+
+#endif // STREAMCODEC_H
@@ -0,0 +1,371 @@
+#include <cstring>
+
+#include "syserrordecoder.h"
+
+#if defined( __GNUC__ ) && ( defined( __x86_64__ ) || defined( __i386__ ) )
+#define LARA_X86_KERNELS
+#include <immintrin.h>
+#endif
+
+// The Key the encrypted tags are XOR-ed with
+static const unsigned char s_poKey[8] = { 115, 3, 23, 8, 120, 6, 22, 111 };
+
+// Type of the kernel functions, selected at runtime
+typedef unsigned int (*tfDecodeTag)( const char *, const unsigned int, char * );
+
+static unsigned int decodeTagScalar( const char *p_poTag, const unsigned int p_uiLength, char *p_poOutput )
+{
+    unsigned int  uiBuffer  = 0;
+    int           inBits    = 0;
+    unsigned int  uiDecoded = 0;
+    unsigned int  uiWritten = 0;
+
+    for( unsigned int i = 0; i < p_uiLength; i++ )
+    {
+        char chChar = p_poTag[i];
+        int  inValue;
+        if( chChar >= 'A' && chChar <= 'Z' )      inValue = chChar - 'A';
+        else if( chChar >= 'a' && chChar <= 'z' ) inValue = chChar - 'a' + 26;
+        else if( chChar >= '0' && chChar <= '9' ) inValue = chChar - '0' + 52;
+        else if( chChar == '+' )                   inValue = 62;
+        else if( chChar == '/' )                   inValue = 63;
+        else continue;
+
+        uiBuffer = (uiBuffer << 6) | inValue;
+        inBits += 6;
+        if( inBits < 8 ) continue;
+
+        inBits -= 8;
+        unsigned char ucDecoded = (unsigned char)(uiBuffer >> inBits) ^ s_poKey[uiDecoded++ % 8];
+        uiBuffer &= (1 << inBits) - 1;
+
+        if( ucDecoded == 0 ) continue;
+        p_poOutput[uiWritten++] = ucDecoded == '\n' ? ' ' : (char)ucDecoded;
+    }
+
+    return uiWritten;
+}
+
+#ifdef LARA_X86_KERNELS
+
+// The 6 bit value of each base64 character, -1 for the other characters
+static signed char s_poBase64Values[256];
+
+static bool buildBase64Values()
+{
+    const char *poAlphabet = "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/";
+    memset( s_poBase64Values, -1, sizeof( s_poBase64Values ) );
+    for( int i = 0; i < 64; i++ ) s_poBase64Values[(unsigned char)poAlphabet[i]] = i;
+    return true;
+}
+
+static bool s_boBase64ValuesBuilt = buildBase64Values();
+
+// Decodes base64 characters without applying the Key, skipping the invalid characters
+static unsigned int decodeBase64Scalar( const char *p_poText, const unsigned int p_uiLength, char *p_poOutput )
+{
+    unsigned int  uiBuffer  = 0;
+    int           inBits    = 0;
+    unsigned int  uiWritten = 0;
+
+    for( unsigned int i = 0; i < p_uiLength; i++ )
+    {
+        int inValue = s_poBase64Values[(unsigned char)p_poText[i]];
+        if( inValue < 0 ) continue;
+
+        uiBuffer = (uiBuffer << 6) | inValue;
+        inBits += 6;
+        if( inBits < 8 ) continue;
+
+        inBits -= 8;
+        p_poOutput[uiWritten++] = (char)(uiBuffer >> inBits);
+        uiBuffer &= (1 << inBits) - 1;
+    }
+
+    return uiWritten;
+}
+
+// Applies the Key 8 bytes at a time, then drops the zero bytes and replaces the new line
+// characters, the same way decodeTagScalar() does
+static unsigned int applyKey( char *p_poData, const unsigned int p_uiLength )
+{
+    const unsigned long long ullOnes  = 0x0101010101010101ULL;
+    const unsigned long long ullHighs = 0x8080808080808080ULL;
+    const unsigned long long ullLines = ullOnes * '\n';
+
+    unsigned long long ullKey;
+    memcpy( &ullKey, s_poKey, 8 );
+
+    // The Key is applied from the first decoded byte, so its position only depends on the index
+    unsigned long long ullSpecial = 0;
+    unsigned int       i          = 0;
+    for( ; i + 8 <= p_uiLength; i += 8 )
+    {
+        unsigned long long ullWord;
+        memcpy( &ullWord, p_poData + i, 8 );
+        ullWord ^= ullKey;
+        memcpy( p_poData + i, &ullWord, 8 );
+
+        unsigned long long ullLine = ullWord ^ ullLines;
+        ullSpecial |= ((ullWord - ullOnes) & ~ullWord & ullHighs) | ((ullLine - ullOnes) & ~ullLine & ullHighs);
+    }
+    for( ; i < p_uiLength; i++ )
+    {
+        p_poData[i] ^= s_poKey[i % 8];
+        if( p_poData[i] == 0 || p_poData[i] == '\n' ) ullSpecial = 1;
+    }
+
+    if( !ullSpecial ) return p_uiLength;
+
+    unsigned int uiWritten = 0;
+    for( i = 0; i < p_uiLength; i++ )
+    {
+        if( p_poData[i] == 0 ) continue;
+        p_poData[uiWritten++] = p_poData[i] == '\n' ? ' ' : p_poData[i];
+    }
+
+    return uiWritten;
+}
+
+// Base64 decoding with vector lookups, see W. Mula and D. Lemire: Faster Base64 Encoding and
+// Decoding Using AVX2 Instructions. The nibble lookups flag every character outside of the
+// alphabet, the roll lookup turns the characters to their 6 bit values, and the multiply-add
+// instructions pack four 6 bit values into three bytes.
+
+// Decodes 16 characters at a time from *p_puiIn as long as they are all valid, the
+// characters before *p_puiIn must all be valid too. It is inlined into the AVX2 kernel as
+// well, so no switch between legacy SSE and AVX encoded instructions happens there.
+__attribute__(( target( "ssse3" ), always_inline ))
+static inline void decodeRunSSSE3( const char *p_poTag, const unsigned int p_uiLength, char *p_poOutput,
+                            unsigned int *p_puiIn, unsigned int *p_puiOut )
+{
+    const __m128i obLutLo   = _mm_setr_epi8( 0x15, 0x11, 0x11, 0x11, 0x11, 0x11, 0x11, 0x11,
+                                             0x11, 0x11, 0x13, 0x1A, 0x1B, 0x1B, 0x1B, 0x1A );
+    const __m128i obLutHi   = _mm_setr_epi8( 0x10, 0x10, 0x01, 0x02, 0x04, 0x08, 0x04, 0x08,
+                                             0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10 );
+    const __m128i obLutRoll = _mm_setr_epi8( 0, 16, 19, 4, -65, -65, -71, -71,
+                                             0, 0, 0, 0, 0, 0, 0, 0 );
+    const __m128i obMask2F  = _mm_set1_epi8( 0x2F );
+    const __m128i obZero    = _mm_setzero_si128();
+    const __m128i obPack    = _mm_setr_epi8( 2, 1, 0, 6, 5, 4, 10, 9, 8, 14, 13, 12, -1, -1, -1, -1 );
+
+    unsigned int uiIn  = *p_puiIn;
+    unsigned int uiOut = *p_puiOut;
+
+    // Each step stores 16 bytes for the 12 decoded ones, the output has room for them as
+    // long as at least 22 characters are left
+    for( ; p_uiLength - uiIn >= 22; uiIn += 16, uiOut += 12 )
+    {
+        __m128i obText = _mm_loadu_si128( (const __m128i *)(p_poTag + uiIn) );
+        __m128i obHiNibbles = _mm_and_si128( _mm_srli_epi32( obText, 4 ), obMask2F );
+        __m128i obLo = _mm_shuffle_epi8( obLutLo, _mm_and_si128( obText, obMask2F ) );
+        __m128i obHi = _mm_shuffle_epi8( obLutHi, obHiNibbles );
+        if( _mm_movemask_epi8( _mm_cmpeq_epi8( _mm_and_si128( obLo, obHi ), obZero ) ) != 0xFFFF ) break;
+
+        __m128i obRoll = _mm_shuffle_epi8( obLutRoll, _mm_add_epi8( _mm_cmpeq_epi8( obText, obMask2F ), obHiNibbles ) );
+        __m128i obValues = _mm_add_epi8( obText, obRoll );
+        obValues = _mm_maddubs_epi16( obValues, _mm_set1_epi32( 0x01400140 ) );
+        obValues = _mm_madd_epi16( obValues, _mm_set1_epi32( 0x00011000 ) );
+        _mm_storeu_si128( (__m128i *)(p_poOutput + uiOut), _mm_shuffle_epi8( obValues, obPack ) );
+    }
+
+    *p_puiIn  = uiIn;
+    *p_puiOut = uiOut;
+}
+
+__attribute__(( target( "ssse3" ) ))
+static unsigned int decodeTagSSSE3( const char *p_poTag, const unsigned int p_uiLength, char *p_poOutput )
+{
+    unsigned int uiIn  = 0;
+    unsigned int uiOut = 0;
+
+    decodeRunSSSE3( p_poTag, p_uiLength, p_poOutput, &uiIn, &uiOut );
+    uiOut += decodeBase64Scalar( p_poTag + uiIn, p_uiLength - uiIn, p_poOutput + uiOut );
+    return applyKey( p_poOutput, uiOut );
+}
+
+__attribute__(( target( "avx2" ) ))
+static unsigned int decodeTagAVX2( const char *p_poTag, const unsigned int p_uiLength, char *p_poOutput )
+{
+    const __m256i obLutLo   = _mm256_setr_epi8( 0x15, 0x11, 0x11, 0x11, 0x11, 0x11, 0x11, 0x11,
+                                                0x11, 0x11, 0x13, 0x1A, 0x1B, 0x1B, 0x1B, 0x1A,
+                                                0x15, 0x11, 0x11, 0x11, 0x11, 0x11, 0x11, 0x11,
+                                                0x11, 0x11, 0x13, 0x1A, 0x1B, 0x1B, 0x1B, 0x1A );
+    const __m256i obLutHi   = _mm256_setr_epi8( 0x10, 0x10, 0x01, 0x02, 0x04, 0x08, 0x04, 0x08,
+                                                0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10,
+                                                0x10, 0x10, 0x01, 0x02, 0x04, 0x08, 0x04, 0x08,
+                                                0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10 );
+    const __m256i obLutRoll = _mm256_setr_epi8( 0, 16, 19, 4, -65, -65, -71, -71,
+                                                0, 0, 0, 0, 0, 0, 0, 0,
+                                                0, 16, 19, 4, -65, -65, -71, -71,
+                                                0, 0, 0, 0, 0, 0, 0, 0 );
+    const __m256i obMask2F  = _mm256_set1_epi8( 0x2F );
+    const __m256i obPack    = _mm256_setr_epi8( 2, 1, 0, 6, 5, 4, 10, 9, 8, 14, 13, 12, -1, -1, -1, -1,
+                                                2, 1, 0, 6, 5, 4, 10, 9, 8, 14, 13, 12, -1, -1, -1, -1 );
+    const __m256i obLanes   = _mm256_setr_epi32( 0, 1, 2, 4, 5, 6, 7, 7 );
+
+    unsigned int uiIn  = 0;
+    unsigned int uiOut = 0;
+
+    // Each step stores 32 bytes for the 24 decoded ones, the output has room for them as
+    // long as at least 43 characters are left
+    for( ; p_uiLength - uiIn >= 43; uiIn += 32, uiOut += 24 )
+    {
+        __m256i obText = _mm256_loadu_si256( (const __m256i *)(p_poTag + uiIn) );
+        __m256i obHiNibbles = _mm256_and_si256( _mm256_srli_epi32( obText, 4 ), obMask2F );
+        __m256i obLo = _mm256_shuffle_epi8( obLutLo, _mm256_and_si256( obText, obMask2F ) );
+        __m256i obHi = _mm256_shuffle_epi8( obLutHi, obHiNibbles );
+        if( !_mm256_testz_si256( obLo, obHi ) ) break;
+
+        __m256i obRoll = _mm256_shuffle_epi8( obLutRoll, _mm256_add_epi8( _mm256_cmpeq_epi8( obText, obMask2F ), obHiNibbles ) );
+        __m256i obValues = _mm256_add_epi8( obText, obRoll );
+        obValues = _mm256_maddubs_epi16( obValues, _mm256_set1_epi32( 0x01400140 ) );
+        obValues = _mm256_madd_epi16( obValues, _mm256_set1_epi32( 0x00011000 ) );
+        obValues = _mm256_permutevar8x32_epi32( _mm256_shuffle_epi8( obValues, obPack ), obLanes );
+        _mm256_storeu_si256( (__m256i *)(p_poOutput + uiOut), obValues );
+    }
+
+    // The rest of the tag, usually less than 43 characters, is decoded 16 at a time
+    decodeRunSSSE3( p_poTag, p_uiLength, p_poOutput, &uiIn, &uiOut );
+    uiOut += decodeBase64Scalar( p_poTag + uiIn, p_uiLength - uiIn, p_poOutput + uiOut );
+    return applyKey( p_poOutput, uiOut );
+}
+
+#endif // LARA_X86_KERNELS
+
+// The kernel starts out as the function selecting the best kernel on its first call
+static unsigned int decodeTagFirst( const char *p_poTag, const unsigned int p_uiLength, char *p_poOutput );
+
+static cSysErrorDecoder::teKernel  s_enKernel      = cSysErrorDecoder::SCALAR;
+static tfDecodeTag                 s_pfDecodeTag   = decodeTagFirst;
+
+static void selectKernel()
+{
+    if( s_pfDecodeTag == decodeTagFirst ) cSysErrorDecoder::setKernel( cSysErrorDecoder::bestKernel() );
+}
+
+static unsigned int decodeTagFirst( const char *p_poTag, const unsigned int p_uiLength, char *p_poOutput )
+{
+    selectKernel();
+    return s_pfDecodeTag( p_poTag, p_uiLength, p_poOutput );
+}
+
+cSysErrorDecoder::cSysErrorDecoder( const bool p_boHeader ) throw()
+{
+    m_boFirstLine = p_boHeader;
+}
+
+cSysErrorDecoder::~cSysErrorDecoder() throw()
+{
+}
+
+void cSysErrorDecoder::decodeBlock( const char *p_poBegin, const char *p_poEnd,
+                                    std::vector<char> *p_poOutput ) throw()
+{
+    // Decoding never makes a line longer, so the output fits the size of the block
+    p_poOutput->resize( p_poEnd - p_poBegin );
+    if( p_poBegin == p_poEnd ) return;
+
+    char *poOut = &(*p_poOutput)[0];
+    for( const char *poLine = p_poBegin; poLine < p_poEnd; )
+    {
+        const char *poNewLine = (const char *)memchr( poLine, '\n', p_poEnd - poLine );
+        const char *poLineEnd = poNewLine ? poNewLine : p_poEnd;
+        const char *poTextEnd = poLineEnd;
+        if( poTextEnd > poLine && poTextEnd[-1] == '\r' ) poTextEnd--;
+
+        if( m_boFirstLine )
+        {
+            memcpy( poOut, poLine, poTextEnd - poLine );
+            poOut += poTextEnd - poLine;
+            m_boFirstLine = false;
+        }
+        else
+        {
+            unsigned int uiTag = 0;
+            for( const char *poTag = poLine; ; uiTag++ )
+            {
+                const char *poComma  = (const char *)memchr( poTag, ',', poTextEnd - poTag );
+                const char *poTagEnd = poComma ? poComma : poTextEnd;
+
+                if( uiTag == 5 || uiTag == 9 || uiTag == 10 || uiTag == 11 )
+                {
+                    poOut += decodeTag( poTag, poTagEnd - poTag, poOut );
+                }
+                else
+                {
+                    memcpy( poOut, poTag, poTagEnd - poTag );
+                    poOut += poTagEnd - poTag;
+                }
+
+                if( !poComma ) break;
+                *poOut++ = ',';
+                poTag = poComma + 1;
+            }
+        }
+
+        if( !poNewLine ) break;
+        *poOut++ = '\n';
+        poLine = poNewLine + 1;
+    }
+
+    p_poOutput->resize( poOut - &(*p_poOutput)[0] );
+}
+
+unsigned int cSysErrorDecoder::decodeTag( const char *p_poTag, const unsigned int p_uiLength,
+                                          char *p_poOutput ) throw()
+{
+    return s_pfDecodeTag( p_poTag, p_uiLength, p_poOutput );
+}
+
+cSysErrorDecoder::teKernel cSysErrorDecoder::kernel() throw()
+{
+    selectKernel();
+    return s_enKernel;
+}
+
+bool cSysErrorDecoder::setKernel( const teKernel p_enKernel ) throw()
+{
+    switch( p_enKernel )
+    {
+        case SCALAR:
+            s_pfDecodeTag = decodeTagScalar;
+            break;
+#ifdef LARA_X86_KERNELS
+        case SSSE3:
+            if( !__builtin_cpu_supports( "ssse3" ) ) return false;
+            s_pfDecodeTag = decodeTagSSSE3;
+            break;
+        case AVX2:
+            if( !__builtin_cpu_supports( "avx2" ) ) return false;
+            s_pfDecodeTag = decodeTagAVX2;
+            break;
+#endif
+        default:
+            return false;
+    }
+
+    s_enKernel = p_enKernel;
+    return true;
+}
+
+cSysErrorDecoder::teKernel cSysErrorDecoder::bestKernel() throw()
+{
+#ifdef LARA_X86_KERNELS
+    __builtin_cpu_init();
+    if( __builtin_cpu_supports( "avx2" ) )  return AVX2;
+    if( __builtin_cpu_supports( "ssse3" ) ) return SSSE3;
+#endif
+    return SCALAR;
+}
+
+const char *cSysErrorDecoder::toStr( const teKernel p_enKernel ) throw()
+{
+    switch( p_enKernel )
+    {
+        case SCALAR: return "SCALAR"; break;
+        case SSSE3:  return "SSSE3";  break;
+        case AVX2:   return "AVX2";   break;
+        default:     return "INVALID";
+    }
+}
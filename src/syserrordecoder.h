@@ -0,0 +1,92 @@
+#ifndef SYSERRORDECODER_H
+#define SYSERRORDECODER_H
+
+#include <vector>
+
+//! \brief Decodes the encrypted tags of sysError log files
+/*! sysError log files are text files, each line consists of several 'tags' that are
+ *  separated by commas. In each line the 5th, 9th, 10th and 11th tags (counting from 0) are
+ *  base64 encoded and XOR-ed with an 8 bytes long Key, the rest of the tags and the first
+ *  line of the file (a header) are plain text.
+ *
+ *  The decoder works on blocks of whole Log Lines as returned by cLineReader, and writes the
+ *  decoded lines into a buffer that is reused for every block, so decoding a file needs no
+ *  memory allocation per line. Both the files read in place (see cLineReader) and the files
+ *  prepared in the Temporary Directory (see cLogDataSource::decodeFile()) are decoded by it.
+ *  The tags are decoded like cLogDataSource::decodeString() does:
+ *  \li characters that are not part of the base64 alphabet (including the '=' padding) are
+ *      skipped, like QByteArray::fromBase64() does
+ *  \li decoded zero bytes are dropped
+ *  \li a '\\r' character at the end of a line is removed
+ *
+ *  A decoded new line character would split the Log Line in two, so it is replaced by a
+ *  space. This keeps the line numbers the same as in the sysError file.
+ *
+ *  The fastest tag decoding kernel supported by the CPU is selected when the first tag is
+ *  decoded, unless one is selected with setKernel() before.
+ */
+class cSysErrorDecoder
+{
+public:
+    //! The available implementations of the tag decoding kernel
+    enum teKernel
+    {
+        SCALAR = 0,     //!< byte by byte reference implementation
+        SSSE3,          //!< decodes 16 base64 characters at once
+        AVX2            //!< decodes 32 base64 characters at once
+    };
+
+    //! \brief Constructor
+    /*! \param p_boHeader if <tt>true</tt>, the first line decoded is taken as the header of
+     *         the file, it is <tt>false</tt> when decoding starts in the middle of the file
+     */
+    cSysErrorDecoder( const bool p_boHeader = true ) throw();
+
+    //! \brief Destructor
+    ~cSysErrorDecoder() throw();
+
+    //! \brief Decodes a block of whole Log Lines
+    /*! \param p_poBegin pointer to the first byte of the block
+     *  \param p_poEnd pointer to the past-the-end byte of the block
+     *  \param p_poOutput receives the decoded lines, its previous content is replaced
+     */
+    void                decodeBlock( const char *p_poBegin, const char *p_poEnd,
+                                     std::vector<char> *p_poOutput ) throw();
+
+    //! \brief Decodes a single encrypted tag
+    /*! The vectorized kernels decode runs of valid base64 characters with SIMD lookups,
+     *  apply the Key to 8 bytes at a time, and only fall back to the byte by byte loop at
+     *  the first character that is not part of the base64 alphabet (usually the '='
+     *  padding at the end of the tag). All kernels produce exactly the same output.
+     *  \param p_poTag pointer to the first character of the tag
+     *  \param p_uiLength length of the tag in bytes
+     *  \param p_poOutput buffer receiving the decoded bytes, it must be at least
+     *         p_uiLength * 3 / 4 bytes long
+     *  \return The number of bytes written to p_poOutput
+     */
+    static unsigned int decodeTag( const char *p_poTag, const unsigned int p_uiLength,
+                                   char *p_poOutput ) throw();
+
+    //! \brief Returns the kernel implementation currently in use
+    static teKernel     kernel() throw();
+
+    //! \brief Selects the given kernel implementation
+    /*! This is mainly for benchmarks and tests, so the implementations can be compared.
+     *  \param p_enKernel the kernel to use
+     *  \return <tt>false</tt> if the CPU does not support the requested kernel, in which
+     *          case the kernel in use is not changed
+     */
+    static bool         setKernel( const teKernel p_enKernel ) throw();
+
+    //! \brief Returns the best kernel implementation supported by the CPU
+    static teKernel     bestKernel() throw();
+
+    //! Conversion function to convert a kernel enum value to a string
+    static const char  *toStr( const teKernel p_enKernel ) throw();
+
+private:
+    //! True until the header line of the file is passed
+    bool                m_boFirstLine;
+};
+
+#endif // SYSERRORDECODER_H
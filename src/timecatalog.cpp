@@ -0,0 +1,274 @@
+#include <QDir>
+#include <QFile>
+#include <QFileInfo>
+#include <QDateTime>
+#include <QDataStream>
+#include <QCryptographicHash>
+
+#include "timecatalog.h"
+
+// Identifies the catalog files, and the version of their format
+static const quint32 TIME_CATALOG_MAGIC   = 0x4c54434cUL;
+static const quint32 TIME_CATALOG_VERSION = 1;
+
+cTimeCatalog::cTimeCatalog( const QString &p_qsFileName, const QString &p_qsTimeStampRegExp ) throw()
+{
+    m_qsFileName        = p_qsFileName;
+    m_qsTimeStampRegExp = p_qsTimeStampRegExp;
+    m_boComplete        = false;
+    m_boHasTimes        = false;
+    m_ullFirstTime      = 0;
+    m_ullLastTime       = 0;
+}
+
+cTimeCatalog::~cTimeCatalog() throw()
+{
+}
+
+bool cTimeCatalog::complete() const throw()
+{
+    return m_boComplete;
+}
+
+bool cTimeCatalog::hasTimes() const throw()
+{
+    return m_boHasTimes;
+}
+
+unsigned long long cTimeCatalog::firstTime() const throw()
+{
+    return m_ullFirstTime;
+}
+
+unsigned long long cTimeCatalog::lastTime() const throw()
+{
+    return m_ullLastTime;
+}
+
+unsigned int cTimeCatalog::pointCount() const throw()
+{
+    return m_vePoints.size();
+}
+
+void cTimeCatalog::addPoint( const unsigned long long p_ullTime, const unsigned long long p_ullOffset,
+                             const unsigned long long p_ullLines ) throw()
+{
+    tsPoint suPoint = { p_ullTime, p_ullOffset, p_ullLines };
+    m_vePoints.push_back( suPoint );
+
+    addTime( p_ullTime );
+}
+
+void cTimeCatalog::addTime( const unsigned long long p_ullTime ) throw()
+{
+    if( !m_boHasTimes || p_ullTime < m_ullFirstTime ) m_ullFirstTime = p_ullTime;
+    if( !m_boHasTimes || p_ullTime > m_ullLastTime )  m_ullLastTime  = p_ullTime;
+    m_boHasTimes = true;
+}
+
+void cTimeCatalog::finish() throw()
+{
+    m_boComplete = true;
+}
+
+bool cTimeCatalog::overlaps( const unsigned long long p_ullFrom, const unsigned long long p_ullTo ) const throw()
+{
+    // A file without time-stamps cannot be placed in time, it is searched as a whole
+    if( !m_boComplete || !m_boHasTimes ) return true;
+
+    return m_ullLastTime >= p_ullFrom && m_ullFirstTime < p_ullTo;
+}
+
+const cTimeCatalog::tsPoint *cTimeCatalog::startPoint( const unsigned long long p_ullFrom ) const throw()
+{
+    if( !m_boComplete ) return NULL;
+
+    // The Log Lines in front of a point earlier than the range are all earlier too, as long
+    // as no point in front of it is already in the range
+    const tsPoint *poStart = NULL;
+    for( unsigned int i = 0; i < m_vePoints.size() && m_vePoints[i].ullTime < p_ullFrom; i++ )
+    {
+        poStart = &m_vePoints[i];
+    }
+
+    return poStart;
+}
+
+unsigned long long cTimeCatalog::endOffset( const unsigned long long p_ullTo ) const throw()
+{
+    unsigned long long ullEnd = ~0ULL;
+    if( !m_boComplete ) return ullEnd;
+
+    for( unsigned int i = m_vePoints.size(); i > 0 && m_vePoints[i - 1].ullTime >= p_ullTo; i-- )
+    {
+        ullEnd = m_vePoints[i - 1].ullOffset;
+    }
+
+    return ullEnd;
+}
+
+bool cTimeCatalog::load( const QString &p_qsCatalogFile ) throw()
+{
+    m_vePoints.clear();
+    m_boComplete = false;
+    m_boHasTimes = false;
+
+    unsigned long long ullFileSize = 0;
+    unsigned int       uiFileTime  = 0;
+    if( !fileStamp( &ullFileSize, &uiFileTime ) ) return false;
+
+    QFile obFile( p_qsCatalogFile );
+    if( !obFile.open( QIODevice::ReadOnly ) ) return false;
+
+    QDataStream obStream( &obFile );
+    obStream.setVersion( QDataStream::Qt_4_0 );
+
+    quint32 uiMagic = 0, uiVersion = 0, uiTime = 0, uiCount = 0;
+    quint64 ullSize = 0, ullFirstTime = 0, ullLastTime = 0;
+    quint8  uiHasTimes = 0;
+    QString qsTimeStampRegExp;
+    obStream >> uiMagic >> uiVersion >> ullSize >> uiTime >> qsTimeStampRegExp
+             >> uiHasTimes >> ullFirstTime >> ullLastTime >> uiCount;
+    if( obStream.status() != QDataStream::Ok || uiMagic != TIME_CATALOG_MAGIC || uiVersion != TIME_CATALOG_VERSION ||
+        ullSize != ullFileSize || uiTime != uiFileTime || qsTimeStampRegExp != m_qsTimeStampRegExp )
+    {
+        return false;
+    }
+
+    for( quint32 i = 0; i < uiCount && obStream.status() == QDataStream::Ok; i++ )
+    {
+        quint64 ullPointTime = 0, ullOffset = 0, ullLines = 0;
+        obStream >> ullPointTime >> ullOffset >> ullLines;
+
+        if( !m_vePoints.empty() && ullOffset < m_vePoints.back().ullOffset )
+        {
+            m_vePoints.clear();
+            return false;
+        }
+        tsPoint suPoint = { ullPointTime, ullOffset, ullLines };
+        m_vePoints.push_back( suPoint );
+    }
+
+    if( obStream.status() != QDataStream::Ok )
+    {
+        m_vePoints.clear();
+        return false;
+    }
+
+    m_boHasTimes   = uiHasTimes;
+    m_ullFirstTime = ullFirstTime;
+    m_ullLastTime  = ullLastTime;
+    m_boComplete   = true;
+
+    return true;
+}
+
+void cTimeCatalog::save( const QString &p_qsCatalogFile ) const throw( cSevException )
+{
+    if( !m_boComplete )
+    {
+        throw cSevException( cSeverity::WARNING, QString( "Time catalog of %1 is not complete" ).arg( m_qsFileName ).toStdString() );
+    }
+
+    unsigned long long ullFileSize = 0;
+    unsigned int       uiFileTime  = 0;
+    if( !fileStamp( &ullFileSize, &uiFileTime ) )
+    {
+        throw cSevException( cSeverity::WARNING, QString( "Cannot find Input Log File %1" ).arg( m_qsFileName ).toStdString() );
+    }
+
+    // The catalog is written under a temporary name first, so a partly written catalog is
+    // never loaded
+    QDir().mkpath( QFileInfo( p_qsCatalogFile ).absolutePath() );
+    QString qsTempFile = p_qsCatalogFile + ".tmp";
+    QFile   obFile( qsTempFile );
+    if( !obFile.open( QIODevice::WriteOnly | QIODevice::Truncate ) )
+    {
+        throw cSevException( cSeverity::WARNING, QString( "Cannot create time catalog file %1: %2" ).arg( qsTempFile ).arg( obFile.errorString() ).toStdString() );
+    }
+
+    QDataStream obStream( &obFile );
+    obStream.setVersion( QDataStream::Qt_4_0 );
+    obStream << TIME_CATALOG_MAGIC << TIME_CATALOG_VERSION << (quint64)ullFileSize << (quint32)uiFileTime << m_qsTimeStampRegExp
+             << (quint8)(m_boHasTimes ? 1 : 0) << (quint64)m_ullFirstTime << (quint64)m_ullLastTime << (quint32)m_vePoints.size();
+
+    for( unsigned int i = 0; i < m_vePoints.size(); i++ )
+    {
+        obStream << (quint64)m_vePoints[i].ullTime << (quint64)m_vePoints[i].ullOffset << (quint64)m_vePoints[i].ullLines;
+    }
+
+    obFile.close();
+    if( obStream.status() != QDataStream::Ok || obFile.error() != QFile::NoError )
+    {
+        QFile::remove( qsTempFile );
+        throw cSevException( cSeverity::WARNING, QString( "Cannot write time catalog file %1" ).arg( qsTempFile ).toStdString() );
+    }
+
+    QFile::remove( p_qsCatalogFile );
+    if( !QFile::rename( qsTempFile, p_qsCatalogFile ) )
+    {
+        QFile::remove( qsTempFile );
+        throw cSevException( cSeverity::WARNING, QString( "Cannot create time catalog file %1" ).arg( p_qsCatalogFile ).toStdString() );
+    }
+}
+
+QString cTimeCatalog::catalogFileName( const QString &p_qsFileName, const QString &p_qsIndexDir ) throw()
+{
+    // Files with the same name in different directories share the index directory, so the
+    // name of the catalog file also has a hash of the full path of the file
+    QFileInfo  obFileInfo( p_qsFileName );
+    QByteArray baHash = QCryptographicHash::hash( obFileInfo.absoluteFilePath().toUtf8(), QCryptographicHash::Md5 ).toHex();
+
+    return QDir( p_qsIndexDir ).filePath( QString( "%1.%2.tcat" ).arg( obFileInfo.fileName() ).arg( QString( baHash.left( 16 ) ) ) );
+}
+
+unsigned long long cTimeCatalog::timeKey( const cAction::tsTimeStamp &p_suTimeStamp ) throw()
+{
+    unsigned long long ullKey = p_suTimeStamp.uiYear;
+    ullKey = ullKey * 100  + p_suTimeStamp.uiMonth;
+    ullKey = ullKey * 100  + p_suTimeStamp.uiDay;
+    ullKey = ullKey * 100  + p_suTimeStamp.uiHour;
+    ullKey = ullKey * 100  + p_suTimeStamp.uiMinute;
+    ullKey = ullKey * 100  + p_suTimeStamp.uiSecond;
+    ullKey = ullKey * 1000 + p_suTimeStamp.uiMSecond;
+
+    return ullKey;
+}
+
+bool cTimeCatalog::parseTime( const QString &p_qsTime, unsigned long long *p_poTime ) throw()
+{
+    QString qsTime = p_qsTime.trimmed();
+    qsTime.replace( 'T', ' ' );
+
+    const char *apFormats[] = { "yyyy-MM-dd hh:mm:ss.zzz", "yyyy-MM-dd hh:mm:ss", "yyyy-MM-dd hh:mm", "yyyy-MM-dd" };
+    for( unsigned int i = 0; i < sizeof( apFormats ) / sizeof( apFormats[0] ); i++ )
+    {
+        QDateTime obTime = QDateTime::fromString( qsTime, apFormats[i] );
+        if( !obTime.isValid() ) continue;
+
+        cAction::tsTimeStamp suTimeStamp;
+        suTimeStamp.uiYear    = obTime.date().year();
+        suTimeStamp.uiMonth   = obTime.date().month();
+        suTimeStamp.uiDay     = obTime.date().day();
+        suTimeStamp.uiHour    = obTime.time().hour();
+        suTimeStamp.uiMinute  = obTime.time().minute();
+        suTimeStamp.uiSecond  = obTime.time().second();
+        suTimeStamp.uiMSecond = obTime.time().msec();
+        *p_poTime = timeKey( suTimeStamp );
+
+        return true;
+    }
+
+    return false;
+}
+
+bool cTimeCatalog::fileStamp( unsigned long long *p_poSize, unsigned int *p_poTime ) const throw()
+{
+    QFileInfo obFileInfo( m_qsFileName );
+    if( !obFileInfo.exists() ) return false;
+
+    *p_poSize = obFileInfo.size();
+    *p_poTime = obFileInfo.lastModified().toTime_t();
+
+    return true;
+}
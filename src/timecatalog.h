@@ -0,0 +1,145 @@
+#ifndef TIMECATALOG_H
+#define TIMECATALOG_H
+
+#include <QString>
+#include <vector>
+
+#include <sevexception.h>
+
+#include "action.h"
+
+//! \brief Time catalog of an Input Log File, used to analyse only a time range of the file
+/*! The catalog holds the first and last time-stamps of the file, and a sparse index of
+ *  the time-stamps: points roughly one block of the cLineReader (1 MB) apart, each holding
+ *  the time-stamp of the first Log Line of the block, the offset of the block and the
+ *  number of Log Lines in front of it. The time-stamps are parsed with the
+ *  <tt>timestamp_regexp</tt> of the Action Definitions, and compared as timeKey() values.
+ *
+ *  A Log Analysis limited to a time range (see cLogAnalyser::setTimeRange()) skips the
+ *  files whose catalog is entirely outside the range, seeks to startPoint() in the files
+ *  that overlap it, and stops at endOffset(). Seeking assumes that the time-stamps of a
+ *  file do not decrease; out of order time-stamps only make the searched region larger,
+ *  since the Log Lines outside the range are dropped anyway.
+ *
+ *  The catalog is built while the whole file is searched once, and is stored in a catalog
+ *  file in the index directory (see catalogFileName()). The size and modification time of
+ *  the file and the time-stamp regular expression are stored with the catalog, so a
+ *  catalog of a file that changed since, or that was built with different Action
+ *  Definitions, is not loaded.
+ */
+class cTimeCatalog
+{
+public:
+    //! A point of the sparse time-stamp index
+    typedef struct
+    {
+        //! The time-stamp of the first Log Line of the block, as a timeKey()
+        unsigned long long  ullTime;
+        //! Offset of the block in the file
+        unsigned long long  ullOffset;
+        //! Number of Log Lines in front of the block
+        unsigned long long  ullLines;
+    } tsPoint;
+
+    //! \brief Constructor, creates an empty catalog of the given file
+    /*! \param p_qsFileName name of the Input Log File
+     *  \param p_qsTimeStampRegExp the time-stamp regular expression of the Action Definitions
+     */
+    cTimeCatalog( const QString &p_qsFileName, const QString &p_qsTimeStampRegExp ) throw();
+
+    //! \brief Destructor
+    ~cTimeCatalog() throw();
+
+    //! \brief Returns <tt>true</tt> if the whole file is catalogued
+    bool                complete() const throw();
+
+    //! \brief Returns <tt>true</tt> if a time-stamp was found in the file
+    bool                hasTimes() const throw();
+
+    //! \brief Returns the earliest time-stamp of the file
+    unsigned long long  firstTime() const throw();
+
+    //! \brief Returns the latest time-stamp of the file
+    unsigned long long  lastTime() const throw();
+
+    //! \brief Returns the number of index points
+    unsigned int        pointCount() const throw();
+
+    //! \brief Adds an index point while the file is searched, in the order of the offsets
+    void                addPoint( const unsigned long long p_ullTime, const unsigned long long p_ullOffset,
+                                  const unsigned long long p_ullLines ) throw();
+
+    //! \brief Adds a time-stamp found in between the index points
+    void                addTime( const unsigned long long p_ullTime ) throw();
+
+    //! \brief Marks the catalog complete, once the end of the file is reached
+    void                finish() throw();
+
+    //! \brief Returns <tt>true</tt> if the file may have Log Lines in the given time range
+    /*! \param p_ullFrom start of the range, included
+     *  \param p_ullTo end of the range, not included
+     */
+    bool                overlaps( const unsigned long long p_ullFrom, const unsigned long long p_ullTo ) const throw();
+
+    //! \brief Returns the index point the search for the given start of a range starts at
+    /*! \return The last point in front of the first point at or after p_ullFrom, NULL if
+     *          the search has to start at the beginning of the file
+     */
+    const tsPoint      *startPoint( const unsigned long long p_ullFrom ) const throw();
+
+    //! \brief Returns the offset the search for the given end of a range can stop at
+    /*! \return The offset of the first point of the points at or after p_ullTo at the end of
+     *          the file, the maximum value if there are none
+     */
+    unsigned long long  endOffset( const unsigned long long p_ullTo ) const throw();
+
+    //! \brief Loads the catalog from the given catalog file
+    /*! \return <tt>false</tt> if the catalog file does not exist, is corrupt, or belongs to
+     *          a different version of the file or to a different time-stamp regular
+     *          expression
+     */
+    bool                load( const QString &p_qsCatalogFile ) throw();
+
+    //! \brief Saves a complete catalog to the given catalog file
+    /*! Failing to save the catalog is not fatal, the exceptions thrown are warnings.
+     */
+    void                save( const QString &p_qsCatalogFile ) const throw( cSevException );
+
+    //! \brief Returns the name of the catalog file of an Input Log File
+    /*! \param p_qsFileName name of the Input Log File
+     *  \param p_qsIndexDir directory of the index files (see cPreferences::indexDir())
+     */
+    static QString      catalogFileName( const QString &p_qsFileName, const QString &p_qsIndexDir ) throw();
+
+    //! \brief Returns a time-stamp as a number, later time-stamps have larger numbers
+    static unsigned long long timeKey( const cAction::tsTimeStamp &p_suTimeStamp ) throw();
+
+    //! \brief Converts a time given in a Batch Definition file to a timeKey()
+    /*! \param p_qsTime the time, in the <tt>yyyy-MM-dd hh:mm:ss</tt> format (the
+     *         <tt>T</tt> separator of ISO 8601 and a missing time of the day are accepted)
+     *  \param p_poTime receives the time
+     *  \return <tt>false</tt> if the time is not valid
+     */
+    static bool         parseTime( const QString &p_qsTime, unsigned long long *p_poTime ) throw();
+
+private:
+    //! Name of the Input Log File
+    QString               m_qsFileName;
+    //! The time-stamp regular expression the catalog is built with
+    QString               m_qsTimeStampRegExp;
+    //! True if the whole file is catalogued
+    bool                  m_boComplete;
+    //! True if a time-stamp was found in the file
+    bool                  m_boHasTimes;
+    //! The earliest time-stamp of the file
+    unsigned long long    m_ullFirstTime;
+    //! The latest time-stamp of the file
+    unsigned long long    m_ullLastTime;
+    //! The index points, in the order of their offsets
+    std::vector<tsPoint>  m_vePoints;
+
+    //! \brief Returns the size and the modification time of the Input Log File
+    bool                fileStamp( unsigned long long *p_poSize, unsigned int *p_poTime ) const throw();
+};
+
+#endif // TIMECATALOG_H
@@ -0,0 +1,262 @@
+#include <cstring>
+
+#include "lara.h"
+#include "timestampparser.h"
+
+using namespace std;
+
+cTimeStampParser::cTimeStampParser( const cActionDefList *p_poActionDefList ) throw()
+{
+    cTracer  obTracer( &g_obLogger, "cTimeStampParser::cTimeStampParser" );
+
+    m_obRegExp    = p_poActionDefList->timeStampRegExp();
+    m_uiLastGroup  = 0;
+    m_uiGroupCount = 0;
+    for( unsigned int i = 0; i < cTimeStampPart::MAX - 1; i++ )
+    {
+        m_veParts.push_back( p_poActionDefList->timeStampPart( i ) );
+    }
+
+    if( !buildLayout( m_obRegExp.pattern() ) ) m_veLayout.clear();
+
+    obTracer << QString( "Time-stamp \"%1\" is parsed by %2" ).arg( m_obRegExp.pattern() )
+                .arg( fastPath() ? "the digit parser" : "the regular expression" ).toStdString();
+}
+
+cTimeStampParser::~cTimeStampParser() throw()
+{
+}
+
+bool cTimeStampParser::fastPath() const throw()
+{
+    return !m_veLayout.empty();
+}
+
+void cTimeStampParser::disableFastPath() throw()
+{
+    m_veLayout.clear();
+}
+
+bool cTimeStampParser::parse( const char *p_poLogLine, const unsigned int p_uiLength,
+                              QString *p_poText, cAction::tsTimeStamp *p_poTimeStamp,
+                              cTimeStampScratch *p_poScratch ) const throw()
+{
+    if( m_veLayout.empty() ) return parseRegExp( p_poLogLine, p_uiLength, p_poText, p_poTimeStamp, p_poScratch );
+
+    vector<char>         &vePrefix = p_poScratch->m_vePrefix;
+    vector<unsigned int> &veValues = p_poScratch->m_veValues;
+    veValues.resize( m_uiGroupCount, 0 );
+
+    // Reusing the fields of the previous time-stamp if only the last field can differ
+    unsigned int uiElement = 0;
+    unsigned int uiGroup   = 0;
+    unsigned int uiPos     = 0;
+    if( !vePrefix.empty() && vePrefix.size() <= p_uiLength &&
+        memcmp( &vePrefix[0], p_poLogLine, vePrefix.size() ) == 0 )
+    {
+        uiElement = m_uiLastGroup;
+        uiGroup   = m_uiGroupCount - 1;
+        uiPos     = vePrefix.size();
+    }
+
+    unsigned int uiPrefixLength = 0;
+    for( ; uiElement < m_veLayout.size(); uiElement++ )
+    {
+        const tsElement &suElement = m_veLayout[uiElement];
+        if( !suElement.boDigits )
+        {
+            if( uiPos >= p_uiLength || p_poLogLine[uiPos] != suElement.chSeparator ) break;
+            uiPos++;
+            continue;
+        }
+
+        if( uiElement == m_uiLastGroup ) uiPrefixLength = uiPos;
+
+        // Same as QString::toUInt(): an empty or too large number is 0
+        unsigned int       uiDigits = 0;
+        unsigned long long ullValue = 0;
+        for( ; uiPos < p_uiLength && p_poLogLine[uiPos] >= '0' && p_poLogLine[uiPos] <= '9' &&
+               (!suElement.uiMaxDigits || uiDigits < suElement.uiMaxDigits); uiPos++, uiDigits++ )
+        {
+            if( ullValue <= 0xFFFFFFFFULL ) ullValue = ullValue * 10 + (p_poLogLine[uiPos] - '0');
+        }
+        if( uiDigits < suElement.uiMinDigits ) break;
+
+        veValues[uiGroup++] = ullValue > 0xFFFFFFFFULL ? 0 : (unsigned int)ullValue;
+    }
+
+    if( uiElement < m_veLayout.size() )
+    {
+        // The layout does not match at the beginning of the line, the regular expression
+        // may still match somewhere else in the line
+        vePrefix.clear();
+        return parseRegExp( p_poLogLine, p_uiLength, p_poText, p_poTimeStamp, p_poScratch );
+    }
+
+    vePrefix.assign( p_poLogLine, p_poLogLine + uiPrefixLength );
+
+    for( unsigned int i = 0; i < m_uiGroupCount; i++ )
+    {
+        setPart( m_veParts[i], veValues[i], p_poTimeStamp );
+    }
+    *p_poText = QString::fromAscii( p_poLogLine, uiPos );
+
+    return true;
+}
+
+bool cTimeStampParser::buildLayout( const QString &p_qsRegExp ) throw()
+{
+    QByteArray   obRegExp = p_qsRegExp.toAscii();
+    unsigned int uiLength = obRegExp.size();
+    unsigned int uiPos    = 0;
+
+    // The digit parser only runs at the beginning of the line, so an anchor changes nothing
+    if( uiPos < uiLength && obRegExp.at( uiPos ) == '^' ) uiPos++;
+
+    while( uiPos < uiLength )
+    {
+        tsElement suElement;
+        suElement.boDigits    = false;
+        suElement.chSeparator = 0;
+        suElement.uiMinDigits = 0;
+        suElement.uiMaxDigits = 0;
+
+        char chChar = obRegExp.at( uiPos );
+        if( chChar == '(' )
+        {
+            // A digit group: "(\d" or "([\d]" or "([0-9]" followed by a quantifier and ")"
+            const char *poDigitClasses[] = { "(\\d", "([\\d]", "([0-9]" };
+            unsigned int uiClassLength = 0;
+            for( unsigned int i = 0; i < 3 && !uiClassLength; i++ )
+            {
+                if( strncmp( obRegExp.constData() + uiPos, poDigitClasses[i], strlen( poDigitClasses[i] ) ) == 0 )
+                {
+                    uiClassLength = strlen( poDigitClasses[i] );
+                }
+            }
+            if( !uiClassLength ) return false;
+            uiPos += uiClassLength;
+            if( uiPos >= uiLength ) return false;
+
+            chChar = obRegExp.at( uiPos++ );
+            if( chChar == '*' )
+            {
+            }
+            else if( chChar == '+' )
+            {
+                suElement.uiMinDigits = 1;
+            }
+            else if( chChar == '{' )
+            {
+                int inClose = obRegExp.indexOf( '}', uiPos );
+                if( inClose < 0 ) return false;
+                QString qsCounts = QString::fromAscii( obRegExp.constData() + uiPos, inClose - uiPos );
+                bool    boMinOk  = false;
+                bool    boMaxOk  = true;
+                suElement.uiMinDigits = qsCounts.section( ',', 0, 0 ).toUInt( &boMinOk );
+                if( !qsCounts.contains( ',' ) )
+                {
+                    suElement.uiMaxDigits = suElement.uiMinDigits;
+                    boMaxOk = suElement.uiMaxDigits > 0;
+                }
+                else if( !qsCounts.section( ',', 1, 1 ).isEmpty() )
+                {
+                    suElement.uiMaxDigits = qsCounts.section( ',', 1, 1 ).toUInt( &boMaxOk );
+                    boMaxOk = boMaxOk && suElement.uiMaxDigits >= suElement.uiMinDigits && suElement.uiMaxDigits > 0;
+                }
+                if( !boMinOk || !boMaxOk ) return false;
+                uiPos = inClose + 1;
+            }
+            else return false;
+
+            if( uiPos >= uiLength || obRegExp.at( uiPos ) != ')' ) return false;
+            uiPos++;
+
+            // Two digit groups next to each other would make the split point ambiguous
+            if( !m_veLayout.empty() && m_veLayout.back().boDigits ) return false;
+
+            suElement.boDigits = true;
+            m_uiLastGroup = m_veLayout.size();
+        }
+        else if( chChar == '\\' )
+        {
+            // Escaped letters and digits are character classes, anchors, etc.
+            if( ++uiPos >= uiLength ) return false;
+            chChar = obRegExp.at( uiPos++ );
+            if( (chChar >= '0' && chChar <= '9') || (chChar >= 'a' && chChar <= 'z') || (chChar >= 'A' && chChar <= 'Z') ) return false;
+            suElement.chSeparator = chChar;
+        }
+        else
+        {
+            if( strchr( "^$.|?*+()[]{}", chChar ) || (chChar >= '0' && chChar <= '9') ) return false;
+            suElement.chSeparator = chChar;
+            uiPos++;
+        }
+
+        // A quantified separator is not a fixed layout anymore
+        if( !suElement.boDigits && uiPos < uiLength && strchr( "?*+{", obRegExp.at( uiPos ) ) ) return false;
+
+        m_veLayout.push_back( suElement );
+    }
+
+    unsigned int uiGroups = 0;
+    for( unsigned int i = 0; i < m_veLayout.size(); i++ )
+    {
+        if( m_veLayout[i].boDigits ) uiGroups++;
+    }
+    if( !uiGroups ) return false;
+
+    m_uiGroupCount = uiGroups;
+    m_veParts.resize( uiGroups, cTimeStampPart::MIN );
+
+    return true;
+}
+
+bool cTimeStampParser::parseRegExp( const char *p_poLogLine, const unsigned int p_uiLength,
+                                    QString *p_poText, cAction::tsTimeStamp *p_poTimeStamp,
+                                    cTimeStampScratch *p_poScratch ) const throw()
+{
+    QRegExp &obRegExp = p_poScratch->m_obRegExp;
+    if( obRegExp.indexIn( QString::fromAscii( p_poLogLine, p_uiLength ) ) == -1 ) return false;
+
+    return setParts( obRegExp.capturedTexts(), p_poText, p_poTimeStamp );
+}
+
+bool cTimeStampParser::setParts( const QStringList &p_slTimeStampTexts,
+                                 QString *p_poText, cAction::tsTimeStamp *p_poTimeStamp ) const throw()
+{
+    if( p_slTimeStampTexts.isEmpty() ) return false;
+
+    *p_poText = p_slTimeStampTexts.at( 0 );
+    for( int i = 1; i < p_slTimeStampTexts.size(); i++ )
+    {
+        if( (unsigned int)i - 1 < m_veParts.size() ) setPart( m_veParts[i - 1], p_slTimeStampTexts.at( i ).toUInt(), p_poTimeStamp );
+    }
+
+    return true;
+}
+
+void cTimeStampParser::setPart( const cTimeStampPart::teTimeStampPart p_enPart, const unsigned int p_uiValue,
+                                cAction::tsTimeStamp *p_poTimeStamp ) throw()
+{
+    switch( p_enPart )
+    {
+        case cTimeStampPart::YEAR:    p_poTimeStamp->uiYear    = p_uiValue; break;
+        case cTimeStampPart::MONTH:   p_poTimeStamp->uiMonth   = p_uiValue; break;
+        case cTimeStampPart::DAY:     p_poTimeStamp->uiDay     = p_uiValue; break;
+        case cTimeStampPart::HOUR:    p_poTimeStamp->uiHour    = p_uiValue; break;
+        case cTimeStampPart::MINUTE:  p_poTimeStamp->uiMinute  = p_uiValue; break;
+        case cTimeStampPart::SECOND:  p_poTimeStamp->uiSecond  = p_uiValue; break;
+        case cTimeStampPart::MSECOND: p_poTimeStamp->uiMSecond = p_uiValue; break;
+        default: ;
+    }
+}
+
+cTimeStampScratch::cTimeStampScratch( const cTimeStampParser *p_poParser ) throw()
+{
+    m_obRegExp = p_poParser->m_obRegExp;
+}
+
+cTimeStampScratch::~cTimeStampScratch() throw()
+{
+}
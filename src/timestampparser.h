@@ -0,0 +1,146 @@
+#ifndef TIMESTAMPPARSER_H
+#define TIMESTAMPPARSER_H
+
+#include <QString>
+#include <QRegExp>
+#include <vector>
+
+#include "actiondeflist.h"
+#include "action.h"
+
+class cTimeStampScratch;
+
+//! \brief Parses the time-stamps of the Log Lines as defined in an Action Definition file
+/*! The time-stamp of a Log Line is defined by the <tt>timestamp_regexp</tt> attribute of
+ *  the Action Definition file, and the <tt>param_N</tt> attributes that tell which part of
+ *  the time-stamp is captured by each group of the regular expression.
+ *
+ *  Most time-stamp regular expressions are a simple sequence of digit groups and separator
+ *  characters, for example <tt>(\\d*)-(\\d*)-(\\d*) (\\d*):(\\d*):(\\d*)\\.(\\d*)</tt>. Such
+ *  layouts are recognized when the parser is created, and they are parsed directly from
+ *  the bytes of the Log Line by a dedicated digit parser. Every other regular expression,
+ *  and every Log Line the digit parser cannot match at its first character, is handled by
+ *  the regular expression itself, so the result is always the same as the result of the
+ *  regular expression.
+ *
+ *  Consecutive Log Lines often share everything but the last field of the time-stamp (for
+ *  example the milliseconds). The parser remembers the fields of the previous time-stamp
+ *  and only parses the last field again if the rest of the time-stamp is unchanged.
+ *
+ *  The parser itself never changes after it is created. The fields of the previous
+ *  time-stamp and the regular expression used for the fallback (QRegExp::indexIn() stores
+ *  the captured texts in the QRegExp object) are kept in a cTimeStampScratch, so a single
+ *  parser can be shared by several threads, each parsing with its own scratch.
+ */
+class cTimeStampParser
+{
+public:
+    //! \brief Constructor that recognizes the time-stamp layout of the Action Definitions
+    /*! \param p_poActionDefList the Action Definitions holding the time-stamp regular
+     *         expression and the order of the captured time-stamp parts
+     */
+    cTimeStampParser( const cActionDefList *p_poActionDefList ) throw();
+
+    //! \brief Destructor
+    ~cTimeStampParser() throw();
+
+    //! \brief Returns <tt>true</tt> if the time-stamp layout is parsed by the digit parser
+    bool          fastPath() const throw();
+
+    //! \brief Makes every time-stamp parsed by the regular expression
+    /*! This is only used to compare the two ways of parsing in the benchmarks.
+     */
+    void          disableFastPath() throw();
+
+    //! \brief Parses the time-stamp of the given Log Line
+    /*! Only the time-stamp parts captured by the regular expression are set in the
+     *  p_poTimeStamp structure, the other members are left untouched.
+     *  \param p_poLogLine pointer to the Log Line (it does not have to be zero terminated)
+     *  \param p_uiLength length of the Log Line in bytes, without the new line character
+     *  \param p_poText receives the time-stamp as it appears in the Log Line
+     *  \param p_poTimeStamp receives the parts of the time-stamp
+     *  \param p_poScratch the parsing state of the calling thread, created for this parser
+     *  \return <tt>false</tt> if the time-stamp regular expression does not match the line
+     */
+    bool          parse( const char *p_poLogLine, const unsigned int p_uiLength,
+                         QString *p_poText, cAction::tsTimeStamp *p_poTimeStamp,
+                         cTimeStampScratch *p_poScratch ) const throw();
+
+    //! \brief Sets the time-stamp from texts already captured by the regular expression
+    /*! This is used when the time-stamp regular expression was evaluated together with the
+     *  Pattern (see cPattern::matchFused()), so the Log Line does not have to be parsed again.
+     *  \param p_slTimeStampTexts the captured texts in the same layout as
+     *         QRegExp::capturedTexts(), an empty list if the regular expression did not match
+     *  \param p_poText receives the time-stamp as it appears in the Log Line
+     *  \param p_poTimeStamp receives the parts of the time-stamp
+     *  \return <tt>false</tt> if the list is empty
+     */
+    bool          setParts( const QStringList &p_slTimeStampTexts,
+                            QString *p_poText, cAction::tsTimeStamp *p_poTimeStamp ) const throw();
+
+private:
+    //! An element of a recognized time-stamp layout
+    typedef struct
+    {
+        //! True for a group of digits, false for a single separator character
+        bool                             boDigits;
+        //! The separator character
+        char                             chSeparator;
+        //! Minimum number of digits in the group
+        unsigned int                     uiMinDigits;
+        //! Maximum number of digits in the group, 0 if unlimited
+        unsigned int                     uiMaxDigits;
+    } tsElement;
+
+    //! The time-stamp regular expression, copied into every cTimeStampScratch
+    QRegExp                  m_obRegExp;
+    //! The time-stamp part captured by each group of the regular expression
+    std::vector<cTimeStampPart::teTimeStampPart>  m_veParts;
+    //! The recognized layout, empty if the regular expression is parsed by QRegExp
+    std::vector<tsElement>   m_veLayout;
+    //! Index of the last digit group in m_veLayout
+    unsigned int             m_uiLastGroup;
+    //! Number of digit groups in m_veLayout
+    unsigned int             m_uiGroupCount;
+
+    //! \brief Tries to recognize the layout of the given time-stamp regular expression
+    bool          buildLayout( const QString &p_qsRegExp ) throw();
+
+    //! \brief Parses the time-stamp with the regular expression of the scratch
+    bool          parseRegExp( const char *p_poLogLine, const unsigned int p_uiLength,
+                               QString *p_poText, cAction::tsTimeStamp *p_poTimeStamp,
+                               cTimeStampScratch *p_poScratch ) const throw();
+
+    //! \brief Sets the given time-stamp part in the time-stamp structure
+    static void   setPart( const cTimeStampPart::teTimeStampPart p_enPart, const unsigned int p_uiValue,
+                           cAction::tsTimeStamp *p_poTimeStamp ) throw();
+
+    friend class cTimeStampScratch;
+};
+
+//! \brief Parsing state of a cTimeStampParser used by a single thread
+/*! \sa cTimeStampParser
+ */
+class cTimeStampScratch
+{
+public:
+    //! \brief Constructor
+    /*! \param p_poParser the parser the scratch is used with
+     */
+    cTimeStampScratch( const cTimeStampParser *p_poParser ) throw();
+
+    //! \brief Destructor
+    ~cTimeStampScratch() throw();
+
+private:
+    //! Own copy of the time-stamp regular expression, matching changes its state
+    QRegExp                   m_obRegExp;
+    //! The bytes of the previous time-stamp in front of the last digit group
+    std::vector<char>         m_vePrefix;
+    //! The values of the digit groups of the previous time-stamp
+    std::vector<unsigned int> m_veValues;
+
+    friend class cTimeStampParser;
+};
+
+#endif // TIMESTAMPPARSER_H
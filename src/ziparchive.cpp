@@ -0,0 +1,352 @@
+#include <QRegExp>
+#include <cstring>
+
+#include "ziparchive.h"
+
+// Signatures of the ZIP records
+static const unsigned long ZIP_LOCAL_HEADER   = 0x04034b50UL;
+static const unsigned long ZIP_CENTRAL_HEADER = 0x02014b50UL;
+static const unsigned long ZIP_END_RECORD     = 0x06054b50UL;
+static const unsigned long ZIP64_END_RECORD   = 0x06064b50UL;
+static const unsigned long ZIP64_END_LOCATOR  = 0x07064b50UL;
+
+// Separates the archive name and the entry name in a logical file name
+static const char *ZIP_MEMBER_SEPARATOR = ".zip#";
+
+static unsigned int readUInt16( const char *p_poData )
+{
+    const unsigned char *poData = (const unsigned char *)p_poData;
+    return poData[0] | (poData[1] << 8);
+}
+
+static unsigned long readUInt32( const char *p_poData )
+{
+    const unsigned char *poData = (const unsigned char *)p_poData;
+    return (unsigned long)poData[0] | ((unsigned long)poData[1] << 8) |
+           ((unsigned long)poData[2] << 16) | ((unsigned long)poData[3] << 24);
+}
+
+static unsigned long long readUInt64( const char *p_poData )
+{
+    return (unsigned long long)readUInt32( p_poData ) | ((unsigned long long)readUInt32( p_poData + 4 ) << 32);
+}
+
+static bool readAt( QFile *p_poFile, const unsigned long long p_ullOffset, char *p_poBuffer, const unsigned int p_uiSize )
+{
+    return p_poFile->seek( p_ullOffset ) && p_poFile->read( p_poBuffer, p_uiSize ) == (qint64)p_uiSize;
+}
+
+cZipArchive::cZipArchive( const QString &p_qsFileName ) throw( cSevException )
+{
+    m_qsFileName = p_qsFileName;
+
+    QFile obFile( p_qsFileName );
+    if( !obFile.open( QIODevice::ReadOnly ) )
+    {
+        throw cSevException( cSeverity::ERROR, QString( "Cannot open ZIP archive %1: %2" ).arg( p_qsFileName ).arg( obFile.errorString() ).toStdString() );
+    }
+
+    // The end of central directory record is followed by a comment of at most 65535 bytes
+    unsigned long long ullFileSize = obFile.size();
+    unsigned int       uiTailSize  = ullFileSize < 65557 ? ullFileSize : 65557;
+    std::vector<char>  veTail( uiTailSize + 1 );
+    if( uiTailSize < 22 || !readAt( &obFile, ullFileSize - uiTailSize, &veTail[0], uiTailSize ) )
+    {
+        throw cSevException( cSeverity::ERROR, QString( "%1 is not a ZIP archive" ).arg( p_qsFileName ).toStdString() );
+    }
+
+    int inEnd = uiTailSize - 22;
+    while( inEnd >= 0 && readUInt32( &veTail[inEnd] ) != ZIP_END_RECORD ) inEnd--;
+    if( inEnd < 0 )
+    {
+        throw cSevException( cSeverity::ERROR, QString( "%1 is not a ZIP archive" ).arg( p_qsFileName ).toStdString() );
+    }
+
+    const char         *poEnd           = &veTail[inEnd];
+    unsigned long long  ullEntryCount   = readUInt16( poEnd + 10 );
+    unsigned long long  ullCentralSize  = readUInt32( poEnd + 12 );
+    unsigned long long  ullCentralStart = readUInt32( poEnd + 16 );
+    if( readUInt16( poEnd + 4 ) != readUInt16( poEnd + 6 ) || readUInt16( poEnd + 8 ) != ullEntryCount )
+    {
+        throw cSevException( cSeverity::ERROR, QString( "Split ZIP archive %1 is not supported" ).arg( p_qsFileName ).toStdString() );
+    }
+
+    // A ZIP64 archive has a locator record right in front of the end of central directory
+    unsigned long long ullEndOffset = ullFileSize - uiTailSize + inEnd;
+    char               poRecord[56];
+    if( ullEndOffset >= 20 && readAt( &obFile, ullEndOffset - 20, poRecord, 20 ) && readUInt32( poRecord ) == ZIP64_END_LOCATOR )
+    {
+        unsigned long long ullRecordOffset = readUInt64( poRecord + 8 );
+        if( !readAt( &obFile, ullRecordOffset, poRecord, 56 ) || readUInt32( poRecord ) != ZIP64_END_RECORD )
+        {
+            throw cSevException( cSeverity::ERROR, QString( "Corrupt ZIP64 end of central directory in %1" ).arg( p_qsFileName ).toStdString() );
+        }
+        ullEntryCount   = readUInt64( poRecord + 32 );
+        ullCentralSize  = readUInt64( poRecord + 40 );
+        ullCentralStart = readUInt64( poRecord + 48 );
+    }
+
+    if( ullCentralStart + ullCentralSize > ullFileSize || ullCentralSize > 0x7FFFFFFFULL )
+    {
+        throw cSevException( cSeverity::ERROR, QString( "Corrupt central directory in %1" ).arg( p_qsFileName ).toStdString() );
+    }
+
+    std::vector<char> veCentral( ullCentralSize + 1 );
+    if( !readAt( &obFile, ullCentralStart, &veCentral[0], ullCentralSize ) )
+    {
+        throw cSevException( cSeverity::ERROR, QString( "Cannot read central directory of %1" ).arg( p_qsFileName ).toStdString() );
+    }
+
+    unsigned long long ullPos = 0;
+    for( unsigned long long i = 0; i < ullEntryCount; i++ )
+    {
+        if( ullPos + 46 > ullCentralSize || readUInt32( &veCentral[ullPos] ) != ZIP_CENTRAL_HEADER )
+        {
+            throw cSevException( cSeverity::ERROR, QString( "Corrupt central directory in %1" ).arg( p_qsFileName ).toStdString() );
+        }
+
+        const char   *poHeader      = &veCentral[ullPos];
+        unsigned int  uiNameLength  = readUInt16( poHeader + 28 );
+        unsigned int  uiExtraLength = readUInt16( poHeader + 30 );
+        unsigned int  uiComment     = readUInt16( poHeader + 32 );
+        if( ullPos + 46 + uiNameLength + uiExtraLength + uiComment > ullCentralSize )
+        {
+            throw cSevException( cSeverity::ERROR, QString( "Corrupt central directory in %1" ).arg( p_qsFileName ).toStdString() );
+        }
+
+        tsEntry suEntry;
+        suEntry.uiFlags           = readUInt16( poHeader + 8 );
+        suEntry.uiMethod          = readUInt16( poHeader + 10 );
+        suEntry.ulCrc             = readUInt32( poHeader + 16 );
+        suEntry.ullCompressedSize = readUInt32( poHeader + 20 );
+        suEntry.ullSize           = readUInt32( poHeader + 24 );
+        suEntry.ullLocalOffset    = readUInt32( poHeader + 42 );
+        // Bit 11 of the flags means UTF-8 names, other names are taken as Latin-1
+        if( suEntry.uiFlags & 0x0800 ) suEntry.qsName = QString::fromUtf8( poHeader + 46, uiNameLength );
+        else                           suEntry.qsName = QString::fromLatin1( poHeader + 46, uiNameLength );
+
+        // The ZIP64 extra field holds the values that do not fit into the header, in order
+        const char *poExtra    = poHeader + 46 + uiNameLength;
+        const char *poExtraEnd = poExtra + uiExtraLength;
+        while( poExtra + 4 <= poExtraEnd )
+        {
+            unsigned int uiId   = readUInt16( poExtra );
+            unsigned int uiSize = readUInt16( poExtra + 2 );
+            if( poExtra + 4 + uiSize > poExtraEnd ) break;
+            if( uiId == 0x0001 )
+            {
+                const char *poValue = poExtra + 4;
+                const char *poLimit = poValue + uiSize;
+                if( suEntry.ullSize == 0xFFFFFFFFULL && poValue + 8 <= poLimit )
+                {
+                    suEntry.ullSize = readUInt64( poValue );
+                    poValue += 8;
+                }
+                if( suEntry.ullCompressedSize == 0xFFFFFFFFULL && poValue + 8 <= poLimit )
+                {
+                    suEntry.ullCompressedSize = readUInt64( poValue );
+                    poValue += 8;
+                }
+                if( suEntry.ullLocalOffset == 0xFFFFFFFFULL && poValue + 8 <= poLimit )
+                {
+                    suEntry.ullLocalOffset = readUInt64( poValue );
+                }
+            }
+            poExtra += 4 + uiSize;
+        }
+
+        m_maEntryIndexes[suEntry.qsName] = m_veEntries.size();
+        m_veEntries.push_back( suEntry );
+        ullPos += 46 + uiNameLength + uiExtraLength + uiComment;
+    }
+}
+
+cZipArchive::~cZipArchive() throw()
+{
+}
+
+QStringList cZipArchive::entryNames( const QString &p_qsFilter ) const throw()
+{
+    QRegExp     obFilter( p_qsFilter, Qt::CaseSensitive, QRegExp::Wildcard );
+    QStringList slNames;
+
+    for( unsigned int i = 0; i < m_veEntries.size(); i++ )
+    {
+        const QString &qsName = m_veEntries[i].qsName;
+        if( qsName.endsWith( '/' ) ) continue;
+        if( obFilter.exactMatch( qsName ) ) slNames.push_back( qsName );
+    }
+
+    return slNames;
+}
+
+QString cZipArchive::memberName( const QString &p_qsArchive, const QString &p_qsEntry ) throw()
+{
+    return p_qsArchive + "#" + p_qsEntry;
+}
+
+bool cZipArchive::splitMemberName( const QString &p_qsName, QString *p_poArchive, QString *p_poEntry ) throw()
+{
+    int inSeparator = p_qsName.indexOf( ZIP_MEMBER_SEPARATOR, 0, Qt::CaseInsensitive );
+    if( inSeparator == -1 ) return false;
+
+    // The archive name keeps its ".zip" extension, only the '#' separates the entry name
+    inSeparator += strlen( ZIP_MEMBER_SEPARATOR ) - 1;
+    *p_poArchive = p_qsName.left( inSeparator );
+    *p_poEntry   = p_qsName.mid( inSeparator + 1 );
+
+    return true;
+}
+
+QString cZipArchive::fileName() const throw()
+{
+    return m_qsFileName;
+}
+
+const cZipArchive::tsEntry *cZipArchive::findEntry( const QString &p_qsEntry ) const throw()
+{
+    tmEntryIndexes::const_iterator itEntry = m_maEntryIndexes.find( p_qsEntry );
+    if( itEntry == m_maEntryIndexes.end() ) return NULL;
+
+    return &m_veEntries[itEntry->second];
+}
+
+cZipEntryReader::cZipEntryReader( const QString &p_qsMemberName ) throw( cSevException )
+{
+    QString qsArchive;
+    QString qsEntry;
+    if( !cZipArchive::splitMemberName( p_qsMemberName, &qsArchive, &qsEntry ) )
+    {
+        throw cSevException( cSeverity::ERROR, QString( "%1 is not an entry of a ZIP archive" ).arg( p_qsMemberName ).toStdString() );
+    }
+
+    cZipArchive obArchive( qsArchive );
+    open( &obArchive, qsEntry );
+}
+
+cZipEntryReader::cZipEntryReader( const cZipArchive *p_poArchive, const QString &p_qsEntry ) throw( cSevException )
+{
+    open( p_poArchive, p_qsEntry );
+}
+
+void cZipEntryReader::open( const cZipArchive *p_poArchive, const QString &p_qsEntry ) throw( cSevException )
+{
+    QString qsArchive   = p_poArchive->fileName();
+    m_qsMemberName      = cZipArchive::memberName( qsArchive, p_qsEntry );
+    m_uiMethod          = 0;
+    m_ulExpectedCrc     = 0;
+    m_ulCrc             = crc32( 0L, Z_NULL, 0 );
+    m_ullCompressedLeft = 0;
+    m_ullSizeLeft       = 0;
+    m_boInflating       = false;
+
+    const cZipArchive::tsEntry *poEntry = p_poArchive->findEntry( p_qsEntry );
+    if( !poEntry )
+    {
+        throw cSevException( cSeverity::ERROR, QString( "No entry %1 in ZIP archive %2" ).arg( p_qsEntry ).arg( qsArchive ).toStdString() );
+    }
+    if( poEntry->uiFlags & 0x0001 )
+    {
+        throw cSevException( cSeverity::ERROR, QString( "Encrypted ZIP entry %1 is not supported" ).arg( m_qsMemberName ).toStdString() );
+    }
+    if( poEntry->uiMethod != 0 && poEntry->uiMethod != 8 )
+    {
+        throw cSevException( cSeverity::ERROR, QString( "Compression method %1 of ZIP entry %2 is not supported" ).arg( poEntry->uiMethod ).arg( m_qsMemberName ).toStdString() );
+    }
+
+    m_uiMethod          = poEntry->uiMethod;
+    m_ulExpectedCrc     = poEntry->ulCrc;
+    m_ullCompressedLeft = poEntry->ullCompressedSize;
+    m_ullSizeLeft       = poEntry->ullSize;
+
+    // The data starts after the local header, its name and extra field can differ from
+    // the ones in the central directory
+    m_obFile.setFileName( qsArchive );
+    char poHeader[30];
+    if( !m_obFile.open( QIODevice::ReadOnly ) ||
+        !readAt( &m_obFile, poEntry->ullLocalOffset, poHeader, 30 ) ||
+        readUInt32( poHeader ) != ZIP_LOCAL_HEADER ||
+        !m_obFile.seek( poEntry->ullLocalOffset + 30 + readUInt16( poHeader + 26 ) + readUInt16( poHeader + 28 ) ) )
+    {
+        throw cSevException( cSeverity::ERROR, QString( "Cannot find the data of ZIP entry %1" ).arg( m_qsMemberName ).toStdString() );
+    }
+
+    m_veInput.resize( 65536 );
+    if( m_uiMethod == 8 )
+    {
+        memset( &m_suStream, 0, sizeof( m_suStream ) );
+        if( inflateInit2( &m_suStream, -MAX_WBITS ) != Z_OK )
+        {
+            throw cSevException( cSeverity::ERROR, QString( "Cannot initialize inflating ZIP entry %1" ).arg( m_qsMemberName ).toStdString() );
+        }
+        m_boInflating = true;
+    }
+}
+
+cZipEntryReader::~cZipEntryReader() throw()
+{
+    if( m_boInflating ) inflateEnd( &m_suStream );
+}
+
+unsigned int cZipEntryReader::read( char *p_poBuffer, const unsigned int p_uiSize ) throw( cSevException )
+{
+    unsigned int uiRead = 0;
+
+    if( m_uiMethod == 0 )
+    {
+        unsigned int uiWanted = m_ullSizeLeft < p_uiSize ? m_ullSizeLeft : p_uiSize;
+        if( uiWanted && m_obFile.read( p_poBuffer, uiWanted ) != (qint64)uiWanted )
+        {
+            throw cSevException( cSeverity::ERROR, QString( "Unexpected end of ZIP entry %1" ).arg( m_qsMemberName ).toStdString() );
+        }
+        uiRead = uiWanted;
+    }
+    else
+    {
+        m_suStream.next_out  = (Bytef *)p_poBuffer;
+        m_suStream.avail_out = p_uiSize;
+        while( m_suStream.avail_out && m_ullSizeLeft > (unsigned long long)(p_uiSize - m_suStream.avail_out) )
+        {
+            if( !m_suStream.avail_in )
+            {
+                unsigned int uiWanted = m_ullCompressedLeft < m_veInput.size() ? m_ullCompressedLeft : m_veInput.size();
+                if( !uiWanted || m_obFile.read( &m_veInput[0], uiWanted ) != (qint64)uiWanted )
+                {
+                    throw cSevException( cSeverity::ERROR, QString( "Unexpected end of ZIP entry %1" ).arg( m_qsMemberName ).toStdString() );
+                }
+                m_ullCompressedLeft -= uiWanted;
+                m_suStream.next_in   = (Bytef *)&m_veInput[0];
+                m_suStream.avail_in  = uiWanted;
+            }
+
+            int inResult = inflate( &m_suStream, Z_NO_FLUSH );
+            if( inResult == Z_STREAM_END ) break;
+            if( inResult != Z_OK )
+            {
+                throw cSevException( cSeverity::ERROR, QString( "Error inflating ZIP entry %1: %2" ).arg( m_qsMemberName ).arg( m_suStream.msg ? m_suStream.msg : "corrupt data" ).toStdString() );
+            }
+        }
+        uiRead = p_uiSize - m_suStream.avail_out;
+        if( uiRead > m_ullSizeLeft )
+        {
+            throw cSevException( cSeverity::ERROR, QString( "ZIP entry %1 is longer than its recorded size" ).arg( m_qsMemberName ).toStdString() );
+        }
+    }
+
+    m_ullSizeLeft -= uiRead;
+    m_ulCrc = crc32( m_ulCrc, (const Bytef *)p_poBuffer, uiRead );
+
+    if( uiRead < p_uiSize || !m_ullSizeLeft )
+    {
+        if( m_ullSizeLeft )
+        {
+            throw cSevException( cSeverity::ERROR, QString( "Unexpected end of ZIP entry %1" ).arg( m_qsMemberName ).toStdString() );
+        }
+        if( m_ulCrc != m_ulExpectedCrc )
+        {
+            throw cSevException( cSeverity::ERROR, QString( "CRC error in ZIP entry %1" ).arg( m_qsMemberName ).toStdString() );
+        }
+    }
+
+    return uiRead;
+}
@@ -0,0 +1,143 @@
+#ifndef ZIPARCHIVE_H
+#define ZIPARCHIVE_H
+
+#include <QString>
+#include <QStringList>
+#include <QFile>
+#include <vector>
+#include <map>
+#include <zlib.h>
+
+#include <sevexception.h>
+
+//! \brief Lists the entries of a ZIP archive
+/*! The central directory of the archive is read when the object is created. Archives larger
+ *  than 4 GB and archives with more than 65535 entries (ZIP64) are supported, encrypted
+ *  entries and split archives are not.
+ *
+ *  An entry of an archive is referred to as a single logical Input Log File by a name made
+ *  of the archive name and the entry name, for example <tt>/logs/day1.zip#app/server.log</tt>
+ *  (see memberName() and splitMemberName()). cLineReader reads such a name with a
+ *  cZipEntryReader. The entries are looked up by their names in a map, so an archive that
+ *  is kept while its entries are read (see cLogDataSource::zipArchive()) has its central
+ *  directory read only once, however many entries it has.
+ */
+class cZipArchive
+{
+public:
+    //! \brief Constructor that reads the central directory of the given archive
+    /*! \param p_qsFileName name of the ZIP archive
+     */
+    cZipArchive( const QString &p_qsFileName ) throw( cSevException );
+
+    //! \brief Destructor
+    ~cZipArchive() throw();
+
+    //! \brief Returns the names of the file entries matching the given wild-card filter
+    /*! Directory entries are never returned. The filter is matched against the full name of
+     *  the entry, including its directories inside the archive.
+     *  \param p_qsFilter file name filter that can contain '*' and '?' characters
+     *  \return The entry names in the order they are stored in the archive
+     */
+    QStringList   entryNames( const QString &p_qsFilter = "*" ) const throw();
+
+    //! \brief Returns the logical file name of an entry of an archive
+    static QString memberName( const QString &p_qsArchive, const QString &p_qsEntry ) throw();
+
+    //! \brief Splits a logical file name to the name of the archive and the entry
+    /*! \return <tt>false</tt> if the name does not refer to an entry of a ZIP archive
+     */
+    static bool   splitMemberName( const QString &p_qsName, QString *p_poArchive, QString *p_poEntry ) throw();
+
+    //! \brief Returns the name of the archive
+    QString       fileName() const throw();
+
+private:
+    //! An entry of the central directory
+    typedef struct
+    {
+        QString             qsName;
+        unsigned int        uiMethod;
+        unsigned int        uiFlags;
+        unsigned long       ulCrc;
+        unsigned long long  ullCompressedSize;
+        unsigned long long  ullSize;
+        unsigned long long  ullLocalOffset;
+    } tsEntry;
+
+    //! Index of the entries in m_veEntries by their names
+    typedef std::map<QString, unsigned int>  tmEntryIndexes;
+
+    //! Name of the archive, used in error messages
+    QString               m_qsFileName;
+    //! The entries of the central directory
+    std::vector<tsEntry>  m_veEntries;
+    //! The index of the entries of the central directory
+    tmEntryIndexes        m_maEntryIndexes;
+
+    //! \brief Returns the entry with the given name, NULL if there is no such entry
+    const tsEntry *findEntry( const QString &p_qsEntry ) const throw();
+
+    friend class cZipEntryReader;
+};
+
+//! \brief Reads the inflated data of a single entry of a ZIP archive
+/*! The entry is inflated while it is read, using a small input buffer, so the inflated
+ *  data is never stored anywhere but in the buffer of the caller. Stored and deflated
+ *  entries are supported. The CRC of the inflated data is checked at the end of the entry.
+ *
+ *  Each reader has its own file handle and inflate state, so the entries of an archive
+ *  (or the same entry) could be read by several readers at the same time. The log analysis
+ *  reads its Input Log Files one after another, so the entries are inflated one by one.
+ */
+class cZipEntryReader
+{
+public:
+    //! \brief Constructor that opens an entry of an archive
+    /*! \param p_qsMemberName the logical file name of the entry, see cZipArchive::memberName()
+     */
+    cZipEntryReader( const QString &p_qsMemberName ) throw( cSevException );
+
+    //! \brief Constructor that opens an entry of an archive whose central directory is read
+    /*! \param p_poArchive the archive
+     *  \param p_qsEntry the name of the entry inside the archive
+     */
+    cZipEntryReader( const cZipArchive *p_poArchive, const QString &p_qsEntry ) throw( cSevException );
+
+    //! \brief Destructor that closes the archive
+    ~cZipEntryReader() throw();
+
+    //! \brief Reads the next part of the inflated entry
+    /*! \param p_poBuffer the buffer that receives the data
+     *  \param p_uiSize size of the buffer in bytes
+     *  \return The number of bytes read, less than p_uiSize only at the end of the entry
+     */
+    unsigned int  read( char *p_poBuffer, const unsigned int p_uiSize ) throw( cSevException );
+
+private:
+    //! The logical file name of the entry, used in error messages
+    QString             m_qsMemberName;
+    //! The archive
+    QFile               m_obFile;
+    //! Compression method of the entry, 0 (stored) or 8 (deflated)
+    unsigned int        m_uiMethod;
+    //! Expected CRC of the inflated data
+    unsigned long       m_ulExpectedCrc;
+    //! CRC of the data read so far
+    unsigned long       m_ulCrc;
+    //! Number of compressed bytes not read from the archive yet
+    unsigned long long  m_ullCompressedLeft;
+    //! Number of inflated bytes not returned yet
+    unsigned long long  m_ullSizeLeft;
+    //! The inflate state of a deflated entry
+    z_stream            m_suStream;
+    //! True when m_suStream is initialized
+    bool                m_boInflating;
+    //! The buffer of the compressed data
+    std::vector<char>   m_veInput;
+
+    //! \brief Opens the given entry of an archive, called by the constructors
+    void          open( const cZipArchive *p_poArchive, const QString &p_qsEntry ) throw( cSevException );
+};
+
+#endif // ZIPARCHIVE_H
@@ -1,17 +1,115 @@
 #include <QDomDocument>
 #include <QDomElement>
+#include <QThread>
 
 #include <logger.h>
 
+#include <cstring>
+#include <cstdlib>
+#include <vector>
+
 #include "actiondefsingleliner.h"
 #include "countaction.h"
 #include "pattern.h"
 #include "actiondeflist.h"
+#include "regexpset.h"
+#include "timestampparser.h"
 
 #include "actiondeftest.h"
 
 extern cLogger g_obLogger;
 
+//! Creates a Pattern that is always matched by PCRE2, used as the reference engine
+static cPattern *referencePattern( const QString &p_qsRegExp )
+{
+    // A leading group keeps the Pattern out of the literal and literal prefix engines
+    QDomDocument obDomDoc( "ActionTest" );
+    QDomElement  obDomElem = obDomDoc.createElement( "pattern" );
+    obDomElem.setAttribute( "name", "REFERENCE" );
+    obDomElem.setAttribute( "regexp", "(?:)" + p_qsRegExp );
+
+    return new cPattern( &obDomElem );
+}
+
+//! Returns a random text of the given alphabet
+static QString randomText( const char *p_poAlphabet, const unsigned int p_uiMaxLength )
+{
+    QString      qsText;
+    unsigned int uiLength = rand() % (p_uiMaxLength + 1);
+    for( unsigned int i = 0; i < uiLength; i++ ) qsText.append( p_poAlphabet[rand() % strlen( p_poAlphabet )] );
+
+    return qsText;
+}
+
+//! Returns a random regular expression of the syntax covered by cRegExpSet
+static QString randomRegExp( const unsigned int p_uiDepth )
+{
+    const char *poAtoms[] = { "a", "b", "c", "1", " ", ".", "[ab]", "[^a ]", "[a-c1]", "\\d", "\\w", "\\s", "\\." };
+    const char *poQuantifiers[] = { "*", "+", "?", "{1,2}", "{2}", "*?", "+?", "??" };
+
+    QString      qsRegExp;
+    unsigned int uiItems = 1 + rand() % 3;
+    for( unsigned int i = 0; i < uiItems; i++ )
+    {
+        if( p_uiDepth < 2 && rand() % 5 == 0 )
+        {
+            qsRegExp += "(" + randomRegExp( p_uiDepth + 1 ) + (rand() % 2 ? "|" + randomRegExp( p_uiDepth + 1 ) : QString()) + ")";
+        }
+        else
+        {
+            qsRegExp += poAtoms[rand() % (sizeof( poAtoms ) / sizeof( poAtoms[0] ))];
+        }
+        if( rand() % 3 == 0 ) qsRegExp += poQuantifiers[rand() % (sizeof( poQuantifiers ) / sizeof( poQuantifiers[0] ))];
+    }
+    if( rand() % 4 == 0 ) qsRegExp += "|" + randomRegExp( p_uiDepth + 1 );
+
+    return qsRegExp;
+}
+
+//! Scans a few Log Lines many times with its own scratch objects and shared Action Definitions
+class cPatternScanThread : public QThread
+{
+public:
+    cPatternScanThread( const cActionDefList *p_poActionDefList ) : m_poActionDefList( p_poActionDefList ), m_uiMatchCount( 0 ) {}
+
+    unsigned int matchCount() const { return m_uiMatchCount; }
+
+protected:
+    void run()
+    {
+        const char *poLines[] = { "2010-04-09 13:35:00.000 [CYCLER.CORE.INFO.0] Spotted a White Furry Rabbit",
+                                  "2010-04-09 13:35:00.001 [CYCLER.CORE.INFO.0] Wasted additional 3 Holy Hand Grenades",
+                                  "2010-04-09 13:35:00.002 [CYCLER.CORE.INFO.0] Nothing to see here" };
+
+        cPatternScratch   obScratch;
+        cTimeStampScratch obTimeStampScratch( &m_poActionDefList->timeStampParser() );
+        for( unsigned int i = 0; i < 3000; i++ )
+        {
+            const char  *poLine   = poLines[i % 3];
+            unsigned int uiLength = strlen( poLine );
+            for( cActionDefList::tiPatternList itPattern = m_poActionDefList->patternBegin();
+                 itPattern != m_poActionDefList->patternEnd();
+                 itPattern++ )
+            {
+                if( !itPattern->matches( poLine, uiLength, &obScratch ) ) continue;
+
+                QString              qsTimeStamp;
+                cAction::tsTimeStamp suTimeStamp;
+                if( itPattern->capturedTexts( poLine, &obScratch ).size() > 1 &&
+                    m_poActionDefList->timeStampParser().parse( poLine, uiLength, &qsTimeStamp, &suTimeStamp, &obTimeStampScratch ) &&
+                    suTimeStamp.uiMSecond == i % 3 )
+                {
+                    m_uiMatchCount++;
+                }
+            }
+        }
+    }
+
+private:
+    const cActionDefList *m_poActionDefList;
+    unsigned int          m_uiMatchCount;
+};
+
 cActionDefTest::cActionDefTest() throw() : cUnitTest( "Action Definition" )
 {
 }
@@ -26,6 +124,8 @@ void cActionDefTest::run() throw()
     testCountActions();
     testPatterns();
     testActionDefList();
+    testRegExpSetReference();
+    testFastEngineReference();
 }
 
 void cActionDefTest::testSingleLinerDef() throw()
@@ -210,6 +310,8 @@ void cActionDefTest::testPatterns() throw()
 
         testCase( "Pattern Correct DOM Element Captures List size", 3, poPattern->captures().size() );
 
+        testCase( "Pattern Correct DOM Element Literal", "", poPattern->literal().toStdString() );
+
         QStringList slNumbers = poPattern->capturedTexts( "4 shalt thou not count, neither count thou 2, excepting that thou then proceed to 3." );
 
         testCase( "Pattern Correct DOM Element Captured Text List size", 4, slNumbers.size() );
@@ -228,6 +330,96 @@ void cActionDefTest::testPatterns() throw()
 
         delete poPattern;
 
+        obDomElem.setAttribute( "regexp", "Spotted a (\\S+) (?:Furry )?Rabbit$" );
+        poPattern = new cPattern( &obDomElem );
+
+        const char *poLine = "Spotted a White Rabbit";
+        testCase( "Pattern matches Log Line bytes", true, poPattern->matches( poLine, strlen( poLine ) ) );
+
+        testCase( "Pattern does not match Log Line prefix", false, poPattern->matches( poLine, 10 ) );
+
+        slNumbers = poPattern->capturedTexts( "Spotted a Black Furry Rabbit" );
+
+        testCase( "Pattern non-capturing group Captured Text List size", 2, slNumbers.size() );
+
+        testCase( "Pattern non-capturing group Captured Text", "Black", slNumbers.at( 1 ).toStdString() );
+
+        testCase( "Pattern no match Captured Text List size", 2, poPattern->capturedTexts( "Missed" ).size() );
+
+        delete poPattern;
+
+        obDomElem.setAttribute( "regexp", "Spotted a (\\S+)$" );
+        poPattern = new cPattern( &obDomElem );
+
+        testCase( "Pattern literal prefix Engine", cPattern::PREFIX, poPattern->engine() );
+
+        slNumbers = poPattern->capturedTexts( "Spotted a Spotted a Rabbit" );
+
+        testCase( "Pattern literal prefix Captured Text", "Rabbit", slNumbers.at( 1 ).toStdString() );
+
+        testCase( "Pattern literal prefix whole match", "Spotted a Rabbit", slNumbers.at( 0 ).toStdString() );
+
+        testCase( "Pattern literal prefix no match", false, poPattern->matches( "Spotted a White Rabbit" ) );
+
+        delete poPattern;
+
+        obDomElem.setAttribute( "regexp", "^Holy Hand Grenade\\." );
+        poPattern = new cPattern( &obDomElem );
+
+        testCase( "Pattern anchored literal Engine", cPattern::LITERAL, poPattern->engine() );
+
+        testCase( "Pattern anchored literal matches", true, poPattern->matches( "Holy Hand Grenade. Of Antioch" ) );
+
+        testCase( "Pattern anchored literal not at start", false, poPattern->matches( "The Holy Hand Grenade." ) );
+
+        delete poPattern;
+
+        obDomElem.setAttribute( "regexp", "Spotted a (\\S+) (?:Furry )?Rabbit$" );
+        poPattern = new cPattern( &obDomElem );
+
+        testCase( "Pattern single unbounded quantifier not backtracking prone", false, poPattern->backtrackingProne() );
+
+        delete poPattern;
+
+        obDomElem.setAttribute( "regexp", ".*Holy.*Grenade" );
+        poPattern = new cPattern( &obDomElem );
+
+        testCase( "Pattern two wildcards backtracking prone", true, poPattern->backtrackingProne() );
+
+        delete poPattern;
+
+        obDomElem.setAttribute( "regexp", "(a+)+[bc]" );
+        poPattern = new cPattern( &obDomElem );
+
+        testCase( "Pattern nested quantifiers backtracking prone", true, poPattern->backtrackingProne() );
+
+        cPatternScratch obScratch;
+        obScratch.setMatchBudget( 10000 );
+        QString qsLine = QString( 30, QChar( 'a' ) );
+
+        testCase( "Pattern over match budget does not match", false, poPattern->matches( qsLine, &obScratch ) );
+
+        testCase( "Pattern over match budget reported", true, obScratch.overBudget() );
+
+        testCase( "Pattern within match budget matches", true, poPattern->matches( qsLine + "c", &obScratch ) );
+
+        testCase( "Pattern within match budget not reported", false, obScratch.overBudget() );
+
+        delete poPattern;
+
+        bool boThrown = false;
+        obDomElem.setAttribute( "regexp", "Spotted a (.*" );
+        try
+        {
+            poPattern = new cPattern( &obDomElem );
+            delete poPattern;
+        } catch( cSevException & )
+        {
+            boThrown = true;
+        }
+
+        testCase( "Pattern invalid regexp throws exception", true, boThrown );
+
     } catch( cSevException &e )
     {
         g_obLogger << e;
@@ -263,6 +455,79 @@ void cActionDefTest::testActionDefList() throw()
 
         testCase( "ActionDefList Pattern count", 4, uiPatternCount );
 
+        testCase( "ActionDefList Pattern 1 Literal", "Hereby Started ", obActionDefList.patternBegin()->literal().toStdString() );
+
+        testCase( "ActionDefList Pattern 3 Literal", " Holy Hand Grenades", (obActionDefList.patternBegin() + 2)->literal().toStdString() );
+
+        testCase( "ActionDefList Pattern 1 Engine", cPattern::PREFIX, obActionDefList.patternBegin()->engine() );
+
+        testCase( "ActionDefList Pattern 2 Engine", cPattern::LITERAL, (obActionDefList.patternBegin() + 1)->engine() );
+
+        testCase( "ActionDefList Pattern 3 Engine", cPattern::REGEXP, (obActionDefList.patternBegin() + 2)->engine() );
+
+        std::vector<unsigned char> veCandidates;
+        const char *poLine = "2010-04-09 13:35:00.000 [CYCLER.CORE.INFO.0] Spotted a White Furry Rabbit";
+        testCase( "ActionDefList Prefilter candidate count", 1, obActionDefList.literalFilter().candidates( poLine, strlen( poLine ), &veCandidates ) );
+
+        testCase( "ActionDefList Prefilter selects Pattern 4", true, veCandidates.at( 3 ) == 1 );
+
+        poLine = "2010-04-09 13:15:10.000 [CYCLER.CORE.INFO.0] The Holy Hand Grenade missed";
+        testCase( "ActionDefList Prefilter no candidates", 0, obActionDefList.literalFilter().candidates( poLine, strlen( poLine ), &veCandidates ) );
+
+        testCase( "ActionDefList RegExpSet covered count", 4, obActionDefList.regExpSet().coveredCount() );
+
+        std::vector<unsigned char> veMatches;
+        cRegExpSetCache            obCache;
+        poLine = "2010-04-09 13:35:00.000 [CYCLER.CORE.INFO.0] Wasted additional 3 Holy Hand Grenades";
+        testCase( "ActionDefList RegExpSet match", true, obActionDefList.regExpSet().match( poLine, strlen( poLine ), &obCache, &veMatches ) );
+
+        testCase( "ActionDefList RegExpSet matches Pattern 3", true, veMatches.at( 2 ) == 1 );
+
+        testCase( "ActionDefList RegExpSet does not match Pattern 2", false, veMatches.at( 1 ) == 1 );
+
+        cRegExpSetCache obTinyCache( 16 );
+        testCase( "ActionDefList RegExpSet cache limit falls back", false, obActionDefList.regExpSet().match( poLine, strlen( poLine ), &obTinyCache, &veMatches ) );
+
+        cActionDefList::tiPatternList itSpotted = obActionDefList.patternBegin() + 3;
+        testCase( "ActionDefList Pattern 4 fused", true, itSpotted->fused() );
+
+        QStringList slTimeStampTexts;
+        QStringList slCapturedTexts;
+        poLine = "2010-04-09 13:35:00.000 [CYCLER.CORE.INFO.0] Spotted a White Furry Rabbit";
+        testCase( "ActionDefList Fused match", true, itSpotted->matchFused( poLine, strlen( poLine ), &slTimeStampTexts, &slCapturedTexts ) );
+
+        testCase( "ActionDefList Fused Captured Text", "White Furry Rabbit", slCapturedTexts.at( 1 ).toStdString() );
+
+        testCase( "ActionDefList Fused Captured Texts same as capturedTexts()", true, slCapturedTexts == itSpotted->capturedTexts( poLine ) );
+
+        testCase( "ActionDefList Fused TimeStamp", "2010-04-09 13:35:00.000", slTimeStampTexts.at( 0 ).toStdString() );
+
+        testCase( "ActionDefList Fused TimeStamp MSecond", "000", slTimeStampTexts.at( 7 ).toStdString() );
+
+        poLine = "[CYCLER.CORE.INFO.0] Spotted a White Furry Rabbit";
+        testCase( "ActionDefList Fused match without TimeStamp", true, itSpotted->matchFused( poLine, strlen( poLine ), &slTimeStampTexts, &slCapturedTexts ) );
+
+        testCase( "ActionDefList Fused missing TimeStamp list empty", true, slTimeStampTexts.isEmpty() );
+
+        poLine = "2010-04-09 13:15:10.000 [CYCLER.CORE.INFO.0] The Holy Hand Grenade missed";
+        testCase( "ActionDefList Fused no match", false, itSpotted->matchFused( poLine, strlen( poLine ), &slTimeStampTexts, &slCapturedTexts ) );
+
+        cPatternScanThread obThread1( &obActionDefList );
+        cPatternScanThread obThread2( &obActionDefList );
+        cPatternScanThread obThread3( &obActionDefList );
+        obThread1.start();
+        obThread2.start();
+        obThread3.start();
+        obThread1.wait();
+        obThread2.wait();
+        obThread3.wait();
+
+        testCase( "ActionDefList shared by threads, thread 1 matches", 2000, obThread1.matchCount() );
+
+        testCase( "ActionDefList shared by threads, thread 2 matches", 2000, obThread2.matchCount() );
+
+        testCase( "ActionDefList shared by threads, thread 3 matches", 2000, obThread3.matchCount() );
+
         unsigned int uiSingleLinerCount = 0;
         for( cActionDefList::tiSingleLinerList itSingleLiner = obActionDefList.singleLinerBegin();
             itSingleLiner != obActionDefList.singleLinerEnd();
@@ -307,9 +572,146 @@ void cActionDefTest::testActionDefList() throw()
 
         testCase( "Bad ActionDefList Timestamp Regexp (XML validation ERROR above is EXPECTED)", "", obBadActionDefList.timeStampRegExp().pattern().toStdString() );
 
+        // The Pattern with the invalid regular expression is left out, the matchers are
+        // built from the other two
+        cActionDefList obInvalidActionDefList( "test/invalid_regexp_actions.xml", "data/lara_actions.xsd" );
+
+        int inValidPatterns = obInvalidActionDefList.patternEnd() - obInvalidActionDefList.patternBegin();
+        testCase( "Invalid Pattern regexp, Pattern count (Invalid regular expression ERROR above is EXPECTED)", 2, inValidPatterns );
+        testCase( "Invalid Pattern regexp, Last Pattern kept", "PAT_TARGET_SPOTTED",
+                  inValidPatterns ? (obInvalidActionDefList.patternEnd() - 1)->name().toStdString() : std::string() );
+        testCase( "Invalid Pattern regexp, Prefilter Pattern count", 2, (int)obInvalidActionDefList.literalFilter().patternCount() );
+        testCase( "Invalid Pattern regexp, Regexp set Pattern count", 2, (int)obInvalidActionDefList.regExpSet().patternCount() );
+
     } catch( cSevException &e )
     {
         g_obLogger << e;
         m_uiFailedNum++;
     }
 }
+
+void cActionDefTest::testRegExpSetReference() throw()
+{
+    printNote( "REGEXP SET REFERENCE TESTS" );
+
+    // Random regular expressions of the covered syntax, anchored now and then, matched by
+    // the set and one by one by PCRE2 against random lines of the same few characters
+    try
+    {
+        srand( 5 );
+        unsigned int uiUncovered = 0;
+        unsigned int uiDifferent = 0;
+        for( unsigned int uiRound = 0; uiRound < 50; uiRound++ )
+        {
+            QStringList            slRegExps;
+            std::vector<cPattern*> vePatterns;
+            for( unsigned int i = 0; i < 20; i++ )
+            {
+                QString qsRegExp = randomRegExp( 0 );
+                if( rand() % 4 == 0 ) qsRegExp = "^(" + qsRegExp + ")";
+                if( rand() % 4 == 0 ) qsRegExp = "(" + qsRegExp + ")$";
+                slRegExps.push_back( qsRegExp );
+                vePatterns.push_back( referencePattern( qsRegExp ) );
+            }
+
+            cRegExpSet obSet;
+            obSet.build( slRegExps );
+            uiUncovered += obSet.patternCount() - obSet.coveredCount();
+
+            cRegExpSetCache            obCache;
+            std::vector<unsigned char> veMatches;
+            for( unsigned int uiLine = 0; uiLine < 100; uiLine++ )
+            {
+                QByteArray baLine = randomText( "abc1 .", 12 ).toAscii();
+                if( !obSet.match( baLine.constData(), baLine.size(), &obCache, &veMatches ) )
+                {
+                    uiDifferent++;
+                    continue;
+                }
+                for( unsigned int i = 0; i < vePatterns.size(); i++ )
+                {
+                    if( !obSet.covers( i ) ) continue;
+                    if( (veMatches[i] == 1) != vePatterns[i]->matches( baLine.constData(), baLine.size() ) )
+                    {
+                        printNote( QString( "RegExpSet differs from PCRE2: \"%1\" on \"%2\"" )
+                                   .arg( slRegExps.at( i ) ).arg( QString( baLine ) ).toStdString() );
+                        uiDifferent++;
+                    }
+                }
+            }
+            for( unsigned int i = 0; i < vePatterns.size(); i++ ) delete vePatterns[i];
+        }
+
+        testCase( "RegExpSet covers every random Pattern", 0, (int)uiUncovered );
+        testCase( "RegExpSet matches the same as PCRE2", 0, (int)uiDifferent );
+    }
+    catch( cSevException &e )
+    {
+        g_obLogger << e;
+        m_uiFailedNum++;
+    }
+}
+
+void cActionDefTest::testFastEngineReference() throw()
+{
+    printNote( "FAST PATTERN ENGINE REFERENCE TESTS" );
+
+    // Random literals, anchored now and then, and literals followed by a capture of a simple
+    // class, matched by the literal engines and by PCRE2 against random lines
+    const char *poClasses[]     = { ".", "\\S", "\\d", "\\w" };
+    const char *poQuantifiers[] = { "*", "+" };
+
+    srand( 8 );
+    unsigned int uiSlow      = 0;
+    unsigned int uiDifferent = 0;
+    try
+    {
+        for( unsigned int uiRound = 0; uiRound < 400; uiRound++ )
+        {
+            QString qsLiteral = randomText( "ab-1 .", 3 );
+            if( qsLiteral.isEmpty() ) qsLiteral = "a";
+
+            QString qsRegExp = QString( qsLiteral ).replace( ".", "\\." );
+            if( uiRound % 2 )
+            {
+                qsRegExp += QString( "(%1%2)" ).arg( poClasses[rand() % 4] ).arg( poQuantifiers[rand() % 2] );
+                if( rand() % 3 == 0 ) qsRegExp += "$";
+            }
+            else
+            {
+                if( rand() % 3 == 0 ) qsRegExp = "^" + qsRegExp;
+                if( rand() % 3 == 0 ) qsRegExp += "$";
+            }
+
+            QDomDocument obDomDoc( "ActionTest" );
+            QDomElement  obDomElem = obDomDoc.createElement( "pattern" );
+            obDomElem.setAttribute( "name", "FAST" );
+            obDomElem.setAttribute( "regexp", qsRegExp );
+            cPattern  obPattern( &obDomElem );
+            cPattern *poReference = referencePattern( qsRegExp );
+            if( obPattern.engine() == cPattern::REGEXP ) uiSlow++;
+
+            for( unsigned int uiLine = 0; uiLine < 50; uiLine++ )
+            {
+                QString    qsLine = randomText( "ab-1 .2\t", 16 );
+                QByteArray baLine = qsLine.toAscii();
+                if( obPattern.matches( baLine.constData(), baLine.size() ) != poReference->matches( baLine.constData(), baLine.size() ) ||
+                    obPattern.capturedTexts( qsLine ) != poReference->capturedTexts( qsLine ) )
+                {
+                    printNote( QString( "%1 engine differs from PCRE2: \"%2\" on \"%3\"" )
+                               .arg( cPattern::engineName( obPattern.engine() ) ).arg( qsRegExp ).arg( qsLine ).toStdString() );
+                    uiDifferent++;
+                }
+            }
+            delete poReference;
+        }
+    }
+    catch( cSevException &e )
+    {
+        g_obLogger << e;
+        m_uiFailedNum++;
+    }
+
+    testCase( "Every random literal Pattern uses a literal engine", 0, (int)uiSlow );
+    testCase( "Literal engines match and capture the same as PCRE2", 0, (int)uiDifferent );
+}
@@ -16,6 +16,8 @@ private:
     void         testCountActions()   throw();
     void         testPatterns()       throw();
     void         testActionDefList()  throw();
+    void         testRegExpSetReference() throw();
+    void         testFastEngineReference() throw();
 };
 
 #endif // ACTIONDEFTEST_H
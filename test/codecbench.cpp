@@ -0,0 +1,106 @@
+#include <QString>
+#include <QStringList>
+#include <QFile>
+#include <QElapsedTimer>
+
+#include <vector>
+#include <zlib.h>
+
+#include <logger.h>
+#include <preferences.h>
+#include <streamcodec.h>
+
+#include "codecbench.h"
+#include "testcompressor.h"
+
+extern cLogger       g_obLogger;
+extern cPreferences *g_poPrefs;
+
+static const unsigned int  s_uiDataSize    = 32 * 1024 * 1024;
+static const unsigned int  s_uiRepetitions = 4;
+
+cCodecBench::cCodecBench() throw() : cUnitTest( "Stream Codec Benchmark" )
+{
+    // Synthetic Input Log, the changing numbers keep it from compressing unrealistically well
+    m_baData.reserve( s_uiDataSize );
+    for( unsigned int i = 0; (unsigned int)m_baData.size() + 200 < s_uiDataSize; i++ )
+    {
+        m_baData.append( QString( "2010-04-09 13:%1:%2.%3 [CYCLER.CORE.INFO.%4] Request %5 of session %6 served in %7 ms\n" )
+                         .arg( (i / 6000) % 60, 2, 10, QChar( '0' ) ).arg( (i / 100) % 60, 2, 10, QChar( '0' ) )
+                         .arg( (i * 7) % 1000, 3, 10, QChar( '0' ) ).arg( i % 5 ).arg( i )
+                         .arg( (i * 2654435761U) % 100000 ).arg( (i * 40503U) % 997 ).toAscii() );
+    }
+}
+
+cCodecBench::~cCodecBench() throw()
+{
+}
+
+void cCodecBench::run() throw()
+{
+    QStringList slCodecs = cCodecRegistry::names();
+    for( int i = 0; i < slCodecs.size(); i++ )
+    {
+        benchDecompress( slCodecs.at( i ) );
+    }
+}
+
+void cCodecBench::benchDecompress( const QString &p_qsCodec ) throw()
+{
+    printNote( QString( "%1 DECOMPRESS BENCHMARK" ).arg( p_qsCodec.toUpper() ).toStdString() );
+
+    const cStreamCodec *poCodec      = cCodecRegistry::codec( p_qsCodec );
+    QByteArray          baCompressed = cTestCompressor::compress( p_qsCodec, m_baData );
+    if( baCompressed.isEmpty() )
+    {
+        printNote( QString( "%1 is not supported by the benchmark" ).arg( p_qsCodec ).toStdString() );
+        return;
+    }
+
+    QString qsFileName = QString( "%1/codecbench%2" ).arg( g_poPrefs->tempDir() ).arg( poCodec->extension() );
+    QFile   obFile( qsFileName );
+    obFile.open( QIODevice::WriteOnly | QIODevice::Truncate );
+    obFile.write( baCompressed );
+    obFile.close();
+
+    testCase( QString( "%1 recognized" ).arg( p_qsCodec ).toStdString(), true, cCodecRegistry::find( qsFileName ) == poCodec );
+
+    std::vector<char>  veBuffer( 1048576 );
+    unsigned long long ullSize = 0;
+    unsigned long      ulCrc   = 0;
+    QElapsedTimer      obTimer;
+    obTimer.start();
+    try
+    {
+        for( unsigned int r = 0; r < s_uiRepetitions; r++ )
+        {
+            cStreamReader *poReader = poCodec->open( qsFileName );
+            unsigned int   uiRead   = 0;
+            ullSize = 0;
+            ulCrc   = crc32( 0L, Z_NULL, 0 );
+            do
+            {
+                uiRead   = poReader->read( &veBuffer[0], veBuffer.size() );
+                ullSize += uiRead;
+                ulCrc    = crc32( ulCrc, (const Bytef *)&veBuffer[0], uiRead );
+            } while( uiRead == veBuffer.size() );
+            delete poReader;
+        }
+    }
+    catch( cSevException &e )
+    {
+        g_obLogger << e;
+        m_uiFailedNum++;
+    }
+    qint64 inNanoSecs = obTimer.nsecsElapsed();
+
+    testCase( QString( "%1 decompressed size" ).arg( p_qsCodec ).toStdString(), m_baData.size(), (int)ullSize );
+    testCase( QString( "%1 decompressed data" ).arg( p_qsCodec ).toStdString(), true,
+              ulCrc == crc32( crc32( 0L, Z_NULL, 0 ), (const Bytef *)m_baData.constData(), m_baData.size() ) );
+
+    printNote( QString( "%1: compressed to %2%, decompressed at %3 MB/s" ).arg( p_qsCodec )
+               .arg( 100.0 * baCompressed.size() / m_baData.size(), 0, 'f', 1 )
+               .arg( (double)m_baData.size() * s_uiRepetitions * 1000 / inNanoSecs, 0, 'f', 0 ).toStdString() );
+
+    QFile::remove( qsFileName );
+}
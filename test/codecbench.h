@@ -0,0 +1,23 @@
+#ifndef CODECBENCH_H
+#define CODECBENCH_H
+
+#include <QString>
+#include <QByteArray>
+
+#include "unittest.h"
+
+class cCodecBench : public cUnitTest
+{
+public:
+    cCodecBench()                 throw();
+    virtual ~cCodecBench()        throw();
+
+    virtual void run()            throw();
+
+private:
+    QByteArray   m_baData;
+
+    void         benchDecompress( const QString &p_qsCodec ) throw();
+};
+
+#endif // CODECBENCH_H
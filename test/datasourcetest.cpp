@@ -1,12 +1,29 @@
 #include <QStringList>
 #include <QFile>
+#include <QDir>
+#include <QFileInfo>
 
 #include <logger.h>
 #include <preferences.h>
 
 #include <logdatasource.h>
+#include <linereader.h>
+#include <syserrordecoder.h>
+#include <gzipindex.h>
+#include <preparedcache.h>
+#include <streamcodec.h>
+#include <followstate.h>
+#include <filediscovery.h>
+#include <ziparchive.h>
+#include <lineindex.h>
+#include <linesplitter.h>
+
+#include <vector>
+#include <cstdlib>
+#include <zlib.h>
 
 #include "datasourcetest.h"
+#include "testcompressor.h"
 
 extern cLogger       g_obLogger;
 extern cPreferences *g_poPrefs;
@@ -22,6 +39,15 @@ cDataSourceTest::~cDataSourceTest() throw()
 void cDataSourceTest::run() throw()
 {
     testDataSource();
+    testDecodeKernels();
+    testSplitKernels();
+    testGzipIndex();
+    testPreparedCache();
+    testStreamCodecs();
+    testFollowState();
+    testLongLines();
+    testFileDiscovery();
+    testLineIndex();
 }
 
 void cDataSourceTest::testDataSource() throw()
@@ -30,12 +56,24 @@ void cDataSourceTest::testDataSource() throw()
 
     try
     {
+        // The prepared files are named after the original files, with a hash of their path
+        QString qsPrepared1 = cLogDataSource::tempFileName( QString( "%1/multiple_files/test1/test1.log.gz" ).arg( g_poPrefs->inputDir() ) );
+        QString qsPrepared2 = cLogDataSource::tempFileName( QString( "%1/multiple_files/test1/test2.log.gz" ).arg( g_poPrefs->inputDir() ) );
+        QString qsCopied    = cLogDataSource::tempFileName( QString( "%1/multiple_files/test1/test.log" ).arg( g_poPrefs->inputDir() ) );
+        qsPrepared1.chop( 3 );
+        qsPrepared2.chop( 3 );
+
+        testCase( "Temporary files: Same names in different directories differ", false,
+                  cLogDataSource::tempFileName( QString( "%1/multiple_files/test1/test.log" ).arg( g_poPrefs->inputDir() ) ) ==
+                  cLogDataSource::tempFileName( QString( "%1/multiple_files/test2/test.log" ).arg( g_poPrefs->inputDir() ) ) );
+        testCase( "Temporary files: Name ends with the file name", true, qsCopied.endsWith( ".test.log" ) );
+
         cLogDataSource  *poDS = new cLogDataSource( g_poPrefs->inputDir(), "multiple_files/test1/test*.gz" );
 
         QStringList  slLogFiles = poDS->logFileList();
         testCase( "Gzipped files: Prepared Input Log Count", 2, slLogFiles.size() );
-        testCase( "Gzipped files: Prepared Log 1 File Name", QString("%1/test1.log" ).arg( g_poPrefs->tempDir() ).toStdString(), slLogFiles.at( 0 ).toStdString() );
-        testCase( "Gzipped files: Prepared Log 2 File Name", QString("%1/test2.log" ).arg( g_poPrefs->tempDir() ).toStdString(), slLogFiles.at( 1 ).toStdString() );
+        testCase( "Gzipped files: Prepared Log 1 File Name", qsPrepared1.toStdString(), slLogFiles.at( 0 ).toStdString() );
+        testCase( "Gzipped files: Prepared Log 2 File Name", qsPrepared2.toStdString(), slLogFiles.at( 1 ).toStdString() );
 
         testCase( "Gzipped files: Prepared Log 1 File exists", true, QFile::exists( slLogFiles.at( 0 ) ) );
         testCase( "Gzipped files: Prepared Log 2 File exists", true, QFile::exists( slLogFiles.at( 1 ) ) );
@@ -50,11 +88,23 @@ void cDataSourceTest::testDataSource() throw()
         testCase( "Gzipped files: Prepared Log 1 File exists after delete", false, QFile::exists( slLogFiles.at( 0 ) ) );
         testCase( "Gzipped files: Prepared Log 2 File exists after delete", false, QFile::exists( slLogFiles.at( 1 ) ) );
 
+        // A resumed analysis does not prepare the files it searched before the checkpoint
+        QString qsDoneFile = QString( "%1/multiple_files/test1/test1.log.gz" ).arg( g_poPrefs->inputDir() );
+        poDS = new cLogDataSource( g_poPrefs->inputDir(), "multiple_files/test1/test*.gz", false, 0, NULL, QStringList( qsDoneFile ) );
+
+        slLogFiles = poDS->logFileList();
+        testCase( "Resumed gzipped files: Prepared Input Log Count", 1, slLogFiles.size() );
+        testCase( "Resumed gzipped files: Searched file not prepared", false, QFile::exists( qsPrepared1 ) );
+        testCase( "Resumed gzipped files: Original of the prepared file", QString("%1/multiple_files/test1/test2.log.gz" ).arg( g_poPrefs->inputDir() ).toStdString(),
+                  slLogFiles.size() ? poDS->origFileName( slLogFiles.at( 0 ) ).toStdString() : std::string() );
+
+        delete poDS;
+
         poDS = new cLogDataSource( g_poPrefs->inputDir(), "multiple_files/test1/test*.log" );
 
         slLogFiles = poDS->logFileList();
         testCase( "Copied files: Prepared Input Log Count", 1, slLogFiles.size() );
-        testCase( "Copied files: Prepared Log 1 File Name", QString("%1/test.log" ).arg( g_poPrefs->tempDir() ).toStdString(), slLogFiles.at( 0 ).toStdString() );
+        testCase( "Copied files: Prepared Log 1 File Name", qsCopied.toStdString(), slLogFiles.at( 0 ).toStdString() );
 
         testCase( "Copied files: Prepared Log 1 File exists", true, QFile::exists( slLogFiles.at( 0 ) ) );
 
@@ -66,6 +116,159 @@ void cDataSourceTest::testDataSource() throw()
 
         testCase( "Copied files: Prepared Log 1 File exists after delete", false, QFile::exists( slLogFiles.at( 0 ) ) );
 
+        poDS = new cLogDataSource( g_poPrefs->inputDir(), "multiple_files/test1/test*.log", true );
+
+        slLogFiles = poDS->logFileList();
+        testCase( "In place files: Prepared Input Log Count", 1, slLogFiles.size() );
+        testCase( "In place files: Prepared Log 1 File Name", QString("%1/multiple_files/test1/test.log" ).arg( g_poPrefs->inputDir() ).toStdString(), slLogFiles.at( 0 ).toStdString() );
+
+        testCase( "In place files: No copy in Temporary Directory", false, QFile::exists( qsCopied ) );
+
+        delete poDS;
+
+        testCase( "In place files: Original Log 1 File exists after delete", true, QFile::exists( slLogFiles.at( 0 ) ) );
+
+        poDS = new cLogDataSource( g_poPrefs->inputDir(), "multiple_files/test1/test*.gz", true );
+
+        slLogFiles = poDS->logFileList();
+        testCase( "In place gzipped files: Prepared Input Log Count", 2, slLogFiles.size() );
+        testCase( "In place gzipped files: Prepared Log 1 File Name", QString("%1/multiple_files/test1/test1.log.gz" ).arg( g_poPrefs->inputDir() ).toStdString(), slLogFiles.at( 0 ).toStdString() );
+
+        testCase( "In place gzipped files: No unpacked file in Temporary Directory", false, QFile::exists( qsPrepared1 ) );
+
+        delete poDS;
+
+        testCase( "In place gzipped files: Original Log 1 File exists after delete", true, QFile::exists( slLogFiles.at( 0 ) ) );
+
+        poDS = new cLogDataSource( g_poPrefs->inputDir(), "multiple_files/test2/*.zip#*.log", true );
+
+        slLogFiles = poDS->logFileList();
+        testCase( "In place zipped files: Prepared Input Log Count", 2, slLogFiles.size() );
+        testCase( "In place zipped files: Prepared Log 1 File Name", QString("%1/multiple_files/test2/logs.zip#test1.log" ).arg( g_poPrefs->inputDir() ).toStdString(), slLogFiles.at( 0 ).toStdString() );
+        testCase( "In place zipped files: Prepared Log 2 File Name", QString("%1/multiple_files/test2/logs.zip#test2.log" ).arg( g_poPrefs->inputDir() ).toStdString(), slLogFiles.at( 1 ).toStdString() );
+
+        slOrigFiles = poDS->origFileList();
+        testCase( "In place zipped files: Original Input Log Count", 1, slOrigFiles.size() );
+
+        // The entries are read with the archive listed by the data source, the same as with
+        // an archive read again
+        const cZipArchive *poArchive = poDS->zipArchive( slLogFiles.at( 1 ) );
+        testCase( "In place zipped files: Archive kept", true, poArchive != NULL );
+        testCase( "In place zipped files: No archive of the archive name", true, poDS->zipArchive( slOrigFiles.at( 0 ) ) == NULL );
+        if( poArchive )
+        {
+            cLineReader  obKept( slLogFiles.at( 1 ), 65536, true, NULL, poArchive );
+            cLineReader  obReread( slLogFiles.at( 1 ), 65536, true );
+            QByteArray   baKept;
+            QByteArray   baReread;
+            const char  *poBegin = NULL;
+            const char  *poEnd   = NULL;
+            while( obKept.readBlock( &poBegin, &poEnd ) ) baKept.append( poBegin, poEnd - poBegin );
+            while( obReread.readBlock( &poBegin, &poEnd ) ) baReread.append( poBegin, poEnd - poBegin );
+            testCase( "In place zipped files: Entry read with the kept archive", true, !baKept.isEmpty() && baKept == baReread );
+        }
+
+        delete poDS;
+
+        poDS = new cLogDataSource( g_poPrefs->inputDir(), "multiple_files/test2/*.zip", true );
+
+        slLogFiles = poDS->logFileList();
+        testCase( "In place zipped files without filter: Prepared Input Log Count", 3, slLogFiles.size() );
+
+        delete poDS;
+
+        // Copied entries are the same logical files as the entries read in place
+        QString qsMember1 = QString( "%1/multiple_files/test2/logs.zip#test1.log" ).arg( g_poPrefs->inputDir() );
+        QString qsMember2 = QString( "%1/multiple_files/test2/logs.zip#test2.log" ).arg( g_poPrefs->inputDir() );
+        poDS = new cLogDataSource( g_poPrefs->inputDir(), "multiple_files/test2/*.zip#*.log" );
+
+        slLogFiles = poDS->logFileList();
+        testCase( "Copied zipped files: Prepared Input Log Count", 2, slLogFiles.size() );
+        testCase( "Copied zipped files: Original of Log 1", qsMember1.toStdString(),
+                  slLogFiles.size() > 0 ? poDS->origFileName( slLogFiles.at( 0 ) ).toStdString() : std::string() );
+        testCase( "Copied zipped files: Original of Log 2", qsMember2.toStdString(),
+                  slLogFiles.size() > 1 ? poDS->origFileName( slLogFiles.at( 1 ) ).toStdString() : std::string() );
+        if( slLogFiles.size() > 1 )
+        {
+            QFile obUnzippedFile( slLogFiles.at( 1 ) );
+            obUnzippedFile.open( QIODevice::ReadOnly );
+            QByteArray baUnzipped = obUnzippedFile.readAll();
+            obUnzippedFile.close();
+
+            cLineReader  obEntryReader( qsMember2, 65536, true );
+            QByteArray   baEntry;
+            const char  *poBegin = NULL;
+            const char  *poEnd   = NULL;
+            while( obEntryReader.readBlock( &poBegin, &poEnd ) ) baEntry.append( poBegin, poEnd - poBegin );
+            testCase( "Copied zipped files: Copied entry equals entry read in place", true, !baEntry.isEmpty() && baEntry == baUnzipped );
+        }
+
+        delete poDS;
+
+        testCase( "Copied zipped files: Prepared Log 1 File exists after delete", false,
+                  slLogFiles.size() > 0 && QFile::exists( slLogFiles.at( 0 ) ) );
+
+        poDS = new cLogDataSource( g_poPrefs->inputDir(), "multiple_files/test2/*.zip" );
+
+        slLogFiles = poDS->logFileList();
+        testCase( "Copied zipped files without filter: Prepared Input Log Count", 3, slLogFiles.size() );
+
+        delete poDS;
+
+        poDS = new cLogDataSource( g_poPrefs->inputDir(), "multiple_files/test3/sysError*", true );
+
+        slLogFiles = poDS->logFileList();
+        testCase( "In place sysError files: Prepared Log 1 File Name", QString("%1/multiple_files/test3/sysError_test.log" ).arg( g_poPrefs->inputDir() ).toStdString(), slLogFiles.at( 0 ).toStdString() );
+
+        cLogDataSource *poDecodedDS = new cLogDataSource( g_poPrefs->inputDir(), "multiple_files/test3/sysError*" );
+
+        QFile obDecodedFile( poDecodedDS->logFileList().at( 0 ) );
+        obDecodedFile.open( QIODevice::ReadOnly );
+        QByteArray baDecoded = obDecodedFile.readAll();
+        obDecodedFile.close();
+
+        cLineReader obReader( slLogFiles.at( 0 ), 1048576, true );
+        QByteArray  baStreamed;
+        const char *poBegin = NULL;
+        const char *poEnd   = NULL;
+        while( obReader.readBlock( &poBegin, &poEnd ) ) baStreamed.append( QByteArray( poBegin, poEnd - poBegin ) );
+
+        testCase( "In place sysError files: Streamed decoding equals decoded file", std::string( baDecoded.constData() ), std::string( baStreamed.constData() ) );
+        testCase( "In place sysError files: Decoded tag", true, baStreamed.contains( "Spotted a Black Rabbit" ) );
+
+        delete poDecodedDS;
+        delete poDS;
+
+        // A tag decoding to a new line and a zero byte is decoded the same way by both modes
+        QString qsNewLineFile = QString( "%1/sysError_newline.log" ).arg( g_poPrefs->tempDir() );
+        QFile   obNewLineFile( qsNewLineFile );
+        obNewLineFile.open( QIODevice::WriteOnly | QIODevice::Truncate );
+        obNewLineFile.write( "Date,Time,Host,Process,Level,Message,Module,Line,Thread,User,Session,Details\n" );
+        obNewLineFile.write( "2012-01-03,10:02:00,host1,lara,ERROR,MW92axMMRA4RYX58eCc=,io,102,7,BnByekk=,AGZkexFpeE9D,AGZkexFpeE9D\n" );
+        obNewLineFile.close();
+
+        poDecodedDS = new cLogDataSource( g_poPrefs->tempDir(), "sysError_newline.log" );
+        baDecoded.clear();
+        if( poDecodedDS->logFileList().size() == 1 )
+        {
+            obDecodedFile.setFileName( poDecodedDS->logFileList().at( 0 ) );
+            obDecodedFile.open( QIODevice::ReadOnly );
+            baDecoded = obDecodedFile.readAll();
+            obDecodedFile.close();
+        }
+
+        cLineReader obNewLineReader( qsNewLineFile, 1048576, true );
+        baStreamed.clear();
+        while( obNewLineReader.readBlock( &poBegin, &poEnd ) ) baStreamed.append( QByteArray( poBegin, poEnd - poBegin ) );
+
+        testCase( "sysError files: Decoded new line streamed the same as decoded to a file",
+                  std::string( baStreamed.constData(), baStreamed.size() ), std::string( baDecoded.constData(), baDecoded.size() ) );
+        testCase( "sysError files: Decoded new line kept in the Log Line", true, baDecoded.contains( ",Black Rabbit!," ) );
+        testCase( "sysError files: Decoded new line line count", 2, baDecoded.count( '\n' ) );
+
+        delete poDecodedDS;
+        QFile::remove( qsNewLineFile );
+
         poDS = new cLogDataSource( g_poPrefs->inputDir(), "nonexisting_file_name" );
 
         slLogFiles = poDS->logFileList();
@@ -86,9 +289,774 @@ void cDataSourceTest::testDataSource() throw()
 
         delete poDS;
 
+        poDS = new cLogDataSource( g_poPrefs->inputDir(), "multiple_files/test1/test*.gz", false, 1 );
+
+        QString qsLogFile;
+        testCase( "Prefetched files: Log 1 returned", true, poDS->nextLogFile( &qsLogFile ) );
+        testCase( "Prefetched files: Log 1 File Name", qsPrepared1.toStdString(), qsLogFile.toStdString() );
+        testCase( "Prefetched files: Log 1 File exists", true, QFile::exists( qsLogFile ) );
+        testCase( "Prefetched files: Log 2 returned", true, poDS->nextLogFile( &qsLogFile ) );
+        testCase( "Prefetched files: Log 2 File Name", qsPrepared2.toStdString(), qsLogFile.toStdString() );
+        testCase( "Prefetched files: Log 1 File removed", false, QFile::exists( qsPrepared1 ) );
+        testCase( "Prefetched files: No more files", false, poDS->nextLogFile( &qsLogFile ) );
+        testCase( "Prefetched files: Prepared Input Log Count", 2, poDS->logFileList().size() );
+
+        delete poDS;
+
+        testCase( "Prefetched files: Log 2 File exists after delete", false, QFile::exists( qsLogFile ) );
+
+        poDS = new cLogDataSource( g_poPrefs->inputDir(), "multiple_files/test1/test*.gz", false, 1 );
+        delete poDS;
+
+        testCase( "Prefetched files: Unread Log 1 File exists after delete", false, QFile::exists( qsPrepared1 ) );
+
+    } catch( cSevException &e )
+    {
+        g_obLogger << e;
+        m_uiFailedNum++;
+    }
+}
+
+void cDataSourceTest::testDecodeKernels() throw()
+{
+    printNote( "SYSERROR DECODE KERNEL TESTS" );
+
+    // Random tags: mostly valid base64, with some padding, invalid characters and
+    // decoded zero and new line bytes, so every fallback path of the kernels is used
+    const char  *poAlphabet = "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/";
+    QStringList  slTags;
+    srand( 1 );
+    for( unsigned int i = 0; i < 2000; i++ )
+    {
+        QString qsTag;
+        unsigned int uiLength = rand() % 200;
+        for( unsigned int j = 0; j < uiLength; j++ )
+        {
+            int inRandom = rand() % 500;
+            if( inRandom == 0 )      qsTag.append( '=' );
+            else if( inRandom == 1 ) qsTag.append( ' ' );
+            else                     qsTag.append( poAlphabet[rand() % 64] );
+        }
+        if( i % 3 == 0 ) qsTag.append( "==" );
+        slTags.push_back( qsTag );
+    }
+    slTags.push_back( "c2ZzbQ==" );
+    slTags.push_back( "" );
+
+    cSysErrorDecoder::teKernel enBestKernel = cSysErrorDecoder::kernel();
+    for( int inKernel = cSysErrorDecoder::SCALAR; inKernel <= cSysErrorDecoder::AVX2; inKernel++ )
+    {
+        cSysErrorDecoder::teKernel enKernel = (cSysErrorDecoder::teKernel)inKernel;
+        if( !cSysErrorDecoder::setKernel( enKernel ) )
+        {
+            printNote( QString( "%1 kernel is not supported by this CPU" ).arg( cSysErrorDecoder::toStr( enKernel ) ).toStdString() );
+            continue;
+        }
+
+        unsigned int uiDifferent = 0;
+        for( int i = 0; i < slTags.size(); i++ )
+        {
+            QByteArray baTag = slTags.at( i ).toAscii();
+
+            // The decoder writes decoded new line characters as spaces, see cSysErrorDecoder
+            QByteArray baExpected = cLogDataSource::decodeString( slTags.at( i ) ).toLatin1().replace( '\n', ' ' );
+
+            std::vector<char> veOutput( baTag.size() * 3 / 4 + 1 );
+            unsigned int uiLength = cSysErrorDecoder::decodeTag( baTag.constData(), baTag.size(), &veOutput[0] );
+            if( QByteArray( &veOutput[0], uiLength ) != baExpected ) uiDifferent++;
+        }
+
+        testCase( QString( "%1 kernel decodes the same as decodeString()" ).arg( cSysErrorDecoder::toStr( enKernel ) ).toStdString(),
+                  0, (int)uiDifferent );
+    }
+    cSysErrorDecoder::setKernel( enBestKernel );
+}
+
+void cDataSourceTest::testSplitKernels() throw()
+{
+    printNote( "LINE SPLITTER KERNEL TESTS" );
+
+    // A block with new lines at its start, its end and in between, long runs without and
+    // with new lines (more than 255 vector steps, so the counters are summed up in between)
+    std::vector<char> veBlock;
+    veBlock.push_back( '\n' );
+    for( int i = 0; i < 100; i++ ) veBlock.push_back( (i % 7) ? 'a' + (i % 26) : '\n' );
+    veBlock.insert( veBlock.end(), 300, 'x' );
+    veBlock.insert( veBlock.end(), 20000, '\n' );
+    for( int i = 0; i < 9000; i++ ) veBlock.push_back( (i % 97) ? (char)(128 + i % 128) : '\n' );
+    veBlock.push_back( '\n' );
+
+    // Every kernel is compared with the scalar kernel on all the starting offsets and
+    // lengths near the vector widths, and on the whole block
+    std::vector<std::pair<unsigned int, unsigned int> > veRanges;
+    for( unsigned int uiStart = 0; uiStart < 70; uiStart++ )
+    {
+        for( unsigned int uiLength = 0; uiLength < 140 && uiStart + uiLength <= veBlock.size(); uiLength++ )
+        {
+            veRanges.push_back( std::make_pair( uiStart, uiLength ) );
+        }
+    }
+    for( unsigned int uiStart = 0; uiStart < 33; uiStart++ )
+    {
+        veRanges.push_back( std::make_pair( uiStart, (unsigned int)veBlock.size() - uiStart ) );
+        veRanges.push_back( std::make_pair( 400u + uiStart, (unsigned int)veBlock.size() - 433u ) );
+    }
+
+    cLineSplitter::teKernel enBestKernel = cLineSplitter::kernel();
+    cLineSplitter::setKernel( cLineSplitter::SCALAR );
+    std::vector<long>          veFound;
+    std::vector<unsigned long> veCounts;
+    for( unsigned int i = 0; i < veRanges.size(); i++ )
+    {
+        const char *poBegin = &veBlock[0] + veRanges[i].first;
+        const char *poEnd   = poBegin + veRanges[i].second;
+        veFound.push_back( cLineSplitter::findNewLine( poBegin, poEnd ) - poBegin );
+        veCounts.push_back( cLineSplitter::countNewLines( poBegin, poEnd ) );
+    }
+    testCase( "SCALAR kernel finds no new line in an empty block", 0, (int)veFound[0] );
+    testCase( "SCALAR kernel counts the whole block", 20000 + 15 + 93 + 2, (int)cLineSplitter::countNewLines( &veBlock[0], &veBlock[0] + veBlock.size() ) );
+
+    for( int inKernel = cLineSplitter::SSE2; inKernel <= cLineSplitter::AVX2; inKernel++ )
+    {
+        cLineSplitter::teKernel enKernel = (cLineSplitter::teKernel)inKernel;
+        if( !cLineSplitter::setKernel( enKernel ) )
+        {
+            printNote( QString( "%1 kernel is not supported by this CPU" ).arg( cLineSplitter::toStr( enKernel ) ).toStdString() );
+            continue;
+        }
+
+        unsigned int uiFoundDifferent = 0;
+        unsigned int uiCountDifferent = 0;
+        for( unsigned int i = 0; i < veRanges.size(); i++ )
+        {
+            const char *poBegin = &veBlock[0] + veRanges[i].first;
+            const char *poEnd   = poBegin + veRanges[i].second;
+            if( cLineSplitter::findNewLine( poBegin, poEnd ) - poBegin != veFound[i] ) uiFoundDifferent++;
+            if( cLineSplitter::countNewLines( poBegin, poEnd ) != veCounts[i] )        uiCountDifferent++;
+        }
+
+        testCase( QString( "%1 kernel finds the same new lines as SCALAR" ).arg( cLineSplitter::toStr( enKernel ) ).toStdString(),
+                  0, (int)uiFoundDifferent );
+        testCase( QString( "%1 kernel counts the same new lines as SCALAR" ).arg( cLineSplitter::toStr( enKernel ) ).toStdString(),
+                  0, (int)uiCountDifferent );
+    }
+    cLineSplitter::setKernel( enBestKernel );
+}
+
+void cDataSourceTest::testGzipIndex() throw()
+{
+    printNote( "GZIP INDEX TESTS" );
+
+    // A gzip file of three members with numbered Log Lines, large enough for several
+    // access points in each member
+    QString     qsFileName  = QString( "%1/gzipindex_test.log.gz" ).arg( g_poPrefs->tempDir() );
+    QString     qsIndexFile = cGzipIndex::indexFileName( qsFileName, g_poPrefs->indexDir() );
+    QByteArray  baExpected;
+    unsigned int uiLineNum = 0;
+    QFile::remove( qsFileName );
+    for( unsigned int uiMember = 0; uiMember < 3; uiMember++ )
+    {
+        QByteArray baMember;
+        for( unsigned int i = 0; i < 20000; i++ )
+        {
+            baMember.append( QString( "2010-04-09 13:15:01.000 [CYCLER.CORE.INFO.0] Log Line %1 of member %2 %3\n" )
+                             .arg( ++uiLineNum ).arg( uiMember ).arg( QString( i % 97, 'x' ) ).toAscii() );
+        }
+        gzFile poGzFile = gzopen( qsFileName.toAscii(), "ab" );
+        gzwrite( poGzFile, baMember.constData(), baMember.size() );
+        gzclose( poGzFile );
+        baExpected.append( baMember );
+    }
+
+    try
+    {
+        cGzipIndex  obIndex( qsFileName, 65536 );
+        QByteArray  baRead;
+        const char *poBegin = NULL;
+        const char *poEnd   = NULL;
+
+        cLineReader *poReader = new cLineReader( qsFileName, 1048576, true, &obIndex );
+        while( poReader->readBlock( &poBegin, &poEnd ) ) baRead.append( QByteArray( poBegin, poEnd - poBegin ) );
+        delete poReader;
+
+        testCase( "Gzip index: Inflated file equals the original", true, baRead == baExpected );
+        testCase( "Gzip index: Index complete after reading the file", true, obIndex.complete() );
+        testCase( "Gzip index: Inflated size", baExpected.size(), (int)obIndex.size() );
+        testCase( "Gzip index: Several access points", true, obIndex.pointCount() > 10 );
+
+        unsigned int uiMemberStarts = 0;
+        for( unsigned int i = 0; i < obIndex.pointCount(); i++ )
+        {
+            if( obIndex.point( i ).boMemberStart ) uiMemberStarts++;
+        }
+        testCase( "Gzip index: Access point at every member", 3, (int)uiMemberStarts );
+
+        obIndex.save( qsIndexFile );
+        testCase( "Gzip index: Index file not next to the gzip file", false, QFile::exists( qsFileName + ".gzidx" ) );
+        cGzipIndex obLoaded( qsFileName, 65536 );
+        testCase( "Gzip index: Saved index loaded", true, obLoaded.load( qsIndexFile ) );
+        testCase( "Gzip index: Loaded access point count", (int)obIndex.pointCount(), (int)obLoaded.pointCount() );
+
+        cGzipIndex obOtherSpan( qsFileName, 131072 );
+        testCase( "Gzip index: Index with different span not loaded", false, obOtherSpan.load( qsIndexFile ) );
+
+        // Reading the file region by region gives the same Log Lines with the same line numbers
+        QByteArray   baRegions;
+        unsigned int uiWrongLineNums = 0;
+        for( unsigned int i = 0; i < obLoaded.pointCount(); i += 2 )
+        {
+            cLineReader obRegionReader( &obLoaded, i, i + 2 < obLoaded.pointCount() ? i + 2 : obLoaded.pointCount() );
+            bool boFirstBlock = true;
+            while( obRegionReader.readBlock( &poBegin, &poEnd ) )
+            {
+                if( boFirstBlock && obRegionReader.linesBefore() != (unsigned long long)baRegions.count( '\n' ) ) uiWrongLineNums++;
+                boFirstBlock = false;
+                baRegions.append( QByteArray( poBegin, poEnd - poBegin ) );
+            }
+        }
+        testCase( "Gzip index: Regions equal the original", true, baRegions == baExpected );
+        testCase( "Gzip index: Line numbers of the regions", 0, (int)uiWrongLineNums );
+
+        // Seeking to the middle of the file
+        unsigned int uiPoint = obLoaded.findPoint( baExpected.size() / 2 );
+        cLineReader  obSeekReader( &obLoaded, uiPoint, obLoaded.pointCount() );
+        obSeekReader.readBlock( &poBegin, &poEnd );
+        QString qsFirstLine = QString::fromAscii( poBegin, poEnd - poBegin ).section( '\n', 0, 0 );
+        testCase( "Gzip index: Line number after seeking",
+                  QString( " Log Line %1 " ).arg( obSeekReader.linesBefore() + 1 ).toStdString(),
+                  qsFirstLine.mid( qsFirstLine.indexOf( " Log Line" ), QString( " Log Line %1 " ).arg( obSeekReader.linesBefore() + 1 ).length() ).toStdString() );
+    } catch( cSevException &e )
+    {
+        g_obLogger << e;
+        m_uiFailedNum++;
+    }
+
+    QFile::remove( qsIndexFile );
+    QFile::remove( qsFileName );
+}
+
+void cDataSourceTest::testPreparedCache() throw()
+{
+    printNote( "PREPARED FILE CACHE TESTS" );
+
+    testCase( "Prepared cache: xxHash of empty data", std::string( "ef46db3751d8e999" ),
+              QString::number( cPreparedCache::hash64( "", 0 ), 16 ).toStdString() );
+    testCase( "Prepared cache: xxHash of \"abc\"", std::string( "44bc2cf5ad770999" ),
+              QString::number( cPreparedCache::hash64( "abc", 3 ), 16 ).toStdString() );
+
+    QString qsCacheDir = QString( "%1/prepared_cache_test" ).arg( g_poPrefs->tempDir() );
+    try
+    {
+        QString qsOrigFile = QString( "%1/multiple_files/test1/test1.log.gz" ).arg( g_poPrefs->inputDir() );
+        QString qsKey      = cPreparedCache::key( qsOrigFile, "gunzip" );
+        testCase( "Prepared cache: Key is stable", qsKey.toStdString(), cPreparedCache::key( qsOrigFile, "gunzip" ).toStdString() );
+        testCase( "Prepared cache: Key depends on the method", false, qsKey == cPreparedCache::key( qsOrigFile, "copy" ) );
+        testCase( "Prepared cache: Key depends on the content", false,
+                  qsKey == cPreparedCache::key( QString( "%1/multiple_files/test1/test2.log.gz" ).arg( g_poPrefs->inputDir() ), "gunzip" ) );
+
+        cPreparedCache obCache( qsCacheDir, 2500 );
+        testCase( "Prepared cache: Empty cache", true, obCache.find( qsKey ).isEmpty() );
+
+        QStringList slKeys;
+        for( int i = 0; i < 4; i++ )
+        {
+            QString qsPreparedFile = QString( "%1/prepared_%2.log" ).arg( g_poPrefs->tempDir() ).arg( i );
+            QFile   obFile( qsPreparedFile );
+            obFile.open( QIODevice::WriteOnly | QIODevice::Truncate );
+            obFile.write( QByteArray( 1000, 'a' + i ) );
+            obFile.close();
+
+            slKeys.push_back( QString( "test-%1" ).arg( i ) );
+            QString qsCachedFile = obCache.store( slKeys.last(), qsPreparedFile );
+            testCase( QString( "Prepared cache: File %1 moved into the cache" ).arg( i ).toStdString(), false, QFile::exists( qsPreparedFile ) );
+            testCase( QString( "Prepared cache: File %1 keeps its name" ).arg( i ).toStdString(), true, qsCachedFile.endsWith( QString( "/prepared_%1.log" ).arg( i ) ) );
+            testCase( QString( "Prepared cache: File %1 found" ).arg( i ).toStdString(), qsCachedFile.toStdString(), obCache.find( slKeys.last() ).toStdString() );
+        }
+
+        testCase( "Prepared cache: Size limit kept", true, obCache.size() <= 2500 );
+        testCase( "Prepared cache: Least recently used files removed", 2000, (int)obCache.size() );
+        testCase( "Prepared cache: Last stored file kept", false, obCache.find( slKeys.last() ).isEmpty() );
+
+        QFile obCached( obCache.find( slKeys.last() ) );
+        obCached.open( QIODevice::ReadOnly );
+        testCase( "Prepared cache: Content of cached file", true, obCached.readAll() == QByteArray( 1000, 'd' ) );
+        obCached.close();
+
+        cPreparedCache obReopenedCache( qsCacheDir, 2500 );
+        testCase( "Prepared cache: Size read by a new cache object", 2000, (int)obReopenedCache.size() );
+
+        // The files of an analysis larger than the cache limit are all pinned by the data
+        // source, none of them is removed until the analysis ends
+        cPreparedCache *poRunCache = new cPreparedCache( qsCacheDir, 1500 );
+        slKeys.clear();
+        for( int i = 0; i < 4; i++ )
+        {
+            QString qsPreparedFile = QString( "%1/pinned_%2.log" ).arg( g_poPrefs->tempDir() ).arg( i );
+            QFile   obFile( qsPreparedFile );
+            obFile.open( QIODevice::WriteOnly | QIODevice::Truncate );
+            obFile.write( QByteArray( 1000, 'a' + i ) );
+            obFile.close();
+
+            slKeys.push_back( QString( "pinned-%1" ).arg( i ) );
+            poRunCache->pin( slKeys.last() );
+            poRunCache->store( slKeys.last(), qsPreparedFile );
+        }
+        int inPinnedFound = 0;
+        for( int i = 0; i < slKeys.size(); i++ ) if( !poRunCache->find( slKeys.at( i ) ).isEmpty() ) inPinnedFound++;
+        testCase( "Prepared cache: Pinned files kept over the size limit", 4, inPinnedFound );
+        delete poRunCache;
+
+        // The next analysis does not pin them any more
+        poRunCache = new cPreparedCache( qsCacheDir, 1500 );
+        QString qsPreparedFile = QString( "%1/pinned_4.log" ).arg( g_poPrefs->tempDir() );
+        QFile   obFile( qsPreparedFile );
+        obFile.open( QIODevice::WriteOnly | QIODevice::Truncate );
+        obFile.write( QByteArray( 1000, 'e' ) );
+        obFile.close();
+        poRunCache->store( "pinned-4", qsPreparedFile );
+        testCase( "Prepared cache: Unpinned files removed", 1000, (int)poRunCache->size() );
+        delete poRunCache;
     } catch( cSevException &e )
     {
         g_obLogger << e;
         m_uiFailedNum++;
     }
+
+    QDir        obCacheDir( qsCacheDir );
+    QStringList slEntries = obCacheDir.entryList( QDir::Dirs | QDir::NoDotAndDotDot );
+    for( int i = 0; i < slEntries.size(); i++ )
+    {
+        QDir        obEntryDir( obCacheDir.filePath( slEntries.at( i ) ) );
+        QStringList slFiles = obEntryDir.entryList( QDir::Files );
+        for( int j = 0; j < slFiles.size(); j++ ) obEntryDir.remove( slFiles.at( j ) );
+        obCacheDir.rmdir( slEntries.at( i ) );
+    }
+    QDir().rmdir( qsCacheDir );
+}
+
+void cDataSourceTest::testStreamCodecs() throw()
+{
+    printNote( "STREAM CODEC TESTS" );
+
+    QByteArray baFirst;
+    QByteArray baSecond;
+    for( int i = 0; i < 20000; i++ )
+    {
+        (i < 12000 ? baFirst : baSecond).append( QString( "2010-04-09 13:15:01.%1 [CYCLER.CORE.INFO.0] Request %2 served\n" ).arg( i % 1000 ).arg( i * 31 ).toAscii() );
+    }
+
+    QStringList slCodecs = cCodecRegistry::names();
+    testCase( "Stream codecs: Built-in codecs", std::string( "gzip,zstd,xz,bzip2" ), slCodecs.join( "," ).toStdString() );
+
+    for( int i = 0; i < slCodecs.size(); i++ )
+    {
+        QString qsCodec = slCodecs.at( i );
+
+        // Two concatenated frames or streams, and no extension, so the codec is found by its magic bytes
+        QString qsFileName = QString( "%1/codec_test_%2" ).arg( g_poPrefs->tempDir() ).arg( qsCodec );
+        QByteArray baCompressed = cTestCompressor::compress( qsCodec, baFirst ) + cTestCompressor::compress( qsCodec, baSecond );
+        QFile   obFile( qsFileName );
+        obFile.open( QIODevice::WriteOnly | QIODevice::Truncate );
+        obFile.write( baCompressed );
+        obFile.close();
+
+        testCase( QString( "Stream codecs: %1 found by magic" ).arg( qsCodec ).toStdString(), true, cCodecRegistry::find( qsFileName ) == cCodecRegistry::codec( qsCodec ) );
+
+        QByteArray  baRead;
+        try
+        {
+            cLineReader  obReader( qsFileName, 4096, true );
+            const char  *poBegin = NULL;
+            const char  *poEnd   = NULL;
+            while( obReader.readBlock( &poBegin, &poEnd ) ) baRead.append( QByteArray( poBegin, poEnd - poBegin ) );
+        }
+        catch( cSevException &e )
+        {
+            g_obLogger << e;
+        }
+        testCase( QString( "Stream codecs: %1 data read" ).arg( qsCodec ).toStdString(), true, baRead == baFirst + baSecond );
+
+        obFile.open( QIODevice::WriteOnly | QIODevice::Truncate );
+        obFile.write( baCompressed.left( baCompressed.size() - 100 ) );
+        obFile.close();
+
+        bool boTruncated = false;
+        try
+        {
+            cLineReader  obReader( qsFileName, 4096, true );
+            const char  *poBegin = NULL;
+            const char  *poEnd   = NULL;
+            while( obReader.readBlock( &poBegin, &poEnd ) );
+        }
+        catch( cSevException & )
+        {
+            boTruncated = true;
+        }
+        testCase( QString( "Stream codecs: %1 truncated file reported" ).arg( qsCodec ).toStdString(), true, boTruncated );
+
+        QFile::remove( qsFileName );
+    }
+
+    testCase( "Stream codecs: Codec found by extension", true,
+              cCodecRegistry::find( "nonexisting_file.log.zst" ) == cCodecRegistry::codec( "zstd" ) );
+    testCase( "Stream codecs: Plain file has no codec", true,
+              cCodecRegistry::find( QString( "%1/multiple_files/test1/test.log" ).arg( g_poPrefs->inputDir() ) ) == NULL );
+
+    // Copied files are decompressed into the Temporary Directory
+    QFile obFile( QString( "%1/codec_test.log.zst" ).arg( g_poPrefs->tempDir() ) );
+    obFile.open( QIODevice::WriteOnly | QIODevice::Truncate );
+    obFile.write( cTestCompressor::compress( "zstd", baFirst ) );
+    obFile.close();
+
+    cLogDataSource *poDS = new cLogDataSource( g_poPrefs->tempDir(), "codec_test.log.zst" );
+    QStringList     slLogFiles = poDS->logFileList();
+    testCase( "Stream codecs: Decompressed Input Log Count", 1, slLogFiles.size() );
+    if( slLogFiles.size() == 1 )
+    {
+        QString qsDecompressed = cLogDataSource::tempFileName( poDS->origFileList().at( 0 ) );
+        qsDecompressed.chop( 4 );
+        testCase( "Stream codecs: Decompressed Log File Name", qsDecompressed.toStdString(), slLogFiles.at( 0 ).toStdString() );
+
+        QFile obDecompressed( slLogFiles.at( 0 ) );
+        obDecompressed.open( QIODevice::ReadOnly );
+        testCase( "Stream codecs: Decompressed Log File content", true, obDecompressed.readAll() == baFirst );
+        obDecompressed.close();
+    }
+    delete poDS;
+
+    QFile::remove( QString( "%1/codec_test.log.zst" ).arg( g_poPrefs->tempDir() ) );
+}
+
+void cDataSourceTest::testFollowState() throw()
+{
+    printNote( "FOLLOW STATE TESTS" );
+
+    QString qsFileName   = QString( "%1/follow_test.log" ).arg( g_poPrefs->tempDir() );
+    QString qsRotated    = QString( "%1/follow_test.log.1" ).arg( g_poPrefs->tempDir() );
+    QString qsCompressed = QString( "%1/follow_test.log.2.gz" ).arg( g_poPrefs->tempDir() );
+    QString qsStateFile  = QString( "%1/follow_test.ini" ).arg( g_poPrefs->tempDir() );
+
+    QFile obFile( qsFileName );
+    obFile.open( QIODevice::WriteOnly | QIODevice::Truncate );
+    obFile.write( "line 1\nline 2\nline 3\npartial" );
+    obFile.close();
+
+    // The unterminated last line is left out in both read modes, and read when completed
+    for( int inInPlace = 0; inInPlace < 2; inInPlace++ )
+    {
+        QString qsMode = inInPlace ? "Mapped" : "Buffered";
+        try
+        {
+            QByteArray  baRead;
+            const char *poBegin = NULL;
+            const char *poEnd   = NULL;
+
+            cLineReader obReader( qsFileName, 4096, inInPlace );
+            obReader.setCompleteLines( true );
+            while( obReader.readBlock( &poBegin, &poEnd ) ) baRead.append( QByteArray( poBegin, poEnd - poBegin ) );
+            testCase( QString( "Follow state: %1 complete lines read" ).arg( qsMode ).toStdString(),
+                      std::string( "line 1\nline 2\nline 3\n" ), std::string( baRead.constData(), baRead.size() ) );
+            testCase( QString( "Follow state: %1 offset after complete lines" ).arg( qsMode ).toStdString(), 21, (int)obReader.offset() );
+
+            cLineReader obSeekReader( qsFileName, 4096, inInPlace );
+            obSeekReader.seek( 7 );
+            baRead.clear();
+            while( obSeekReader.readBlock( &poBegin, &poEnd ) ) baRead.append( QByteArray( poBegin, poEnd - poBegin ) );
+            testCase( QString( "Follow state: %1 read from offset" ).arg( qsMode ).toStdString(),
+                      std::string( "line 2\nline 3\npartial" ), std::string( baRead.constData(), baRead.size() ) );
+        }
+        catch( cSevException &e )
+        {
+            g_obLogger << e;
+            m_uiFailedNum++;
+        }
+    }
+
+    unsigned long long ullLines = 0;
+    {
+        cFollowState obState( qsStateFile );
+        testCase( "Follow state: No previous run", false, obState.loaded() );
+        testCase( "Follow state: New file read from the beginning", 0, (int)obState.position( qsFileName, &ullLines ) );
+        obState.setPosition( qsFileName, 21, 3 );
+
+        cFollowState::tmCounts maCounts;
+        maCounts["Requests"] = std::make_pair( 5UL, 2UL );
+        obState.setCounts( maCounts );
+        obState.setBatchId( 42 );
+        try
+        {
+            obState.save();
+        }
+        catch( cSevException &e )
+        {
+            g_obLogger << e;
+            m_uiFailedNum++;
+        }
+    }
+
+    obFile.open( QIODevice::WriteOnly | QIODevice::Append );
+    obFile.write( " line 4\nline 5\n" );
+    obFile.close();
+
+    {
+        cFollowState obState( qsStateFile );
+        testCase( "Follow state: Previous run loaded", true, obState.loaded() );
+        testCase( "Follow state: Batch id loaded", 42, (int)obState.batchId() );
+        testCase( "Follow state: Counts loaded", 2, obState.counts().size() == 1 ? (int)obState.counts().find( "Requests" )->second.second : -1 );
+        testCase( "Follow state: Grown file continued", 21, (int)obState.position( qsFileName, &ullLines ) );
+        testCase( "Follow state: Line count continued", 3, (int)ullLines );
+
+#ifdef Q_OS_UNIX
+        // Log rotation: the file is continued under its new name, the new file starts at 0
+        QFile::remove( qsRotated );
+        QFile::rename( qsFileName, qsRotated );
+        obFile.open( QIODevice::WriteOnly | QIODevice::Truncate );
+        obFile.write( "new line 1\nnew line 2\nnew line 3\n" );
+        obFile.close();
+
+        testCase( "Follow state: Rotated file continued", 21, (int)obState.position( qsRotated, &ullLines ) );
+        testCase( "Follow state: File replacing the rotated one read from the beginning", 0, (int)obState.position( qsFileName, &ullLines ) );
+
+        // The rotated file compressed under a new name is not read again
+        QFile obRotatedFile( qsRotated );
+        obRotatedFile.open( QIODevice::ReadOnly );
+        QByteArray baRotated = obRotatedFile.readAll();
+        obRotatedFile.close();
+
+        QFile obCompressedFile( qsCompressed );
+        obCompressedFile.open( QIODevice::WriteOnly | QIODevice::Truncate );
+        obCompressedFile.write( cTestCompressor::compress( "gzip", baRotated ) );
+        obCompressedFile.close();
+        QFile::remove( qsRotated );
+
+        testCase( "Follow state: Compressed rotated file taken as read", (int)QFileInfo( qsCompressed ).size(),
+                  (int)obState.position( qsCompressed, &ullLines ) );
+        testCase( "Follow state: Compressed rotated file line count continued", 3, (int)ullLines );
+#endif
+
+        obState.setPosition( qsFileName, 11, 1 );
+        obFile.open( QIODevice::WriteOnly | QIODevice::Truncate );
+        obFile.write( "trunc\n" );
+        obFile.close();
+        testCase( "Follow state: Truncated file read from the beginning", 0, (int)obState.position( qsFileName, &ullLines ) );
+        testCase( "Follow state: Truncated file line count reset", 0, (int)ullLines );
+    }
+
+    QFile::remove( qsFileName );
+    QFile::remove( qsRotated );
+    QFile::remove( qsCompressed );
+    QFile::remove( qsStateFile );
+}
+
+void cDataSourceTest::testLongLines() throw()
+{
+    printNote( "LONG LINE TESTS" );
+
+    // Lines of 3 MB fit the 4 MB maximum line length, lines of 6 MB are truncated to it
+    QByteArray baData;
+    baData.append( "short line\n" );
+    baData.append( QByteArray( 3 * 1048576, 'a' ) + "\n" );
+    baData.append( "line after the long one\n" );
+    baData.append( QByteArray( 6 * 1048576, 'b' ) + "\n" );
+    baData.append( QByteArray( 3 * 1048576, 'c' ) );
+
+    QString qsFileName   = QString( "%1/long_lines_test.log" ).arg( g_poPrefs->tempDir() );
+    QString qsGzFileName = qsFileName + ".gz";
+    QFile   obFile( qsFileName );
+    obFile.open( QIODevice::WriteOnly | QIODevice::Truncate );
+    obFile.write( baData );
+    obFile.close();
+    QFile   obGzFile( qsGzFileName );
+    obGzFile.open( QIODevice::WriteOnly | QIODevice::Truncate );
+    obGzFile.write( cTestCompressor::compress( "gzip", baData ) );
+    obGzFile.close();
+
+    const char *apModes[] = { "Buffered", "Mapped", "Gzipped" };
+    for( int inMode = 0; inMode < 3; inMode++ )
+    {
+        QString qsMode = apModes[inMode];
+        try
+        {
+            cLineReader obReader( inMode == 2 ? qsGzFileName : qsFileName, 1048576, inMode == 1 );
+            obReader.setMaxLineLength( 4 * 1048576 );
+
+            std::vector<unsigned int> veLengths;
+            QByteArray                baLastLine;
+            const char               *poBegin = NULL;
+            const char               *poEnd   = NULL;
+            while( obReader.readBlock( &poBegin, &poEnd ) )
+            {
+                for( const char *poLine = poBegin; poLine < poEnd; )
+                {
+                    const char *poLineEnd = poLine;
+                    while( poLineEnd < poEnd && *poLineEnd != '\n' ) poLineEnd++;
+                    veLengths.push_back( poLineEnd - poLine );
+                    baLastLine = QByteArray( poLine, qMin( (int)(poLineEnd - poLine), 32 ) );
+                    poLine = poLineEnd < poEnd ? poLineEnd + 1 : poEnd;
+                }
+            }
+
+            testCase( QString( "Long lines: %1 line count" ).arg( qsMode ).toStdString(), 5, (int)veLengths.size() );
+            if( veLengths.size() == 5 )
+            {
+                testCase( QString( "Long lines: %1 short line" ).arg( qsMode ).toStdString(), 10, (int)veLengths[0] );
+                testCase( QString( "Long lines: %1 3 MB line read whole" ).arg( qsMode ).toStdString(), 3 * 1048576, (int)veLengths[1] );
+                testCase( QString( "Long lines: %1 line after the long one" ).arg( qsMode ).toStdString(), 23, (int)veLengths[2] );
+                testCase( QString( "Long lines: %1 6 MB line truncated" ).arg( qsMode ).toStdString(), 4 * 1048576, (int)veLengths[3] );
+                testCase( QString( "Long lines: %1 last line without new line" ).arg( qsMode ).toStdString(), 3 * 1048576, (int)veLengths[4] );
+            }
+            testCase( QString( "Long lines: %1 last line content" ).arg( qsMode ).toStdString(), std::string( 32, 'c' ),
+                      std::string( baLastLine.constData(), baLastLine.size() ) );
+            testCase( QString( "Long lines: %1 truncated line counted" ).arg( qsMode ).toStdString(), 1, (int)obReader.truncatedLines() );
+        }
+        catch( cSevException &e )
+        {
+            g_obLogger << e;
+            m_uiFailedNum++;
+        }
+    }
+
+    QFile::remove( qsFileName );
+    QFile::remove( qsGzFileName );
+}
+
+void cDataSourceTest::testFileDiscovery() throw()
+{
+    printNote( "FILE DISCOVERY TESTS" );
+
+    // A small tree of log files in the Temporary Directory, with index files next to a log
+    QString qsRoot = QString( "%1/discovery_test" ).arg( g_poPrefs->tempDir() );
+    const char *apFiles[] = { "top.log", "a/x.log", "a/b/y.log", "a/b/c/z.log", "d/w.log", "d/w.txt",
+                              "d/w.log.tcat", "d/w.log.gzidx", "d/w.log.lidx.tmp" };
+    QDir().mkpath( qsRoot + "/a/b/c" );
+    QDir().mkpath( qsRoot + "/d" );
+    for( int i = 0; i < 9; i++ )
+    {
+        QFile obFile( qsRoot + "/" + apFiles[i] );
+        obFile.open( QIODevice::WriteOnly | QIODevice::Truncate );
+        obFile.write( QByteArray( i + 1, 'x' ) );
+        obFile.close();
+    }
+
+    cFileDiscovery                obDiscovery( 3 );
+    cFileDiscovery::tvFileEntries veFound = obDiscovery.find( qsRoot + "/**/*.log" );
+    testCase( "File discovery: Recursive mask count", 5, (int)veFound.size() );
+    if( veFound.size() == 5 )
+    {
+        testCase( "File discovery: Recursive mask file 1", QDir( qsRoot ).absoluteFilePath( "a/b/c/z.log" ).toStdString(), veFound[0].qsFileName.toStdString() );
+        testCase( "File discovery: Recursive mask file 2", QDir( qsRoot ).absoluteFilePath( "a/b/y.log" ).toStdString(), veFound[1].qsFileName.toStdString() );
+        testCase( "File discovery: Recursive mask file 5", QDir( qsRoot ).absoluteFilePath( "top.log" ).toStdString(), veFound[4].qsFileName.toStdString() );
+        testCase( "File discovery: File size", 4, (int)veFound[0].ullSize );
+        testCase( "File discovery: File modification time", true, veFound[0].tmModified > 0 );
+    }
+    testCase( "File discovery: Directories listed", 5, (int)obDiscovery.listedDirs() );
+
+    veFound = obDiscovery.find( qsRoot + "/*/*.log" );
+    testCase( "File discovery: Wild-card directory count", 2, (int)veFound.size() );
+    veFound = obDiscovery.find( qsRoot + "/a/**/Y.LOG" );
+    testCase( "File discovery: Recursive name ignoring case", 1, (int)veFound.size() );
+    veFound = obDiscovery.find( qsRoot + "/**/**/z.log" );
+    testCase( "File discovery: Repeated recursive mask count", 1, (int)veFound.size() );
+    veFound = obDiscovery.find( qsRoot + "/d/w.*" );
+    testCase( "File discovery: Plain mask count", 2, (int)veFound.size() );
+    veFound = obDiscovery.find( qsRoot + "/d/w.log*" );
+    testCase( "File discovery: Index files left out", 1, (int)veFound.size() );
+    testCase( "File discovery: Listings reused", 5, (int)obDiscovery.listedDirs() );
+
+    // The listings are kept, a file removed after the first search is still found
+    QFile::remove( qsRoot + "/top.log" );
+    veFound = obDiscovery.find( qsRoot + "/top.log" );
+    testCase( "File discovery: Cached listing", 1, (int)veFound.size() );
+
+    try
+    {
+        cLogDataSource *poDS = new cLogDataSource( g_poPrefs->tempDir(), "discovery_test/**/*.log", true, 0, &obDiscovery );
+        testCase( "File discovery: Data Source Input Log Count", 5, poDS->origFileList().size() );
+        delete poDS;
+    }
+    catch( cSevException &e )
+    {
+        g_obLogger << e;
+        m_uiFailedNum++;
+    }
+
+    for( int i = 1; i < 9; i++ ) QFile::remove( qsRoot + "/" + apFiles[i] );
+    const char *apDirs[] = { "a/b/c", "a/b", "a", "d", "" };
+    for( int i = 0; i < 5; i++ ) QDir().rmdir( qsRoot + "/" + apDirs[i] );
+}
+
+void cDataSourceTest::testLineIndex() throw()
+{
+    printNote( "LINE INDEX TESTS" );
+
+    QString qsFileName  = QString( "%1/line_index_test.log" ).arg( g_poPrefs->tempDir() );
+    QString qsIndexFile = cLineIndex::indexFileName( qsFileName, g_poPrefs->tempDir() );
+    QFile   obFile( qsFileName );
+    obFile.open( QIODevice::WriteOnly | QIODevice::Truncate );
+    for( int i = 1; i <= 20000; i++ ) obFile.write( QString( "Log Line %1\n" ).arg( i ).toAscii() );
+    obFile.close();
+
+    try
+    {
+        // The index is built from the blocks of a small buffer, with points 4 kB apart
+        cLineIndex          obIndex( qsFileName, 4096 );
+        cLineReader         obReader( qsFileName, 65536 );
+        const char         *poBegin    = NULL;
+        const char         *poEnd      = NULL;
+        unsigned long long  ullOffset  = 0;
+        unsigned long long  ullLines   = 0;
+        while( obReader.readBlock( &poBegin, &poEnd ) )
+        {
+            obIndex.addBlock( poBegin, poEnd, ullOffset, obReader.offset(), ullLines );
+            ullLines  += cLineSplitter::countNewLines( poBegin, poEnd );
+            ullOffset  = obReader.offset();
+        }
+
+        unsigned long long ullFileSize = QFileInfo( qsFileName ).size();
+        testCase( "Line index: Point count", true, obIndex.pointCount() >= ullFileSize / 4200 && obIndex.pointCount() <= ullFileSize / 4096 + 1 );
+        testCase( "Line index: First line read from the beginning", true, obIndex.findPoint( 1 ) && !obIndex.findPoint( 1 )->ullOffset );
+
+        const cLineIndex::tsPoint *poPoint = obIndex.findPoint( 10000 );
+        testCase( "Line index: Point in front of the line", true, poPoint && poPoint->ullLines < 10000 && poPoint->ullOffset > 0 );
+        if( poPoint )
+        {
+            QFile obCheck( qsFileName );
+            obCheck.open( QIODevice::ReadOnly );
+            obCheck.seek( poPoint->ullOffset );
+            testCase( "Line index: Point at the beginning of a line", QString( "Log Line %1\n" ).arg( poPoint->ullLines + 1 ).toStdString(),
+                      QString( obCheck.readLine() ).toStdString() );
+        }
+
+        QStringList slLines = obIndex.lines( 9998, 10002 );
+        testCase( "Line index: Context line count", 5, slLines.size() );
+        if( slLines.size() == 5 )
+        {
+            testCase( "Line index: First context line", std::string( "Log Line 9998" ), slLines.at( 0 ).toStdString() );
+            testCase( "Line index: Last context line", std::string( "Log Line 10002" ), slLines.at( 4 ).toStdString() );
+        }
+        testCase( "Line index: Context at the end of the file", 2, obIndex.lines( 19999, 20005 ).size() );
+
+        obIndex.save( qsIndexFile );
+        testCase( "Line index: Index below 1% of the file", true, QFileInfo( qsIndexFile ).size() * 100 < (qint64)ullFileSize );
+
+        cLineIndex obLoaded( qsFileName );
+        testCase( "Line index: Index loaded", true, obLoaded.load( qsIndexFile ) );
+        testCase( "Line index: Loaded point count", (int)obIndex.pointCount(), (int)obLoaded.pointCount() );
+        slLines = obLoaded.lines( 1, 1 );
+        testCase( "Line index: Loaded index reads lines", std::string( "Log Line 1" ), slLines.size() ? slLines.at( 0 ).toStdString() : std::string() );
+
+        // An index of a file that changed since is not loaded
+        obFile.open( QIODevice::WriteOnly | QIODevice::Append );
+        obFile.write( "Log Line 20001\n" );
+        obFile.close();
+        testCase( "Line index: Index of changed file not loaded", false, obLoaded.load( qsIndexFile ) );
+    }
+    catch( cSevException &e )
+    {
+        g_obLogger << e;
+        m_uiFailedNum++;
+    }
+
+    QFile::remove( qsFileName );
+    QFile::remove( qsIndexFile );
 }
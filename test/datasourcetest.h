@@ -13,6 +13,15 @@ public:
 
 private:
     void         testDataSource() throw();
+    void         testDecodeKernels() throw();
+    void         testSplitKernels() throw();
+    void         testGzipIndex() throw();
+    void         testPreparedCache() throw();
+    void         testStreamCodecs() throw();
+    void         testFollowState() throw();
+    void         testLongLines() throw();
+    void         testFileDiscovery() throw();
+    void         testLineIndex() throw();
 };
 
 #endif // DATASOURCETEST_H
@@ -17,6 +17,10 @@
 #include "datasourcetest.h"
 #include "outputcreatortest.h"
 #include "loganalysertest.h"
+#include "linesplitterbench.h"
+#include "timestampbench.h"
+#include "syserrorbench.h"
+#include "codecbench.h"
 //#include "batchanalysertest.h"
 
 using namespace std;
@@ -42,6 +46,10 @@ int main( int argc, char *argv[] )
     QStringList slAllTests;
     slAllTests << "actiondef"<< "datasource" << "outputcreator" << "loganalyser" << "batchanalyser" ;
 
+    /* Benchmarks take long, so they only run when requested by name */
+    QStringList slAllBenchmarks;
+    slAllBenchmarks << "linesplitterbench" << "timestampbench" << "syserrorbench" << "codecbench";
+
     /* Determine list of Tests to run */
     QStringList slTestsToRun;
     if( argc == 1 )
@@ -66,10 +74,15 @@ int main( int argc, char *argv[] )
         else if( slTestsToRun[inTest] == "datasource" )    poTest = new cDataSourceTest;
         else if( slTestsToRun[inTest] == "outputcreator" ) poTest = new cOutputCreatorTest;
         else if( slTestsToRun[inTest] == "loganalyser" )   poTest = new cLogAnalyserTest;
+        else if( slTestsToRun[inTest] == "linesplitterbench" ) poTest = new cLineSplitterBench;
+        else if( slTestsToRun[inTest] == "timestampbench" )    poTest = new cTimeStampBench;
+        else if( slTestsToRun[inTest] == "syserrorbench" )     poTest = new cSysErrorBench;
+        else if( slTestsToRun[inTest] == "codecbench" )        poTest = new cCodecBench;
         else
         {
             cout << "Invalid test name: " << slTestsToRun[inTest].toStdString() << endl;
-            cout << "    Test name can be one of: " << slAllTests.join( ", " ).toStdString() << endl << endl;
+            cout << "    Test name can be one of: " << slAllTests.join( ", " ).toStdString() << endl;
+            cout << "    Benchmark name can be one of: " << slAllBenchmarks.join( ", " ).toStdString() << endl << endl;
         }
 
         if( poTest )
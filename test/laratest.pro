@@ -18,6 +18,21 @@ HEADERS = ../../qtframework/severity.h \
     ../src/actiondefsingleliner.h \
     ../src/actiondeflist.h \
     ../src/pattern.h \
+    ../src/literalfilter.h \
+    ../src/regexpset.h \
+    ../src/timestampparser.h \
+    ../src/linesplitter.h \
+    ../src/linereader.h \
+    ../src/ziparchive.h \
+    ../src/syserrordecoder.h \
+    ../src/gzipindex.h \
+    ../src/streamcodec.h \
+    ../src/preparedcache.h \
+    ../src/followstate.h \
+    ../src/checkpoint.h \
+    ../src/filediscovery.h \
+    ../src/timecatalog.h \
+    ../src/lineindex.h \
     ../src/countaction.h \
     ../src/action.h \
     ../src/logdatasource.h \
@@ -28,7 +43,12 @@ HEADERS = ../../qtframework/severity.h \
     actiondeftest.h \
     loganalysertest.h \
     datasourcetest.h \
-    outputcreatortest.h
+    outputcreatortest.h \
+    linesplitterbench.h \
+    timestampbench.h \
+    syserrorbench.h \
+    codecbench.h \
+    testcompressor.h
 
 SOURCES = ../../qtframework/logger.cpp \
     ../../qtframework/consolewriter.cpp \
@@ -41,6 +61,21 @@ SOURCES = ../../qtframework/logger.cpp \
     ../src/actiondefsingleliner.cpp \
     ../src/actiondeflist.cpp \
     ../src/pattern.cpp \
+    ../src/literalfilter.cpp \
+    ../src/regexpset.cpp \
+    ../src/timestampparser.cpp \
+    ../src/linesplitter.cpp \
+    ../src/linereader.cpp \
+    ../src/ziparchive.cpp \
+    ../src/syserrordecoder.cpp \
+    ../src/gzipindex.cpp \
+    ../src/streamcodec.cpp \
+    ../src/preparedcache.cpp \
+    ../src/followstate.cpp \
+    ../src/checkpoint.cpp \
+    ../src/filediscovery.cpp \
+    ../src/timecatalog.cpp \
+    ../src/lineindex.cpp \
     ../src/countaction.cpp \
     ../src/action.cpp \
     ../src/logdatasource.cpp \
@@ -52,7 +87,12 @@ SOURCES = ../../qtframework/logger.cpp \
     actiondeftest.cpp \
     loganalysertest.cpp \
     datasourcetest.cpp \
-    outputcreatortest.cpp
+    outputcreatortest.cpp \
+    linesplitterbench.cpp \
+    timestampbench.cpp \
+    syserrorbench.cpp \
+    codecbench.cpp \
+    testcompressor.cpp
 
 DESTDIR = ..
 
@@ -63,3 +103,9 @@ QT += xmlpatterns
 
 CONFIG += qt
 CONFIG += console
+
+LIBS += -lpcre2-8
+LIBS += -lz
+LIBS += -lzstd
+LIBS += -llzma
+LIBS += -lbz2
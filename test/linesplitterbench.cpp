@@ -0,0 +1,107 @@
+#include <QString>
+#include <QElapsedTimer>
+
+#include <cstring>
+
+#include <linesplitter.h>
+
+#include "linesplitterbench.h"
+
+static const unsigned int  s_uiDataSize    = 64 * 1024 * 1024;
+static const unsigned int  s_uiRepetitions = 16;
+
+cLineSplitterBench::cLineSplitterBench() throw() : cUnitTest( "Line Splitter Benchmark" )
+{
+    // Synthetic Input Log with lines of varying length, similar to the real logs
+    const char  *poLine = "2010-04-09 13:15:01.000 [CYCLER.CORE.INFO.0] Throwing the Holy Hand Grenade at the White Furry Rabbit";
+    unsigned int uiLineLength = strlen( poLine );
+    m_veData.reserve( s_uiDataSize );
+    for( unsigned int i = 0; m_veData.size() + uiLineLength + 1 < s_uiDataSize; i++ )
+    {
+        m_veData.insert( m_veData.end(), poLine, poLine + 40 + (i * 7) % (uiLineLength - 40) );
+        m_veData.push_back( '\n' );
+    }
+}
+
+cLineSplitterBench::~cLineSplitterBench() throw()
+{
+    cLineSplitter::setKernel( cLineSplitter::bestKernel() );
+}
+
+void cLineSplitterBench::run() throw()
+{
+    benchCountNewLines();
+    benchSplitLines();
+}
+
+void cLineSplitterBench::benchCountNewLines() throw()
+{
+    printNote( "COUNT NEW LINES BENCHMARK" );
+
+    const char   *poBegin = &m_veData[0];
+    const char   *poEnd   = poBegin + m_veData.size();
+
+    cLineSplitter::setKernel( cLineSplitter::SCALAR );
+    unsigned long ulExpected = cLineSplitter::countNewLines( poBegin, poEnd );
+
+    for( int inKernel = cLineSplitter::SCALAR; inKernel <= cLineSplitter::AVX2; inKernel++ )
+    {
+        cLineSplitter::teKernel enKernel = (cLineSplitter::teKernel)inKernel;
+        if( !cLineSplitter::setKernel( enKernel ) )
+        {
+            printNote( QString( "%1 kernel is not supported by this CPU" ).arg( cLineSplitter::toStr( enKernel ) ).toStdString() );
+            continue;
+        }
+
+        unsigned long ulCount = 0;
+        QElapsedTimer obTimer;
+        obTimer.start();
+        for( unsigned int i = 0; i < s_uiRepetitions; i++ )
+        {
+            ulCount = cLineSplitter::countNewLines( poBegin, poEnd );
+        }
+        qint64 inNanoSecs = obTimer.nsecsElapsed();
+
+        testCase( QString( "%1 kernel line count" ).arg( cLineSplitter::toStr( enKernel ) ).toStdString(),
+                  (int)ulExpected, (int)ulCount );
+
+        printNote( QString( "%1 countNewLines: %2 GB/s" ).arg( cLineSplitter::toStr( enKernel ) )
+                   .arg( (double)m_veData.size() * s_uiRepetitions / inNanoSecs, 0, 'f', 2 ).toStdString() );
+    }
+}
+
+void cLineSplitterBench::benchSplitLines() throw()
+{
+    printNote( "SPLIT LINES BENCHMARK" );
+
+    const char   *poBegin = &m_veData[0];
+    const char   *poEnd   = poBegin + m_veData.size();
+
+    cLineSplitter::setKernel( cLineSplitter::SCALAR );
+    unsigned long ulExpected = cLineSplitter::countNewLines( poBegin, poEnd );
+
+    for( int inKernel = cLineSplitter::SCALAR; inKernel <= cLineSplitter::AVX2; inKernel++ )
+    {
+        cLineSplitter::teKernel enKernel = (cLineSplitter::teKernel)inKernel;
+        if( !cLineSplitter::setKernel( enKernel ) ) continue;
+
+        unsigned long ulLines = 0;
+        QElapsedTimer obTimer;
+        obTimer.start();
+        for( unsigned int i = 0; i < s_uiRepetitions; i++ )
+        {
+            ulLines = 0;
+            for( const char *poPos = poBegin; poPos < poEnd; ulLines++ )
+            {
+                poPos = cLineSplitter::findNewLine( poPos, poEnd ) + 1;
+            }
+        }
+        qint64 inNanoSecs = obTimer.nsecsElapsed();
+
+        testCase( QString( "%1 kernel split line count" ).arg( cLineSplitter::toStr( enKernel ) ).toStdString(),
+                  (int)ulExpected, (int)ulLines );
+
+        printNote( QString( "%1 findNewLine: %2 GB/s" ).arg( cLineSplitter::toStr( enKernel ) )
+                   .arg( (double)m_veData.size() * s_uiRepetitions / inNanoSecs, 0, 'f', 2 ).toStdString() );
+    }
+}
@@ -0,0 +1,23 @@
+#ifndef LINESPLITTERBENCH_H
+#define LINESPLITTERBENCH_H
+
+#include <vector>
+
+#include "unittest.h"
+
+class cLineSplitterBench : public cUnitTest
+{
+public:
+    cLineSplitterBench()              throw();
+    virtual ~cLineSplitterBench()     throw();
+
+    virtual void run()                throw();
+
+private:
+    std::vector<char>  m_veData;
+
+    void         benchCountNewLines() throw();
+    void         benchSplitLines()    throw();
+};
+
+#endif // LINESPLITTERBENCH_H
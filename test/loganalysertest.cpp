@@ -1,11 +1,14 @@
 #include <QStringList>
 #include <QFile>
+#include <QDir>
 
 #include <logger.h>
 #include <preferences.h>
 
 #include <action.h>
 #include <loganalyser.h>
+#include <logdatasource.h>
+#include <timecatalog.h>
 
 #include "loganalysertest.h"
 
@@ -24,6 +27,7 @@ void cLogAnalyserTest::run() throw()
 {
     testAction();
     testLogAnalyser();
+    testTimeRange();
 }
 
 void cLogAnalyserTest::testAction() throw()
@@ -136,6 +140,15 @@ void cLogAnalyserTest::testLogAnalyser() throw()
         delete poLA;
         poLA = NULL;
 
+        // The Patterns following the one with an invalid regular expression are still found
+        poLA = new cLogAnalyser( qsDirPrefix, "test*.log.gz", "test/invalid_regexp_actions.xml", NULL );
+        poLA->analyse();
+
+        testCase( "Invalid Pattern regexp, Pattern count", 4, poLA->patternCount() );
+
+        delete poLA;
+        poLA = NULL;
+
         cOutputCreator  *poOC        = NULL;
         poOC = new cOutputCreator( qsDirPrefix );
 
@@ -155,25 +168,29 @@ void cLogAnalyserTest::testLogAnalyser() throw()
 
         poOC->generateActionList();
 
+        // The decompressed copies are named after a hash of the original file (see
+        // cLogDataSource::tempFileName()), without the extension of the codec
+        QString qsOrigDir   = QDir::cleanPath( g_poPrefs->inputDir() + "/" + qsDirPrefix );
+        QString qsPrepared1 = cLogDataSource::tempFileName( qsOrigDir + "/test1.log.gz" );
+        QString qsPrepared2 = cLogDataSource::tempFileName( qsOrigDir + "/test2.log.gz" );
+        qsPrepared1.chop( 3 );
+        qsPrepared2.chop( 3 );
+
         QStringList slListContent;
         QString qsListLine = "2010-04-09 13:50:01.000 HOLY_HAND_GRENADE OK type=\"combat\" ";
-        qsListLine += g_poPrefs->tempDir();
-        qsListLine += "/test2.log:5";
+        qsListLine += qsPrepared2 + ":5";
         slListContent << qsListLine;
 
         qsListLine = "2010-04-09 13:15:01.000 HOLY_HAND_GRENADE OK type=\"combat\" ";
-        qsListLine += g_poPrefs->tempDir();
-        qsListLine += "/test1.log:1";
+        qsListLine += qsPrepared1 + ":1";
         slListContent << qsListLine;
 
         qsListLine = "2010-04-09 13:50:00.000 NEW_TARGET OK subtype=\"targeting\" target=\"White Furry Rabbit\" type=\"intel\" ";
-        qsListLine += g_poPrefs->tempDir();
-        qsListLine += "/test2.log:4";
+        qsListLine += qsPrepared2 + ":4";
         slListContent << qsListLine;
 
         qsListLine = "2010-04-09 13:35:00.000 NEW_TARGET OK subtype=\"targeting\" target=\"White Furry Rabbit\" type=\"intel\" ";
-        qsListLine += g_poPrefs->tempDir();
-        qsListLine += "/test2.log:2";
+        qsListLine += qsPrepared2 + ":2";
         slListContent << qsListLine;
 
         checkFileContents( qsActionListFileName.toStdString(), slListContent );
@@ -187,3 +204,80 @@ void cLogAnalyserTest::testLogAnalyser() throw()
         m_uiFailedNum++;
     }
 }
+
+void cLogAnalyserTest::testTimeRange() throw()
+{
+    printNote( "TIME RANGE TESTS" );
+
+    try
+    {
+        unsigned long long ullFrom = 0;
+        unsigned long long ullTo   = 0;
+        testCase( "Time range: Parse from time", true, cTimeCatalog::parseTime( "2010-04-09 13:40", &ullFrom ) );
+        testCase( "Time range: Parse to time", true, cTimeCatalog::parseTime( "2010-04-10T00:00:00", &ullTo ) );
+        testCase( "Time range: Invalid time", false, cTimeCatalog::parseTime( "yesterday", &ullTo ) );
+        cTimeCatalog::parseTime( "2010-04-10", &ullTo );
+
+        unsigned long long ullTime = 0;
+        cTimeCatalog::parseTime( "2010-04-09 13:45:00.500", &ullTime );
+        testCase( "Time range: Time keys ordered", true, ullFrom < ullTime && ullTime < ullTo );
+
+        // A catalog built by hand: one point in every hour from 10:00 to 15:00
+        cTimeCatalog obCatalog( "catalog_test.log", "regexp" );
+        for( int i = 0; i < 6; i++ )
+        {
+            cTimeCatalog::parseTime( QString( "2010-04-09 %1:00" ).arg( 10 + i ), &ullTime );
+            obCatalog.addPoint( ullTime, i * 1000, i * 10 );
+        }
+        obCatalog.finish();
+
+        cTimeCatalog::parseTime( "2010-04-09 12:30", &ullFrom );
+        cTimeCatalog::parseTime( "2010-04-09 14:00", &ullTo );
+        const cTimeCatalog::tsPoint *poStart = obCatalog.startPoint( ullFrom );
+        testCase( "Time range: Catalog overlaps", true, obCatalog.overlaps( ullFrom, ullTo ) );
+        testCase( "Time range: Catalog start offset", 2000, poStart ? (int)poStart->ullOffset : -1 );
+        testCase( "Time range: Catalog start lines", 20, poStart ? (int)poStart->ullLines : -1 );
+        testCase( "Time range: Catalog end offset", 4000, (int)obCatalog.endOffset( ullTo ) );
+
+        cTimeCatalog::parseTime( "2010-04-09 16:00", &ullFrom );
+        cTimeCatalog::parseTime( "2010-04-09 17:00", &ullTo );
+        testCase( "Time range: Catalog outside the range", false, obCatalog.overlaps( ullFrom, ullTo ) );
+
+        // The first run catalogues the files, the second one uses the catalogs and skips
+        // test1.log.gz, which is entirely before the range, both find the two Patterns of the
+        // range. The catalogs belong to the original files, not to their prepared copies, and
+        // the mask of the second run does not find them.
+        cTimeCatalog::parseTime( "2010-04-09 13:40", &ullFrom );
+        cTimeCatalog::parseTime( "2010-04-10", &ullTo );
+        QString qsCatalogFile1 = cTimeCatalog::catalogFileName( QString( "%1/multiple_files/test1/test1.log.gz" ).arg( g_poPrefs->inputDir() ), g_poPrefs->indexDir() );
+        QString qsCatalogFile2 = cTimeCatalog::catalogFileName( QString( "%1/multiple_files/test1/test2.log.gz" ).arg( g_poPrefs->inputDir() ), g_poPrefs->indexDir() );
+        QFile::remove( qsCatalogFile1 );
+        QFile::remove( qsCatalogFile2 );
+        unsigned long long ullLinesRead[2] = { 0, 0 };
+        for( int i = 0; i < 2; i++ )
+        {
+            cLogAnalyser  obAnalyser( "multiple_files/test1", "test*.log.gz*", "test/test_actions.xml", NULL );
+            obAnalyser.setTimeRange( ullFrom, ullTo );
+            obAnalyser.analyse();
+            ullLinesRead[i] = obAnalyser.linesRead();
+
+            testCase( QString( "Time range: Run %1 Pattern count" ).arg( i + 1 ).toStdString(), 2, obAnalyser.patternCount() );
+            testCase( QString( "Time range: Run %1 catalog file exists" ).arg( i + 1 ).toStdString(), true, QFile::exists( qsCatalogFile2 ) );
+        }
+        testCase( "Time range: File before the range catalogued", true, QFile::exists( qsCatalogFile1 ) );
+        testCase( "Time range: Second run reads fewer Log Lines", true, ullLinesRead[1] < ullLinesRead[0] );
+        testCase( "Time range: No catalog next to the Input Log Files", true,
+                  QDir( g_poPrefs->inputDir() + "/multiple_files/test1" ).entryList( QStringList( "*.tcat" ) ).isEmpty() );
+        testCase( "Time range: No catalog of the prepared copies", true,
+                  QDir( g_poPrefs->tempDir() ).entryList( QStringList( "*.tcat" ) ).isEmpty() );
+
+        cLogDataSource obDataSource( g_poPrefs->inputDir(), "multiple_files/test1/test*.log.gz*", true );
+        testCase( "Time range: Mask finds no index files", 2, obDataSource.origFileList().size() );
+        QFile::remove( qsCatalogFile1 );
+        QFile::remove( qsCatalogFile2 );
+    } catch( cSevException &e )
+    {
+        g_obLogger << e;
+        m_uiFailedNum++;
+    }
+}
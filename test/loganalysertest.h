@@ -14,6 +14,7 @@ public:
 private:
     void         testAction()         throw();
     void         testLogAnalyser()    throw();
+    void         testTimeRange()      throw();
 };
 
 #endif // LOGANALYSERTEST_H
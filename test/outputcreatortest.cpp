@@ -6,6 +6,8 @@
 #include <QFile>
 #include <QTextStream>
 #include <QSqlQuery>
+#include <QDir>
+#include <QDataStream>
 
 #include "action.h"
 
@@ -29,6 +31,7 @@ void cOutputCreatorTest::run() throw()
     testTextFileResults();
     testDatabaseResults();
     testCombilogResults();
+    testCheckpoint();
 }
 
 void cOutputCreatorTest::testTextFileResults()  throw()
@@ -225,9 +228,135 @@ void cOutputCreatorTest::testCombilogResults()  throw()
 
         checkFileContents( qsCombilogFileName.toStdString(), slExpectedCombilogContent );
 
+        // A followed analysis adds the entries of a later run to the Combined Log
+        QString qsFollowDir = g_poPrefs->outputDir() + "/combilog_follow_test";
+        QFile::remove( qsFollowDir + "/combilog.html" );
+        QFile::remove( qsFollowDir + "/followstate.ini" );
+
+        cOutputCreator *poOC = new cOutputCreator( "combilog_follow_test", true );
+        poOC->addCombilogEntry( 1, "Followed Line 1", "#000088" );
+        poOC->generateCombilog();
+        poOC->saveFollowState();
+        delete poOC;
+
+        poOC = new cOutputCreator( "combilog_follow_test", true );
+        poOC->addCombilogEntry( 2, "Followed Line 2", "#000099" );
+        poOC->generateCombilog();
+        delete poOC;
+
+        QStringList slExpectedFollowContent;
+        slExpectedFollowContent << "<div><pre class=\"combilogline\" style=\"background: #000088\">Followed Line 1</pre></div>";
+        slExpectedFollowContent << "<div><pre class=\"combilogline\" style=\"background: #000099\">Followed Line 2</pre></div>";
+        checkFileContents( ( qsFollowDir + "/combilog.html" ).toStdString(), slExpectedFollowContent );
+
+        QFile obFollowFile( qsFollowDir + "/combilog.html" );
+        obFollowFile.open( QIODevice::ReadOnly );
+        testCase( "Followed Combined Log closed once", 1, obFollowFile.readAll().count( "</body></html>" ) );
+        obFollowFile.close();
+
+    } catch( cSevException &e )
+    {
+        g_obLogger << e;
+        m_uiFailedNum++;
+    }
+}
+
+void cOutputCreatorTest::testCheckpoint()  throw()
+{
+    printNote( "CHECKPOINT TESTS" );
+
+    QString qsDir            = g_poPrefs->outputDir() + "/checkpoint_test";
+    QString qsCheckpointFile = qsDir + "/checkpoint.dat";
+    QDir().mkpath( qsDir );
+
+    try
+    {
+        cCheckpoint *poCheckpoint = new cCheckpoint( qsCheckpointFile, 0 );
+        poCheckpoint->open( false );
+        poCheckpoint->append( cCheckpoint::FILE_DONE, "first" );
+        poCheckpoint->commit();
+        poCheckpoint->append( cCheckpoint::FILE_DONE, "not committed" );
+        delete poCheckpoint;
+
+        // A checkpoint torn while it was written is dropped
+        QFile obFile( qsCheckpointFile );
+        obFile.open( QIODevice::WriteOnly | QIODevice::Append );
+        obFile.write( QByteArray( "\x07\x00\x00\x10", 4 ) );
+        obFile.close();
+
+        poCheckpoint = new cCheckpoint( qsCheckpointFile, 0 );
+        testCase( "Checkpoint: Committed checkpoint loaded", true, poCheckpoint->load() );
+        testCase( "Checkpoint: Only committed records loaded", 1, (int)poCheckpoint->records().size() );
+        testCase( "Checkpoint: Record data", std::string( "first" ),
+                  poCheckpoint->records().size() ? std::string( poCheckpoint->records()[0].baData.constData() ) : std::string() );
+        testCase( "Checkpoint: No Log Analyser finished", 0, (int)poCheckpoint->analysersDone() );
+
+        poCheckpoint->open( true );
+        poCheckpoint->append( cCheckpoint::ANALYSER_DONE, QByteArray() );
+        poCheckpoint->commit();
+        delete poCheckpoint;
+
+        poCheckpoint = new cCheckpoint( qsCheckpointFile, 0 );
+        poCheckpoint->load();
+        testCase( "Checkpoint: Resumed checkpoint appended", 2, (int)poCheckpoint->records().size() );
+        testCase( "Checkpoint: Log Analyser finished", 1, (int)poCheckpoint->analysersDone() );
+        testCase( "Checkpoint: Analysis not finished", false, poCheckpoint->analysisDone() );
+        delete poCheckpoint;
+
+        if( g_poPrefs->checkpointInterval() )
+        {
+            // The results recorded by the Output Creator are restored when resuming
+            cOutputCreator *poOC = new cOutputCreator( "checkpoint_test" );
+            poOC->fileId( "checkpoint_input.log.1" );
+            poOC->addCountAction( "CHECKPOINT_COUNT", 3, 1 );
+            poOC->addAttribute( "cellName", "CHECKPOINT_CELL" );
+            poOC->checkpoint()->commit();
+            poOC->addCountAction( "CHECKPOINT_COUNT", 10, 10 );
+            delete poOC;
+
+            // A Combined Log entry without its file id and line number is dropped
+            QByteArray  baMalformed;
+            QDataStream obMalformedStream( &baMalformed, QIODevice::WriteOnly );
+            obMalformedStream << (quint64)1 << QString( "Malformed CombiLog Line" ) << QString( "#0000AA" );
+            poCheckpoint = new cCheckpoint( qsCheckpointFile, 0 );
+            poCheckpoint->load();
+            poCheckpoint->open( true );
+            poCheckpoint->append( cCheckpoint::COMBILOG_ENTRY, baMalformed );
+            poCheckpoint->commit();
+            delete poCheckpoint;
+
+            poOC = new cOutputCreator( "checkpoint_test", false, true );
+            testCase( "Checkpoint: Restored file id", 0, (int)poOC->fileId( "checkpoint_input.log.1" ) );
+            testCase( "Checkpoint: New file id after restored ones", 1, (int)poOC->fileId( "checkpoint_input.log.2" ) );
+
+            QString qsActionSummaryFileName = qsDir + "/actionsummary.txt";
+            poOC->generateActionSummary();
+
+            QString qsCombilogFileName = qsDir + "/combilog.html";
+            poOC->generateCombilog();
+            delete poOC;
+
+            QFile obCombilogFile( qsCombilogFileName );
+            obCombilogFile.open( QIODevice::ReadOnly );
+            testCase( "Checkpoint: Malformed Combined Log entry dropped", false, obCombilogFile.readAll().contains( "Malformed CombiLog Line" ) );
+            obCombilogFile.close();
+            QFile::remove( qsCombilogFileName );
+
+            QStringList slExpectedActionSummaryContent;
+            slExpectedActionSummaryContent << "checkpoint_input.log.1";
+            slExpectedActionSummaryContent << "checkpoint_input.log.2";
+            slExpectedActionSummaryContent << "cellName: CHECKPOINT_CELL";
+            slExpectedActionSummaryContent << "CHECKPOINT_COUNT OK: 3 FAILED: 1 TOTAL: 4";
+            checkFileContents( qsActionSummaryFileName.toStdString(), slExpectedActionSummaryContent );
+
+            QFile::remove( qsActionSummaryFileName );
+        }
     } catch( cSevException &e )
     {
         g_obLogger << e;
         m_uiFailedNum++;
     }
+
+    QFile::remove( qsCheckpointFile );
+    QDir().rmdir( qsDir );
 }
@@ -19,6 +19,7 @@ private:
     void         testTextFileResults()  throw();
     void         testDatabaseResults()  throw();
     void         testCombilogResults()  throw();
+    void         testCheckpoint()       throw();
 };
 
 #endif // OUTPUTCREATORTEST_H
@@ -0,0 +1,86 @@
+#include <QString>
+#include <QByteArray>
+#include <QElapsedTimer>
+
+#include <algorithm>
+
+#include <syserrordecoder.h>
+
+#include "syserrorbench.h"
+
+static const unsigned int  s_uiDataSize    = 64 * 1024 * 1024;
+static const unsigned int  s_uiRepetitions = 8;
+
+cSysErrorBench::cSysErrorBench() throw() : cUnitTest( "SysError Decoder Benchmark" )
+{
+    // Synthetic encrypted tags of varying length, similar to the tags of the real sysError files
+    QByteArray   baText = "Exception in thread main: java.lang.NullPointerException at com.example.Cycler.run(Cycler.java:42) ";
+    baText = baText.repeated( 4 );
+    m_veData.reserve( s_uiDataSize );
+    for( unsigned int i = 0; m_veData.size() + baText.size() * 2 < s_uiDataSize; i++ )
+    {
+        QByteArray baTag = baText.left( 40 + (i * 13) % (baText.size() - 40) ).toBase64();
+        m_veData.insert( m_veData.end(), baTag.constData(), baTag.constData() + baTag.size() );
+        m_veTagLengths.push_back( baTag.size() );
+    }
+}
+
+cSysErrorBench::~cSysErrorBench() throw()
+{
+    cSysErrorDecoder::setKernel( cSysErrorDecoder::bestKernel() );
+}
+
+void cSysErrorBench::run() throw()
+{
+    benchDecodeTags();
+}
+
+void cSysErrorBench::benchDecodeTags() throw()
+{
+    printNote( "DECODE TAGS BENCHMARK" );
+
+    std::vector<char>  veExpected( m_veData.size() );
+    std::vector<char>  veOutput( m_veData.size() );
+    unsigned int       uiExpectedSize = 0;
+
+    cSysErrorDecoder::setKernel( cSysErrorDecoder::SCALAR );
+    const char *poTag = &m_veData[0];
+    for( unsigned int i = 0; i < m_veTagLengths.size(); i++ )
+    {
+        uiExpectedSize += cSysErrorDecoder::decodeTag( poTag, m_veTagLengths[i], &veExpected[uiExpectedSize] );
+        poTag += m_veTagLengths[i];
+    }
+
+    for( int inKernel = cSysErrorDecoder::SCALAR; inKernel <= cSysErrorDecoder::AVX2; inKernel++ )
+    {
+        cSysErrorDecoder::teKernel enKernel = (cSysErrorDecoder::teKernel)inKernel;
+        if( !cSysErrorDecoder::setKernel( enKernel ) )
+        {
+            printNote( QString( "%1 kernel is not supported by this CPU" ).arg( cSysErrorDecoder::toStr( enKernel ) ).toStdString() );
+            continue;
+        }
+
+        unsigned int  uiSize = 0;
+        QElapsedTimer obTimer;
+        obTimer.start();
+        for( unsigned int r = 0; r < s_uiRepetitions; r++ )
+        {
+            uiSize = 0;
+            poTag  = &m_veData[0];
+            for( unsigned int i = 0; i < m_veTagLengths.size(); i++ )
+            {
+                uiSize += cSysErrorDecoder::decodeTag( poTag, m_veTagLengths[i], &veOutput[uiSize] );
+                poTag  += m_veTagLengths[i];
+            }
+        }
+        qint64 inNanoSecs = obTimer.nsecsElapsed();
+
+        testCase( QString( "%1 kernel decoded size" ).arg( cSysErrorDecoder::toStr( enKernel ) ).toStdString(),
+                  (int)uiExpectedSize, (int)uiSize );
+        testCase( QString( "%1 kernel decoded data" ).arg( cSysErrorDecoder::toStr( enKernel ) ).toStdString(),
+                  true, uiSize == uiExpectedSize && std::equal( veOutput.begin(), veOutput.begin() + uiSize, veExpected.begin() ) );
+
+        printNote( QString( "%1 decodeTag: %2 GB/s" ).arg( cSysErrorDecoder::toStr( enKernel ) )
+                   .arg( (double)m_veData.size() * s_uiRepetitions / inNanoSecs, 0, 'f', 2 ).toStdString() );
+    }
+}
@@ -0,0 +1,23 @@
+#ifndef SYSERRORBENCH_H
+#define SYSERRORBENCH_H
+
+#include <vector>
+
+#include "unittest.h"
+
+class cSysErrorBench : public cUnitTest
+{
+public:
+    cSysErrorBench()              throw();
+    virtual ~cSysErrorBench()     throw();
+
+    virtual void run()            throw();
+
+private:
+    std::vector<char>          m_veData;
+    std::vector<unsigned int>  m_veTagLengths;
+
+    void         benchDecodeTags() throw();
+};
+
+#endif // SYSERRORBENCH_H
@@ -0,0 +1,49 @@
+#include <vector>
+#include <cstring>
+#include <zlib.h>
+#include <zstd.h>
+#include <lzma.h>
+#include <bzlib.h>
+
+#include "testcompressor.h"
+
+QByteArray cTestCompressor::compress( const QString &p_qsCodec, const QByteArray &p_baData ) throw()
+{
+    std::vector<char> veOutput;
+    size_t            uiSize = 0;
+
+    if( p_qsCodec == "gzip" )
+    {
+        z_stream suStream;
+        memset( &suStream, 0, sizeof( suStream ) );
+        deflateInit2( &suStream, Z_DEFAULT_COMPRESSION, Z_DEFLATED, MAX_WBITS + 16, 8, Z_DEFAULT_STRATEGY );
+        veOutput.resize( deflateBound( &suStream, p_baData.size() ) + 32 );
+        suStream.next_in   = (Bytef *)p_baData.constData();
+        suStream.avail_in  = p_baData.size();
+        suStream.next_out  = (Bytef *)&veOutput[0];
+        suStream.avail_out = veOutput.size();
+        deflate( &suStream, Z_FINISH );
+        uiSize = suStream.total_out;
+        deflateEnd( &suStream );
+    }
+    else if( p_qsCodec == "zstd" )
+    {
+        veOutput.resize( ZSTD_compressBound( p_baData.size() ) );
+        uiSize = ZSTD_compress( &veOutput[0], veOutput.size(), p_baData.constData(), p_baData.size(), 3 );
+        if( ZSTD_isError( uiSize ) ) uiSize = 0;
+    }
+    else if( p_qsCodec == "xz" )
+    {
+        veOutput.resize( lzma_stream_buffer_bound( p_baData.size() ) );
+        if( lzma_easy_buffer_encode( LZMA_PRESET_DEFAULT, LZMA_CHECK_CRC64, NULL, (const uint8_t *)p_baData.constData(), p_baData.size(),
+                                     (uint8_t *)&veOutput[0], &uiSize, veOutput.size() ) != LZMA_OK ) uiSize = 0;
+    }
+    else if( p_qsCodec == "bzip2" )
+    {
+        unsigned int uiBzSize = p_baData.size() + p_baData.size() / 100 + 600;
+        veOutput.resize( uiBzSize );
+        if( BZ2_bzBuffToBuffCompress( &veOutput[0], &uiBzSize, (char *)p_baData.constData(), p_baData.size(), 9, 0, 0 ) == BZ_OK ) uiSize = uiBzSize;
+    }
+
+    return uiSize ? QByteArray( &veOutput[0], uiSize ) : QByteArray();
+}
@@ -0,0 +1,22 @@
+#ifndef TESTCOMPRESSOR_H
+#define TESTCOMPRESSOR_H
+
+#include <QString>
+#include <QByteArray>
+
+//! \brief Creates compressed data for the tests and benchmarks of the stream codecs
+/*! LARA only reads compressed Input Log Files, so the codecs of cCodecRegistry cannot
+ *  compress. The tests use this class to create compressed files in every format.
+ */
+class cTestCompressor
+{
+public:
+    //! \brief Compresses the given data with the library of the named codec
+    /*! \param p_qsCodec name of the codec (see cStreamCodec::name())
+     *  \param p_baData the data to compress
+     *  \return The compressed data, empty if the codec is unknown or compressing failed
+     */
+    static QByteArray compress( const QString &p_qsCodec, const QByteArray &p_baData ) throw();
+};
+
+#endif // TESTCOMPRESSOR_H
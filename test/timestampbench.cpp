@@ -0,0 +1,138 @@
+#include <QString>
+#include <QElapsedTimer>
+
+#include <logger.h>
+
+#include <cstdio>
+#include <cstring>
+
+#include <actiondeflist.h>
+#include <timestampparser.h>
+
+#include "timestampbench.h"
+
+extern cLogger g_obLogger;
+
+// 100,000 distinct lines parsed 100 times: 10 million time-stamps per parser
+static const unsigned int  s_uiLineCount   = 100000;
+static const unsigned int  s_uiRepetitions = 100;
+
+cTimeStampBench::cTimeStampBench() throw() : cUnitTest( "Time-Stamp Parser Benchmark" )
+{
+    // Synthetic Input Log with a few lines per millisecond, like the real logs
+    char poLine[128];
+    m_veData.reserve( s_uiLineCount * 80 );
+    for( unsigned int i = 0; i < s_uiLineCount; i++ )
+    {
+        unsigned int uiMSecs = i * 7;
+        int inLength = snprintf( poLine, sizeof( poLine ), "2010-04-09 %02u:%02u:%02u.%03u [CYCLER.CORE.INFO.0] Spotted a White Furry Rabbit",
+                                 13 + uiMSecs / 3600000, (uiMSecs / 60000) % 60, (uiMSecs / 1000) % 60, uiMSecs % 1000 );
+        m_veLineStarts.push_back( m_veData.size() );
+        m_veData.insert( m_veData.end(), poLine, poLine + inLength );
+    }
+    m_veLineStarts.push_back( m_veData.size() );
+}
+
+cTimeStampBench::~cTimeStampBench() throw()
+{
+}
+
+void cTimeStampBench::run() throw()
+{
+    testEquivalence();
+    benchParsers();
+}
+
+void cTimeStampBench::testEquivalence() throw()
+{
+    printNote( "TIME-STAMP PARSER EQUIVALENCE" );
+
+    try
+    {
+        cActionDefList   obActionDefList( "test/test_actions.xml", "data/lara_actions.xsd" );
+        cTimeStampParser obFastParser( &obActionDefList );
+        cTimeStampParser obRegExpParser( &obActionDefList );
+        obRegExpParser.disableFastPath();
+        cTimeStampScratch obFastScratch( &obFastParser );
+        cTimeStampScratch obRegExpScratch( &obRegExpParser );
+
+        testCase( "Time-stamp layout recognized", true, obFastParser.fastPath() );
+
+        unsigned int uiDifferences = 0;
+        for( unsigned int i = 0; i < s_uiLineCount; i++ )
+        {
+            const char   *poLine   = &m_veData[m_veLineStarts[i]];
+            unsigned int  uiLength = m_veLineStarts[i + 1] - m_veLineStarts[i];
+
+            QString              qsFastText;
+            QString              qsRegExpText;
+            cAction::tsTimeStamp suFast;
+            cAction::tsTimeStamp suRegExp;
+            memset( &suFast, 0, sizeof( suFast ) );
+            memset( &suRegExp, 0, sizeof( suRegExp ) );
+            bool boFast   = obFastParser.parse( poLine, uiLength, &qsFastText, &suFast, &obFastScratch );
+            bool boRegExp = obRegExpParser.parse( poLine, uiLength, &qsRegExpText, &suRegExp, &obRegExpScratch );
+            if( boFast != boRegExp || qsFastText != qsRegExpText || memcmp( &suFast, &suRegExp, sizeof( suFast ) ) != 0 ) uiDifferences++;
+        }
+
+        testCase( "Digit parser and regexp give the same time-stamps", 0, uiDifferences );
+
+        const char *poLine = "x2010-04-09 13:35:00.000 starts with a letter";
+        QString              qsText;
+        cAction::tsTimeStamp suTimeStamp;
+        memset( &suTimeStamp, 0, sizeof( suTimeStamp ) );
+        testCase( "Digit parser falls back to regexp", true, obFastParser.parse( poLine, strlen( poLine ), &qsText, &suTimeStamp, &obFastScratch ) );
+
+        testCase( "Digit parser fallback time-stamp", "2010-04-09 13:35:00.000", qsText.toStdString() );
+
+    } catch( cSevException &e )
+    {
+        g_obLogger << e;
+        m_uiFailedNum++;
+    }
+}
+
+void cTimeStampBench::benchParsers() throw()
+{
+    printNote( "TIME-STAMP PARSER BENCHMARK" );
+
+    try
+    {
+        cActionDefList obActionDefList( "test/test_actions.xml", "data/lara_actions.xsd" );
+
+        for( int inFastPath = 1; inFastPath >= 0; inFastPath-- )
+        {
+            cTimeStampParser obParser( &obActionDefList );
+            if( !inFastPath ) obParser.disableFastPath();
+            cTimeStampScratch obScratch( &obParser );
+
+            QString              qsText;
+            cAction::tsTimeStamp suTimeStamp;
+            unsigned long long   ullChecksum = 0;
+            memset( &suTimeStamp, 0, sizeof( suTimeStamp ) );
+            QElapsedTimer        obTimer;
+            obTimer.start();
+            for( unsigned int r = 0; r < s_uiRepetitions; r++ )
+            {
+                for( unsigned int i = 0; i < s_uiLineCount; i++ )
+                {
+                    obParser.parse( &m_veData[m_veLineStarts[i]], m_veLineStarts[i + 1] - m_veLineStarts[i], &qsText, &suTimeStamp, &obScratch );
+                    ullChecksum += suTimeStamp.uiMSecond;
+                }
+            }
+            qint64 inNanoSecs = obTimer.nsecsElapsed();
+
+            printNote( QString( "%1: %2 lines in %3 ms, %4 ns/line (checksum %5)" )
+                       .arg( inFastPath ? "Digit parser" : "QRegExp" )
+                       .arg( (unsigned long long)s_uiLineCount * s_uiRepetitions )
+                       .arg( inNanoSecs / 1000000 )
+                       .arg( (double)inNanoSecs / s_uiLineCount / s_uiRepetitions, 0, 'f', 1 )
+                       .arg( ullChecksum ).toStdString() );
+        }
+
+    } catch( cSevException &e )
+    {
+        g_obLogger << e;
+        m_uiFailedNum++;
+    }
+}
@@ -0,0 +1,24 @@
+#ifndef TIMESTAMPBENCH_H
+#define TIMESTAMPBENCH_H
+
+#include <vector>
+
+#include "unittest.h"
+
+class cTimeStampBench : public cUnitTest
+{
+public:
+    cTimeStampBench()                 throw();
+    virtual ~cTimeStampBench()        throw();
+
+    virtual void run()                throw();
+
+private:
+    std::vector<char>          m_veData;
+    std::vector<unsigned int>  m_veLineStarts;
+
+    void         testEquivalence()    throw();
+    void         benchParsers()       throw();
+};
+
+#endif // TIMESTAMPBENCH_H